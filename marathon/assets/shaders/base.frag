@@ -10,7 +10,6 @@
 in vec3 vColour;
 
 // uniforms
-uniform vec3    uResolution;
 uniform float   uTime;
 uniform float   uTimeDelta;
 uniform int     uFrame;  
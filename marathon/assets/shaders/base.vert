@@ -18,18 +18,34 @@ layout(location = 4) in vec2 aUV0;
 layout(location = 5) in vec2 aUV1;
 layout(location = 6) in vec2 aUV2;
 layout(location = 7) in vec2 aUV3;
+#ifdef INSTANCED
+// per instance model matrix, occupies locations 8-11
+layout(location = 8) in mat4 aInstanceModel;
+#endif
 
 // "varying" variables
 out vec3 vColour;
 
 // uniforms
 uniform float   uTime;
+#ifndef INSTANCED
 uniform mat4	uModel;
-uniform mat4	uView;
-uniform mat4	uProjection;
+#endif
+// shared per frame camera data, see renderer/uniform_blocks.hpp
+layout(std140) uniform Camera {
+    mat4    uView;
+    mat4    uProjection;
+    vec3    uResolution;
+    vec3    uCameraPosition;
+};
 
 void main()
 {
+#ifdef INSTANCED
+    mat4 model = aInstanceModel;
+#else
+    mat4 model = uModel;
+#endif
     vColour = aPosition;
-	gl_Position = uProjection * uView * uModel * vec4(aPosition, 1.0f);
+	gl_Position = uProjection * uView * model * vec4(aPosition, 1.0f);
 }
\ No newline at end of file
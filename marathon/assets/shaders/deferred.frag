@@ -0,0 +1,175 @@
+#version 330 core
+
+// // standard variables
+// in vec4 gl_FragCoord;
+
+// full screen lighting of the G-buffer, once per pixel however many surfaces were drawn into it
+// lighting matches lighting.frag, keep the two in sync
+
+struct DirectionalLight {
+    vec3 colour;
+    float intensity;
+    vec3 direction;
+    int enabled;
+};
+#define DIRECTIONAL_LIGHT_MAX 4
+
+// range 0 marks an empty slot
+struct PointLight {
+    vec3 colour;
+    float intensity;
+    vec3 position;
+    float range;
+};
+#define POINT_LIGHT_MAX 16
+
+// cut offs are cosines
+struct SpotLight {
+    vec3 colour;
+    float intensity;
+    vec3 position;
+    float range;
+	vec3 direction;
+    float cutOff;
+    float outerCutOff;
+    int enabled;
+    // map in uShadowSpots, -1 for none
+    int shadow;
+};
+#define SPOT_LIGHT_MAX 4
+
+// shared per frame camera and light data, see renderer/uniform_blocks.hpp
+layout(std140) uniform Camera {
+    mat4    uView;
+    mat4    uProjection;
+    vec3    uResolution;
+    vec3    uCameraPosition;
+};
+
+layout(std140) uniform Lights {
+    DirectionalLight uDirectionalLights[DIRECTIONAL_LIGHT_MAX];
+    PointLight uPointLights[POINT_LIGHT_MAX];
+    SpotLight uSpotLights[SPOT_LIGHT_MAX];
+};
+
+// shadow maps in one depth atlas, matrices go from world space to atlas coordinates, see renderer/shadow_maps.hpp
+#define SHADOW_CASCADES 4
+#define SHADOW_SPOT_MAX 8
+layout(std140) uniform Shadows {
+    mat4    uShadowCascades[SHADOW_CASCADES];
+    mat4    uShadowSpots[SHADOW_SPOT_MAX];
+    // view depth where each cascade ends
+    vec4    uShadowSplits;
+    // cascades in use, directional light they belong to, spot maps in use
+    ivec4   uShadowInfo;
+    // atlas texel size, depth bias, normal offset
+    vec4    uShadowParams;
+};
+uniform sampler2DShadow uShadowAtlas;
+
+#ifdef CLUSTERED
+// point and spot lights binned into a froxel grid, see renderer/light_clusters.hpp
+layout(std140) uniform Clusters {
+    uvec4   uClusterDims;
+    float   uClusterSliceScale;
+    float   uClusterSliceBias;
+    vec2    uClusterTileSize;
+};
+// 4 texels per light: position range, colour intensity, direction spot, cutOff outerCutOff shadow
+uniform samplerBuffer   uClusterLights;
+// offset and count into the index list per cluster
+uniform usamplerBuffer  uClusterGrid;
+uniform usamplerBuffer  uClusterIndices;
+#endif
+
+// G-buffer, see renderer/uniform_blocks.hpp
+uniform sampler2D   uGAlbedo;
+uniform sampler2D   uGNormal;
+uniform sampler2D   uGDepth;
+// clip space back to world space for the current camera
+uniform mat4        uInverseViewProjection;
+
+// output
+out vec4 oColour;
+
+// function declaration
+vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir, float shadow);
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+float RangeWindow(float distance, float range);
+float SampleShadow(mat4 shadowMatrix, vec3 fragPos, vec3 normal);
+float DirectionalShadow(vec3 fragPos, vec3 normal);
+vec3 DecodeNormal(vec2 encoded);
+
+void main()
+{
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(uGDepth, texel, 0).r;
+    // nothing was drawn here, leave the cleared colour
+    if (depth >= 1.0)
+        discard;
+    vec4 albedo = texelFetch(uGAlbedo, texel, 0);
+    vec3 norm = DecodeNormal(texelFetch(uGNormal, texel, 0).rg);
+    vec2 uv = (vec2(texel) + 0.5) / vec2(textureSize(uGDepth, 0));
+    vec4 world = uInverseViewProjection * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+    vec3 position = world.xyz / world.w;
+
+    vec3 viewDir = normalize(uCameraPosition - position);
+    vec3 result = vec3(0.0);
+    // phase 1: directional lighting, one light may be shadowed by the cascades
+    for (int i = 0; i < DIRECTIONAL_LIGHT_MAX; i++) {
+        if (uDirectionalLights[i].enabled == 0)
+            continue;
+        float shadow = i == uShadowInfo.y ? DirectionalShadow(position, norm) : 1.0;
+        result += CalcDirectionalLight(uDirectionalLights[i], norm, viewDir, shadow);
+    }
+#ifdef CLUSTERED
+    // phase 2: point and spot lights of this pixel's cluster only
+    float viewDepth = -(uView * vec4(position, 1.0)).z;
+    uvec3 tile = uvec3(
+        min(uint(gl_FragCoord.x / uClusterTileSize.x), uClusterDims.x - 1u),
+        min(uint(gl_FragCoord.y / uClusterTileSize.y), uClusterDims.y - 1u),
+        uint(clamp(floor(log(max(viewDepth, 1e-6)) * uClusterSliceScale + uClusterSliceBias), 0.0, float(uClusterDims.z - 1u))));
+    int cluster = int((tile.z * uClusterDims.y + tile.y) * uClusterDims.x + tile.x);
+    uvec2 span = texelFetch(uClusterGrid, cluster).xy;
+    for (uint i = 0u; i < span.y; i++) {
+        int light = int(texelFetch(uClusterIndices, int(span.x + i)).x) * 4;
+        vec4 positionRange = texelFetch(uClusterLights, light);
+        vec4 colourIntensity = texelFetch(uClusterLights, light + 1);
+        vec4 directionSpot = texelFetch(uClusterLights, light + 2);
+        if (directionSpot.w == 0.0) {
+            PointLight point = PointLight(colourIntensity.rgb, colourIntensity.a, positionRange.xyz, positionRange.w);
+            result += CalcPointLight(point, norm, position, viewDir);
+        } else {
+            vec4 cutOffs = texelFetch(uClusterLights, light + 3);
+            SpotLight spot = SpotLight(colourIntensity.rgb, colourIntensity.a, positionRange.xyz, positionRange.w,
+                directionSpot.xyz, cutOffs.x, cutOffs.y, 1, int(cutOffs.z));
+            result += CalcSpotLight(spot, norm, position, viewDir);
+        }
+    }
+#else
+    // phase 2: point lights
+    for(int i = 0; i < POINT_LIGHT_MAX; i++)
+        if (uPointLights[i].range > 0.0)
+            result += CalcPointLight(uPointLights[i], norm, position, viewDir);
+    // phase 3: spot light
+    for(int i = 0; i < SPOT_LIGHT_MAX; i++)
+        if (uSpotLights[i].enabled != 0)
+            result += CalcSpotLight(uSpotLights[i], norm, position, viewDir);
+#endif
+
+    oColour = vec4(result * albedo.rgb, 1);
+}
+
+
+
+// inverse of the octahedral encoding in lighting.frag
+vec3 DecodeNormal(vec2 encoded)
+{
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    if (normal.z < 0.0) {
+        vec2 signs = vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+        normal.xy = (1.0 - abs(normal.yx)) * signs;
+    }
+    return normalize(normal);
+}
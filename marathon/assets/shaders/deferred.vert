@@ -0,0 +1,11 @@
+#version 330 core
+
+// // standard variables
+// in int gl_VertexID;
+// out vec4 gl_Position;
+
+// one triangle covering the screen, drawn without vertex buffers
+void main() {
+    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
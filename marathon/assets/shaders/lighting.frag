@@ -14,71 +14,187 @@ struct DirectionalLight {
 };
 #define DIRECTIONAL_LIGHT_MAX 4
 
+// range 0 marks an empty slot
 struct PointLight {
     vec3 colour;
     float intensity;
     vec3 position;
-    int enabled;
+    float range;
 };
 #define POINT_LIGHT_MAX 16
 
+// cut offs are cosines
 struct SpotLight {
     vec3 colour;
     float intensity;
     vec3 position;
+    float range;
 	vec3 direction;
     float cutOff;
     float outerCutOff;
     int enabled;
+    // map in uShadowSpots, -1 for none
+    int shadow;
 };
 #define SPOT_LIGHT_MAX 4
 
-// variables passed on from vertex shader
-in vec3 vPosition;
-in vec3 vNormal;
-in vec2 vUV0;
+// shared per frame camera and light data, see renderer/uniform_blocks.hpp
+layout(std140) uniform Camera {
+    mat4    uView;
+    mat4    uProjection;
+    vec3    uResolution;
+    vec3    uCameraPosition;
+};
+
+layout(std140) uniform Lights {
+    DirectionalLight uDirectionalLights[DIRECTIONAL_LIGHT_MAX];
+    PointLight uPointLights[POINT_LIGHT_MAX];
+    SpotLight uSpotLights[SPOT_LIGHT_MAX];
+};
+
+// shadow maps in one depth atlas, matrices go from world space to atlas coordinates, see renderer/shadow_maps.hpp
+#define SHADOW_CASCADES 4
+#define SHADOW_SPOT_MAX 8
+layout(std140) uniform Shadows {
+    mat4    uShadowCascades[SHADOW_CASCADES];
+    mat4    uShadowSpots[SHADOW_SPOT_MAX];
+    // view depth where each cascade ends
+    vec4    uShadowSplits;
+    // cascades in use, directional light they belong to, spot maps in use
+    ivec4   uShadowInfo;
+    // atlas texel size, depth bias, normal offset
+    vec4    uShadowParams;
+};
+uniform sampler2DShadow uShadowAtlas;
+
+#ifdef CLUSTERED
+// point and spot lights binned into a froxel grid, see renderer/light_clusters.hpp
+layout(std140) uniform Clusters {
+    uvec4   uClusterDims;
+    float   uClusterSliceScale;
+    float   uClusterSliceBias;
+    vec2    uClusterTileSize;
+};
+// 4 texels per light: position range, colour intensity, direction spot, cutOff outerCutOff shadow
+uniform samplerBuffer   uClusterLights;
+// offset and count into the index list per cluster
+uniform usamplerBuffer  uClusterGrid;
+uniform usamplerBuffer  uClusterIndices;
+#endif
+
+// variables passed on from vertex shader, or lighting.geom for WIREFRAME
+#ifdef WIREFRAME
+in GeometryData {
+#else
+in VertexData {
+#endif
+    vec3 vPosition;
+    vec3 vNormal;
+    vec2 vUV0;
+};
+#ifdef WIREFRAME
+// window space distance to each edge of the triangle
+noperspective in vec3 gEdgeDistance;
+// line half width in pixels and colour, see platform/software/software_rasteriser.hpp
+#define WIREFRAME_WIDTH 1.0
+#define WIREFRAME_COLOUR vec3(0.0)
+#endif
 
 // uniforms
-uniform vec3    uResolution;
 uniform float   uTime;
 uniform float   uTimeDelta;
 uniform int     uFrame;
-uniform vec3    uCameraPosition;
-uniform DirectionalLight uDirectionalLights[DIRECTIONAL_LIGHT_MAX];
-uniform PointLight uPointLights[POINT_LIGHT_MAX];
-uniform SpotLight uSpotLights[SPOT_LIGHT_MAX];
 
 // output
+#ifdef GBUFFER
+// surface attributes for the deferred lighting pass, see deferred.frag
+layout(location = 0) out vec4 oAlbedo;
+layout(location = 1) out vec2 oNormal;
+#else
 out vec4 oColour;
+#endif
 
 // function declaration
-vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir);
+vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir, float shadow);
 vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
 vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+float RangeWindow(float distance, float range);
+float SampleShadow(mat4 shadowMatrix, vec3 fragPos, vec3 normal);
+float DirectionalShadow(vec3 fragPos, vec3 normal);
+vec2 EncodeNormal(vec3 normal);
 
 void main()
 {   
     vec3 norm = normalize(vNormal);
+#ifdef GBUFFER
+    // no lighting here, there are no material albedos yet so the surface is white
+    oAlbedo = vec4(1.0);
+    oNormal = EncodeNormal(norm);
+#else
     vec3 viewDir = normalize(uCameraPosition - vPosition);
     vec3 result = vec3(0.0);
-    // phase 1: directional lighting
-    for (int i = 0; i < DIRECTIONAL_LIGHT_MAX; i++)
-        if (uDirectionalLights[i].enabled != 0)
-            result += CalcDirectionalLight(uDirectionalLights[i], norm, viewDir);
+    // phase 1: directional lighting, one light may be shadowed by the cascades
+    for (int i = 0; i < DIRECTIONAL_LIGHT_MAX; i++) {
+        if (uDirectionalLights[i].enabled == 0)
+            continue;
+        float shadow = i == uShadowInfo.y ? DirectionalShadow(vPosition, norm) : 1.0;
+        result += CalcDirectionalLight(uDirectionalLights[i], norm, viewDir, shadow);
+    }
+#ifdef CLUSTERED
+    // phase 2: point and spot lights of this fragment's cluster only
+    float depth = -(uView * vec4(vPosition, 1.0)).z;
+    uvec3 tile = uvec3(
+        min(uint(gl_FragCoord.x / uClusterTileSize.x), uClusterDims.x - 1u),
+        min(uint(gl_FragCoord.y / uClusterTileSize.y), uClusterDims.y - 1u),
+        uint(clamp(floor(log(max(depth, 1e-6)) * uClusterSliceScale + uClusterSliceBias), 0.0, float(uClusterDims.z - 1u))));
+    int cluster = int((tile.z * uClusterDims.y + tile.y) * uClusterDims.x + tile.x);
+    uvec2 span = texelFetch(uClusterGrid, cluster).xy;
+    for (uint i = 0u; i < span.y; i++) {
+        int light = int(texelFetch(uClusterIndices, int(span.x + i)).x) * 4;
+        vec4 positionRange = texelFetch(uClusterLights, light);
+        vec4 colourIntensity = texelFetch(uClusterLights, light + 1);
+        vec4 directionSpot = texelFetch(uClusterLights, light + 2);
+        if (directionSpot.w == 0.0) {
+            PointLight point = PointLight(colourIntensity.rgb, colourIntensity.a, positionRange.xyz, positionRange.w);
+            result += CalcPointLight(point, norm, vPosition, viewDir);
+        } else {
+            vec4 cutOffs = texelFetch(uClusterLights, light + 3);
+            SpotLight spot = SpotLight(colourIntensity.rgb, colourIntensity.a, positionRange.xyz, positionRange.w,
+                directionSpot.xyz, cutOffs.x, cutOffs.y, 1, int(cutOffs.z));
+            result += CalcSpotLight(spot, norm, vPosition, viewDir);
+        }
+    }
+#else
     // phase 2: point lights
     for(int i = 0; i < POINT_LIGHT_MAX; i++)
-        if (uPointLights[i].enabled != 0)
+        if (uPointLights[i].range > 0.0)
             result += CalcPointLight(uPointLights[i], norm, vPosition, viewDir); 
     // phase 3: spot light
     for(int i = 0; i < SPOT_LIGHT_MAX; i++)
         if (uSpotLights[i].enabled != 0)
             result += CalcSpotLight(uSpotLights[i], norm, vPosition, viewDir);    
+#endif
+#ifdef WIREFRAME
+    float edge = min(min(gEdgeDistance.x, gEdgeDistance.y), gEdgeDistance.z);
+    result = mix(WIREFRAME_COLOUR, result, smoothstep(WIREFRAME_WIDTH - 0.5, WIREFRAME_WIDTH + 0.5, edge));
+#endif
     
     oColour = vec4(result, 1);
+#endif
+}
+
+// octahedral encoding, a unit normal folded onto two signed components
+vec2 EncodeNormal(vec3 normal)
+{
+    normal /= abs(normal.x) + abs(normal.y) + abs(normal.z);
+    if (normal.z >= 0.0)
+        return normal.xy;
+    vec2 signs = vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+    return (1.0 - abs(normal.yx)) * signs;
 }
 
 // calculates the color when using a directional light.
-vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir)
+vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir, float shadow)
 {
     vec3 lightDir = normalize(-light.direction);
     // diffuse shading
@@ -92,7 +208,7 @@ vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir)
     vec3 ambient = light.colour * light.intensity * amb;
     vec3 diffuse = light.colour * light.intensity * diff;
     vec3 specular = light.colour * light.intensity * spec;
-    return (ambient + diffuse + specular);
+    return (ambient + (diffuse + specular) * shadow);
 }
 
 vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
@@ -109,6 +225,7 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     // attenuation
     float distance = length(light.position - fragPos);
     float attenuation = light.intensity / (1.0 + 0.09 * distance + 0.032 * (distance * distance));    
+    attenuation *= RangeWindow(distance, light.range);
     // combine results
     vec3 ambient = light.colour * amb;
     vec3 diffuse = light.colour * diff; 
@@ -133,6 +250,7 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     // attenuation
     float distance = length(light.position - fragPos);
     float attenuation = light.intensity / (1.0 + 0.09 * distance + 0.032 * (distance * distance));    
+    attenuation *= RangeWindow(distance, light.range);
     // spotlight intensity
     float theta = dot(lightDir, normalize(-light.direction)); 
     float epsilon = light.cutOff - light.outerCutOff;
@@ -141,8 +259,47 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     vec3 ambient = light.colour * amb;
     vec3 diffuse = light.colour * diff;
     vec3 specular = light.colour * spec;
+    float shadow = 1.0;
+    if (light.shadow >= 0 && light.shadow < uShadowInfo.z)
+        shadow = SampleShadow(uShadowSpots[light.shadow], fragPos, normal);
     ambient *= attenuation * intensity;
-    diffuse *= attenuation * intensity;
-    specular *= attenuation * intensity;
+    diffuse *= attenuation * intensity * shadow;
+    specular *= attenuation * intensity * shadow;
     return (ambient + diffuse + specular);
-}
\ No newline at end of file
+}
+
+// smooth fall off to nothing at the light's range, so lights can be culled by it
+float RangeWindow(float distance, float range)
+{
+    float ratio = distance / range;
+    float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return window * window;
+}
+
+// fraction of light reaching a point, 3x3 comparison taps around its texel in one map
+float SampleShadow(mat4 shadowMatrix, vec3 fragPos, vec3 normal)
+{
+    // pushing the point out along the normal keeps grazing surfaces off their own map
+    vec4 coord = shadowMatrix * vec4(fragPos + normal * uShadowParams.z, 1.0);
+    if (coord.w <= 0.0)
+        return 1.0;
+    coord.xyz /= coord.w;
+    if (coord.z >= 1.0)
+        return 1.0;
+    float depth = coord.z - uShadowParams.y;
+    float lit = 0.0;
+    for (int y = -1; y <= 1; y++)
+        for (int x = -1; x <= 1; x++)
+            lit += texture(uShadowAtlas, vec3(coord.xy + vec2(x, y) * uShadowParams.x, depth));
+    return lit / 9.0;
+}
+
+// the first cascade whose slice holds the point, unshadowed beyond the last
+float DirectionalShadow(vec3 fragPos, vec3 normal)
+{
+    float depth = -(uView * vec4(fragPos, 1.0)).z;
+    for (int c = 0; c < uShadowInfo.x; c++)
+        if (depth <= uShadowSplits[c])
+            return SampleShadow(uShadowCascades[c], fragPos, normal);
+    return 1.0;
+}
@@ -18,20 +18,38 @@ layout(location = 4) in vec2 aUV0;
 layout(location = 5) in vec2 aUV1;
 layout(location = 6) in vec2 aUV2;
 layout(location = 7) in vec2 aUV3;
+#ifdef INSTANCED
+// per instance model matrix, occupies locations 8-11
+layout(location = 8) in mat4 aInstanceModel;
+#endif
 
-// "varying" variables
-out vec3 vPosition;
-out vec3 vNormal;
-out vec2 vUV0;
+// "varying" variables, a block so lighting.geom can pass them on under the same member names
+out VertexData {
+    vec3 vPosition;
+    vec3 vNormal;
+    vec2 vUV0;
+};
 
 // uniforms
+#ifndef INSTANCED
 uniform mat4	uModel;
-uniform mat4	uView;
-uniform mat4	uProjection;
+#endif
+// shared per frame camera data, see renderer/uniform_blocks.hpp
+layout(std140) uniform Camera {
+    mat4    uView;
+    mat4    uProjection;
+    vec3    uResolution;
+    vec3    uCameraPosition;
+};
 
 void main() {
-    vPosition = vec3(uModel * vec4(aPosition, 1.0));
+#ifdef INSTANCED
+    mat4 model = aInstanceModel;
+#else
+    mat4 model = uModel;
+#endif
+    vPosition = vec3(model * vec4(aPosition, 1.0));
     vNormal = aNormal;
     vUV0 = aUV0;
-    gl_Position = uProjection * uView * uModel * vec4(aPosition, 1.0f);
+    gl_Position = uProjection * uView * model * vec4(aPosition, 1.0f);
 }
\ No newline at end of file
@@ -0,0 +1,6 @@
+#version 330 core
+
+// depth only, the depth write is all a shadow map needs
+
+void main() {
+}
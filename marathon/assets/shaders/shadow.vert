@@ -0,0 +1,26 @@
+#version 330 core
+
+// depth only pass for shadow maps, see renderer/shadow_maps.hpp
+
+// vertex attributes
+layout(location = 0) in vec3 aPosition;
+#ifdef INSTANCED
+// per instance model matrix, occupies locations 8-11
+layout(location = 8) in mat4 aInstanceModel;
+#endif
+
+// uniforms
+#ifndef INSTANCED
+uniform mat4	uModel;
+#endif
+// world to light clip space of the map being drawn
+uniform mat4	uLightViewProjection;
+
+void main() {
+#ifdef INSTANCED
+    mat4 model = aInstanceModel;
+#else
+    mat4 model = uModel;
+#endif
+    gl_Position = uLightViewProjection * model * vec4(aPosition, 1.0f);
+}
@@ -0,0 +1,274 @@
+#pragma once
+
+// std libs
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <thread>
+#include <type_traits>
+
+// internal libs
+#include "core/mapped_file.hpp"
+
+//// TODO:
+// evict entries that have not been read for a while
+// pack small entries into one file
+// remember source hashes by size+mtime so warm starts can skip reading sources
+
+//// NOTES:
+// On disk cache for data that is expensive to derive from a source asset, e.g. compressed textures,
+// parsed meshes or linked shader programs.
+// Entries live at <root>/<bucket>/<key>.bin where key hashes the source bytes plus anything that
+// changes the output (importer version, settings), so a stale entry is simply never looked up again.
+// Hits are memory mapped, BlobReader parses straight out of the mapping.
+// Safe to call from loader workers, writes go to a temp file that is renamed into place.
+
+#define DERIVED_DATA_CACHE_DIR "marathon/cache"
+
+// 64 bit hash over 8 byte words, good enough to key cache entries, not for security
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0) {
+    const uint64_t prime = 0x9E3779B97F4A7C15ull;
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t h = seed ^ (size * prime);
+    size_t words = size / 8;
+    for (size_t i = 0; i < words; i++) {
+        uint64_t k;
+        std::memcpy(&k, bytes + i * 8, 8);
+        k *= 0xBF58476D1CE4E5B9ull;
+        k ^= k >> 31;
+        h = (h ^ k) * prime;
+        h ^= h >> 29;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, bytes + words * 8, size - words * 8);
+    h = (h ^ tail) * prime;
+    h ^= h >> 32;
+    return h;
+}
+
+struct DerivedDataStats {
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    uint32_t writes = 0;
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+
+    float GetHitRate() const {
+        uint32_t lookups = hits + misses;
+        return lookups == 0 ? 0.0f : (float)hits / lookups;
+    }
+};
+
+class DerivedDataCache {
+public:
+    static DerivedDataCache& Instance() {
+        static DerivedDataCache instance;
+        return instance;
+    }
+
+    // set before loading, not while workers are using the cache
+    void SetRoot(const std::string& root) { _root = root; }
+    const std::string& GetRoot() const { return _root; }
+    void SetEnabled(bool enabled) { _enabled = enabled; }
+    bool IsEnabled() const { return _enabled; }
+
+    // maps the entry into file, which keeps it alive for as long as the data is needed
+    bool Map(const std::string& bucket, uint64_t key, MappedFile& file) {
+        if (!_enabled)
+            return false;
+        std::string path = GetEntryPath(bucket, key);
+        if (!std::filesystem::exists(path) || !file.Open(path)) {
+            _misses++;
+            return false;
+        }
+        _hits++;
+        _bytesRead += file.Size();
+        return true;
+    }
+
+    bool Get(const std::string& bucket, uint64_t key, std::vector<uint8_t>& out) {
+        MappedFile file;
+        if (!Map(bucket, key, file))
+            return false;
+        out.assign(file.Data(), file.Data() + file.Size());
+        return true;
+    }
+
+    // an entry that turned out unusable, e.g. written by an older build, counts as a miss
+    void Reject(const std::string& bucket, uint64_t key) {
+        _hits--;
+        _misses++;
+        std::error_code ec;
+        std::filesystem::remove(GetEntryPath(bucket, key), ec);
+    }
+
+    bool Put(const std::string& bucket, uint64_t key, const uint8_t* data, size_t size) {
+        if (!_enabled)
+            return false;
+        std::error_code ec;
+        std::filesystem::create_directories(_root + "/" + bucket, ec);
+        std::string path = GetEntryPath(bucket, key);
+        // unique temp name so two workers deriving the same entry don't interleave writes
+        std::string temp = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+        {
+            std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+            if (!file.good()) {
+                std::cout << "WARNING (DerivedDataCache): Can't write cache entry @ " << temp << std::endl;
+                return false;
+            }
+            file.write(reinterpret_cast<const char*>(data), size);
+            if (!file.good()) {
+                std::cout << "WARNING (DerivedDataCache): Failed writing cache entry @ " << temp << std::endl;
+                file.close();
+                std::filesystem::remove(temp, ec);
+                return false;
+            }
+        }
+        std::filesystem::rename(temp, path, ec);
+        if (ec) {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        _writes++;
+        _bytesWritten += size;
+        return true;
+    }
+
+    DerivedDataStats GetStats() const {
+        DerivedDataStats stats;
+        stats.hits = _hits;
+        stats.misses = _misses;
+        stats.writes = _writes;
+        stats.bytesRead = _bytesRead;
+        stats.bytesWritten = _bytesWritten;
+        return stats;
+    }
+
+    void ResetStats() {
+        _hits = 0;
+        _misses = 0;
+        _writes = 0;
+        _bytesRead = 0;
+        _bytesWritten = 0;
+    }
+
+private:
+    DerivedDataCache() = default;
+    DerivedDataCache(const DerivedDataCache&) = delete;
+    DerivedDataCache& operator=(const DerivedDataCache&) = delete;
+
+    std::string _root = DERIVED_DATA_CACHE_DIR;
+    bool _enabled = true;
+    std::atomic<uint32_t> _hits = 0;
+    std::atomic<uint32_t> _misses = 0;
+    std::atomic<uint32_t> _writes = 0;
+    std::atomic<uint64_t> _bytesRead = 0;
+    std::atomic<uint64_t> _bytesWritten = 0;
+
+    std::string GetEntryPath(const std::string& bucket, uint64_t key) const {
+        char name[17];
+        std::snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+        return _root + "/" + bucket + "/" + name + ".bin";
+    }
+};
+
+// helpers for cache entries, plain little endian copies of trivially copyable values
+class BlobWriter {
+public:
+    template<typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+        WriteBytes(&value, sizeof(T));
+    }
+
+    void WriteBytes(const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        _data.insert(_data.end(), bytes, bytes + size);
+    }
+
+    void WriteString(const std::string& value) {
+        Write<uint32_t>(value.size());
+        WriteBytes(value.data(), value.size());
+    }
+
+    template<typename T>
+    void WriteVector(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+        Write<uint64_t>(values.size());
+        WriteBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    const std::vector<uint8_t>& Data() const { return _data; }
+
+private:
+    std::vector<uint8_t> _data;
+};
+
+// bounds checked, any failed read leaves the reader invalid and every later read fails
+class BlobReader {
+public:
+    BlobReader(const uint8_t* data, size_t size)
+        : _data(data), _size(size) {}
+
+    template<typename T>
+    bool Read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+        return ReadBytes(&value, sizeof(T));
+    }
+
+    bool ReadBytes(void* dst, size_t size) {
+        const uint8_t* src = Skip(size);
+        if (src != nullptr)
+            std::memcpy(dst, src, size);
+        return src != nullptr;
+    }
+
+    bool ReadString(std::string& value) {
+        uint32_t size = 0;
+        if (!Read(size))
+            return false;
+        const uint8_t* src = Skip(size);
+        if (src != nullptr)
+            value.assign(reinterpret_cast<const char*>(src), size);
+        return src != nullptr;
+    }
+
+    template<typename T>
+    bool ReadVector(std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+        uint64_t count = 0;
+        if (!Read(count) || count > Remaining() / sizeof(T)) {
+            _valid = false;
+            return false;
+        }
+        values.resize(count);
+        return ReadBytes(values.data(), count * sizeof(T));
+    }
+
+    // pointer to the next size bytes, null if past the end
+    const uint8_t* Skip(size_t size) {
+        if (!_valid || size > _size - _offset) {
+            _valid = false;
+            return nullptr;
+        }
+        const uint8_t* src = _data + _offset;
+        _offset += size;
+        return src;
+    }
+
+    bool IsValid() const { return _valid; }
+    size_t Remaining() const { return _size - _offset; }
+
+private:
+    const uint8_t* _data = nullptr;
+    size_t _size = 0;
+    size_t _offset = 0;
+    bool _valid = true;
+};
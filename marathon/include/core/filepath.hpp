@@ -2,6 +2,9 @@
 
 #include <string>
 #include <fstream>
+#include <vector>
+#include <filesystem>
+#include <algorithm>
 
 bool CheckFileExists(const std::string& filepath) {
     std::ifstream file(filepath);
@@ -38,4 +41,16 @@ std::string GetParentFolder(const std::string& filepath) {
         return filepath.substr(0, lastSlashPos);
     }
     return filepath;
-}
\ No newline at end of file
+}
+
+// every regular file below folder, sorted so load order is stable
+std::vector<std::string> ListFilesRecursive(const std::string& folder) {
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(folder, ec)) {
+        if (entry.is_regular_file())
+            files.push_back(entry.path().generic_string());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
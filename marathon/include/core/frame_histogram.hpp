@@ -0,0 +1,97 @@
+#pragma once
+
+// std libs
+#include <cstdint>
+#include <array>
+#include <algorithm>
+
+//// NOTES:
+// Frame times over a sliding window of the last FRAME_HISTOGRAM_WINDOW frames, binned so percentiles
+// are a walk over the bins instead of a sort. Percentiles interpolate within a bin, so they are
+// accurate to well under a bin width. Frames slower than the last bin are counted in it.
+
+// 0.25 ms bins up to 100 ms
+#define FRAME_HISTOGRAM_BIN_NANOS 250000
+#define FRAME_HISTOGRAM_BINS 400
+#define FRAME_HISTOGRAM_WINDOW 1024
+
+// milliseconds over the window
+struct FrameStats {
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double mean = 0.0;
+    double max = 0.0;
+    uint32_t frames = 0;
+};
+
+class FrameTimeHistogram {
+public:
+    void Add(uint64_t nanos) {
+        // oldest sample leaves the window
+        if (_count == FRAME_HISTOGRAM_WINDOW) {
+            uint64_t old = _samples[_next];
+            _bins[GetBin(old)]--;
+            _sum -= old;
+        } else {
+            _count++;
+        }
+        _samples[_next] = nanos;
+        _next = (_next + 1) % FRAME_HISTOGRAM_WINDOW;
+        _bins[GetBin(nanos)]++;
+        _sum += nanos;
+    }
+
+    // p in [0, 1], milliseconds
+    double GetPercentile(double p) const {
+        if (_count == 0)
+            return 0.0;
+        double rank = std::clamp(p, 0.0, 1.0) * _count;
+        uint32_t seen = 0;
+        for (uint32_t bin = 0; bin < FRAME_HISTOGRAM_BINS; bin++) {
+            if (_bins[bin] == 0)
+                continue;
+            if (seen + _bins[bin] >= rank) {
+                double within = (rank - seen) / _bins[bin];
+                return (bin + within) * FRAME_HISTOGRAM_BIN_NANOS / 1e6;
+            }
+            seen += _bins[bin];
+        }
+        return FRAME_HISTOGRAM_BINS * FRAME_HISTOGRAM_BIN_NANOS / 1e6;
+    }
+
+    FrameStats GetStats() const {
+        FrameStats stats;
+        stats.frames = _count;
+        if (_count == 0)
+            return stats;
+        stats.p50 = GetPercentile(0.5);
+        stats.p99 = GetPercentile(0.99);
+        stats.mean = (double)_sum / _count / 1e6;
+        uint64_t max = 0;
+        for (uint32_t i = 0; i < _count; i++)
+            max = std::max(max, _samples[i]);
+        stats.max = max / 1e6;
+        return stats;
+    }
+
+    // frame counts per bin, for plotting
+    const std::array<uint32_t, FRAME_HISTOGRAM_BINS>& GetBins() const { return _bins; }
+
+    void Reset() {
+        _bins.fill(0);
+        _count = 0;
+        _next = 0;
+        _sum = 0;
+    }
+
+private:
+    std::array<uint32_t, FRAME_HISTOGRAM_BINS> _bins = {};
+    std::array<uint64_t, FRAME_HISTOGRAM_WINDOW> _samples = {};
+    uint32_t _count = 0;
+    uint32_t _next = 0;
+    uint64_t _sum = 0;
+
+    static uint32_t GetBin(uint64_t nanos) {
+        return std::min<uint64_t>(nanos / FRAME_HISTOGRAM_BIN_NANOS, FRAME_HISTOGRAM_BINS - 1);
+    }
+};
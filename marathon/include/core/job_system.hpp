@@ -0,0 +1,333 @@
+#pragma once
+
+// std libs
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <type_traits>
+
+// internal libs
+#include "core/module.hpp"
+#include "core/profiler.hpp"
+
+//// TODO:
+// lock free Chase-Lev deques if the per deque locks ever show up in profiles
+// fibers so a waiting job can be parked instead of running others on its stack
+
+//// NOTES:
+// Work stealing scheduler for fine grained engine work, booted by Application as a module.
+// Every thread in the system owns a deque, the thread that called Boot is index 0 and the workers follow.
+// Owners push and pop at the back (newest first, still in cache), idle threads steal from the front of others.
+// Dependencies are continuations: a job scheduled after others is held by their counters and queued by
+// whichever finishes last, nothing blocks. Wait runs other jobs until the handle completes, so it is safe to
+// wait inside a job, and sleeps with the workers when there is nothing to run. Threads outside the system
+// push to deque 0.
+// With one thread, or while not booted, everything runs inline on the caller.
+// ThreadPool stays for long blocking jobs (file loads, asset prepare waiting on commit space) that would
+// otherwise hold up a worker, those can still fan out through ParallelFor from their own thread.
+
+// smallest ParallelFor chunk when the caller doesn't care
+#define JOB_DEFAULT_GRAIN 64
+// chunks per thread a ParallelFor is split into at most, spare chunks even out uneven work
+#define JOB_CHUNKS_PER_THREAD 4
+
+struct JobCounter {
+    // jobs still to finish, the handle is complete at zero
+    std::atomic<uint32_t> pending = 0;
+    std::mutex lock;
+    // queued once pending reaches zero
+    std::vector<std::function<void()>> continuations;
+
+    bool IsDone() const {
+        return pending.load(std::memory_order_acquire) == 0;
+    }
+};
+typedef std::shared_ptr<JobCounter> JobHandle;
+
+class JobSystem : public Module {
+public:
+    std::string GetName() override {
+        return "JobSystem";
+    }
+    ModuleType GetType() override {
+        return ModuleType::JOBS;
+    }
+
+    void Boot() override {
+        if (_running)
+            Shutdown();
+        uint32_t threads = _threadCount == 0 ? std::max(1u, std::thread::hardware_concurrency()) : _threadCount;
+        _queues = std::vector<Queue>(threads);
+        _stopping = false;
+        _queued = 0;
+        _running = true;
+        _activeThreads = threads;
+        _index = 0;
+        _system = this;
+        _workers.reserve(threads - 1);
+        for (uint32_t i = 1; i < threads; i++)
+            _workers.emplace_back([this, i]() {
+                Profiler::Instance().SetThreadName("Job Worker " + std::to_string(i));
+                _index = i;
+                _system = this;
+                WorkerLoop(i);
+            });
+    }
+
+    void Shutdown() override {
+        if (!_running)
+            return;
+        {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+            _stopping = true;
+        }
+        _wake.notify_all();
+        for (std::thread& worker : _workers)
+            worker.join();
+        _workers.clear();
+        // finish anything left so no handle stays pending
+        while (TryRun(0)) {}
+        _queues.clear();
+        _running = false;
+        _activeThreads = 1;
+        _system = nullptr;
+    }
+
+    // threads including the one calling Boot, 0 for every hardware thread, applied on the next Boot
+    void SetThreadCount(uint32_t threadCount) {
+        _threadCount = threadCount;
+    }
+
+    uint32_t GetThreadCount() const {
+        return _activeThreads;
+    }
+
+    bool IsRunning() const {
+        return _running;
+    }
+
+    JobHandle Schedule(std::function<void()> job) {
+        return Schedule(std::move(job), {});
+    }
+
+    // job runs once every dependency has completed, null dependencies are skipped
+    JobHandle Schedule(std::function<void()> job, const std::vector<JobHandle>& dependencies) {
+        JobHandle handle = std::make_shared<JobCounter>();
+        handle->pending = 1;
+        auto task = [this, handle, job = std::move(job)]() {
+            job();
+            Finish(*handle);
+        };
+        if (!_running || _activeThreads == 1) {
+            for (const JobHandle& dependency : dependencies)
+                Wait(dependency);
+            task();
+            return handle;
+        }
+
+        // one count per unfinished dependency plus one released below, the last to drop it queues the job
+        auto waiting = std::make_shared<std::atomic<uint32_t>>(1);
+        auto release = [this, waiting, task]() {
+            if (waiting->fetch_sub(1, std::memory_order_acq_rel) == 1)
+                Push(task);
+        };
+        for (const JobHandle& dependency : dependencies) {
+            if (!dependency)
+                continue;
+            std::lock_guard<std::mutex> lock(dependency->lock);
+            if (dependency->IsDone())
+                continue;
+            waiting->fetch_add(1, std::memory_order_relaxed);
+            dependency->continuations.push_back(release);
+        }
+        release();
+        return handle;
+    }
+
+    // runs other jobs until the handle completes, sleeping while there are none to run
+    void Wait(const JobHandle& handle) {
+        if (!handle)
+            return;
+        uint32_t index = CurrentIndex();
+        while (!handle->IsDone()) {
+            if (!_running) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (TryRun(index))
+                continue;
+            // woken by Finish once a counter reaches zero, or by Push like any sleeping worker
+            _sleeping.fetch_add(1);
+            _waiting.fetch_add(1);
+            {
+                std::unique_lock<std::mutex> lock(_sleepMutex);
+                _wake.wait(lock, [this, &handle]() { return handle->pending.load() == 0 || _queued.load() > 0 || _stopping; });
+            }
+            _waiting.fetch_sub(1);
+            _sleeping.fetch_sub(1);
+        }
+    }
+
+    // body(begin, end) over [0, count) in chunks of at least grain, returns once every chunk has run
+    template<typename F>
+    void ParallelFor(uint32_t count, uint32_t grain, F&& body) {
+        if (count == 0)
+            return;
+        grain = std::max(1u, grain);
+        uint32_t chunks = std::min((count + grain - 1) / grain, _activeThreads * JOB_CHUNKS_PER_THREAD);
+        if (!_running || _activeThreads == 1 || chunks <= 1) {
+            body(0u, count);
+            return;
+        }
+
+        uint32_t size = (count + chunks - 1) / chunks;
+        JobHandle handle = std::make_shared<JobCounter>();
+        handle->pending = (count + size - 1) / size;
+        // chunks are pushed in reverse so the caller pops the first one back
+        for (uint32_t c = handle->pending.load(); c-- > 0;) {
+            uint32_t begin = c * size;
+            uint32_t end = std::min(count, begin + size);
+            // the handle is held by value, Wait may return before Finish lets go of it
+            Push([this, &body, handle, begin, end]() {
+                body(begin, end);
+                Finish(*handle);
+            });
+        }
+        Wait(handle);
+    }
+
+    // body(element) for every element of a range such as an entt view, elements are copied out first
+    // as ranges over several components can't be split
+    template<typename Range, typename F>
+    void ParallelForEach(const Range& range, uint32_t grain, F&& body) {
+        using Element = std::decay_t<decltype(*std::begin(range))>;
+        std::vector<Element> elements(std::begin(range), std::end(range));
+        ParallelFor((uint32_t)elements.size(), grain, [&elements, &body](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++)
+                body(elements[i]);
+        });
+    }
+
+    // delete copy and assign operators should always get instance from class::instance func
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    static JobSystem& Instance() {
+        static JobSystem* instance;
+        if (!instance)
+            instance = new JobSystem();
+        return *instance;
+    }
+
+protected:
+    JobSystem() = default;
+    ~JobSystem() = default;
+
+private:
+    struct Queue {
+        std::mutex lock;
+        std::deque<std::function<void()>> jobs;
+    };
+
+    uint32_t _threadCount = 0;
+    uint32_t _activeThreads = 1;
+    bool _running = false;
+    std::vector<Queue> _queues;
+    std::vector<std::thread> _workers;
+
+    // jobs sitting in any deque, sleepers wake when it rises
+    std::atomic<uint32_t> _queued = 0;
+    std::atomic<uint32_t> _sleeping = 0;
+    // threads asleep in Wait, they also wake when any counter completes
+    std::atomic<uint32_t> _waiting = 0;
+    std::mutex _sleepMutex;
+    std::condition_variable _wake;
+    bool _stopping = false;
+
+    static inline thread_local uint32_t _index = 0;
+    static inline thread_local JobSystem* _system = nullptr;
+
+    uint32_t CurrentIndex() const {
+        return _system == this ? _index : 0;
+    }
+
+    void Push(std::function<void()> job) {
+        Queue& queue = _queues[CurrentIndex()];
+        {
+            // counted before it can be stolen, so a thief's decrement never runs ahead of it
+            std::lock_guard<std::mutex> lock(queue.lock);
+            _queued.fetch_add(1);
+            queue.jobs.push_back(std::move(job));
+        }
+        if (_sleeping.load() > 0) {
+            // taking the lock orders the wake after a sleeper's predicate check
+            { std::lock_guard<std::mutex> lock(_sleepMutex); }
+            _wake.notify_one();
+        }
+    }
+
+    // own deque from the back, then steal from the front of the others
+    bool TryRun(uint32_t index) {
+        std::function<void()> job;
+        uint32_t count = (uint32_t)_queues.size();
+        for (uint32_t i = 0; i < count && !job; i++) {
+            Queue& queue = _queues[(index + i) % count];
+            std::lock_guard<std::mutex> lock(queue.lock);
+            if (queue.jobs.empty())
+                continue;
+            if (i == 0) {
+                job = std::move(queue.jobs.back());
+                queue.jobs.pop_back();
+            } else {
+                job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+            }
+        }
+        if (!job)
+            return false;
+        _queued.fetch_sub(1);
+        job();
+        return true;
+    }
+
+    void Finish(JobCounter& counter) {
+        // sequentially consistent against a waiter's count of itself and its check of pending
+        if (counter.pending.fetch_sub(1) != 1)
+            return;
+        if (_waiting.load() > 0) {
+            { std::lock_guard<std::mutex> lock(_sleepMutex); }
+            _wake.notify_all();
+        }
+        std::vector<std::function<void()>> continuations;
+        {
+            std::lock_guard<std::mutex> lock(counter.lock);
+            continuations.swap(counter.continuations);
+        }
+        for (std::function<void()>& continuation : continuations)
+            continuation();
+    }
+
+    void WorkerLoop(uint32_t index) {
+        while (true) {
+            if (TryRun(index))
+                continue;
+            _sleeping.fetch_add(1);
+            {
+                std::unique_lock<std::mutex> lock(_sleepMutex);
+                _wake.wait(lock, [this]() { return _stopping || _queued.load() > 0; });
+            }
+            _sleeping.fetch_sub(1);
+            if (_stopping && _queued.load() == 0)
+                return;
+        }
+    }
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+// std libs
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define MAPPED_FILE_MMAP
+#endif
+
+//// TODO:
+// native windows mapping with CreateFileMapping
+
+//// NOTES:
+// Read only view of a whole file, pages are faulted in on access rather than copied up front.
+// Falls back to reading the file into memory on platforms without mmap.
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const std::string& filepath) {
+        Open(filepath);
+    }
+    ~MappedFile() {
+        Close();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& filepath) {
+        Close();
+#ifdef MAPPED_FILE_MMAP
+        int fd = open(filepath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cout << "WARNING (MappedFile): Can't open file: " << filepath << std::endl;
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            close(fd);
+            std::cout << "WARNING (MappedFile): Can't map empty file: " << filepath << std::endl;
+            return false;
+        }
+        void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // mapping keeps its own reference to the file
+        close(fd);
+        if (data == MAP_FAILED) {
+            std::cout << "WARNING (MappedFile): Failed to map file: " << filepath << std::endl;
+            return false;
+        }
+        madvise(data, info.st_size, MADV_SEQUENTIAL);
+        _data = static_cast<const uint8_t*>(data);
+        _size = info.st_size;
+#else
+        std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            std::cout << "WARNING (MappedFile): Can't open file: " << filepath << std::endl;
+            return false;
+        }
+        _fallback.resize((size_t)file.tellg());
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(_fallback.data()), _fallback.size());
+        _data = _fallback.data();
+        _size = _fallback.size();
+#endif
+        return true;
+    }
+
+    void Close() {
+#ifdef MAPPED_FILE_MMAP
+        if (_data != nullptr)
+            munmap(const_cast<uint8_t*>(_data), _size);
+#else
+        _fallback.clear();
+        _fallback.shrink_to_fit();
+#endif
+        _data = nullptr;
+        _size = 0;
+    }
+
+    bool IsOpen() const { return _data != nullptr; }
+    const uint8_t* Data() const { return _data; }
+    size_t Size() const { return _size; }
+
+private:
+    const uint8_t* _data = nullptr;
+    size_t _size = 0;
+#ifndef MAPPED_FILE_MMAP
+    std::vector<uint8_t> _fallback;
+#endif
+};
@@ -13,6 +13,7 @@ enum class ModuleType {
     MATHS,
     RENDER,
     AUDIO,
+    JOBS,
     MAX_ENUM
 };
 
@@ -0,0 +1,353 @@
+#pragma once
+
+// std libs
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+//// TODO:
+// recycle thread slots when threads exit, short lived threads use one up each
+// flows between jobs and the zones that waited on them
+
+//// NOTES:
+// Zones are recorded with PROFILE_SCOPE("Name"), the name must be a string literal as only the pointer is kept.
+// Each thread writes finished zones into its own ring with a single release store, no locks or allocation,
+// the main thread drains every ring in BeginFrame and files the zones under the frame that just ended.
+// A ring that fills up before it is drained overwrites its oldest zones, they are dropped and counted.
+// GPU zones come in late from the renderer's timer queries and are filed under the frame that issued them.
+// Frame history, the panel and Chrome trace export are main thread only.
+// Define PROFILER_ENABLED 0 to compile zones out entirely.
+
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+// zones per thread between drains
+#define PROFILER_RING_SIZE 8192
+#define PROFILER_MAX_THREADS 64
+// frames kept for the panel and captures
+#define PROFILER_HISTORY 240
+// track index used for GPU zones, after every thread track
+#define PROFILER_GPU_TRACK PROFILER_MAX_THREADS
+
+struct ProfileEvent {
+    const char* name = nullptr;
+    // nanoseconds since the profiler started
+    uint64_t start = 0;
+    uint64_t end = 0;
+    uint32_t depth = 0;
+    uint32_t track = 0;
+};
+
+struct ProfileFrame {
+    uint64_t index = 0;
+    uint64_t start = 0;
+    uint64_t end = 0;
+    std::vector<ProfileEvent> events;
+
+    double GetMillis() const { return (end - start) / 1e6; }
+};
+
+// single producer (the owning thread), single consumer (the main thread)
+class ProfileRing {
+public:
+    void Push(const ProfileEvent& event) {
+        uint64_t head = _head.load(std::memory_order_relaxed);
+        _events[head % PROFILER_RING_SIZE] = event;
+        _head.store(head + 1, std::memory_order_release);
+    }
+
+    // returns how many zones were overwritten before they could be read
+    template<typename F>
+    uint64_t Drain(F&& consume) {
+        uint64_t head = _head.load(std::memory_order_acquire);
+        uint64_t dropped = 0;
+        if (head - _tail > PROFILER_RING_SIZE) {
+            dropped = head - PROFILER_RING_SIZE - _tail;
+            _tail = head - PROFILER_RING_SIZE;
+        }
+        for (; _tail < head; _tail++) {
+            ProfileEvent event = _events[_tail % PROFILER_RING_SIZE];
+            // the producer may have lapped us while copying, the slot then holds a newer zone,
+            // Push writes slot head % N before publishing head + 1 so a gap of exactly N is already torn
+            if (_head.load(std::memory_order_acquire) - _tail >= PROFILER_RING_SIZE) {
+                dropped++;
+                continue;
+            }
+            consume(event);
+        }
+        return dropped;
+    }
+
+private:
+    std::array<ProfileEvent, PROFILER_RING_SIZE> _events;
+    std::atomic<uint64_t> _head = 0;
+    uint64_t _tail = 0;
+};
+
+class Profiler {
+public:
+    static Profiler& Instance() {
+        static Profiler instance;
+        return instance;
+    }
+
+    // nanoseconds since the profiler started
+    uint64_t Now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _epoch).count();
+    }
+
+    // recording can be toggled at runtime, open zones still close cleanly
+    void SetRecording(bool recording) { _recording.store(recording, std::memory_order_relaxed); }
+    bool IsRecording() const { return _recording.load(std::memory_order_relaxed); }
+
+    // keeps the history frozen for inspection, rings are still drained
+    void SetPaused(bool paused) { _paused = paused; }
+    bool IsPaused() const { return _paused; }
+
+    // called by zones on their own thread
+    void BeginZone() {
+        if (ThreadState* state = GetThreadState())
+            state->depth++;
+    }
+
+    void EndZone(const char* name, uint64_t start) {
+        ThreadState* state = GetThreadState();
+        if (state == nullptr)
+            return;
+        state->depth--;
+        ProfileEvent event;
+        event.name = name;
+        event.start = start;
+        event.end = Now();
+        event.depth = state->depth;
+        event.track = state->track;
+        state->ring.Push(event);
+    }
+
+    void SetThreadName(const std::string& name) {
+        ThreadState* state = GetThreadState();
+        if (state == nullptr)
+            return;
+        std::lock_guard<std::mutex> lock(_namesMutex);
+        _trackNames[state->track] = name;
+    }
+
+    std::string GetTrackName(uint32_t track) const {
+        if (track == PROFILER_GPU_TRACK)
+            return "GPU";
+        std::lock_guard<std::mutex> lock(_namesMutex);
+        if (track < _trackNames.size() && !_trackNames[track].empty())
+            return _trackNames[track];
+        return "Thread " + std::to_string(track);
+    }
+
+    // number of thread tracks registered so far
+    uint32_t GetTrackCount() const {
+        return std::min<uint32_t>(_threadCount.load(std::memory_order_acquire), PROFILER_MAX_THREADS);
+    }
+
+    // main thread, once per frame: closes the current frame and files every finished zone under it
+    void BeginFrame() {
+        uint64_t now = Now();
+        ProfileFrame& frame = _frames[_frameIndex % PROFILER_HISTORY];
+        frame.end = now;
+        uint32_t tracks = GetTrackCount();
+        for (uint32_t i = 0; i < tracks; i++) {
+            ThreadState* state = _threads[i].load(std::memory_order_acquire);
+            if (state == nullptr)
+                continue;
+            _dropped += state->ring.Drain([&](const ProfileEvent& event) {
+                if (!_paused)
+                    frame.events.push_back(event);
+            });
+        }
+        // a paused frame is thrown away and restarted so resuming doesn't record one huge frame
+        if (_paused) {
+            frame.start = now;
+            frame.events.clear();
+            return;
+        }
+
+        _frameIndex++;
+        ProfileFrame& next = _frames[_frameIndex % PROFILER_HISTORY];
+        next.index = _frameIndex;
+        next.start = now;
+        next.end = now;
+        next.events.clear();
+    }
+
+    // GPU results arrive a few frames late, dropped if the frame already left the history
+    void RecordGpuZone(uint64_t frameIndex, const char* name, uint64_t start, uint64_t end) {
+        if (_paused || frameIndex > _frameIndex || _frameIndex - frameIndex >= PROFILER_HISTORY)
+            return;
+        ProfileFrame& frame = _frames[frameIndex % PROFILER_HISTORY];
+        if (frame.index != frameIndex)
+            return;
+        ProfileEvent event;
+        event.name = name;
+        event.start = start;
+        event.end = end;
+        event.track = PROFILER_GPU_TRACK;
+        frame.events.push_back(event);
+    }
+
+    // index of the frame currently being recorded
+    uint64_t GetFrameIndex() const { return _frameIndex; }
+
+    // completed frames in the history, 0 is the oldest
+    uint32_t GetFrameCount() const {
+        return std::min<uint64_t>(_frameIndex, PROFILER_HISTORY - 1);
+    }
+
+    const ProfileFrame& GetFrame(uint32_t i) const {
+        return _frames[(_frameIndex - GetFrameCount() + i) % PROFILER_HISTORY];
+    }
+
+    uint64_t GetDroppedCount() const { return _dropped; }
+
+    // every completed frame in the history as Chrome trace JSON, open with chrome://tracing or Perfetto
+    bool WriteChromeTrace(const std::string& path) const {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file.good()) {
+            std::cout << "WARNING (Profiler): Can't write trace @ " << path << std::endl;
+            return false;
+        }
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        bool first = true;
+        auto separator = [&]() {
+            if (!first)
+                file << ",\n";
+            first = false;
+        };
+        auto writeName = [&](const std::string& name) {
+            file << '"';
+            for (char c : name) {
+                if (c == '"' || c == '\\')
+                    file << '\\';
+                file << c;
+            }
+            file << '"';
+        };
+        // tids: thread tracks as is, then the GPU track, then frame markers
+        uint32_t frameTrack = PROFILER_GPU_TRACK + 1;
+        for (uint32_t track = 0; track <= frameTrack; track++) {
+            if (track >= GetTrackCount() && track < PROFILER_GPU_TRACK)
+                continue;
+            separator();
+            file << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << track << ",\"args\":{\"name\":";
+            writeName(track == frameTrack ? "Frames" : GetTrackName(track));
+            file << "}}";
+        }
+        char number[64];
+        for (uint32_t i = 0; i < GetFrameCount(); i++) {
+            const ProfileFrame& frame = GetFrame(i);
+            separator();
+            std::snprintf(number, sizeof(number), "%.3f,\"dur\":%.3f", frame.start / 1e3, (frame.end - frame.start) / 1e3);
+            file << "{\"ph\":\"X\",\"name\":\"Frame " << frame.index << "\",\"pid\":1,\"tid\":" << frameTrack << ",\"ts\":" << number << "}";
+            for (const ProfileEvent& event : frame.events) {
+                separator();
+                std::snprintf(number, sizeof(number), "%.3f,\"dur\":%.3f", event.start / 1e3, (event.end - event.start) / 1e3);
+                file << "{\"ph\":\"X\",\"name\":";
+                writeName(event.name);
+                file << ",\"pid\":1,\"tid\":" << event.track << ",\"ts\":" << number << "}";
+            }
+        }
+        file << "\n]}\n";
+        return file.good();
+    }
+
+private:
+    struct ThreadState {
+        ProfileRing ring;
+        uint32_t track = 0;
+        uint32_t depth = 0;
+    };
+
+    Profiler() {
+        _trackNames.resize(PROFILER_MAX_THREADS);
+        _frames[0].index = 0;
+    }
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    std::chrono::steady_clock::time_point _epoch = std::chrono::steady_clock::now();
+    std::atomic<bool> _recording = true;
+
+    // thread slots are claimed once per thread and never released
+    std::array<std::atomic<ThreadState*>, PROFILER_MAX_THREADS> _threads = {};
+    std::atomic<uint32_t> _threadCount = 0;
+    mutable std::mutex _namesMutex;
+    std::vector<std::string> _trackNames;
+
+    // main thread only
+    std::array<ProfileFrame, PROFILER_HISTORY> _frames;
+    uint64_t _frameIndex = 0;
+    uint64_t _dropped = 0;
+    bool _paused = false;
+
+    ThreadState* GetThreadState() {
+        thread_local ThreadState* state = RegisterThread();
+        return state;
+    }
+
+    // null once every slot is taken, that thread's zones are ignored
+    ThreadState* RegisterThread() {
+        uint32_t track = _threadCount.fetch_add(1, std::memory_order_acq_rel);
+        if (track >= PROFILER_MAX_THREADS) {
+            if (track == PROFILER_MAX_THREADS)
+                std::cout << "WARNING (Profiler): Out of thread slots, zones on new threads are ignored." << std::endl;
+            return nullptr;
+        }
+        ThreadState* state = new ThreadState();
+        state->track = track;
+        _threads[track].store(state, std::memory_order_release);
+        return state;
+    }
+};
+
+// records the enclosing scope as a zone on the calling thread
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name)
+        : _name(name) {
+        Profiler& profiler = Profiler::Instance();
+        _active = profiler.IsRecording();
+        if (_active) {
+            profiler.BeginZone();
+            _start = profiler.Now();
+        }
+    }
+
+    ~ProfileZone() {
+        if (_active)
+            Profiler::Instance().EndZone(_name, _start);
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* _name;
+    uint64_t _start = 0;
+    bool _active = false;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILER_ENABLED
+#define PROFILE_SCOPE(name) ProfileZone PROFILE_CONCAT(_profileZone, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#endif
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string_view>
+#include <functional>
+
+// lets unordered containers keyed by std::string be searched with a string_view without allocating
+// pair with std::equal_to<> as the key equal
+struct StringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+// std libs
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <algorithm>
+#include <string>
+
+// internal libs
+#include "core/profiler.hpp"
+
+//// TODO:
+// per worker queues with stealing once jobs get finer grained
+
+//// NOTES:
+// Fixed set of workers pulling from one shared FIFO.
+// Meant for coarse jobs like whole file loads, not per element work.
+
+class ThreadPool {
+public:
+    // 0 picks one less than the number of hardware threads, leaving a core for the main thread,
+    // hardware_concurrency may report 0 so at least 2 are assumed
+    ThreadPool(uint32_t workerCount = 0) {
+        if (workerCount == 0)
+            workerCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+        _workers.reserve(workerCount);
+        for (uint32_t i = 0; i < workerCount; i++)
+            _workers.emplace_back([this, i]() {
+                Profiler::Instance().SetThreadName("Worker " + std::to_string(i));
+                WorkerLoop();
+            });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _wake.notify_all();
+        for (std::thread& worker : _workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template<typename F>
+    auto Submit(F&& job) -> std::future<decltype(job())> {
+        using Result = decltype(job());
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+        std::future<Result> future = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _jobs.emplace_back([task]() { (*task)(); });
+        }
+        _wake.notify_one();
+        return future;
+    }
+
+    uint32_t GetWorkerCount() const {
+        return _workers.size();
+    }
+
+private:
+    std::vector<std::thread> _workers;
+    std::deque<std::function<void()>> _jobs;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    bool _stopping = false;
+
+    void WorkerLoop() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wake.wait(lock, [this]() { return _stopping || !_jobs.empty(); });
+                // drain outstanding jobs before exiting so no future is left unset
+                if (_jobs.empty())
+                    return;
+                job = std::move(_jobs.front());
+                _jobs.pop_front();
+            }
+            job();
+        }
+    }
+};
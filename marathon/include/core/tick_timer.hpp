@@ -3,60 +3,80 @@
 #include <chrono>
 #include <cstdint>
 
+//// NOTES:
+// Monotonic steady_clock with nanosecond resolution, so deltas never go backwards or quantise to whole ms.
+// Tick() marks the end of one tick and the start of the next, GetTickElapsed() is the length of the
+// last completed tick. Seconds by default, milliseconds with isMilli, both fractional.
+
 class TickTimer {
     private:
-        std::chrono::time_point<std::chrono::system_clock> _startTime;
-        std::chrono::time_point<std::chrono::system_clock> _endTime;
-        std::chrono::time_point<std::chrono::system_clock> _lastFrameTime;
+        using Clock = std::chrono::steady_clock;
+
+        Clock::time_point _startTime;
+        Clock::time_point _endTime;
+        Clock::time_point _lastTickTime;
+        uint64_t _tickNanos = 0;
         uint32_t _tickCount = 0;
         bool _running = true;
 
-    public: 
+        Clock::time_point GetEndTime() const {
+            return _running ? Clock::now() : _endTime;
+        }
+
+        static double ToSeconds(uint64_t nanos, bool isMilli) {
+            return isMilli ? nanos / 1e6 : nanos / 1e9;
+        }
+
+    public:
         TickTimer() {
             Start();
         }
 
         void Start() {
-            _startTime = std::chrono::system_clock::now();
-            _lastFrameTime = _startTime;
+            _startTime = Clock::now();
+            _lastTickTime = _startTime;
+            _tickNanos = 0;
             _running = true;
         }
 
         void Stop() {
-            _endTime = std::chrono::system_clock::now();
+            _endTime = Clock::now();
             _running = false;
         }
-        
-        void Tick() {
+
+        // returns the length of the tick that just ended in seconds
+        double Tick() {
             _tickCount += 1;
             if (_running) {
-                _lastFrameTime = std::chrono::system_clock::now();
+                Clock::time_point now = Clock::now();
+                _tickNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(now - _lastTickTime).count();
+                _lastTickTime = now;
             }
+            return ToSeconds(_tickNanos, false);
         }
 
         int GetTickCount() {
             return _tickCount;
         }
 
-        double GetTickElapsed(bool isMilli = false) {
-            std::chrono::time_point<std::chrono::system_clock> endTime;
-            if(_running) {
-                endTime = std::chrono::system_clock::now();
-            } else {
-                endTime = _endTime;
-            }
-            double dt = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - _lastFrameTime).count();
-            return isMilli ? dt : dt / 1000;
-        }
-    
-        double GetTotalElapsed(bool isMilli = false) {
-            std::chrono::time_point<std::chrono::system_clock> endTime;
-            if(_running) {
-                endTime = std::chrono::system_clock::now();
-            } else {
-                endTime = _endTime;
-            }
-            double dt = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - _startTime).count();
-            return isMilli ? dt : dt / 1000;
+        uint64_t GetTickNanos() const {
+            return _tickNanos;
+        }
+
+        double GetTickElapsed(bool isMilli = false) const {
+            return ToSeconds(_tickNanos, isMilli);
+        }
+
+        // time since the last Tick, e.g. to pace the current frame
+        uint64_t GetSinceTickNanos() const {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(GetEndTime() - _lastTickTime).count();
+        }
+
+        uint64_t GetTotalNanos() const {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(GetEndTime() - _startTime).count();
+        }
+
+        double GetTotalElapsed(bool isMilli = false) const {
+            return ToSeconds(GetTotalNanos(), isMilli);
         }
-};
\ No newline at end of file
+};
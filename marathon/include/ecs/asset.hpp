@@ -10,14 +10,22 @@
 #include <iostream>
 #include <memory>
 #include <algorithm>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <condition_variable>
 
 // internal libs
 #include "core/uuid.hpp"
+#include "core/string_hash.hpp"
+#include "core/thread_pool.hpp"
 
 // Assets:
-// Implement asset destruction
 // Maybe change naming to find instead of get as not always return asset
-// Improve GetAssets to remove iterative conversion/vector build
 // Rename asset manager to asset library
 // Consolidate asset manager & asset loader manager into single interface/class, use composition & singleton
 // Fix singletons to remove copy and assignment operators
@@ -35,12 +43,165 @@ struct Asset {
         virtual ~Asset() = default;
 };
 
-// note: using map as is already sorted when iterating
+// open addressing UUID -> slot table, linear probing with a power of 2 capacity
+// UUID 0 is invalid so a zero key marks an empty bucket, removed buckets keep probing alive
+class AssetIndex {
+    private:
+        struct Bucket {
+            int64_t key = 0;
+            uint32_t value = 0;
+        };
+        static constexpr uint32_t TOMBSTONE = 0xFFFFFFFF;
+
+        std::vector<Bucket> _buckets;
+        size_t _count = 0;
+        size_t _used = 0;
+
+        static uint64_t Hash(int64_t key) {
+            // splitmix64 finaliser, runtime UUIDs are already random but file ones may not be
+            uint64_t x = (uint64_t)key;
+            x ^= x >> 30;
+            x *= 0xBF58476D1CE4E5B9ull;
+            x ^= x >> 27;
+            x *= 0x94D049BB133111EBull;
+            x ^= x >> 31;
+            return x;
+        }
+
+        static bool IsEmpty(const Bucket& b) {
+            return b.key == 0 && b.value != TOMBSTONE;
+        }
+
+        // rehash to a quarter full, also clears out tombstones left by erase
+        void Grow() {
+            size_t capacity = 16;
+            while (capacity < (_count + 1) * 4)
+                capacity *= 2;
+            std::vector<Bucket> old = std::move(_buckets);
+            _buckets.assign(capacity, Bucket());
+            _count = 0;
+            _used = 0;
+            for (const Bucket& b : old) {
+                if (b.key != 0)
+                    Insert(b.key, b.value);
+            }
+        }
+
+    public:
+        void Insert(int64_t key, uint32_t value) {
+            assert(key != 0 && "Can't index the invalid UUID.");
+            // keep load including tombstones at or below half
+            if ((_used + 1) * 2 > _buckets.size())
+                Grow();
+            size_t mask = _buckets.size() - 1;
+            size_t tombstone = _buckets.size();
+            for (size_t i = Hash(key) & mask;; i = (i + 1) & mask) {
+                Bucket& b = _buckets[i];
+                if (b.key == key) {
+                    b.value = value;
+                    return;
+                }
+                if (b.key == 0 && b.value == TOMBSTONE && tombstone == _buckets.size())
+                    tombstone = i;
+                if (IsEmpty(b)) {
+                    if (tombstone != _buckets.size()) {
+                        i = tombstone;
+                    } else {
+                        _used++;
+                    }
+                    _buckets[i].key = key;
+                    _buckets[i].value = value;
+                    _count++;
+                    return;
+                }
+            }
+        }
+
+        // returns false if not present
+        bool Find(int64_t key, uint32_t& value) const {
+            if (_buckets.empty() || key == 0)
+                return false;
+            size_t mask = _buckets.size() - 1;
+            for (size_t i = Hash(key) & mask;; i = (i + 1) & mask) {
+                const Bucket& b = _buckets[i];
+                if (b.key == key) {
+                    value = b.value;
+                    return true;
+                }
+                if (IsEmpty(b))
+                    return false;
+            }
+        }
+
+        bool Erase(int64_t key) {
+            if (_buckets.empty() || key == 0)
+                return false;
+            size_t mask = _buckets.size() - 1;
+            for (size_t i = Hash(key) & mask;; i = (i + 1) & mask) {
+                Bucket& b = _buckets[i];
+                if (b.key == key) {
+                    b.key = 0;
+                    b.value = TOMBSTONE;
+                    _count--;
+                    return true;
+                }
+                if (IsEmpty(b))
+                    return false;
+            }
+        }
+
+        size_t Size() const { return _count; }
+};
+
+// dense per type id, ids are handed out on first use of each type
+class AssetTypeId {
+    private:
+        static inline uint32_t _next = 0;
+
+    public:
+        template<typename T>
+        static uint32_t Get() {
+            static const uint32_t id = _next++;
+            return id;
+        }
+};
+
+struct IAssetStorage {
+    virtual ~IAssetStorage() = default;
+};
+
+// assets of exactly type T packed together, slot i in assets is what the indices point at
+// names are not unique, the name index points at the first asset created with that name
+template<typename T>
+struct AssetStorage : public IAssetStorage {
+    std::vector<std::shared_ptr<T>> assets;
+    AssetIndex uuidIndex;
+    std::unordered_map<std::string, uint32_t, StringHash, std::equal_to<>> nameIndex;
+
+    void IndexName(uint32_t slot) {
+        nameIndex.try_emplace(assets[slot]->name, slot);
+    }
+
+    // drop slot from the name index, handing the name to another asset that shares it
+    void UnindexName(uint32_t slot) {
+        auto it = nameIndex.find(assets[slot]->name);
+        if (it == nameIndex.end() || it->second != slot)
+            return;
+        nameIndex.erase(it);
+        for (uint32_t i = 0; i < assets.size(); i++) {
+            if (i != slot && assets[i]->name == assets[slot]->name) {
+                nameIndex.emplace(assets[i]->name, i);
+                return;
+            }
+        }
+    }
+};
+
+// note: assets are stored by their concrete type, GetAssets<Mesh> will not see OpenGLMesh
+// note: rename through RenameAsset, writing Asset::name directly leaves the name index stale
 class AssetManager {
     private:
-        std::map<std::string, uint32_t> _typeToBuffer;
-        std::vector<std::map<UUID, uint32_t>> _idToIndex;
-        std::vector<std::vector<std::shared_ptr<Asset>>> _assetLibrary;
+        std::vector<std::unique_ptr<IAssetStorage>> _storages;
 
         // private constructor for singleton
         AssetManager() = default;
@@ -51,18 +212,22 @@ class AssetManager {
         AssetManager& operator=(const AssetManager&) = delete;
 
         template<typename T>
-        void CheckForBuffer() {
-            std::string s = typeid(T).name();
-            if (_typeToBuffer.find(s) == _typeToBuffer.end()) {
-                uint32_t buf = _assetLibrary.size();
-                _typeToBuffer[s] = buf;
-                // add buffer
-                std::vector<std::shared_ptr<Asset>> newBuffer;
-                _assetLibrary.push_back(newBuffer);
-                // add uuid look up table
-                std::map<UUID, uint32_t> newLut;
-                _idToIndex.push_back(newLut);
-            }
+        AssetStorage<T>& Storage() {
+            uint32_t id = AssetTypeId::Get<T>();
+            if (id >= _storages.size())
+                _storages.resize(id + 1);
+            if (_storages[id] == nullptr)
+                _storages[id] = std::make_unique<AssetStorage<T>>();
+            return static_cast<AssetStorage<T>&>(*_storages[id]);
+        }
+
+        // null if nothing of type T was ever created, never allocates
+        template<typename T>
+        AssetStorage<T>* FindStorage() {
+            uint32_t id = AssetTypeId::Get<T>();
+            if (id >= _storages.size())
+                return nullptr;
+            return static_cast<AssetStorage<T>*>(_storages[id].get());
         }
 
     public:
@@ -71,92 +236,99 @@ class AssetManager {
 
         template<typename T>
         auto begin() {
-            CheckForBuffer<T>();
-            std::string s = typeid(T).name();
-            uint32_t buf = _typeToBuffer[s];
-            return _assetLibrary[buf].begin();
+            return Storage<T>().assets.cbegin();
         }
 
         template<typename T>
         auto end() {
-            CheckForBuffer<T>();
-            std::string s = typeid(T).name();
-            uint32_t buf = _typeToBuffer[s];
-            return _assetLibrary[buf].end();
+            return Storage<T>().assets.cend();
         }
 
         template<typename T, typename... Args>
         std::shared_ptr<T> CreateAsset(Args&&... args) {
-            CheckForBuffer<T>();
-            std::string s = typeid(T).name();
-            uint32_t buf = _typeToBuffer[s];
+            AssetStorage<T>& storage = Storage<T>();
             std::shared_ptr<T> newAsset = std::make_shared<T>(std::forward<Args>(args)...);
-            uint32_t idx = _assetLibrary[buf].size();
-            _idToIndex[buf].emplace(newAsset->uuid, idx);
-            _assetLibrary[buf].push_back(newAsset);
+            uint32_t slot = storage.assets.size();
+            storage.uuidIndex.Insert(newAsset->uuid, slot);
+            storage.assets.push_back(newAsset);
+            storage.IndexName(slot);
             return newAsset;
         }
 
         template<typename T>
-        std::shared_ptr<T> GetAssetByUUID(UUID uuid) {
-            std::string s = typeid(T).name();
-            // didnt find buffer to even hold T, return null
-            if (_typeToBuffer.find(s) == _typeToBuffer.end()) {
-                return nullptr;
+        bool RenameAsset(UUID uuid, const std::string& name) {
+            AssetStorage<T>* storage = FindStorage<T>();
+            uint32_t slot = 0;
+            if (storage == nullptr || !storage->uuidIndex.Find(uuid, slot))
+                return false;
+            storage->UnindexName(slot);
+            storage->assets[slot]->name = name;
+            storage->IndexName(slot);
+            return true;
+        }
+
+        // removes from the manager, anything still holding the shared_ptr keeps it alive
+        // last asset is moved into the gap so slots stay dense
+        template<typename T>
+        bool DestroyAsset(UUID uuid) {
+            AssetStorage<T>* storage = FindStorage<T>();
+            uint32_t slot = 0;
+            if (storage == nullptr || !storage->uuidIndex.Find(uuid, slot))
+                return false;
+            uint32_t last = storage->assets.size() - 1;
+            storage->UnindexName(slot);
+            storage->uuidIndex.Erase(uuid);
+            if (slot != last) {
+                storage->UnindexName(last);
+                storage->assets[slot] = std::move(storage->assets[last]);
+                storage->uuidIndex.Insert(storage->assets[slot]->uuid, slot);
+                storage->IndexName(slot);
             }
-            uint32_t buf = _typeToBuffer[s];
-            // couldnt find uuid in index map
-            if (_idToIndex[buf].find(uuid) == _idToIndex[buf].end()) {
+            storage->assets.pop_back();
+            return true;
+        }
+
+        template<typename T>
+        std::shared_ptr<T> GetAssetByUUID(UUID uuid) {
+            AssetStorage<T>* storage = FindStorage<T>();
+            uint32_t idx = 0;
+            if (storage == nullptr || !storage->uuidIndex.Find(uuid, idx))
                 return nullptr;
-            }
-            uint32_t idx = _idToIndex[buf][uuid];
-            std::shared_ptr<Asset> ptr = _assetLibrary[buf][idx];
-            return std::dynamic_pointer_cast<T>(ptr);
+            return storage->assets[idx];
         }
 
         template<typename T>
-        std::shared_ptr<T> FindAsset(const std::string& name) {
-            std::string s = typeid(T).name();
-            // didnt find buffer to even hold T, return null
-            if (_typeToBuffer.find(s) == _typeToBuffer.end()) {
+        std::shared_ptr<T> FindAsset(std::string_view name) {
+            AssetStorage<T>* storage = FindStorage<T>();
+            if (storage == nullptr)
                 return nullptr;
-            }
-            std::vector<std::shared_ptr<Asset>> arr = GetAssets<T>();
-            for (auto asset : arr) {
-                if (asset->name.compare(name) == 0)
-                    return std::dynamic_pointer_cast<T>(asset);
-            }
+            auto it = storage->nameIndex.find(name);
             // could not find matching name
-            return nullptr;
+            if (it == storage->nameIndex.end())
+                return nullptr;
+            return storage->assets[it->second];
         }
 
         template<typename T>
-        UUID GetAssetUUID(const std::string& name) {
-            std::string s = typeid(T).name();
-            // didnt find buffer to even hold T, return null
-            if (_typeToBuffer.find(s) == _typeToBuffer.end()) {
-                return 0;
-            }
-            std::vector<std::shared_ptr<Asset>> arr = GetAssets<T>();
-            for (auto asset : arr) {
-                if (asset->name.compare(name) == 0)
-                    return asset->uuid;
-            }
-            // could not find matching name
-            return 0;
+        UUID GetAssetUUID(std::string_view name) {
+            std::shared_ptr<T> asset = FindAsset<T>(name);
+            return asset == nullptr ? UUID(0) : asset->uuid;
         }
 
+        // non-owning view, valid until the next asset of type T is created
         template<typename T>
-        std::vector<std::shared_ptr<Asset>> GetAssets() {
-            std::string s = typeid(T).name();
-            // check for buffer of T
-            if (_typeToBuffer.find(s) == _typeToBuffer.end()) {
-                return std::vector<std::shared_ptr<Asset>>();
-            }
-            return _assetLibrary[_typeToBuffer[s]];
+        std::span<const std::shared_ptr<T>> GetAssets() {
+            AssetStorage<T>* storage = FindStorage<T>();
+            if (storage == nullptr)
+                return {};
+            return std::span<const std::shared_ptr<T>>(storage->assets);
         }
 };
 
+// second half of an async load, runs on the main thread and creates the assets
+// returns false if loading failed
+using AssetCommit = std::function<bool()>;
+
 class IAssetLoader {
     private:
         std::vector<std::string> _extensions;
@@ -166,15 +338,49 @@ class IAssetLoader {
         virtual bool Load(const std::string& filepath) = 0;
         virtual std::vector<std::string> GetSupportedExt() = 0;
         virtual bool CanLoad(const std::string& filepath) = 0;
+
+        // runs on a worker, file io and parsing only, must not touch the AssetManager or GL
+        // return an empty commit on failure
+        // default defers everything to the commit so loaders without a split still work
+        virtual AssetCommit Prepare(const std::string& filepath) {
+            return [this, filepath]() { return Load(filepath); };
+        }
         
 };
 
+// result of LoadAsync, ready once the commit has run
+struct AssetLoadHandle {
+    std::string path;
+    std::shared_future<bool> result;
+
+    bool IsReady() const {
+        return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+};
+
+// prepared loads waiting for the main thread, workers block when it is full
+#define ASSET_COMMIT_QUEUE_MAX 32
+
 class AssetLoaderManager {
     private:
+        struct PendingCommit {
+            AssetCommit commit;
+            std::shared_ptr<std::promise<bool>> promise;
+        };
+
         std::vector<std::shared_ptr<IAssetLoader>> _loaders;
+        std::unique_ptr<ThreadPool> _pool;
+
+        std::deque<PendingCommit> _commits;
+        std::mutex _commitMutex;
+        std::condition_variable _commitReady;
+        std::condition_variable _commitSpace;
+        bool _stopping = false;
 
         AssetLoaderManager() = default;
-        ~AssetLoaderManager() = default;
+        ~AssetLoaderManager();
+
+        std::shared_ptr<IAssetLoader> FindLoader(const std::string& filepath);
 
     public:
         // Public static method to get the single instance
@@ -182,5 +388,13 @@ class AssetLoaderManager {
 
         void AddLoader(std::shared_ptr<IAssetLoader> loader);
 
+        // blocking, everything on the calling thread
         bool Load(const std::string& filepath);
+
+        // prepare on the worker pool, commits are queued for ProcessCommits on the main thread
+        std::vector<AssetLoadHandle> LoadAsync(const std::vector<std::string>& filepaths);
+        // run queued commits on the calling thread, 0 runs everything queued, returns number run
+        uint32_t ProcessCommits(uint32_t maxCommits = 0);
+        // process commits until every handle is ready, true if all loads succeeded
+        bool Wait(const std::vector<AssetLoadHandle>& handles);
 };
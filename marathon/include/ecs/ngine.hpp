@@ -8,15 +8,24 @@
 #include <typeinfo>
 #include <map>
 #include <iostream>
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
 // external libs
 #include <entt.hpp>
 // internal libs
 #include "la_extended.h"
 #include "core/uuid.hpp"
+#include "core/string_hash.hpp"
+#include "core/job_system.hpp"
 
 //// TODO: the asset N entity engine
 // 
 
+// scenes with fewer transforms update on the calling thread, and the smallest job for larger ones
+#define SCENE_PARALLEL_TRANSFORMS 2048
+#define SCENE_TRANSFORM_GRAIN 256
+
 struct CoreComponent {
     UUID uuid;
     std::string name;
@@ -39,25 +48,89 @@ struct TransformComponent {
         : position(pos) {}
 
 
+    // local TRS, only rebuilt when position/rotation/scale differ from the last build
     LA::mat4 GetTransform() {
-        return LA::Transformation(position, rotation, scale);
+        UpdateLocal();
+        return _local;
+    }
+
+    // parent * local, valid after Scene::UpdateTransforms
+    const LA::mat4& GetWorldTransform() const {
+        return _world;
+    }
+
+    // incremented whenever the world matrix is rebuilt
+    uint32_t GetVersion() const {
+        return _version;
     }
 
     LA::vec3 GetForward() {
-        LA::mat4 total = GetTransform();
-        return LA::vec3({ total[2][0], total[2][1], total[2][2] });
+        UpdateLocal();
+        return LA::vec3({ _local[2][0], _local[2][1], _local[2][2] });
     }
 
     LA::vec3 GetRight() {
-        LA::mat4 total = GetTransform();
-        return LA::vec3({ total[0][0], total[0][1], total[0][2] });
+        UpdateLocal();
+        return LA::vec3({ _local[0][0], _local[0][1], _local[0][2] });
     }
 
     LA::vec3 GetUp() {
-        LA::mat4 total = GetTransform();
-        return LA::vec3({ total[1][0], total[1][1], total[1][2] });
+        UpdateLocal();
+        return LA::vec3({ _local[1][0], _local[1][1], _local[1][2] });
+    }
+
+    LA::vec3 GetWorldPosition() const {
+        return LA::vec3({ _world[3][0], _world[3][1], _world[3][2] });
+    }
+
+    LA::vec3 GetWorldForward() const {
+        return LA::vec3({ _world[2][0], _world[2][1], _world[2][2] });
+    }
+
+    // returns true if the local matrix was rebuilt
+    bool UpdateLocal() {
+        if (_localValid && SameVec3(position, _cachedPosition)
+            && SameVec3(rotation, _cachedRotation) && SameVec3(scale, _cachedScale))
+            return false;
+        _local = LA::Transformation(position, rotation, scale);
+        _cachedPosition = position;
+        _cachedRotation = rotation;
+        _cachedScale = scale;
+        _localValid = true;
+        return true;
+    }
+
+    // force a rebuild on the next update
+    void Invalidate() {
+        _localValid = false;
+    }
+
+private:
+    friend class Scene;
+
+    LA::mat4 _local = LA::mat4();
+    LA::mat4 _world = LA::mat4();
+    LA::vec3 _cachedPosition = LA::vec3(0.0f);
+    LA::vec3 _cachedRotation = LA::vec3(0.0f);
+    LA::vec3 _cachedScale = LA::vec3(1.0f);
+    bool _localValid = false;
+    uint32_t _version = 0;
+    uint32_t _parentVersion = 0;
+
+    static bool SameVec3(const LA::vec3& a, const LA::vec3& b) {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
     }
-    
+};
+
+// parent/child links, managed through Entity::SetParent
+// depth is 0 for roots and orders the transform update so parents come first
+struct HierarchyComponent {
+    entt::entity parent = entt::null;
+    std::vector<entt::entity> children;
+    uint32_t depth = 0;
+
+    HierarchyComponent() = default;
+    HierarchyComponent(const HierarchyComponent&) = default;
 };
 
 class Entity;
@@ -66,7 +139,25 @@ class Scene {
     private:
         entt::registry _registry;
 
+        // set when parents change, transforms are re-sorted by depth on next update
+        bool _hierarchyChanged = true;
+        // transform pool order split into runs of equal depth, rebuilt each parallel update
+        std::vector<entt::entity> _transformOrder;
+        std::vector<uint32_t> _transformRuns;
+
+        // name -> entities, kept in step with CoreComponent by registry signals
+        // rename through Entity::SetName, writing CoreComponent::name directly leaves it stale
+        std::unordered_multimap<std::string, entt::entity, StringHash, std::equal_to<>> _nameIndex;
+
+        void OnCoreConstruct(entt::registry& registry, entt::entity entity);
+        void OnCoreDestroy(entt::registry& registry, entt::entity entity);
+        void UnindexName(const std::string& name, entt::entity entity);
+        void RenameEntity(entt::entity entity, const std::string& name);
+
         std::vector<Entity> ViewToVector(auto view);
+        void SetParent(entt::entity child, entt::entity parent);
+        void SetDepth(entt::entity entity, uint32_t depth);
+        void UpdateWorldTransform(entt::entity entity);
 
         friend class Entity; 
 
@@ -78,9 +169,22 @@ class Scene {
         void DestroyEntity(Entity);
         void Clear();
 
+        // bulk creation for loaders, handles come first so hierarchy links can refer to them
+        // every handle must then get a Core, Transform and Hierarchy component via InsertComponents
+        std::vector<entt::entity> CreateEntities(size_t count);
+        template<typename T>
+        void InsertComponents(const std::vector<entt::entity>& entities, const std::vector<T>& components);
+
+        // rebuild world matrices in parent before child order
+        // only entities whose local transform or parent changed do matrix work
+        // large scenes fan out over the job system one depth at a time
+        void UpdateTransforms();
+
+        // any one entity with the name, names are not unique
+        Entity FindEntityByName(std::string_view name);
+
         /// TODO: All of the following are slow conversions from entt::view
         /// Implement using internal registry system to support desired functionality
-        Entity FindEntityByName(const std::string& name);
         template<typename... Components>
         std::vector<Entity> GetEntitiesWith();
         std::vector<Entity> GetEntities();
@@ -147,10 +251,31 @@ class Entity {
         void RemoveComponent() {
             static_assert(!std::is_same_v<T, CoreComponent>, "Cannot remove CoreComponent.");
             static_assert(!std::is_same_v<T, TransformComponent>, "Cannot remove TransformComponent.");
+            static_assert(!std::is_same_v<T, HierarchyComponent>, "Cannot remove HierarchyComponent.");
             assert(HasComponent<T>() && "We don't have a component of this type to remove.");
             _scene->_registry.remove<T>(_entityHandle);
         }
         
+        void SetName(const std::string& name) {
+            _scene->RenameEntity(_entityHandle, name);
+        }
+
+        // pass a null entity to make this a root
+        void SetParent(Entity parent) {
+            _scene->SetParent(_entityHandle, parent._entityHandle);
+        }
+
+        Entity GetParent() {
+            return Entity{GetComponent<HierarchyComponent>().parent, _scene};
+        }
+
+        std::vector<Entity> GetChildren() {
+            std::vector<Entity> children;
+            for (entt::entity child : GetComponent<HierarchyComponent>().children)
+                children.push_back(Entity{child, _scene});
+            return children;
+        }
+
         void Destroy() {
             assert((_scene == nullptr) && "Cannot destroy entity with no scene bound.");
             _scene->DestroyEntity(*this);
@@ -160,9 +285,39 @@ class Entity {
 
 };
 
-Scene::Scene() {}
+Scene::Scene() {
+    _registry.on_construct<CoreComponent>().connect<&Scene::OnCoreConstruct>(this);
+    _registry.on_destroy<CoreComponent>().connect<&Scene::OnCoreDestroy>(this);
+}
 Scene::~Scene() {}
 
+void Scene::OnCoreConstruct(entt::registry& registry, entt::entity entity) {
+    _nameIndex.emplace(registry.get<CoreComponent>(entity).name, entity);
+}
+
+void Scene::OnCoreDestroy(entt::registry& registry, entt::entity entity) {
+    UnindexName(registry.get<CoreComponent>(entity).name, entity);
+}
+
+void Scene::UnindexName(const std::string& name, entt::entity entity) {
+    auto [first, last] = _nameIndex.equal_range(name);
+    for (auto it = first; it != last; ++it) {
+        if (it->second == entity) {
+            _nameIndex.erase(it);
+            return;
+        }
+    }
+}
+
+void Scene::RenameEntity(entt::entity entity, const std::string& name) {
+    CoreComponent& cc = _registry.get<CoreComponent>(entity);
+    if (cc.name == name)
+        return;
+    UnindexName(cc.name, entity);
+    cc.name = name;
+    _nameIndex.emplace(cc.name, entity);
+}
+
 std::vector<Entity> Scene::ViewToVector(auto view) {
     std::vector<Entity> arr = std::vector<Entity>(view.size());
     std::size_t idx = 0;
@@ -176,25 +331,143 @@ Entity Scene::CreateEntity(const std::string& name="Entity") {
     Entity entity = {_registry.create(), this};
     entity.AddComponent<CoreComponent>(name);
     entity.AddComponent<TransformComponent>();
+    entity.AddComponent<HierarchyComponent>();
+    _hierarchyChanged = true;
     return entity;
 }
 
+std::vector<entt::entity> Scene::CreateEntities(size_t count) {
+    std::vector<entt::entity> entities(count);
+    _registry.create(entities.begin(), entities.end());
+    _hierarchyChanged = true;
+    return entities;
+}
+
+template<typename T>
+void Scene::InsertComponents(const std::vector<entt::entity>& entities, const std::vector<T>& components) {
+    assert(entities.size() == components.size() && "Need one component per entity.");
+    _registry.insert<T>(entities.begin(), entities.end(), components.begin());
+    if constexpr (std::is_same_v<T, HierarchyComponent>)
+        _hierarchyChanged = true;
+}
+
 void Scene::DestroyEntity(Entity entity) {
+    // children go with their parent
+    std::vector<entt::entity> children = _registry.get<HierarchyComponent>(entity).children;
+    for (entt::entity child : children)
+        DestroyEntity(Entity{child, this});
+    SetParent(entity, entt::null);
+    // destroy swaps the last transform into the hole, which can put a child before its parent
     _registry.destroy(entity);
+    _hierarchyChanged = true;
 }
 
 void Scene::Clear() {
     _registry.clear();
+    _nameIndex.clear();
+    _hierarchyChanged = true;
 }
 
-Entity Scene::FindEntityByName(const std::string& name) {
-    auto view = _registry.view<CoreComponent>();
+void Scene::SetParent(entt::entity child, entt::entity parent) {
+    HierarchyComponent& hc = _registry.get<HierarchyComponent>(child);
+    if (hc.parent == parent)
+        return;
+    // refuse to parent to self or a descendant
+    for (entt::entity p = parent; p != entt::null; p = _registry.get<HierarchyComponent>(p).parent) {
+        if (p == child) {
+            std::cout << "WARNING (Scene): Can't parent an entity to itself or its descendant." << std::endl;
+            return;
+        }
+    }
+
+    if (hc.parent != entt::null) {
+        std::vector<entt::entity>& siblings = _registry.get<HierarchyComponent>(hc.parent).children;
+        siblings.erase(std::remove(siblings.begin(), siblings.end(), child), siblings.end());
+    }
+    hc.parent = parent;
+    uint32_t depth = 0;
+    if (parent != entt::null) {
+        HierarchyComponent& phc = _registry.get<HierarchyComponent>(parent);
+        phc.children.push_back(child);
+        depth = phc.depth + 1;
+    }
+    SetDepth(child, depth);
+    // world matrix must be rebuilt against the new parent, children follow by version
+    _registry.get<TransformComponent>(child).Invalidate();
+    _hierarchyChanged = true;
+}
+
+void Scene::SetDepth(entt::entity entity, uint32_t depth) {
+    HierarchyComponent& hc = _registry.get<HierarchyComponent>(entity);
+    hc.depth = depth;
+    for (entt::entity child : hc.children)
+        SetDepth(child, depth + 1);
+}
+
+void Scene::UpdateTransforms() {
+    // keep the transform pool in parent before child order, only when links change
+    if (_hierarchyChanged) {
+        _registry.sort<TransformComponent>([this](const entt::entity lhs, const entt::entity rhs) {
+            return _registry.get<HierarchyComponent>(lhs).depth < _registry.get<HierarchyComponent>(rhs).depth;
+        });
+        _hierarchyChanged = false;
+    }
+
+    auto view = _registry.view<TransformComponent>();
+    JobSystem& jobs = JobSystem::Instance();
+    if (jobs.GetThreadCount() == 1 || view.size() < SCENE_PARALLEL_TRANSFORMS) {
+        for (auto entity : view)
+            UpdateWorldTransform(entity);
+        return;
+    }
+
+    // parents always come earlier in the pool, so a run of one depth only reads finished parents
+    _transformOrder.clear();
+    _transformRuns.clear();
+    uint32_t runDepth = UINT32_MAX;
     for (auto entity : view) {
-        const CoreComponent& nc = view.get<CoreComponent>(entity);
-        if (nc.name == name)
-            return Entity{entity, this};
+        uint32_t depth = _registry.get<HierarchyComponent>(entity).depth;
+        if (depth != runDepth) {
+            _transformRuns.push_back((uint32_t)_transformOrder.size());
+            runDepth = depth;
+        }
+        _transformOrder.push_back(entity);
     }
-    return Entity{entt::null, this};
+    _transformRuns.push_back((uint32_t)_transformOrder.size());
+
+    for (size_t run = 0; run + 1 < _transformRuns.size(); run++) {
+        uint32_t first = _transformRuns[run];
+        jobs.ParallelFor(_transformRuns[run + 1] - first, SCENE_TRANSFORM_GRAIN, [this, first](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++)
+                UpdateWorldTransform(_transformOrder[first + i]);
+        });
+    }
+}
+
+void Scene::UpdateWorldTransform(entt::entity entity) {
+    TransformComponent& tc = _registry.get<TransformComponent>(entity);
+    bool localChanged = tc.UpdateLocal();
+    entt::entity parent = _registry.get<HierarchyComponent>(entity).parent;
+    if (parent == entt::null) {
+        if (localChanged) {
+            tc._world = tc._local;
+            tc._version++;
+        }
+        return;
+    }
+    const TransformComponent& ptc = _registry.get<TransformComponent>(parent);
+    if (localChanged || tc._parentVersion != ptc._version) {
+        tc._world = ptc._world * tc._local;
+        tc._parentVersion = ptc._version;
+        tc._version++;
+    }
+}
+
+Entity Scene::FindEntityByName(std::string_view name) {
+    auto it = _nameIndex.find(name);
+    if (it == _nameIndex.end())
+        return Entity{entt::null, this};
+    return Entity{it->second, this};
 }
 template<typename... Components>
 std::vector<Entity> Scene::GetEntitiesWith() {
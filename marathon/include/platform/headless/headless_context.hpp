@@ -0,0 +1,32 @@
+#pragma once
+
+#include "renderer/context.hpp"
+
+//// NOTES:
+// Keeps the settings so they read back as set, nothing is applied anywhere.
+
+class HeadlessContext : public Context {
+public:
+    HeadlessContext() = default;
+    ~HeadlessContext() = default;
+
+    void SetDrawMode(DrawMode m) override;
+    DrawMode GetDrawMode() override;
+    void SetPointSize(float size) override;
+    float GetPointSize() override;
+    void SetLineWidth(float width) override;
+    float GetLineWidth() override;
+    void SetWinding(Winding winding) override;
+    Winding GetWinding() override;
+    void SetClearColour(const LA::vec4& colour) override;
+    LA::vec4 GetClearColour() override;
+    void SetCulling(bool enabled) override;
+    bool IsCulling() override;
+    void SetDepthTesting(bool enabled) override;
+    bool IsDepthTesting() override;
+
+    // delete copy and assign operators should always get instance from class::instance func
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+};
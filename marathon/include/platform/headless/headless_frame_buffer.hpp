@@ -0,0 +1,20 @@
+#pragma once
+
+#include "renderer/frame_buffer.hpp"
+
+//// NOTES:
+// Only a size and the spec it was asked for, there are no attachments so every handle is 0.
+// Binds and clears show up in the headless renderer's command list rather than here.
+
+class HeadlessFrameBuffer : public FrameBuffer {
+public:
+    HeadlessFrameBuffer(const std::string& name="Frame", int width=800, int height=600, const FrameBufferSpec& spec=FrameBufferSpec());
+    ~HeadlessFrameBuffer() = default;
+
+    void Resize(int width, int height) override;
+    void Bind() override;
+    void Unbind() override;
+    uint32_t GetColourAttachment(uint32_t index=0) override;
+    uint32_t GetDepthStencilAttachment() override;
+    void Clear() override;
+};
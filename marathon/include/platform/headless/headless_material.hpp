@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include "renderer/material.hpp"
+
+//// NOTES:
+// Apply counts the properties the shader reflects, the same uploads OpenGLMaterial would make.
+// Textures are still bound so they go through RequestUpload on first use.
+
+class HeadlessMaterial : public Material {
+public:
+    HeadlessMaterial(std::string name = "Material");
+
+    bool IsUsable() const;
+    void Bind();
+    uint32_t Apply();
+    void Unbind();
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+
+#include "renderer/mesh.hpp"
+
+//// NOTES:
+// Nothing leaves the CPU arrays. RequestUpload fixes the layout and works out the sizes
+// the GL backend would upload, then the mesh is usable straight away.
+// Binds and draws are no-ops, the headless renderer records them instead.
+
+class HeadlessMesh : public Mesh {
+public:
+    HeadlessMesh(std::string name="Mesh");
+    ~HeadlessMesh() = default;
+
+    bool IsUsable() override;
+    void RequestUpload() override;
+
+    void Bind() override;
+    void Unbind() override;
+    void Draw(uint32_t lod=0) override;
+    void DrawInstanced(uint32_t instanceCount, uint32_t lod=0) override;
+    MeshMemoryUsage GetMemoryUsage() const override;
+
+private:
+    bool _isGenerated = false;
+    MeshMemoryUsage _memory;
+};
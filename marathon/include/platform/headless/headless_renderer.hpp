@@ -0,0 +1,122 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <iostream>
+
+#include "renderer/renderer.hpp"
+#include "platform/headless/headless_frame_buffer.hpp"
+
+//// NOTES:
+// Renderer for RendererAPI::API::NONE, no window, context or GPU.
+// Flush sorts, batches and walks the queue through Renderer exactly like OpenGLRenderer, so it counts
+// the same stats, but instead of issuing GL calls every state change and draw is appended to a command list.
+// Redundant binds are skipped as they would be on the GPU, so the list is what a real backend
+// would have been asked to do. Meshes and textures become usable on their first upload request.
+// Commands build up over a frame, EndFrame keeps them as the last frame and starts a new list.
+// Shadow maps record a SHADOW_VIEW per dirty view followed by its draws, with pass SHADOW.
+// A deferred Flush targets an owned G-buffer for its GBUFFER draws, then records the LIGHTING_PASS
+// on the original target before the forward draws, as OpenGLRenderer would issue them.
+
+enum class RenderCommandType : uint8_t {
+    CLEAR,
+    SET_FRAME_BUFFER,
+    SET_DRAW_MODE,
+    BIND_SHADER,
+    APPLY_MATERIAL,
+    BIND_MESH,
+    DRAW,
+    DRAW_INSTANCED,
+    // clears and targets one shadow atlas slot, the slot is in first
+    SHADOW_VIEW,
+    // full screen lighting of the G-buffer with the bound deferred shader
+    LIGHTING_PASS
+};
+
+// draws carry the full state they were issued with, so they can be checked without replaying binds
+struct RenderCommand {
+    RenderCommandType type = RenderCommandType::DRAW;
+    // null frame buffer is the screen
+    const FrameBuffer* frameBuffer = nullptr;
+    const Shader* shader = nullptr;
+    const Material* material = nullptr;
+    const Mesh* mesh = nullptr;
+    ShaderVariant variant = ShaderVariant::DEFAULT;
+    DrawMode drawMode = DrawMode::FILL;
+    RenderPass pass = RenderPass::OPAQUE;
+    uint8_t lod = 0;
+    // draws, model matrices are transforms[first, first + count)
+    uint32_t first = 0;
+    uint32_t count = 0;
+};
+
+struct RenderCommandList {
+    std::vector<RenderCommand> commands;
+    std::vector<LA::mat4> transforms;
+
+    uint32_t CountOf(RenderCommandType type) const {
+        uint32_t count = 0;
+        for (const RenderCommand& command : commands)
+            count += command.type == type;
+        return count;
+    }
+
+    void Clear() {
+        commands.clear();
+        transforms.clear();
+    }
+};
+
+class HeadlessRenderer : public Renderer {
+public:
+    void Boot() override;
+    void Shutdown() override;
+
+    // set null to draw directly to screen
+    void SetFrameBuffer(std::shared_ptr<FrameBuffer> fb) override;
+    std::shared_ptr<FrameBuffer> GetFrameBuffer() override;
+    void SetProjection(const LA::mat4& proj) override;
+    LA::mat4 GetProjection() override;
+    void SetView(const LA::mat4& view) override;
+    LA::mat4 GetView() override;
+
+    void Clear() override;
+    void RenderMesh(std::shared_ptr<Shader> shader, std::shared_ptr<Mesh> mesh, const LA::mat4& transform) override;
+    void Flush() override;
+    void EndFrame() override;
+
+    // commands recorded since the last EndFrame
+    const RenderCommandList& GetCommands() const;
+    // commands of the last completed frame
+    const RenderCommandList& GetLastFrame() const;
+    uint64_t GetFrameCount() const;
+
+    static HeadlessRenderer& Instance();
+
+protected:
+    HeadlessRenderer() = default;
+    ~HeadlessRenderer() = default;
+
+    void DrawShadows(const Shader* shader) override;
+
+private:
+    RenderCommandList _commands;
+    RenderCommandList _lastFrame;
+    uint64_t _frameCount = 0;
+    std::shared_ptr<HeadlessFrameBuffer> _gBuffer = nullptr;
+    bool _drawingGBuffer = false;
+
+    RenderCommand& Record(RenderCommandType type);
+    void UploadFrameData();
+    void BeginGBuffer();
+
+    void OnSetDrawMode(DrawMode mode) override;
+    void OnBindShader(const Shader* shader, ShaderVariant variant) override;
+    void OnApplyMaterial(const Material* material) override;
+    void OnBindMesh(const Mesh* mesh) override;
+    void IssueDraw(const DrawCall& draw, const DrawState& state) override;
+    void ResolveGBuffer() override;
+    void DrawLightingPass(const DrawState& state) override;
+    void BeginShadowView(const ShadowView& view) override;
+};
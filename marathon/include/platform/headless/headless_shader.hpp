@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "renderer/shader.hpp"
+
+//// NOTES:
+// No program is built, Compile checks the stages and reflects uniforms from the source text instead,
+// every "uniform type name;" declaration outside a block gets a handle, arrays as name and name[0].
+// Locate therefore fails for the same names the GL backend would, keeping upload counts comparable.
+// Variants exist when the sources mention their defines, as with OpenGLShader.
+// Setters are no-ops.
+
+class HeadlessShader : public Shader {
+    private:
+        bool _validShader = false;
+        bool _hasVariant[SHADER_VARIANT_COUNT] = {false};
+        std::unordered_map<std::string, int32_t> _uniformToHandle;
+
+        void ReflectUniforms(const std::string& source);
+
+    public:
+        HeadlessShader(std::string name="Default Shader", std::shared_ptr<ShaderSource> vs=nullptr, std::shared_ptr<ShaderSource> fs=nullptr, std::shared_ptr<ShaderSource> gs=nullptr);
+        ~HeadlessShader() = default;
+
+        bool IsUsable() const override;
+
+        void Compile() override;
+        void Bind() const override;
+        void Bind(ShaderVariant variant) const override;
+        bool HasVariant(ShaderVariant variant) const override;
+        void Unbind() const override;
+        void SetBool(const std::string& name, bool value) const override {}
+        void SetInt(const std::string& name, int value) const override {}
+        void SetUint(const std::string& name, uint32_t value) const override {}
+        void SetFloat(const std::string& name, float value) const override {}
+        void SetVec2(const std::string& name, const LA::vec2& v) const override {}
+        void SetVec2(const std::string& name, float x, float y) const override {}
+        void SetVec3(const std::string& name, const LA::vec3& v) const override {}
+        void SetVec3(const std::string& name, float x, float y, float z) const override {}
+        void SetVec4(const std::string& name, const LA::vec4& v) const override {}
+        void SetVec4(const std::string& name, float x, float y, float z, float w) const override {}
+        void SetMat2(const std::string& name, const LA::mat2& m) const override {}
+        void SetMat2(const std::string& name, float* mPtr) const override {}
+        void SetMat3(const std::string& name, const LA::mat3& m) const override {}
+        void SetMat3(const std::string& name, float* mPtr) const override {}
+        void SetMat4(const std::string& name, const LA::mat4& m) const override {}
+        void SetMat4(const std::string& name, float* mPtr) const override {}
+
+        UniformHandle Locate(const std::string& name) const override;
+        void SetBool(UniformHandle h, bool value) const override {}
+        void SetInt(UniformHandle h, int value) const override {}
+        void SetUint(UniformHandle h, uint32_t value) const override {}
+        void SetFloat(UniformHandle h, float value) const override {}
+        void SetVec2(UniformHandle h, const LA::vec2& v) const override {}
+        void SetVec3(UniformHandle h, const LA::vec3& v) const override {}
+        void SetVec4(UniformHandle h, const LA::vec4& v) const override {}
+        void SetMat2(UniformHandle h, const LA::mat2& m) const override {}
+        void SetMat3(UniformHandle h, const LA::mat3& m) const override {}
+        void SetMat4(UniformHandle h, const LA::mat4& m) const override {}
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "renderer/shader_source.hpp"
+
+//// NOTES:
+// Source text is kept for HeadlessShader to inspect, there is nothing to compile.
+
+class HeadlessShaderSource : public ShaderSource {
+public:
+    HeadlessShaderSource(const std::string& name="Default Shader Stage", const std::string& source="", ShaderStage stage=ShaderStage::INVALID);
+
+    // nothing to compile, always 0 as there is no shader object
+    uint32_t Compile(const std::vector<std::string>& defines={}) override;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+#include "renderer/texture.hpp"
+
+//// NOTES:
+// Levels stay in mips, RequestUpload only totals their size and marks the texture usable.
+// Pixels are dropped afterwards unless keepPixels is set, as with the GL backend.
+
+class HeadlessTexture : public Texture {
+public:
+    HeadlessTexture(std::string name="Texture");
+    ~HeadlessTexture() = default;
+
+    bool IsUsable() override;
+    void RequestUpload() override;
+    void Bind(uint32_t unit) override;
+    void Unbind(uint32_t unit) override;
+    TextureMemoryUsage GetMemoryUsage() const override;
+
+private:
+    bool _isGenerated = false;
+    TextureMemoryUsage _memory;
+};
@@ -1,24 +1,35 @@
 #pragma once
 
+#include <vector>
+
 #include "renderer/frame_buffer.hpp"
 #include "platform/opengl/opengl.hpp"
 
+//// NOTES:
+// One texture per colour attachment of the spec, all drawn to at once with glDrawBuffers.
+// Colour attachments filter linearly so ImGui can draw them, depth-stencil filters nearest.
+
 class OpenGLFrameBuffer : public FrameBuffer {
 private:
     uint32_t _fbo = 0;
-    uint32_t _texColour = 0;
+    std::vector<uint32_t> _texColours;
     uint32_t _texDepthStencil = 0;
 
     friend class Application;
 
+    // (re)allocates every attachment at the current size
+    void AllocateAttachments();
+
 public:
-    OpenGLFrameBuffer(const std::string& name="Frame", int width=800, int height=600);
+    OpenGLFrameBuffer(const std::string& name="Frame", int width=800, int height=600, const FrameBufferSpec& spec=FrameBufferSpec());
     ~OpenGLFrameBuffer();
 
     void Resize(int width, int height) override;
     void Bind() override;
     void Unbind() override;
-    uint32_t GetColourAttachment() override;
+    uint32_t GetColourAttachment(uint32_t index=0) override;
     uint32_t GetDepthStencilAttachment() override;
     void Clear() override;
+    // the GL framebuffer object, for blits
+    uint32_t GetId() const;
 };
@@ -0,0 +1,81 @@
+#pragma once
+
+// std libs
+#include <cstdint>
+
+// internal libs
+#include "platform/opengl/opengl.hpp"
+#include "core/profiler.hpp"
+
+//// TODO:
+// GL_TIMESTAMP queries for exact placement on the timeline
+
+//// NOTES:
+// GPU zones are GL_TIME_ELAPSED queries begun and ended around a renderer pass.
+// Each frame gets its own set of queries, a set is only read back GPU_TIMER_LATENCY frames later
+// so reading results never waits on the GPU, results that still aren't ready are dropped.
+// Elapsed queries can't nest, a zone begun inside another is ignored.
+// Only durations are measured, zones are placed on the profiler's GPU track at the time they were
+// submitted, pushed right so they don't overlap. GPU work runs behind the CPU so starts are a lower bound.
+
+#define GPU_TIMER_LATENCY 3
+#define GPU_TIMER_MAX_ZONES 32
+
+class OpenGLGpuTimer {
+public:
+    static OpenGLGpuTimer& Instance();
+
+    // needs a current GL context, does nothing without timer queries
+    void Begin(const char* name);
+    void End();
+
+    // once per frame after the last zone: files finished results with the profiler and moves to the next set
+    void EndFrame();
+    // release GL objects
+    void Shutdown();
+
+    bool IsSupported() const { return _supported; }
+
+private:
+    OpenGLGpuTimer() = default;
+    ~OpenGLGpuTimer() = default;
+    OpenGLGpuTimer(const OpenGLGpuTimer&) = delete;
+    OpenGLGpuTimer& operator=(const OpenGLGpuTimer&) = delete;
+
+    struct Zone {
+        const char* name = nullptr;
+        uint64_t submitted = 0;
+    };
+
+    struct QuerySet {
+        GLuint queries[GPU_TIMER_MAX_ZONES] = {};
+        Zone zones[GPU_TIMER_MAX_ZONES];
+        uint32_t count = 0;
+        uint64_t frameIndex = 0;
+    };
+
+    QuerySet _sets[GPU_TIMER_LATENCY];
+    uint32_t _current = 0;
+    bool _open = false;
+    bool _initialised = false;
+    bool _supported = false;
+
+    void Initialise();
+    void Resolve(QuerySet& set);
+};
+
+// GPU zone for the enclosing scope, pair with PROFILE_SCOPE to see the CPU side too
+class OpenGLGpuZone {
+public:
+    explicit OpenGLGpuZone(const char* name) { OpenGLGpuTimer::Instance().Begin(name); }
+    ~OpenGLGpuZone() { OpenGLGpuTimer::Instance().End(); }
+
+    OpenGLGpuZone(const OpenGLGpuZone&) = delete;
+    OpenGLGpuZone& operator=(const OpenGLGpuZone&) = delete;
+};
+
+#if PROFILER_ENABLED
+#define PROFILE_GPU_SCOPE(name) PROFILE_SCOPE(name); OpenGLGpuZone PROFILE_CONCAT(_gpuZone, __LINE__)(name)
+#else
+#define PROFILE_GPU_SCOPE(name)
+#endif
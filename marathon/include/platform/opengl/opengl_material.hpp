@@ -14,5 +14,6 @@ public:
 
     bool IsUsable() const;
     void Bind();
+    uint32_t Apply();
     void Unbind();
 };
\ No newline at end of file
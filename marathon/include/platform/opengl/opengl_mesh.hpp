@@ -9,9 +9,16 @@
 
 //// TODO:
 // think about renaming position to "vertex" or "fragment" for coordinate space to be inherant in the name
-// modify to use an array of buffers instead of having 8 fixed buffers, glGenBuffers(n, &buffers)
 // support uv4-uv7, bitangents
-// implement using VertexAttribute configuration structs to make it flexible
+
+//// NOTES:
+// All attributes live in one interleaved vertex buffer described by the mesh layout.
+// Indices are stored as 16 bit when every vertex can be addressed, otherwise 32 bit.
+// Flush requests an upload through OpenGLUploadQueue instead of generating on first draw,
+// the mesh is skipped until its buffers have been copied from staging.
+// Staged data is vertices then indices at a 4 byte aligned offset, both written from the
+// CPU arrays when the queue runs, so keep them unchanged until the mesh is usable.
+// LOD levels follow LOD 0 in the same index buffer, a level draws its own range of it.
 
 enum OpenGLAttribLocs : uint32_t {
     POSITION = 0,
@@ -21,7 +28,9 @@ enum OpenGLAttribLocs : uint32_t {
     UV0 = 4,
     UV1 = 5,
     UV2 = 6,
-    UV3 = 7
+    UV3 = 7,
+    // per instance model matrix, one column per location 8-11
+    INSTANCE_MODEL = 8
 };
 
 class OpenGLMesh : public Mesh {
@@ -33,19 +42,43 @@ public:
     ~OpenGLMesh();
 
     bool IsUsable() override;
+    void RequestUpload() override;
     
-    void Draw() override;
+    void Bind() override;
+    void Unbind() override;
+    void Draw(uint32_t lod=0) override;
+    void DrawInstanced(uint32_t instanceCount, uint32_t lod=0) override;
+    MeshMemoryUsage GetMemoryUsage() const override;
 
 private:
     bool _isGenerated = false;
     bool _isIndexed = false;
+    bool _uploadPending = false;
 
-    uint32_t _vertexBuffer, _normalBuffer, _tangentBuffer, _colourBuffer, _indexBuffer = 0;
-    uint32_t _uv0Buffer, _uv1Buffer, _uv2Buffer, _uv3Buffer = 0;
+    uint32_t _vertexBuffer = 0;
+    uint32_t _indexBuffer = 0;
     uint32_t _vaBuffer = 0;
 
-    template <typename T>
-    uint32_t GenerateBuffer(GLenum target, const std::vector<T>& data) ;
+    GLenum _indexType = GL_UNSIGNED_INT;
+    uint32_t _drawCount = 0;
+    // byte offset into the index buffer and index count per level, LOD 0 first
+    struct IndexRange {
+        size_t offset = 0;
+        uint32_t count = 0;
+    };
+    std::vector<IndexRange> _lodRanges;
+    MeshMemoryUsage _memory;
+    size_t _indexOffset = 0;
 
+    // blocking path for Bind outside of Flush
     void Generate();
+    // fixes layout, index type and staged sizes
+    void PrepareLayout();
+    size_t GetUploadSize() const;
+    void WriteUpload(uint8_t* dst) const;
+    // copies from source at offset when source is set, otherwise uploads from data
+    void CreateBuffers(GLuint source, size_t offset, const uint8_t* data);
+    void FillBuffer(GLenum target, size_t bytes, GLuint source, size_t offset, const uint8_t* data);
+    void EnableAttribute(const VertexElement& element, uint32_t stride);
+    const IndexRange& RangeOf(uint32_t lod) const;
 };
@@ -14,6 +14,11 @@
 #include "platform/opengl/opengl.hpp"
 #include "platform/opengl/opengl_shader.hpp"
 #include "platform/opengl/opengl_mesh.hpp"
+#include "platform/opengl/opengl_frame_buffer.hpp"
+
+// slope scaled depth offset while drawing shadow maps
+#define SHADOW_POLYGON_OFFSET_FACTOR 1.5f
+#define SHADOW_POLYGON_OFFSET_UNITS 4.0f
 
 //// TODO:
 // no method for glViewport(0, 0, width, height);
@@ -22,6 +27,23 @@
 // switching shader will need all uniforms reassigned
 // switching framebuffer will ONLY affect where pixels are drawn to
 // switching material/proj/view will ONLY affect bound shader
+// camera and light data live in one uniform buffer shared by every program,
+// it is re-uploaded with a single glBufferSubData before the first draw after a change
+// Flush walks the batches through Renderer, which skips redundant program/material/vao binds,
+// this backend only issues the draws, G-buffer resolve and shadow view targets
+// runs of the same mesh+material are drawn instanced when the shader has an
+// INSTANCED variant, model matrices for the frame go up in one buffer upload
+// GL 3.3 has no SSBOs, so matrices are read from per instance vertex attributes
+// new meshes stream in through OpenGLUploadQueue, at most a staging segment per Flush,
+// and are skipped until resident rather than stalling the frame
+// Clear, uploads and draws are timed on the GPU as well, see OpenGLGpuTimer
+// clustered lights, the cluster grid and the light index list go up as buffer textures (GL 3.1)
+// with the frame data, and are bound to the fixed CLUSTER_*_UNIT units for every Flush
+// shadow maps are drawn into one depth texture with its own framebuffer, the atlas keeps cached maps
+// between frames and is bound with depth comparison on SHADOW_ATLAS_UNIT for every Flush
+// the deferred path draws into an owned G-buffer sized to the target, lights it with one full screen
+// triangle from an empty vao, then blits its depth into the target for the forward packets that follow,
+// the default framebuffer only takes the blit when its depth format matches DEPTH24_STENCIL8
 
 class OpenGLRenderer : public Renderer {
 public:
@@ -38,9 +60,51 @@ public:
 
     void Clear() override;
     void RenderMesh(std::shared_ptr<Shader> shader, std::shared_ptr<Mesh> mesh, const LA::mat4& transform) override;
+    void Flush() override;
+    void EndFrame() override;
     static Renderer& Instance();
 
 protected:
     OpenGLRenderer() = default;
     ~OpenGLRenderer() = default;
+
+    void DrawShadows(const Shader* shader) override;
+
+private:
+    // camera block at offset 0, light, cluster and shadow blocks at the next aligned offsets
+    uint32_t _frameUniformBuffer = 0;
+    uint32_t _lightBlockOffset = 0;
+    uint32_t _clusterBlockOffset = 0;
+    uint32_t _shadowBlockOffset = 0;
+    std::vector<uint8_t> _frameUniformStaging;
+
+    // lights, grid, indices
+    uint32_t _clusterBuffers[3] = {0, 0, 0};
+    uint32_t _clusterTextures[3] = {0, 0, 0};
+    int32_t _maxTextureBufferTexels = 0;
+
+    uint32_t _shadowAtlas = 0;
+    uint32_t _shadowFrameBuffer = 0;
+
+    uint32_t _instanceBuffer = 0;
+    size_t _instanceCapacity = 0;
+
+    std::shared_ptr<OpenGLFrameBuffer> _gBuffer = nullptr;
+    uint32_t _emptyVertexArray = 0;
+
+    void UploadFrameData();
+    void UploadClusters();
+    void BindClusters();
+    void UploadInstances(const std::vector<LA::mat4>& instances);
+    void BindInstanceAttributes(uint32_t instanceOffset);
+    // after each instanced draw, so later plain draws of the vao don't read per instance matrices
+    void UnbindInstanceAttributes();
+    // the frame buffer set, or the window at the camera resolution
+    void BindTarget();
+    void BeginGBuffer();
+    // the target takes the G-buffer's depth, its attachments are bound for the lighting pass
+    void ResolveGBuffer() override;
+    void DrawLightingPass(const DrawState& state) override;
+    void IssueDraw(const DrawCall& draw, const DrawState& state) override;
+    void BeginShadowView(const ShadowView& view) override;
 };
\ No newline at end of file
@@ -4,26 +4,63 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <vector>
+#include <unordered_map>
 
 #include "platform/opengl/opengl.hpp"
 #include "renderer/shader.hpp"
+#include "renderer/uniform_blocks.hpp"
+#include "core/derived_data_cache.hpp"
 
 //// TODO:
 // unfix binding fragment data output location to "oColour"
 
+//// NOTES:
+// All active uniforms are reflected once after linking into a location table.
+// String setters hash into the table, handle setters index it directly.
+// Neither path calls glGetUniformLocation per set.
+// Each variant is its own program, handles are shared by name across variants
+// and setters resolve against the variant that was last bound.
+// Shared uniform blocks and the cluster buffer samplers are tied to their fixed bindings and units
+// once after linking.
+// Linked programs are kept in the derived data cache when the driver supports program binaries,
+// keyed by the sources, defines and driver strings. A binary the driver rejects is recompiled.
+
+#define SHADER_CACHE_BUCKET "shaders"
+// bump when anything set before linking changes, e.g. frag data locations
+#define SHADER_CACHE_VERSION 1
+
 class OpenGLShader : public Shader {
     private:
         bool _validShader = false;
-        uint32_t _programId = 0;
+        uint32_t _programIds[SHADER_VARIANT_COUNT] = {0};
+        mutable ShaderVariant _boundVariant = ShaderVariant::DEFAULT;
+
+        // uniform name -> handle index -> location per variant
+        std::unordered_map<std::string, int32_t> _uniformToHandle;
+        std::vector<int32_t> _locations[SHADER_VARIANT_COUNT];
+
+        // the geometry source is only attached when asked for
+        uint32_t LinkProgram(const std::vector<std::string>& defines, bool geometry=false);
+        uint64_t GetProgramKey(const std::vector<std::string>& defines, bool geometry) const;
+        uint32_t LoadProgramBinary(uint64_t key) const;
+        void SaveProgramBinary(uint32_t program, uint64_t key) const;
+        void ReflectUniforms(ShaderVariant variant);
+        void BindUniformBlocks(uint32_t program);
+        void AddUniform(const std::string& name, ShaderVariant variant, int32_t location);
+        int32_t GetLocation(const std::string& name) const;
+        int32_t GetLocation(UniformHandle h) const;
 
     public:
-        OpenGLShader(std::string name="Default Shader", std::shared_ptr<ShaderSource> vs=nullptr, std::shared_ptr<ShaderSource> fs=nullptr);
+        OpenGLShader(std::string name="Default Shader", std::shared_ptr<ShaderSource> vs=nullptr, std::shared_ptr<ShaderSource> fs=nullptr, std::shared_ptr<ShaderSource> gs=nullptr);
         ~OpenGLShader();
         
         bool IsUsable() const override;
 
         void Compile() override;
         void Bind() const override;
+        void Bind(ShaderVariant variant) const override;
+        bool HasVariant(ShaderVariant variant) const override;
         void Unbind() const override;
 
         void SetBool(const std::string& name, bool value) const override;
@@ -42,4 +79,19 @@ class OpenGLShader : public Shader {
         void SetMat3(const std::string& name, float* mPtr) const override;
         void SetMat4(const std::string& name, const LA::mat4& m) const override;
         void SetMat4(const std::string& name, float* mPtr) const override;
+
+        UniformHandle Locate(const std::string& name) const override;
+        void SetBool(UniformHandle h, bool value) const override;
+        void SetInt(UniformHandle h, int value) const override;
+        void SetUint(UniformHandle h, uint32_t value) const override;
+        void SetFloat(UniformHandle h, float value) const override;
+        void SetVec2(UniformHandle h, const LA::vec2& v) const override;
+        void SetVec3(UniformHandle h, const LA::vec3& v) const override;
+        void SetVec4(UniformHandle h, const LA::vec4& v) const override;
+        void SetMat2(UniformHandle h, const LA::mat2& m) const override;
+        void SetMat3(UniformHandle h, const LA::mat3& m) const override;
+        void SetMat4(UniformHandle h, const LA::mat4& m) const override;
+
+        // number of entries in the reflected location table
+        size_t GetUniformCount() const;
 };
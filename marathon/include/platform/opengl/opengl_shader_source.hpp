@@ -15,5 +15,5 @@ class OpenGLShaderSource : public ShaderSource {
 public:
     OpenGLShaderSource(const std::string& name="Default Shader Stage", const std::string& source="", ShaderStage stage=ShaderStage::INVALID);
 
-    uint32_t Compile();
+    uint32_t Compile(const std::vector<std::string>& defines={}) override;
 };
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <iostream>
+
+#include "platform/opengl/opengl.hpp"
+#include "renderer/texture.hpp"
+
+//// NOTES:
+// Each mip level is its own job on OpenGLUploadQueue, read from the staging buffer through
+// GL_PIXEL_UNPACK_BUFFER, so a 1k RGBA level 0 fits one segment and the rest follow next Flush.
+// The texture only reports usable once every level is in, until then Bind binds nothing.
+// Block compressed levels go up as they are, BC1/BC3 are decoded first if the driver lacks S3TC.
+
+class OpenGLTexture : public Texture {
+public:
+    OpenGLTexture(std::string name="Texture");
+    ~OpenGLTexture();
+
+    bool IsUsable() override;
+    void RequestUpload() override;
+    void Bind(uint32_t unit) override;
+    void Unbind(uint32_t unit) override;
+    TextureMemoryUsage GetMemoryUsage() const override;
+
+private:
+    bool _isGenerated = false;
+    bool _uploadPending = false;
+    uint32_t _levelsUploaded = 0;
+    uint32_t _levelCount = 0;
+    GLuint _texture = 0;
+    TextureMemoryUsage _memory;
+
+    void CreateTexture();
+    void UploadLevel(uint32_t level, GLuint source, size_t offset, const uint8_t* data);
+};
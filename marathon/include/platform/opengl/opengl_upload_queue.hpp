@@ -0,0 +1,81 @@
+#pragma once
+
+// std libs
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include <functional>
+
+// internal libs
+#include "platform/opengl/opengl.hpp"
+
+//// TODO:
+// split jobs larger than a segment across frames
+
+//// NOTES:
+// Uploads are written into a staging ring and copied into their destination on the GPU,
+// so the frame that first draws a mesh does not stall on a large glBufferData.
+// Ring is UPLOAD_SEGMENT_COUNT segments, one used per Process, each guarded by a fence
+// so the CPU never writes over data the GPU is still copying from.
+// With ARB_buffer_storage the ring is mapped once persistently, otherwise one segment
+// sized buffer is orphaned and mapped each Process.
+// A segment is also the per Process byte budget, jobs bigger than a segment are uploaded directly.
+
+#define UPLOAD_SEGMENT_SIZE (4 * 1024 * 1024)
+#define UPLOAD_SEGMENT_COUNT 3
+#define UPLOAD_ALIGNMENT 16
+
+struct UploadJob {
+    // jobs are cancelled by owner, e.g. when a mesh is destroyed before its upload ran
+    const void* owner = nullptr;
+    size_t bytes = 0;
+    // write the job's data to dst, bytes long, on the CPU
+    std::function<void(uint8_t* dst)> fill;
+    // create/copy into the destination from source at offset,
+    // source is 0 for direct uploads and data points at the filled bytes instead
+    std::function<void(GLuint source, size_t offset, const uint8_t* data)> finish;
+};
+
+struct UploadStats {
+    uint32_t bytes = 0;
+    uint32_t jobs = 0;
+    uint32_t pending = 0;
+};
+
+class OpenGLUploadQueue {
+public:
+    static OpenGLUploadQueue& Instance();
+
+    void Enqueue(UploadJob job);
+    void Cancel(const void* owner);
+
+    // runs queued jobs up to the byte budget, needs a current GL context
+    void Process();
+    // release GL objects, pending jobs stay queued
+    void Shutdown();
+
+    const UploadStats& GetStats() const { return _stats; }
+    size_t GetPendingCount() const { return _jobs.size(); }
+    bool IsPersistent() const { return _persistent; }
+
+private:
+    OpenGLUploadQueue() = default;
+    ~OpenGLUploadQueue() = default;
+    OpenGLUploadQueue(const OpenGLUploadQueue&) = delete;
+    OpenGLUploadQueue& operator=(const OpenGLUploadQueue&) = delete;
+
+    std::deque<UploadJob> _jobs;
+    UploadStats _stats;
+
+    bool _initialised = false;
+    bool _persistent = false;
+    GLuint _stagingBuffer = 0;
+    uint8_t* _mapped = nullptr;
+    GLsync _fences[UPLOAD_SEGMENT_COUNT] = {};
+    uint32_t _segment = 0;
+
+    void Initialise();
+    void WaitForSegment(uint32_t segment);
+    void UploadDirect(UploadJob& job);
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "la_extended.h"
+#include "renderer/frame_buffer.hpp"
+
+//// NOTES:
+// RGBA8 colour and float depth in CPU memory, rows top first, each padded to a multiple of 4 pixels
+// so the rasteriser can always work on 4 pixels at once. Depth is window depth in [0, 1], cleared to 1.
+// Colour bytes are r, g, b, a in memory, the same as glReadPixels with GL_RGBA/GL_UNSIGNED_BYTE flipped.
+// Only the first colour attachment of a spec is kept and always as RGBA8, the rasteriser's deferred
+// path keeps its own per tile G-buffer rather than drawing into extra attachments.
+
+class SoftwareFrameBuffer : public FrameBuffer {
+private:
+    uint32_t _stride = 0;
+    std::vector<uint32_t> _colour;
+    std::vector<float> _depth;
+
+public:
+    // applied by Clear, the renderer copies the context clear colour in before clearing
+    LA::vec4 clearColour = LA::vec4({0.0f, 0.0f, 0.0f, 1.0f});
+
+    SoftwareFrameBuffer(const std::string& name="Frame", int width=800, int height=600, const FrameBufferSpec& spec=FrameBufferSpec());
+    ~SoftwareFrameBuffer() = default;
+
+    void Resize(int width, int height) override;
+    void Bind() override;
+    void Unbind() override;
+    // there are no GL objects behind a software frame buffer
+    uint32_t GetColourAttachment(uint32_t index=0) override;
+    uint32_t GetDepthStencilAttachment() override;
+    void Clear() override;
+
+    // pixels per row including padding
+    uint32_t GetStride() const { return _stride; }
+    uint32_t* GetColour() { return _colour.data(); }
+    const uint32_t* GetColour() const { return _colour.data(); }
+    float* GetDepth() { return _depth.data(); }
+
+    // tightly packed RGBA8, top row first
+    void ReadPixels(std::vector<uint8_t>& out) const;
+};
@@ -0,0 +1,156 @@
+#pragma once
+
+// std libs
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+
+// internal libs
+#include "la_extended.h"
+#include "core/thread_pool.hpp"
+#include "renderer/mesh.hpp"
+#include "renderer/context.hpp"
+#include "renderer/uniform_blocks.hpp"
+#include "platform/software/software_frame_buffer.hpp"
+
+//// TODO:
+// textures, vertex colours and uvs, only the two shading models below are drawn
+// line and point draw modes
+
+//// NOTES:
+// Sort middle tiled rasteriser, every stage runs on all threads and the caller:
+//      vertices    each draw is transformed into clip space, world position and the untransformed
+//                  normal, the same varyings lighting.vert hands to the fragment shader
+//      setup       triangles are split into one contiguous run per thread, clipped against the near
+//                  plane, then set up four at a time with SSE (projection, area, culling, bounds and
+//                  edge equations) and binned into RASTER_TILE_SIZE square tiles
+//      raster      tiles are pulled from a shared counter, each walks every thread's bins in submission
+//                  order and tests 4 pixels at a time against the edges and the depth buffer (LESS)
+// Only pixels passing the depth test are shaded, shading is scalar and follows the GLSL line by line
+// so images match the GPU to within a few levels. Fill follows the top-left rule at pixel centres.
+// Deferred shading keeps a G-buffer per tile instead of per target: lit triangles only store their
+// interpolated position and normal, and once every triangle of the tile is drawn each covered pixel
+// is lit once, as the GPU deferred path does over the whole screen.
+// Wireframe draws darken pixels within RASTER_WIREFRAME_WIDTH of a triangle edge like lighting.frag's
+// WIREFRAME variant, the edge functions are already barycentrics so their gradient gives the distance.
+
+#define RASTER_TILE_SIZE 64
+// edge line half width in pixels and colour, match lighting.frag
+#define RASTER_WIREFRAME_WIDTH 1.0f
+#define RASTER_WIREFRAME_COLOUR 0.0f
+
+enum class RasterShading : uint8_t {
+    // lighting.frag, directional, point and spot lights from the light block
+    LIGHTING,
+    // base.frag, object space position as colour
+    POSITION
+};
+
+struct RasterDraw {
+    const Mesh* mesh = nullptr;
+    LA::mat4 model = LA::mat4();
+    RasterShading shading = RasterShading::POSITION;
+    // edges drawn over the shading, forward only
+    bool wireframe = false;
+    // index list of mesh->GetLODIndices
+    uint32_t lod = 0;
+};
+
+struct RasterState {
+    LA::mat4 viewProjection = LA::mat4();
+    const CameraBlock* camera = nullptr;
+    const LightBlock* lights = nullptr;
+    bool culling = true;
+    Winding winding = Winding::CCW;
+    bool depthTesting = true;
+    // light each pixel once after all triangles are drawn rather than every fragment passing the depth test
+    bool deferred = false;
+};
+
+// counters and stage timings of the last Draw
+struct RasterStats {
+    uint32_t triangles = 0;
+    // near plane clipped triangles, and triangles off screen, back facing or covering no pixel
+    uint32_t clipped = 0;
+    uint32_t culled = 0;
+    // triangle and tile pairs
+    uint32_t binned = 0;
+    // fragments passing the depth test, and the pixels those cost a shading evaluation
+    uint64_t fragments = 0;
+    uint64_t pixelsShaded = 0;
+    double vertexMs = 0.0;
+    double setupMs = 0.0;
+    double rasterMs = 0.0;
+};
+
+class SoftwareRasteriser {
+public:
+    // threads including the caller, 0 picks every hardware thread
+    SoftwareRasteriser(uint32_t threadCount = 0);
+
+    void SetThreadCount(uint32_t threadCount);
+    uint32_t GetThreadCount() const;
+
+    // draws are rasterised in order, ties in depth keep the first
+    void Draw(SoftwareFrameBuffer& target, const std::vector<RasterDraw>& draws, const RasterState& state);
+    const RasterStats& GetStats() const;
+
+    // clip space position, then the varyings
+    struct Vertex {
+        float clip[4];
+        float world[3];
+        float normal[3];
+        float local[3];
+    };
+
+    // edge equations give barycentrics directly, b = a * x + b * y + c
+    struct Triangle {
+        float edges[3][3];
+        float depth[3];
+        float invW[3];
+        const Vertex* vertices[3];
+        uint32_t draw = 0;
+        // pixel bounds, max exclusive
+        int minX = 0, minY = 0, maxX = 0, maxY = 0;
+        // bit i set when edge i is a top or left edge and owns pixels exactly on it
+        uint8_t topLeft = 0;
+    };
+
+private:
+    // one pixel of a tile's G-buffer
+    struct Surface {
+        float position[3];
+        float normal[3];
+        bool lit = false;
+    };
+
+    struct ThreadData {
+        std::vector<Triangle> triangles;
+        // near plane clipping output, deque keeps pointers stable
+        std::deque<Vertex> clipped;
+        // triangle indices per tile
+        std::vector<std::vector<uint32_t>> bins;
+        // RASTER_TILE_SIZE squared, reused for every tile the thread draws deferred
+        std::vector<Surface> surfaces;
+        RasterStats stats;
+    };
+
+    uint32_t _threadCount = 1;
+    std::unique_ptr<ThreadPool> _pool;
+    std::vector<ThreadData> _threads;
+    RasterStats _stats;
+
+    // per frame
+    std::vector<Vertex> _vertices;
+    std::vector<uint32_t> _vertexOffsets;
+    std::vector<uint32_t> _triangleOffsets;
+
+    // runs job(thread) once per thread, thread 0 on the caller
+    void RunParallel(const std::function<void(uint32_t)>& job);
+    void TransformDraw(const RasterDraw& draw, const LA::mat4& viewProjection, Vertex* out);
+    void SetupTriangles(uint32_t thread, const std::vector<RasterDraw>& draws, const RasterState& state, int width, int height, int tilesX);
+    // counts fragments and pixels shaded into the thread's stats
+    void RasteriseTile(uint32_t thread, uint32_t tile, SoftwareFrameBuffer& target, const std::vector<RasterDraw>& draws, const RasterState& state, int tilesX);
+};
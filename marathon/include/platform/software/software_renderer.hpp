@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <unordered_map>
+
+#include "renderer/renderer.hpp"
+#include "platform/software/software_frame_buffer.hpp"
+#include "platform/software/software_rasteriser.hpp"
+
+//// TODO:
+// wireframe packets are skipped until the rasteriser draws lines
+// clustered lighting, the legacy light block is shaded even when the renderer has clustered lighting on
+// shadows, Boot turns them off so no map is planned that nothing would draw
+
+//// NOTES:
+// Renderer for RendererAPI::API::SOFTWARE, draws on the CPU so images and timings don't depend on a driver.
+// Meshes, materials and shaders are the headless assets, the shading model comes from the fragment source:
+// shaders declaring the light block shade as lighting.frag, everything else as base.frag.
+// Flush sorts the queue like the GPU backends and rasterises every packet in one parallel pass.
+// With no frame buffer set draws go to an internal screen sized to the camera resolution.
+// The deferred path needs no deferred shader here, the rasteriser lights each tile from its own G-buffer.
+
+class SoftwareRenderer : public Renderer {
+public:
+    void Boot() override;
+    void Shutdown() override;
+
+    // set null to draw directly to screen, only SoftwareFrameBuffers can be drawn to
+    void SetFrameBuffer(std::shared_ptr<FrameBuffer> fb) override;
+    std::shared_ptr<FrameBuffer> GetFrameBuffer() override;
+    void SetProjection(const LA::mat4& proj) override;
+    LA::mat4 GetProjection() override;
+    void SetView(const LA::mat4& view) override;
+    LA::mat4 GetView() override;
+
+    void Clear() override;
+    void RenderMesh(std::shared_ptr<Shader> shader, std::shared_ptr<Mesh> mesh, const LA::mat4& transform) override;
+    void Flush() override;
+    void EndFrame() override;
+
+    std::shared_ptr<SoftwareFrameBuffer> GetScreen();
+    // threads rasterising including the caller, 0 for every hardware thread
+    void SetThreadCount(uint32_t threadCount);
+    uint32_t GetThreadCount() const;
+    // stats of the last rasterised pass
+    const RasterStats& GetRasterStats() const;
+
+    static SoftwareRenderer& Instance();
+
+protected:
+    SoftwareRenderer() = default;
+    ~SoftwareRenderer() = default;
+
+    void DrawShadows(const Shader* shader) override;
+
+private:
+    std::shared_ptr<SoftwareFrameBuffer> _target = nullptr;
+    std::shared_ptr<SoftwareFrameBuffer> _screen = nullptr;
+    SoftwareRasteriser _rasteriser;
+    std::vector<RasterDraw> _draws;
+    std::unordered_map<const Shader*, RasterShading> _shading;
+
+    SoftwareFrameBuffer& Target();
+    RasterShading ShadingOf(const Shader* shader);
+    void Rasterise();
+};
@@ -10,6 +10,7 @@
 #include "la_extended.h"
 #include "renderer/mesh.hpp"
 #include "renderer/material.hpp"
+#include "renderer/uniform_blocks.hpp"
 
 struct CameraComponent {
     float fov = 45.0f;
@@ -27,16 +28,16 @@ struct CameraComponent {
     }
 };
 
-#define DIRECTIONAL_LIGHT_MAX 4
 struct DirectionalLightComponent {
     LA::vec3 colour = LA::vec3({1.0f, 1.0f, 1.0f});
     float intensity = 1.0f;
+    // only the first shadowed directional light gets cascades
+    bool castShadows = true;
 
     DirectionalLightComponent() = default;
     DirectionalLightComponent(const DirectionalLightComponent&) = default;
 };
 
-#define POINT_LIGHT_MAX 16
 struct PointLightComponent {
     LA::vec3 colour = LA::vec3({1.0f, 1.0f, 1.0f});
     float intensity = 1.0f;
@@ -46,21 +47,37 @@ struct PointLightComponent {
     PointLightComponent(const PointLightComponent&) = default;
 };
 
-#define SPOT_LIGHT_MAX 4
 struct SpotLightComponent {
     LA::vec3 colour = LA::vec3({1.0f, 1.0f, 1.0f});
     float intensity = 1.0f;
     float cutOff = 12.5f;
     float outerCutOff = 15.0f;
+    float range = 10.0f;
+    bool castShadows = false;
 
     SpotLightComponent() = default;
     SpotLightComponent(const SpotLightComponent&) = default;
 };
 
+// world space bounds cached per entity by the culling pass
+// recomputed only when the transform version or mesh differs from the cached ones
+struct BoundsComponent {
+    LA::vec3 min = LA::vec3(0.0f);
+    LA::vec3 max = LA::vec3(0.0f);
+    uint32_t version = 0;
+    const Mesh* mesh = nullptr;
+    // mesh LOD drawn last frame, for hysteresis
+    uint8_t lod = 0;
+
+    BoundsComponent() = default;
+    BoundsComponent(const BoundsComponent&) = default;
+};
+
 // Note: will keep assets alive even if it has been removed from AssetManager until reassigned
 struct MeshRendererComponent {
     std::shared_ptr<Mesh> mesh = nullptr;
     std::shared_ptr<Material> material = nullptr;
+    bool castShadows = true;
 
     MeshRendererComponent() = default;
     MeshRendererComponent(const MeshRendererComponent&) = default;
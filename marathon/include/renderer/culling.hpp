@@ -0,0 +1,50 @@
+#pragma once
+
+// std libs
+#include <cstdint>
+#include <vector>
+
+// internal libs
+#include "la_extended.h"
+
+//// TODO:
+// hierarchical culling for very large scenes
+// occlusion culling
+
+//// NOTES:
+// Bounds are stored SoA as centre/extent so the kernel tests 4 boxes per plane at once.
+// Planes are left unnormalised, the box is outside when dot(n, c) + w < -dot(|n|, e)
+// which holds at any scale.
+// SSE2 is used when available, otherwise the scalar kernel runs.
+// Large sets are split across the job system, CULL_GRAIN boxes at least per job.
+
+#define CULL_GRAIN 4096
+
+struct Frustum {
+    // left, right, bottom, top, near, far as (nx, ny, nz, w) pointing inwards
+    LA::vec4 planes[6];
+
+    // Gribb/Hartmann extraction from a column major projection * view matrix
+    static Frustum FromMatrix(const LA::mat4& viewProjection);
+};
+
+// world space bounds of many objects, one entry per object
+struct BoundsSoA {
+    std::vector<float> cx, cy, cz;
+    std::vector<float> ex, ey, ez;
+
+    void Clear();
+    void Reserve(size_t count);
+    void Push(const LA::vec3& min, const LA::vec3& max);
+    // Resize then Set lets jobs fill disjoint entries
+    void Resize(size_t count);
+    void Set(size_t i, const LA::vec3& min, const LA::vec3& max);
+    size_t Size() const;
+};
+
+// transforms local bounds by the model matrix into a world space aabb
+void TransformBounds(const LA::vec3& localMin, const LA::vec3& localMax, const LA::mat4& transform, LA::vec3& worldMin, LA::vec3& worldMax);
+
+// writes 1 to visible[i] if box i intersects the frustum, returns the visible count
+uint32_t CullBounds(const Frustum& frustum, const BoundsSoA& bounds, std::vector<uint8_t>& visible);
+uint32_t CullBoundsScalar(const Frustum& frustum, const BoundsSoA& bounds, std::vector<uint8_t>& visible);
@@ -1,30 +1,55 @@
 #pragma once
 
+#include <vector>
+
 #include "ecs/asset.hpp"
 #include "renderer/renderer_api.hpp"
 
+//// NOTES:
+// A frame buffer is built from a FrameBufferSpec, colour attachment i is written by fragment output
+// location i. The default spec is the single RGBA8 colour plus depth-stencil every viewport uses.
+// Backends without GPU attachments keep the spec but only honour what they can (see their notes).
+
+enum class FrameBufferFormat : uint8_t {
+    RGBA8,
+    RGBA16F,
+    RG16F,
+    R11G11B10F,
+    R32F
+};
+
+struct FrameBufferSpec {
+    std::vector<FrameBufferFormat> colour = {FrameBufferFormat::RGBA8};
+    // 24 bit depth and 8 bit stencil, sampleable as a texture
+    bool depthStencil = true;
+};
+
 class FrameBuffer : public Asset {
 protected:
     int _width = 0;
     int _height = 0;
+    FrameBufferSpec _spec;
     
-    FrameBuffer(const std::string& name="FrameBuffer", int width=800, int height=600)
-        : Asset(name), _width(width), _height(height) {}
+    FrameBuffer(const std::string& name="FrameBuffer", int width=800, int height=600, const FrameBufferSpec& spec=FrameBufferSpec())
+        : Asset(name), _width(width), _height(height), _spec(spec) {}
 
 public:
     
     // handle resolution
     int GetWidth() { return _width; }
     int GetHeight() { return _height; }
+    const FrameBufferSpec& GetSpec() const { return _spec; }
+    uint32_t GetColourAttachmentCount() const { return (uint32_t)_spec.colour.size(); }
     
     // platform specific calls
     virtual void Resize(int width, int height) = 0;
     virtual void Bind() = 0;
     virtual void Unbind() = 0;
-    virtual uint32_t GetColourAttachment() = 0;
+    // texture handle of colour attachment index, 0 when there is none
+    virtual uint32_t GetColourAttachment(uint32_t index=0) = 0;
     virtual uint32_t GetDepthStencilAttachment() = 0;
     virtual void Clear() = 0;
 
-    static std::shared_ptr<FrameBuffer> Create(const std::string& name="Frame", int width=800, int height=600);
+    static std::shared_ptr<FrameBuffer> Create(const std::string& name="Frame", int width=800, int height=600, const FrameBufferSpec& spec=FrameBufferSpec());
         
 };
@@ -0,0 +1,101 @@
+#pragma once
+
+// std libs
+#include <cstdint>
+#include <vector>
+
+// internal libs
+#include "la_extended.h"
+#include "renderer/uniform_blocks.hpp"
+
+//// TODO:
+// tighten slices to the depth range of the last frame so empty space costs no clusters
+// assign on the GPU once compute shaders are available
+
+//// NOTES:
+// Clustered light assignment for forward shading. The view frustum is cut into a froxel grid of
+// CLUSTER_TILES_X x CLUSTER_TILES_Y screen tiles by CLUSTER_SLICES depth slices, slices grow
+// exponentially from the near plane to min(far, CLUSTER_FAR_MAX) so froxels stay roughly cubic.
+// Build runs once per frame:
+//      lights      every light goes to view space, its range becomes a sphere and a span of slices
+//      slices      one job per slice takes the lights overlapping it, projects the sphere to a tile
+//                  rectangle, then tests that rectangle four clusters at a time (SSE2 sphere against
+//                  cluster aabb), spot lights are also tested as cones against each cluster's sphere
+//      compaction  per cluster lists are joined into one index list, grid holds (offset, count)
+// Cluster bounds depend only on the projection and resolution and are kept until either changes.
+// A fragment finds its cluster from gl_FragCoord and its view depth, GetClusterIndex does the same
+// on the CPU. Clusters keep at most CLUSTER_LIGHTS_MAX lights, the rest are counted as dropped.
+
+#define CLUSTER_TILES_X 16
+#define CLUSTER_TILES_Y 9
+#define CLUSTER_SLICES 24
+#define CLUSTER_COUNT (CLUSTER_TILES_X * CLUSTER_TILES_Y * CLUSTER_SLICES)
+#define CLUSTER_LIGHTS_MAX 256
+// slices start no closer than this, orthographic near planes may be at or behind the camera
+#define CLUSTER_NEAR_MIN 0.05f
+// and end no further, for infinite or very deep projections
+#define CLUSTER_FAR_MAX 1000.0f
+// smallest job when moving lights to view space
+#define CLUSTER_LIGHT_GRAIN 256
+
+struct LightClusterStats {
+    uint32_t lights = 0;
+    // index list length, every light counted once per cluster it lands in
+    uint32_t references = 0;
+    uint32_t occupied = 0;
+    uint32_t maxPerCluster = 0;
+    // light references beyond CLUSTER_LIGHTS_MAX
+    uint32_t dropped = 0;
+    double buildMs = 0.0;
+};
+
+class LightClusters {
+public:
+    // lights in world space, indices in the output refer to this vector
+    void Build(const LA::mat4& view, const LA::mat4& projection, float width, float height, const std::vector<ClusterLightData>& lights);
+
+    const ClusterBlock& GetBlock() const;
+    // two entries per cluster, offset into the index list then count, tiles x fastest then y then slice
+    const std::vector<uint32_t>& GetGrid() const;
+    const std::vector<uint32_t>& GetIndices() const;
+    const LightClusterStats& GetStats() const;
+
+    // cluster of a fragment, window coordinates with the origin at the bottom left
+    uint32_t GetClusterIndex(float windowX, float windowY, float viewDepth) const;
+
+private:
+    // a light in view space, depth is positive in front of the camera
+    struct ViewLight {
+        float centre[3];
+        float radius;
+        float direction[3];
+        float cosOuter;
+        float sinOuter;
+        bool spot;
+    };
+
+    ClusterBlock _block = ClusterBlock();
+    LightClusterStats _stats = LightClusterStats();
+    std::vector<uint32_t> _grid;
+    std::vector<uint32_t> _indices;
+
+    // cluster view space aabbs, padded by 3 so a group of 4 starting on the last cluster stays in bounds
+    LA::mat4 _boundsProjection = LA::mat4();
+    float _boundsWidth = 0.0f;
+    float _boundsHeight = 0.0f;
+    bool _perspective = true;
+    float _sliceDepths[CLUSTER_SLICES + 1] = {};
+    std::vector<float> _minX, _minY, _minZ, _maxX, _maxY, _maxZ;
+
+    // frame scratch, capacity is kept between builds
+    std::vector<ViewLight> _viewLights;
+    std::vector<std::vector<uint32_t>> _sliceLights;
+    std::vector<std::vector<uint32_t>> _clusterLights;
+
+    void BuildBounds(const LA::mat4& projection, float width, float height);
+    int SliceOf(float viewDepth) const;
+    // tiles along one axis touched by view space extent [low, high] between depths near and far
+    bool TileRange(int axis, float low, float high, float near, float far, int& first, int& last) const;
+    void AssignSlice(uint32_t slice);
+    bool ConeHits(const ViewLight& light, uint32_t cluster) const;
+};
@@ -10,6 +10,8 @@
 #include "la_extended.h"
 #include "renderer/renderer_api.hpp"
 #include "renderer/shader.hpp"
+#include "renderer/texture.hpp"
+#include "renderer/sort_id.hpp"
 
 //// TODO:
 // Integrate more thoroughly with shader
@@ -28,7 +30,8 @@ using GLSLType = std::variant<
     LA::vec4, // for GLSL vec4
     LA::mat2, // for GLSL mat2
     LA::mat3, // for GLSL mat3
-    LA::mat4  // for GLSL mat4
+    LA::mat4, // for GLSL mat4
+    std::shared_ptr<Texture> // for GLSL sampler2D
 >;
 
 template <class T, class... Ts>
@@ -44,12 +47,15 @@ class Material : public Asset {
 public:
     std::map<std::string, GLSLType> properties;
     std::shared_ptr<Shader> shader = nullptr;
+    SortId sortId = SortId(SortIdTable::MATERIAL);
 
     Material(std::string name="Material")
         : Asset(name) {}
 
     virtual bool IsUsable() const = 0;
     virtual void Bind() = 0;
+    // upload properties to the already bound shader, returns uniforms uploaded
+    virtual uint32_t Apply() = 0;
 
     void SetProperty(const std::string& key, GLSLType value) {
         properties[key] = value;
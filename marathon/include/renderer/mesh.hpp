@@ -7,6 +7,8 @@
 #include "ecs/asset.hpp"
 #include "la_extended.h"
 #include "renderer/renderer_api.hpp"
+#include "renderer/vertex_layout.hpp"
+#include "renderer/sort_id.hpp"
 
 //// TODO:
 // add sub mesh support for future more complex meshes
@@ -15,6 +17,33 @@
 // support more texture channels
 // add internal state to ensure recompilation if vertices changed
 
+//// NOTES:
+// Attributes are kept as separate arrays on the CPU for editing and loading.
+// The backend interleaves them into a single buffer using layout when generating.
+// indices is LOD 0, lods holds coarser index lists over the same vertices (see mesh_simplifier.hpp).
+// Backends upload every level into one index buffer after LOD 0 and draw a level as a range of it.
+// SelectLOD picks the coarsest level whose error stays under MESH_LOD_PIXEL_ERROR pixels at the
+// given projected size, only moving to a coarser level once it is MESH_LOD_HYSTERESIS under that.
+
+// levels after LOD 0, the sort key keeps 3 bits for the level
+#define MESH_LOD_MAX 7
+#define MESH_LOD_PIXEL_ERROR 1.0f
+#define MESH_LOD_HYSTERESIS 0.25f
+
+// GPU memory taken by a mesh, packed is what was uploaded, unpacked is the float equivalent
+struct MeshMemoryUsage {
+    size_t vertexBytes = 0;
+    size_t indexBytes = 0;
+    size_t unpackedBytes = 0;
+};
+
+// one simplified level of a mesh
+struct MeshLOD {
+    std::vector<uint32_t> indices;
+    // largest distance in local units the surface moved from LOD 0
+    float error = 0.0f;
+};
+
 class Mesh : public Asset {
 public:
     std::vector<LA::vec3> vertices;
@@ -26,12 +55,42 @@ public:
     std::vector<LA::vec2> uv1;
     std::vector<LA::vec2> uv2;
     std::vector<LA::vec2> uv3;
+    // coarsest last, errors never decrease along the chain
+    std::vector<MeshLOD> lods;
+
+    // local space axis aligned bounds, refresh with CalculateBounds after editing vertices
+    LA::vec3 boundsMin = LA::vec3(0.0f);
+    LA::vec3 boundsMax = LA::vec3(0.0f);
+
+    // compact attribute formats, set before the mesh is generated
+    bool quantise = true;
+    // optional explicit layout, built from the attributes present if left empty
+    VertexLayout layout;
+    SortId sortId = SortId(SortIdTable::MESH);
 
     Mesh(std::string name)
         : Asset(name) {}
 
+    void CalculateBounds();
+
+    uint32_t GetLODCount() const;
+    // levels past the last clamp to it
+    const std::vector<uint32_t>& GetLODIndices(uint32_t lod) const;
+    uint32_t GetTriangleCount(uint32_t lod=0) const;
+    // every level, for sizing the index buffer
+    size_t GetTotalIndexCount() const;
+    // screenSize is the diameter of the bounds in pixels, current the level drawn last
+    uint32_t SelectLOD(float screenSize, uint32_t current=0) const;
+
     virtual bool IsUsable() = 0;
-    virtual void Draw() = 0;
+    // queue the GPU upload without blocking, IsUsable turns true once it has landed
+    virtual void RequestUpload() = 0;
+    // Draw assumes the mesh is bound, so consecutive draws can share a bind
+    virtual void Bind() = 0;
+    virtual void Unbind() = 0;
+    virtual void Draw(uint32_t lod=0) = 0;
+    virtual void DrawInstanced(uint32_t instanceCount, uint32_t lod=0) = 0;
+    virtual MeshMemoryUsage GetMemoryUsage() const = 0;
 
     static std::shared_ptr<Mesh> Create(std::string name);
 };
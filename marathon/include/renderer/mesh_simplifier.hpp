@@ -0,0 +1,38 @@
+#pragma once
+
+// std libs
+#include <cstdint>
+#include <vector>
+
+// internal libs
+#include "la_extended.h"
+#include "renderer/mesh.hpp"
+
+//// TODO:
+// collapse along hard edges and open borders, both are locked in place for now
+// weigh quadrics by normals and uvs as well as positions
+
+//// NOTES:
+// Garland-Heckbert quadric error simplification by half edge collapse: a vertex is only ever merged
+// into one of its neighbours, so every level indexes the original vertices and can share their buffer.
+// Vertices with equal position and normal are welded first. Positions shared by vertices with
+// different normals (hard edges) and positions on open or non manifold edges are locked.
+// Collapses are taken cheapest first from a lazily updated heap and rejected when they would flip a
+// triangle or break the link condition, which keeps closed surfaces closed.
+// GenerateLODs runs one simplification and snapshots it at each level, so every level's error is
+// measured against LOD 0: the square root of the largest quadric cost taken so far, in local units.
+
+// each level aims for this share of the previous one's triangles
+#define LOD_REDUCTION 0.5f
+// no level below this many triangles, and none saving less than LOD_MIN_SAVING of the previous
+#define LOD_MIN_TRIANGLES 32
+#define LOD_MIN_SAVING 0.1f
+
+// indices simplified towards targetTriangles, error is set to the error reached
+std::vector<uint32_t> SimplifyMesh(const std::vector<LA::vec3>& positions, const std::vector<LA::vec3>& normals,
+    const std::vector<uint32_t>& indices, uint32_t targetTriangles, float& error);
+
+// up to MESH_LOD_MAX levels coarser than indices, empty when nothing can be removed
+// normals may be empty, positions alone decide welding then
+std::vector<MeshLOD> GenerateLODs(const std::vector<LA::vec3>& positions, const std::vector<LA::vec3>& normals,
+    const std::vector<uint32_t>& indices);
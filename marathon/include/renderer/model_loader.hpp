@@ -9,13 +9,17 @@
 #include <vector>
 
 #include "core/filepath.hpp"
+#include "core/mapped_file.hpp"
+#include "core/derived_data_cache.hpp"
+#include "core/profiler.hpp"
 #include "ecs/asset.hpp"
 #include "renderer/mesh.hpp"
+#include "renderer/mesh_simplifier.hpp"
 #include "renderer/material.hpp"
 #include "la_extended.h"
 using namespace LA;
 
-#include "platform/opengl/opengl_mesh.hpp"
+#include "renderer/render_assets.hpp"
 
 #define TINYGLTF_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -25,14 +29,34 @@ using namespace LA;
 
 //// TODO:
 // remove opengl dependancy
+// include external .bin buffers in the cache key, only the .gltf bytes are hashed
+
+//// NOTES:
+// Parsing is kept free of shared state so Prepare can run on a worker,
+// assets are only created in the returned commit on the main thread.
+// Parsed meshes are stored in the derived data cache keyed by a hash of the gltf,
+// a hit maps the arrays back in and skips json and base64 decoding entirely.
+// LOD levels are generated with the parse and cached with it, so a hit skips simplification too.
+
+#define MODEL_CACHE_BUCKET "models"
+// bump when parsing or the cached layout changes
+#define MODEL_IMPORTER_VERSION 2
 
 class ModelLoader : public IAssetLoader {
 
 private:
     std::vector<std::string> _extensions = {".gltf"};
-	std::string _currentlyLoading = "";
 
-	void ProcessMesh(const tinygltf::Mesh& mesh, const tinygltf::Model& model) {
+	// mesh data pulled out of the gltf, becomes a mesh asset of the current API on commit
+	struct ParsedMesh {
+		std::string name;
+		std::vector<vec3> vertices;
+		std::vector<vec3> normals;
+		std::vector<uint32_t> indices;
+		std::vector<MeshLOD> lods;
+	};
+
+	void ProcessMesh(const tinygltf::Mesh& mesh, const tinygltf::Model& model, std::vector<ParsedMesh>& parsed) {
 		std::vector<vec3> vertices;
 		std::vector<vec3> normals;
 		std::vector<uint32_t> indices;
@@ -89,15 +113,50 @@ private:
 				indices.push_back(index);
 			}
 			// std::cout << vertices.size() << "|" << normals.size() << "|" << indices.size() << std::endl;
-			std::shared_ptr<OpenGLMesh> meshGL = assetManager.CreateAsset<OpenGLMesh>();
-			meshGL->name = mesh.name;
-			meshGL->path = _currentlyLoading;
-			meshGL->vertices = vertices;
-			meshGL->normals = normals;
-			meshGL->indices = indices;
+			std::vector<MeshLOD> lods = GenerateLODs(vertices, normals, indices);
+			parsed.push_back(ParsedMesh{mesh.name, vertices, normals, indices, std::move(lods)});
 		}
 	}
 
+	static std::vector<uint8_t> WriteCached(const std::vector<ParsedMesh>& parsed) {
+		BlobWriter writer;
+		writer.Write<uint32_t>(parsed.size());
+		for (const ParsedMesh& mesh : parsed) {
+			writer.WriteString(mesh.name);
+			writer.WriteVector(mesh.vertices);
+			writer.WriteVector(mesh.normals);
+			writer.WriteVector(mesh.indices);
+			writer.Write<uint32_t>(mesh.lods.size());
+			for (const MeshLOD& lod : mesh.lods) {
+				writer.WriteVector(lod.indices);
+				writer.Write(lod.error);
+			}
+		}
+		return writer.Data();
+	}
+
+	static bool ReadCached(const MappedFile& file, std::vector<ParsedMesh>& parsed) {
+		BlobReader reader(file.Data(), file.Size());
+		uint32_t count = 0;
+		if (!reader.Read(count))
+			return false;
+		parsed.resize(count);
+		for (ParsedMesh& mesh : parsed) {
+			if (!reader.ReadString(mesh.name) || !reader.ReadVector(mesh.vertices)
+				|| !reader.ReadVector(mesh.normals) || !reader.ReadVector(mesh.indices))
+				return false;
+			uint32_t lodCount = 0;
+			if (!reader.Read(lodCount) || lodCount > MESH_LOD_MAX)
+				return false;
+			mesh.lods.resize(lodCount);
+			for (MeshLOD& lod : mesh.lods) {
+				if (!reader.ReadVector(lod.indices) || !reader.Read(lod.error))
+					return false;
+			}
+		}
+		return reader.Remaining() == 0;
+	}
+
 	void ProcessMaterial(const tinygltf::Material& material, const tinygltf::Model& model) {
 		// const std::vector<double>& baseD = material.pbrMetallicRoughness.baseColorFactor;
 		// vec4 colour = vec4(std::vector<float>(baseD.begin(), baseD.end()));
@@ -112,26 +171,67 @@ public:
 		: IAssetLoader() {}
 
 	bool Load(const std::string& filepath) {
+		AssetCommit commit = Prepare(filepath);
+		return commit && commit();
+	}
+
+	AssetCommit Prepare(const std::string& filepath) override {
+		MappedFile file(filepath);
+		if (!file.IsOpen()) {
+			std::cout << "WARNING: Failed to open glTF file: " << filepath << std::endl;
+			return nullptr;
+		}
+
+		DerivedDataCache& cache = DerivedDataCache::Instance();
+		uint64_t key = HashBytes(file.Data(), file.Size(), MODEL_IMPORTER_VERSION);
+		auto parsed = std::make_shared<std::vector<ParsedMesh>>();
+		MappedFile cached;
+		if (cache.Map(MODEL_CACHE_BUCKET, key, cached)) {
+			if (ReadCached(cached, *parsed))
+				return MakeCommit(filepath, parsed);
+			std::cout << "WARNING (ModelLoader): Ignoring corrupt cache entry for " << filepath << std::endl;
+			cache.Reject(MODEL_CACHE_BUCKET, key);
+			parsed->clear();
+		}
+
 		tinygltf::Model model;
 		tinygltf::TinyGLTF loader;
 		std::string err;
 		std::string warn;
-		
-		bool result = loader.LoadASCIIFromFile(&model, &err, &warn, filepath);
+
+		// parse the bytes already mapped for hashing, external buffers resolve against the parent folder
+		PROFILE_SCOPE("Model Parse");
+		bool result = loader.LoadASCIIFromString(&model, &err, &warn, reinterpret_cast<const char*>(file.Data()),
+			(unsigned int)file.Size(), GetParentFolder(filepath));
 		if (!result) {
 			std::cout << "WARNING: Failed to load glTF file: " << err << std::endl;
-			return false;
+			return nullptr;
 		}
-		_currentlyLoading = filepath;
 		for (const tinygltf::Material& material : model.materials) {
 			ProcessMaterial(material, model);
 		}
 
 		for (const tinygltf::Mesh& mesh : model.meshes) {
-			ProcessMesh(mesh, model);
+			ProcessMesh(mesh, model, *parsed);
 		}
-		_currentlyLoading = "";
-		return true;
+		std::vector<uint8_t> blob = WriteCached(*parsed);
+		cache.Put(MODEL_CACHE_BUCKET, key, blob.data(), blob.size());
+		return MakeCommit(filepath, parsed);
+	}
+
+	AssetCommit MakeCommit(const std::string& filepath, std::shared_ptr<std::vector<ParsedMesh>> parsed) {
+		return [this, filepath, parsed]() {
+			for (ParsedMesh& mesh : *parsed) {
+				std::shared_ptr<Mesh> asset = CreateRenderAsset<Mesh>(mesh.name);
+				asset->path = filepath;
+				asset->vertices = std::move(mesh.vertices);
+				asset->normals = std::move(mesh.normals);
+				asset->indices = std::move(mesh.indices);
+				asset->lods = std::move(mesh.lods);
+				asset->CalculateBounds();
+			}
+			return true;
+		};
 	}
 
 	std::vector<std::string> GetSupportedExt() {
@@ -0,0 +1,96 @@
+#pragma once
+
+// std libs
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// internal libs
+#include "ecs/asset.hpp"
+#include "renderer/renderer_api.hpp"
+#include "renderer/mesh.hpp"
+#include "renderer/material.hpp"
+#include "renderer/texture.hpp"
+#include "renderer/shader.hpp"
+#include "renderer/shader_source.hpp"
+#include "platform/opengl/opengl_mesh.hpp"
+#include "platform/opengl/opengl_material.hpp"
+#include "platform/opengl/opengl_texture.hpp"
+#include "platform/opengl/opengl_shader.hpp"
+#include "platform/opengl/opengl_shader_source.hpp"
+#include "platform/headless/headless_mesh.hpp"
+#include "platform/headless/headless_material.hpp"
+#include "platform/headless/headless_texture.hpp"
+#include "platform/headless/headless_shader.hpp"
+#include "platform/headless/headless_shader_source.hpp"
+
+//// NOTES:
+// The AssetManager stores assets by concrete type, so code shared by every backend (loaders, serializers,
+// the scene renderer) creates and finds renderer assets through these, which pick the type for the current
+// RendererAPI. Backends without GPU resources of their own (NONE, SOFTWARE) share the headless types.
+
+template<typename T>
+struct RenderAssetTypes;
+
+template<>
+struct RenderAssetTypes<Mesh> {
+    using OpenGL = OpenGLMesh;
+    using Headless = HeadlessMesh;
+};
+
+template<>
+struct RenderAssetTypes<Material> {
+    using OpenGL = OpenGLMaterial;
+    using Headless = HeadlessMaterial;
+};
+
+template<>
+struct RenderAssetTypes<Texture> {
+    using OpenGL = OpenGLTexture;
+    using Headless = HeadlessTexture;
+};
+
+template<>
+struct RenderAssetTypes<Shader> {
+    using OpenGL = OpenGLShader;
+    using Headless = HeadlessShader;
+};
+
+template<>
+struct RenderAssetTypes<ShaderSource> {
+    using OpenGL = OpenGLShaderSource;
+    using Headless = HeadlessShaderSource;
+};
+
+// calls f with std::type_identity of the current API's concrete type for T
+template<typename T, typename F>
+decltype(auto) DispatchRenderAsset(F&& f) {
+    switch (RendererAPI::GetAPI()) {
+        case RendererAPI::API::OPENGL:
+            return f(std::type_identity<typename RenderAssetTypes<T>::OpenGL>());
+        default:
+            return f(std::type_identity<typename RenderAssetTypes<T>::Headless>());
+    }
+}
+
+template<typename T, typename... Args>
+std::shared_ptr<T> CreateRenderAsset(Args&&... args) {
+    return DispatchRenderAsset<T>([&](auto type) -> std::shared_ptr<T> {
+        return AssetManager::Instance().CreateAsset<typename decltype(type)::type>(std::forward<Args>(args)...);
+    });
+}
+
+template<typename T>
+std::shared_ptr<T> FindRenderAsset(std::string_view name) {
+    return DispatchRenderAsset<T>([&](auto type) -> std::shared_ptr<T> {
+        return AssetManager::Instance().FindAsset<typename decltype(type)::type>(name);
+    });
+}
+
+template<typename T>
+std::shared_ptr<T> GetRenderAssetByUUID(UUID uuid) {
+    return DispatchRenderAsset<T>([&](auto type) -> std::shared_ptr<T> {
+        return AssetManager::Instance().GetAssetByUUID<typename decltype(type)::type>(uuid);
+    });
+}
@@ -20,6 +20,91 @@
 #include "renderer/frame_buffer.hpp"
 #include "renderer/material.hpp"
 #include "renderer/context.hpp"
+#include "renderer/uniform_blocks.hpp"
+#include "renderer/light_clusters.hpp"
+#include "renderer/shadow_maps.hpp"
+#include "renderer/mesh.hpp"
+
+//// NOTES:
+// Submit() queues draws for the frame, Flush() sorts them by key and only
+// rebinds programs/VAOs/material properties when they change between packets.
+// Sort key, most significant first:
+//      pass     4 bits
+//      shader  12 bits
+//      material 16 bits
+//      mesh    13 bits
+//      LOD      3 bits
+//      depth   16 bits (front to back)
+// ids are the SortId each shader, material and mesh holds (see sort_id.hpp), past
+// 8192 live meshes they wrap and share, a collision only costs sort quality as
+// Flush compares the real objects for state changes
+// With clustered lighting on, backends build LightClusters from every point and spot light before
+// drawing and bind the CLUSTERED variant of shaders that have one. Shaders without it, and backends
+// that never build clusters, see only the lights that fit the Lights block.
+// RenderShadows plans the frame's shadow maps through ShadowMaps and has the backend draw only the
+// views whose casters or light changed, depth only with the given shader, before the frame is flushed.
+// With the DEFERRED path, opaque packets whose shader has a GBUFFER variant are drawn into a G-buffer
+// (albedo RGBA8, octahedral normal RG16F, depth) and lit once per pixel by a full screen pass with the
+// deferred shader, so lighting no longer scales with overdraw. Every other packet is drawn forward on
+// top, depth tested against the G-buffer's depth.
+// SHADED_WIREFRAME packets draw the opaque surface with its edges in one pass through the shader's
+// WIREFRAME variant (see assets/shaders/lighting.geom), instead of an OPAQUE packet plus a WIREFRAME
+// packet drawn again as lines. Submitters ask CanOverlayWireframe per shader and fall back to the
+// two packets when it says no.
+// Packets carry the mesh LOD to draw, a level of 0 is the mesh's own indices (see renderer/mesh.hpp).
+// SceneRenderer picks levels per entity from their projected size while IsMeshLOD is on.
+
+enum class RenderPass : uint8_t {
+    OPAQUE = 0,
+    WIREFRAME = 1,
+    // depth only, drawn by RenderShadows rather than queued
+    SHADOW = 2,
+    // opaque with its edges drawn in the same draw by the WIREFRAME variant
+    SHADED_WIREFRAME = 3
+};
+
+enum class RenderPath : uint8_t {
+    FORWARD = 0,
+    DEFERRED = 1
+};
+
+// per frame counters, reset with ResetStats()
+struct RenderStats {
+    uint32_t draws = 0;
+    uint32_t instances = 0;
+    uint32_t programBinds = 0;
+    uint32_t vaoBinds = 0;
+    uint32_t uniformUploads = 0;
+    // switches between filled and line drawing
+    uint32_t drawModeChanges = 0;
+    // triangles in the frame's draws, shadow maps aside
+    uint32_t triangles = 0;
+    uint32_t visible = 0;
+    uint32_t culled = 0;
+    // bytes copied through the upload queue, and jobs still waiting for budget
+    uint32_t uploadBytes = 0;
+    uint32_t uploadsPending = 0;
+    // shadow maps drawn and kept from earlier frames, draws and caster instances they took
+    uint32_t shadowViews = 0;
+    uint32_t shadowCacheHits = 0;
+    uint32_t shadowDraws = 0;
+    uint32_t shadowCasters = 0;
+    // draws into the G-buffer and full screen lighting passes with the deferred path
+    uint32_t gBufferDraws = 0;
+    uint32_t lightingPasses = 0;
+};
+
+// smallest run worth an instanced draw
+#define INSTANCE_BATCH_MIN 2
+
+struct RenderPacket {
+    uint64_t key = 0;
+    Mesh* mesh = nullptr;
+    Material* material = nullptr;
+    LA::mat4 transform = LA::mat4();
+    RenderPass pass = RenderPass::OPAQUE;
+    uint8_t lod = 0;
+};
 
 
 class Renderer : public Module {
@@ -29,6 +114,132 @@ protected:
     LA::mat4 _projection = LA::mat4();
     LA::mat4 _view = LA::mat4();
 
+    // per frame uniform block data, uploaded once before the first draw after a change
+    CameraBlock _cameraBlock = CameraBlock();
+    LightBlock _lightBlock = LightBlock();
+    uint32_t _directionalLightCount = 0;
+    uint32_t _pointLightCount = 0;
+    uint32_t _spotLightCount = 0;
+    bool _frameDataDirty = true;
+    // every point and spot light of the frame, the Lights block keeps only the first few
+    std::vector<ClusterLightData> _clusterLights;
+    LightClusters _lightClusters;
+    bool _clusteredLighting = true;
+
+    // lights asking for shadows and where each one's map index goes
+    struct ShadowSource {
+        int32_t directional = -1;
+        int32_t spot = -1;
+        int32_t cluster = -1;
+    };
+    std::vector<ShadowLight> _shadowLights;
+    std::vector<ShadowSource> _shadowSources;
+    ShadowMaps _shadowMaps;
+    ShadowBlock _shadowBlock = ShadowBlock();
+    bool _shadows = true;
+
+    RenderPath _renderPath = RenderPath::FORWARD;
+    std::shared_ptr<Shader> _deferredShader = nullptr;
+    bool _singlePassWireframe = true;
+    bool _meshLOD = true;
+
+    // casters of the dirty shadow views grouped by mesh, every batch draws with its view's matrix
+    struct ShadowBatch {
+        uint32_t view = 0;
+        Mesh* mesh = nullptr;
+        // model matrices are _shadowInstances[first, first + count)
+        uint32_t first = 0;
+        uint32_t count = 0;
+        bool instanced = false;
+    };
+    std::vector<ShadowBatch> _shadowBatches;
+    std::vector<LA::mat4> _shadowInstances;
+    std::vector<uint32_t> _shadowOrder;
+
+    // frame local render queue, sorted in place by Flush
+    std::vector<RenderPacket> _queue;
+    std::vector<uint32_t> _order;
+    std::vector<uint32_t> _orderScratch;
+    RenderStats _stats = RenderStats();
+
+    // consecutive sorted packets sharing mesh, LOD, material and pass
+    struct DrawBatch {
+        uint32_t first = 0;
+        uint32_t count = 0;
+        uint32_t instanceOffset = 0;
+        bool instanced = false;
+    };
+    std::vector<DrawBatch> _batches;
+    // model matrices of instanced batches in draw order
+    std::vector<LA::mat4> _instanceStaging;
+
+    uint64_t MakeSortKey(RenderPass pass, const Shader* shader, const Material* material, const Mesh* mesh, const LA::mat4& transform);
+    // the depth bits of a key only read the view, safe from any thread
+    uint64_t MakeDepthKey(const LA::mat4& transform) const;
+    // LSD radix sort of _order by packet key, skips bytes shared by every key
+    void SortQueue();
+    // groups the sorted queue into batches, runs of INSTANCE_BATCH_MIN or more are instanced
+    // when the shader has an INSTANCED variant
+    void BuildBatches();
+    // clusters this frame's lights for the current camera, a no-op with clustered lighting off
+    void BuildLightClusters();
+    // program for a batch, clustered when lighting is and the shader has that variant
+    // G-buffer programs never light so are never clustered, wireframe adds the edges on top
+    ShaderVariant SelectVariant(const Shader* shader, bool instanced, bool gBuffer=false, bool wireframe=false) const;
+    // true when this Flush takes the deferred path, warns once when it was asked for without a usable shader
+    bool IsDeferredFlush();
+    // packets drawn into the G-buffer on a deferred Flush, the rest are drawn forward after lighting
+    bool WritesGBuffer(const RenderPacket& packet) const;
+    // fills _shadowBatches for the dirty views of _shadowMaps
+    void BuildShadowBatches(const ShadowCasters& casters, const Shader* shader);
+    // draws the dirty views of _shadowMaps into the atlas from _shadowBatches, leaves the frame buffer as it was
+    virtual void DrawShadows(const Shader* shader) = 0;
+
+    // what a Flush has bound, carried from one pass to the next
+    struct DrawState {
+        DrawMode drawMode = DrawMode::FILL;
+        const Shader* shader = nullptr;
+        ShaderVariant variant = ShaderVariant::DEFAULT;
+        const Material* material = nullptr;
+        Mesh* mesh = nullptr;
+        UniformHandle model;
+    };
+    // one draw with its state bound, model matrices are transforms[0, count)
+    // instanced draws find the same matrices in the backend's instance upload from instanceOffset
+    struct DrawCall {
+        Mesh* mesh = nullptr;
+        uint8_t lod = 0;
+        RenderPass pass = RenderPass::OPAQUE;
+        const LA::mat4* transforms = nullptr;
+        uint32_t count = 1;
+        uint32_t instanceOffset = 0;
+        bool instanced = false;
+    };
+
+    // batch walks of the GPU backends, state changes go through Context, Shader, Material and Mesh
+    // only when they differ from the DrawState and the stats are counted here, the backend hooks
+    // below issue whatever else the backend needs
+    // the batches writing the G-buffer, or the forward ones, every batch unless deferred
+    void DrawBatches(bool gBuffer, bool deferred, DrawState& state);
+    void IssueBatch(const DrawBatch& batch, bool gBuffer, DrawState& state);
+    // full screen lighting of the G-buffer into the target with the deferred shader
+    void LightGBuffer(DrawState& state);
+    // every dirty view of _shadowMaps with its casters, meshes that aren't usable yet are left out
+    void DrawShadowBatches(const Shader* shader);
+    void SetDrawMode(DrawMode mode, DrawState& state);
+
+    // backend hooks, called after the change they are named for
+    virtual void OnSetDrawMode(DrawMode mode) {}
+    virtual void OnBindShader(const Shader* shader, ShaderVariant variant) {}
+    virtual void OnApplyMaterial(const Material* material) {}
+    virtual void OnBindMesh(const Mesh* mesh) {}
+    virtual void IssueDraw(const DrawCall& draw, const DrawState& state) {}
+    // the target bound with the G-buffer's depth, before the lighting pass
+    virtual void ResolveGBuffer() {}
+    virtual void DrawLightingPass(const DrawState& state) {}
+    // a dirty shadow view targeted and cleared, before its casters are drawn
+    virtual void BeginShadowView(const ShadowView& view) {}
+
 public:
     std::string GetName() override {
         return "Renderer";
@@ -49,10 +260,70 @@ public:
     virtual void SetView(const LA::mat4& view) = 0;
     virtual LA::mat4 GetView() = 0;
 
+    // shared camera state for every shader
+    void SetCameraPosition(const LA::vec3& position);
+    void SetResolution(float width, float height);
+
+    // lights are collected each frame, point and spot lights reach nothing beyond their range
+    // without clustered lighting extras beyond the Lights block limits are dropped
+    // spot cut offs are angles in radians
+    void ClearLights();
+    void AddDirectionalLight(const LA::vec3& colour, float intensity, const LA::vec3& direction, bool castShadows=false);
+    void AddPointLight(const LA::vec3& colour, float intensity, const LA::vec3& position, float range);
+    void AddSpotLight(const LA::vec3& colour, float intensity, const LA::vec3& position, const LA::vec3& direction, float cutOff, float outerCutOff, float range, bool castShadows=false);
+
+    // on by default
+    void SetClusteredLighting(bool clustered);
+    bool IsClusteredLighting() const;
+    // clusters as last built
+    const LightClusters& GetLightClusters() const;
+
+    // shadow maps for this frame's shadow casting lights, call after the camera and lights are set
+    // and before Flush, the shader draws depth only (see assets/shaders/shadow.vert)
+    void RenderShadows(const ShadowCasters& casters, const Shader* shader);
+    // on by default, off leaves every light unshadowed
+    void SetShadows(bool shadows);
+    bool IsShadows() const;
+    const ShadowMaps& GetShadowMaps() const;
+
+    // forward by default, deferred needs the lighting shader (see assets/shaders/deferred.frag)
+    // on backends drawing on the GPU and falls back to forward without it
+    void SetRenderPath(RenderPath path);
+    RenderPath GetRenderPath() const;
+    void SetDeferredShader(const std::shared_ptr<Shader>& shader);
+
+    // on by default, off always draws the wireframe overlay as a second pass of lines
+    void SetSinglePassWireframe(bool singlePass);
+    bool IsSinglePassWireframe() const;
+    // true when a SHADED_WIREFRAME packet may use this shader, needs its WIREFRAME variant and the
+    // forward path as the G-buffer keeps no edges, safe from any thread
+    bool CanOverlayWireframe(const Shader* shader) const;
+
+    // on by default, off draws every mesh at LOD 0
+    void SetMeshLOD(bool lod);
+    bool IsMeshLOD() const;
+
     virtual void Clear() = 0;
     
     virtual void RenderMesh(std::shared_ptr<Shader> shader, std::shared_ptr<Mesh> mesh, const LA::mat4& transform) = 0;
 
+    // deferred submission, packets are kept until the next Flush
+    // mesh and material must outlive the Flush
+    void Submit(const std::shared_ptr<Mesh>& mesh, const std::shared_ptr<Material>& material, const LA::mat4& transform, RenderPass pass=RenderPass::OPAQUE);
+    // bulk submission from jobs: ReservePackets grows the queue and returns the first new index,
+    // jobs fill disjoint packets with FillPacket (a null mesh leaves the slot empty), then
+    // ResolvePackets drops empty slots and finishes the keys on the calling thread
+    uint32_t ReservePackets(uint32_t count);
+    void FillPacket(uint32_t index, Mesh* mesh, Material* material, const LA::mat4& transform, RenderPass pass=RenderPass::OPAQUE, uint8_t lod=0);
+    void ResolvePackets(uint32_t first);
+    virtual void Flush() = 0;
+    // once per frame before presenting, e.g. to collect GPU timings
+    virtual void EndFrame() = 0;
+
+    const RenderStats& GetStats() const;
+    void ResetStats();
+    void RecordCulling(uint32_t visible, uint32_t culled);
+
     // delete copy and assign operators should always get instance from class::instance func
     Renderer(const Renderer&) = delete;
     Renderer& operator=(const Renderer&) = delete;
@@ -1,16 +1,26 @@
 #pragma once
 
+//// NOTES:
+// Every factory and Renderer::Instance() dispatch on the API, objects from different APIs can't be mixed,
+// so set it once before anything is created. NONE selects the headless backend, no window or GPU needed.
+// SOFTWARE draws on the CPU into SoftwareFrameBuffers and shares the headless assets.
+
 class RendererAPI {
 public:
     enum class API {
         NONE = 0,
-        OPENGL
+        OPENGL,
+        SOFTWARE
     };
 
     static API GetAPI() {
         return _api;
     }
 
+    static void SetAPI(API api) {
+        _api = api;
+    }
+
 private:
     RendererAPI() = delete;
     RendererAPI(RendererAPI const&) = delete;
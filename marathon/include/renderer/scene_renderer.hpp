@@ -0,0 +1,243 @@
+#pragma once
+
+// std libs
+#include <memory>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cmath>
+
+// internal libs
+#include "la_extended.h"
+#include "ecs/ngine.hpp"
+#include "ecs/asset.hpp"
+#include "renderer/renderer.hpp"
+#include "renderer/components.hpp"
+#include "renderer/culling.hpp"
+#include "renderer/render_assets.hpp"
+#include "core/job_system.hpp"
+
+//// TODO:
+// Render all cameras in scene
+
+//// NOTES:
+// Same dependency injection approach as SceneSerializer, pass in the scene to render.
+// Shared by the runtime and the editor so both draw a scene identically.
+// Camera and lights are pushed to the renderer once per frame, never per shader.
+// Wireframe overlay draws every mesh with the material named WIREFRAME_MATERIAL_NAME. Shaded with the
+// overlay, meshes whose shader can draw its own edges (Renderer::CanOverlayWireframe) are drawn once as
+// SHADED_WIREFRAME packets, the rest are drawn twice.
+// Renderables are frustum culled against cached world bounds before submission.
+// Bounds refresh, culling and packet building run as job system ParallelFors, anything that
+// adds components or touches the renderer's tables stays on the calling thread.
+// Renderables with castShadows go to the renderer as shadow casters before the flush, stamped with
+// their entity and transform version so shadow maps are only redrawn when a caster moves.
+// The deferred path lights the G-buffer with the shader named DEFERRED_SHADER_NAME.
+// While Renderer::IsMeshLOD each visible renderable draws the mesh LOD picked from the pixel diameter of
+// its world bounds, remembered in its BoundsComponent for hysteresis. Shadow casters always draw LOD 0.
+
+#define WIREFRAME_MATERIAL_NAME "wireframe-material"
+#define SHADOW_SHADER_NAME "shadow"
+#define DEFERRED_SHADER_NAME "deferred"
+// smallest job when refreshing bounds or building packets
+#define SCENE_RENDER_GRAIN 256
+
+enum class ShadingMode {
+    SHADED,
+    WIREFRAME,
+    SHADED_WIREFRAME
+};
+
+// camera state needed to draw a scene, independant of the camera controller
+struct SceneView {
+    LA::mat4 view = LA::mat4();
+    LA::mat4 projection = LA::mat4();
+    LA::vec3 position = LA::vec3(0.0f);
+    uint32_t width = 800;
+    uint32_t height = 600;
+};
+
+class SceneRenderer {
+public:
+    SceneRenderer(Scene& scene)
+        : _scene(scene) {}
+
+    void Render(const SceneView& view, ShadingMode shadingMode) {
+        // frame wide uniforms
+        _renderer.SetProjection(view.projection);
+        _renderer.SetView(view.view);
+        _renderer.SetResolution(view.width, view.height);
+        _renderer.SetCameraPosition(view.position);
+        _scene.UpdateTransforms();
+        GatherLights();
+
+        // queue visible entities, the renderer sorts and draws them on flush
+        _renderer.ResetStats();
+        GatherRenderables();
+        Frustum frustum = Frustum::FromMatrix(view.projection * view.view);
+        uint32_t visibleCount = CullBounds(frustum, _bounds, _visible);
+        _renderer.RecordCulling(visibleCount, (uint32_t)_visible.size() - visibleCount);
+        _renderer.RenderShadows(_casters, FindRenderAsset<Shader>(SHADOW_SHADER_NAME).get());
+
+        std::shared_ptr<Material> wireframe = FindRenderAsset<Material>(WIREFRAME_MATERIAL_NAME);
+        SubmitVisible(view, shadingMode, wireframe.get());
+        if (_renderer.GetRenderPath() == RenderPath::DEFERRED)
+            _renderer.SetDeferredShader(FindRenderAsset<Shader>(DEFERRED_SHADER_NAME));
+        _renderer.Flush();
+    }
+
+private:
+    Scene& _scene;
+    Renderer& _renderer = Renderer::Instance();
+
+    // frame scratch, index i refers to the same renderable in each
+    std::vector<Entity> _renderables;
+    std::vector<LA::mat4> _models;
+    BoundsSoA _bounds;
+    std::vector<uint8_t> _visible;
+    std::vector<uint32_t> _visibleIndices;
+    // renderables casting shadows
+    std::vector<uint32_t> _casterIndices;
+    ShadowCasters _casters;
+
+    void GatherRenderables() {
+        std::vector<Entity> entities = _scene.GetEntitiesWith<MeshRendererComponent>();
+        _renderables.clear();
+        _renderables.reserve(entities.size());
+        _casterIndices.clear();
+
+        for (auto& ent : entities) {
+            // check meshrenderer mesh is not none
+            MeshRendererComponent& mrc = ent.GetComponent<MeshRendererComponent>();
+            if (mrc.mesh == nullptr || mrc.material == nullptr) {
+                std::cout << "WARNING (SceneRenderer): Trying to render null mesh/material." << std::endl;
+                continue;
+            }
+            // adding components isn't safe from jobs
+            if (!ent.HasComponent<BoundsComponent>())
+                ent.AddComponent<BoundsComponent>();
+            if (mrc.castShadows)
+                _casterIndices.push_back((uint32_t)_renderables.size());
+            _renderables.push_back(ent);
+        }
+
+        uint32_t count = (uint32_t)_renderables.size();
+        _models.resize(count);
+        _bounds.Resize(count);
+        JobSystem::Instance().ParallelFor(count, SCENE_RENDER_GRAIN, [this](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                Entity& ent = _renderables[i];
+                MeshRendererComponent& mrc = ent.GetComponent<MeshRendererComponent>();
+                TransformComponent& tc = ent.GetComponent<TransformComponent>();
+                const LA::mat4& model = tc.GetWorldTransform();
+                BoundsComponent& bc = ent.GetComponent<BoundsComponent>();
+                if (bc.mesh != mrc.mesh.get() || bc.version != tc.GetVersion()) {
+                    TransformBounds(mrc.mesh->boundsMin, mrc.mesh->boundsMax, model, bc.min, bc.max);
+                    bc.version = tc.GetVersion();
+                    bc.mesh = mrc.mesh.get();
+                }
+                _models[i] = model;
+                _bounds.Set(i, bc.min, bc.max);
+            }
+        });
+
+        uint32_t casterCount = (uint32_t)_casterIndices.size();
+        _casters.Resize(casterCount);
+        JobSystem::Instance().ParallelFor(casterCount, SCENE_RENDER_GRAIN, [this](uint32_t begin, uint32_t end) {
+            for (uint32_t k = begin; k < end; k++) {
+                uint32_t i = _casterIndices[k];
+                Entity& ent = _renderables[i];
+                MeshRendererComponent& mrc = ent.GetComponent<MeshRendererComponent>();
+                BoundsComponent& bc = ent.GetComponent<BoundsComponent>();
+                uint64_t stamp = ((uint64_t)(uint32_t)ent << 32) | bc.version;
+                _casters.Set(k, mrc.mesh.get(), _models[i], bc.min, bc.max, stamp);
+            }
+        });
+    }
+
+    // one shaded and/or wireframe packet per visible renderable, or a single shaded wireframe one,
+    // filled by jobs into reserved slots
+    void SubmitVisible(const SceneView& view, ShadingMode shadingMode, Material* wireframe) {
+        _visibleIndices.clear();
+        for (uint32_t i = 0; i < (uint32_t)_renderables.size(); i++) {
+            if (_visible[i])
+                _visibleIndices.push_back(i);
+        }
+        bool shaded = shadingMode == ShadingMode::SHADED || shadingMode == ShadingMode::SHADED_WIREFRAME;
+        bool wire = (shadingMode == ShadingMode::WIREFRAME || shadingMode == ShadingMode::SHADED_WIREFRAME) && wireframe != nullptr;
+        uint32_t perObject = (shaded ? 1 : 0) + (wire ? 1 : 0);
+        if (perObject == 0 || _visibleIndices.empty())
+            return;
+
+        // pixels per world unit at unit distance, or at any distance for orthographic projections
+        bool perspective = view.projection[2][3] != 0.0f;
+        float pixelsPerUnit = view.projection[1][1] * (float)view.height * 0.5f;
+        bool meshLOD = _renderer.IsMeshLOD();
+
+        uint32_t first = _renderer.ReservePackets((uint32_t)_visibleIndices.size() * perObject);
+        JobSystem::Instance().ParallelFor((uint32_t)_visibleIndices.size(), SCENE_RENDER_GRAIN, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t k = begin; k < end; k++) {
+                uint32_t i = _visibleIndices[k];
+                MeshRendererComponent& mrc = _renderables[i].GetComponent<MeshRendererComponent>();
+                BoundsComponent& bc = _renderables[i].GetComponent<BoundsComponent>();
+                bc.lod = meshLOD ? SelectLOD(bc, view.position, perspective, pixelsPerUnit) : 0;
+                uint8_t lod = bc.lod;
+                uint32_t slot = first + k * perObject;
+                // unusable materials leave their slot empty, as does the overlay when drawn in one pass
+                if (shaded) {
+                    Material* material = mrc.material->IsUsable() ? mrc.material.get() : nullptr;
+                    if (wire && material && _renderer.CanOverlayWireframe(material->shader.get())) {
+                        _renderer.FillPacket(slot, mrc.mesh.get(), material, _models[i], RenderPass::SHADED_WIREFRAME, lod);
+                        continue;
+                    }
+                    _renderer.FillPacket(slot++, mrc.mesh.get(), material, _models[i], RenderPass::OPAQUE, lod);
+                }
+                if (wire)
+                    _renderer.FillPacket(slot, mrc.mesh.get(), wireframe, _models[i], RenderPass::WIREFRAME, lod);
+            }
+        });
+        _renderer.ResolvePackets(first);
+    }
+
+    // level for the projected diameter of the world bounds, cameras inside them get LOD 0
+    static uint8_t SelectLOD(const BoundsComponent& bc, const LA::vec3& camera, bool perspective, float pixelsPerUnit) {
+        if (!bc.mesh || bc.mesh->lods.empty())
+            return 0;
+        float ex = bc.max.x - bc.min.x, ey = bc.max.y - bc.min.y, ez = bc.max.z - bc.min.z;
+        float diameter = std::sqrt(ex * ex + ey * ey + ez * ez);
+        float screenSize = diameter * pixelsPerUnit;
+        if (perspective) {
+            float dx = (bc.min.x + bc.max.x) * 0.5f - camera.x;
+            float dy = (bc.min.y + bc.max.y) * 0.5f - camera.y;
+            float dz = (bc.min.z + bc.max.z) * 0.5f - camera.z;
+            float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+            if (distance <= diameter * 0.5f)
+                return 0;
+            screenSize /= distance;
+        }
+        return (uint8_t)bc.mesh->SelectLOD(screenSize, bc.lod);
+    }
+
+    void GatherLights() {
+        _renderer.ClearLights();
+
+        for (auto& e : _scene.GetEntitiesWith<DirectionalLightComponent>()) {
+            TransformComponent& tc = e.GetComponent<TransformComponent>();
+            DirectionalLightComponent& dlc = e.GetComponent<DirectionalLightComponent>();
+            _renderer.AddDirectionalLight(dlc.colour, dlc.intensity, tc.GetWorldForward(), dlc.castShadows);
+        }
+
+        for (auto& e : _scene.GetEntitiesWith<PointLightComponent>()) {
+            TransformComponent& tc = e.GetComponent<TransformComponent>();
+            PointLightComponent& plc = e.GetComponent<PointLightComponent>();
+            _renderer.AddPointLight(plc.colour, plc.intensity, tc.GetWorldPosition(), plc.range);
+        }
+
+        for (auto& e : _scene.GetEntitiesWith<SpotLightComponent>()) {
+            TransformComponent& tc = e.GetComponent<TransformComponent>();
+            SpotLightComponent& slc = e.GetComponent<SpotLightComponent>();
+            _renderer.AddSpotLight(slc.colour, slc.intensity, tc.GetWorldPosition(), tc.GetWorldForward(),
+                LA::Radians(slc.cutOff), LA::Radians(slc.outerCutOff), slc.range, slc.castShadows);
+        }
+    }
+};
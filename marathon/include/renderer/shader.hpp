@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -10,21 +11,93 @@
 #include "ecs/asset.hpp"
 #include "renderer/renderer_api.hpp"
 #include "renderer/shader_source.hpp"
+#include "renderer/sort_id.hpp"
+
+// index into a shader's reflected uniform table
+// resolve once with Shader::Locate and reuse in hot loops to avoid string lookups
+struct UniformHandle {
+    int32_t index = -1;
+
+    bool IsValid() const { return index >= 0; }
+};
+
+// compiled permutations of one shader, selected with preprocessor defines
+// the bits combine, a shader only builds a variant if its sources mention every define in it
+//      INSTANCED   per instance model matrices, looked for in the vertex source
+//      CLUSTERED   lights read from the cluster buffers, looked for in the fragment source
+//      GBUFFER     surface written to the deferred G-buffer instead of lit, looked for in the fragment source
+//      WIREFRAME   triangle edges drawn over the shaded surface in the same draw, needs a geometry source
+//                  and is looked for in the fragment source
+// GBUFFER never lights, so it is never combined with CLUSTERED or WIREFRAME
+enum class ShaderVariant : uint8_t {
+    DEFAULT = 0,
+    INSTANCED = 1,
+    CLUSTERED = 2,
+    INSTANCED_CLUSTERED = 3,
+    GBUFFER = 4,
+    INSTANCED_GBUFFER = 5,
+    WIREFRAME = 8,
+    INSTANCED_WIREFRAME = 9,
+    CLUSTERED_WIREFRAME = 10,
+    INSTANCED_CLUSTERED_WIREFRAME = 11
+};
+#define SHADER_VARIANT_COUNT 16
+
+inline ShaderVariant MakeShaderVariant(bool instanced, bool clustered, bool gbuffer=false, bool wireframe=false) {
+    return (ShaderVariant)((instanced ? 1 : 0) | (clustered ? 2 : 0) | (gbuffer ? 4 : 0) | (wireframe ? 8 : 0));
+}
+
+// preprocessor defines a variant is compiled with
+inline std::vector<std::string> GetVariantDefines(ShaderVariant variant) {
+    std::vector<std::string> defines;
+    if ((uint8_t)variant & (uint8_t)ShaderVariant::INSTANCED)
+        defines.push_back("INSTANCED");
+    if ((uint8_t)variant & (uint8_t)ShaderVariant::CLUSTERED)
+        defines.push_back("CLUSTERED");
+    if ((uint8_t)variant & (uint8_t)ShaderVariant::GBUFFER)
+        defines.push_back("GBUFFER");
+    if ((uint8_t)variant & (uint8_t)ShaderVariant::WIREFRAME)
+        defines.push_back("WIREFRAME");
+    return defines;
+}
 
 class Shader : public Asset {
 public:
     std::shared_ptr<ShaderSource> vs = nullptr;
     std::shared_ptr<ShaderSource> fs = nullptr;
+    // optional, only linked into the WIREFRAME variants
+    std::shared_ptr<ShaderSource> gs = nullptr;
+    SortId sortId = SortId(SortIdTable::SHADER);
 
-    Shader(const std::string& name, std::shared_ptr<ShaderSource> vs=nullptr, std::shared_ptr<ShaderSource> fs=nullptr)
-        : Asset(name), vs(vs), fs(fs) {}
+    Shader(const std::string& name, std::shared_ptr<ShaderSource> vs=nullptr, std::shared_ptr<ShaderSource> fs=nullptr, std::shared_ptr<ShaderSource> gs=nullptr)
+        : Asset(name), vs(vs), fs(fs), gs(gs) {}
     
     // check shader validity
     virtual bool IsUsable() const = 0;
 
+    // true when the sources mention every define of the variant, so it is worth compiling
+    bool SourcesMention(ShaderVariant variant) const {
+        if (((uint8_t)variant & (uint8_t)ShaderVariant::INSTANCED) && (!vs || vs->source.find("INSTANCED") == std::string::npos))
+            return false;
+        if (((uint8_t)variant & (uint8_t)ShaderVariant::CLUSTERED) && (!fs || fs->source.find("CLUSTERED") == std::string::npos))
+            return false;
+        if ((uint8_t)variant & (uint8_t)ShaderVariant::GBUFFER) {
+            if (!fs || fs->source.find("GBUFFER") == std::string::npos)
+                return false;
+            if ((uint8_t)variant & ((uint8_t)ShaderVariant::CLUSTERED | (uint8_t)ShaderVariant::WIREFRAME))
+                return false;
+        }
+        if (((uint8_t)variant & (uint8_t)ShaderVariant::WIREFRAME)
+            && (!gs || gs->stage != ShaderStage::GEOMETRY || !fs || fs->source.find("WIREFRAME") == std::string::npos))
+            return false;
+        return true;
+    }
+
     // Renderer Impl calls
     virtual void Compile() = 0;
     virtual void Bind() const = 0;
+    virtual void Bind(ShaderVariant variant) const = 0;
+    virtual bool HasVariant(ShaderVariant variant) const = 0;
     virtual void Unbind() const = 0;
     virtual void SetBool(const std::string& name, bool value) const = 0;
     virtual void SetInt(const std::string& name, int value) const = 0;
@@ -43,6 +116,19 @@ public:
     virtual void SetMat4(const std::string& name, const LA::mat4& m) const = 0;
     virtual void SetMat4(const std::string& name, float* mPtr) const = 0;
 
-    static std::shared_ptr<Shader> Create(const std::string& name, std::shared_ptr<ShaderSource> vs, std::shared_ptr<ShaderSource> fs);
+    // handle based setters, invalid handles are ignored
+    virtual UniformHandle Locate(const std::string& name) const = 0;
+    virtual void SetBool(UniformHandle h, bool value) const = 0;
+    virtual void SetInt(UniformHandle h, int value) const = 0;
+    virtual void SetUint(UniformHandle h, uint32_t value) const = 0;
+    virtual void SetFloat(UniformHandle h, float value) const = 0;
+    virtual void SetVec2(UniformHandle h, const LA::vec2& v) const = 0;
+    virtual void SetVec3(UniformHandle h, const LA::vec3& v) const = 0;
+    virtual void SetVec4(UniformHandle h, const LA::vec4& v) const = 0;
+    virtual void SetMat2(UniformHandle h, const LA::mat2& m) const = 0;
+    virtual void SetMat3(UniformHandle h, const LA::mat3& m) const = 0;
+    virtual void SetMat4(UniformHandle h, const LA::mat4& m) const = 0;
+
+    static std::shared_ptr<Shader> Create(const std::string& name, std::shared_ptr<ShaderSource> vs, std::shared_ptr<ShaderSource> fs, std::shared_ptr<ShaderSource> gs=nullptr);
 
 };
@@ -10,8 +10,7 @@
 
 #include "ecs/asset.hpp"
 #include "core/filepath.hpp"
-#include "platform/opengl/opengl_shader.hpp"
-#include "platform/opengl/opengl_shader_source.hpp"
+#include "renderer/render_assets.hpp"
 
 //  GLSL standard shader file extensions
 // .vert - a vertex shader
@@ -40,18 +39,24 @@ public:
 		: IAssetLoader() {}
 
 	bool Load(const std::string& filepath) {
+		AssetCommit commit = Prepare(filepath);
+		return commit && commit();
+	}
+
+	// reads the source on the calling thread, the asset is created by the returned commit
+	AssetCommit Prepare(const std::string& filepath) override {
 		// inspect file extension
         std::string ext = GetFileExtension(filepath);
         if (!CanLoad(ext)) {
             std::cout << "WARNING (ShaderLoader): Trying to open file of unsupported ext @ " << filepath << std::endl;
-            return false;
+            return nullptr;
         }
 
         // open file
         std::ifstream f(filepath);
         if (!f.good()) {
             std::cout << "WARNING (ShaderLoader): Failed to open file successfully @ " << filepath << std::endl;
-            return false;
+            return nullptr;
         }
         // load file contents as string
         try {
@@ -69,21 +74,22 @@ public:
             auto it = _extToType.find(ext);
             if (it != _extToType.end()) {
                 ShaderStage stage = it->second;
-                std::shared_ptr<ShaderSource> shaderSource = assetManager.CreateAsset<OpenGLShaderSource>();
-                shaderSource->name = name;
-                shaderSource->path = filepath;
-                shaderSource->source = source;
-                shaderSource->stage = stage;
+                return [this, filepath, name, source, stage]() {
+                    std::shared_ptr<ShaderSource> shaderSource = CreateRenderAsset<ShaderSource>(name);
+                    shaderSource->path = filepath;
+                    shaderSource->source = source;
+                    shaderSource->stage = stage;
+                    return true;
+                };
             } else {
                 std::cout << "WARNING (ShaderLoader): Unsupported shader extension @ " << filepath << std::endl;
-                return false;
+                return nullptr;
             }
         }
         catch (std::ifstream::failure& e) {
             std::cout << "ERROR (ShaderLoader): " << e.what() << std::endl;
-            return false;
+            return nullptr;
         }
-		return true;
 	}
 
 	std::vector<std::string> GetSupportedExt() {
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <vector>
 
 #include "ecs/asset.hpp"
 #include "renderer/renderer_api.hpp"
@@ -26,7 +27,8 @@ public:
     ShaderSource(const std::string& name="Default Shader Stage", const std::string& source="", const ShaderStage& stage=ShaderStage::INVALID)
         : Asset(name), source(source), stage(stage) {}
 
-    virtual uint32_t Compile() = 0;
+    // defines are injected after the #version line to build shader variants
+    virtual uint32_t Compile(const std::vector<std::string>& defines={}) = 0;
 
     static std::shared_ptr<ShaderSource> Create(const std::string& name, const std::string& source="", const ShaderStage& stage=ShaderStage::INVALID);
 
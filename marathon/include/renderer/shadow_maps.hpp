@@ -0,0 +1,123 @@
+#pragma once
+
+// std libs
+#include <cstdint>
+#include <vector>
+
+// internal libs
+#include "la_extended.h"
+#include "renderer/uniform_blocks.hpp"
+#include "renderer/culling.hpp"
+
+class Mesh;
+
+//// TODO:
+// size spot maps by their screen coverage instead of fixed slots
+// point light shadows (cube faces in the atlas)
+// redraw far cascades at a lower rate than near ones
+
+//// NOTES:
+// Plans the shadow maps of a frame and decides which need drawing, backends then draw the dirty ones
+// depth only. Every map is a fixed square slot of one depth atlas, SHADOW_ATLAS_SIZE texels across:
+//      top row         SHADOW_CASCADES cascades of SHADOW_CASCADE_SIZE for the first shadowed directional light
+//      rows below      SHADOW_SPOT_SIZE maps for the first SHADOW_SPOT_MAX shadowed spot lights
+// Cascades split [near, SHADOW_DISTANCE] between log and linear spacing. Each is an ortho box around the
+// bounding sphere of its slice, in a light basis that doesn't turn with the camera. Box centres snap to a
+// grid of 1/SHADOW_CASCADE_SNAP of the box, padded by as much, so a cascade only moves once the camera has
+// moved that far. Boxes reach SHADOW_CASTER_DISTANCE back towards the light for casters outside the view.
+// Every view culls the casters against its own frustum. Its signature hashes the matrix with the mesh and
+// stamp of each caster inside, a slot whose last drawn signature matches is kept as it is (a cache hit).
+// Stamps must change whenever a caster moves, SceneRenderer uses the entity and its transform version.
+
+#define SHADOW_ATLAS_SIZE 4096
+#define SHADOW_CASCADE_SIZE 1024
+#define SHADOW_SPOT_SIZE 512
+#define SHADOW_SLOTS (SHADOW_CASCADES + SHADOW_SPOT_MAX)
+// view depth covered by the cascades
+#define SHADOW_DISTANCE 100.0f
+// 0 splits cascades evenly, 1 logarithmically
+#define SHADOW_CASCADE_LAMBDA 0.75f
+#define SHADOW_CASCADE_SNAP 8.0f
+#define SHADOW_CASTER_DISTANCE 200.0f
+#define SHADOW_SPOT_NEAR 0.05f
+// widest spot cone given a map, wider cones are clamped
+#define SHADOW_SPOT_FOV_MAX 150.0f
+// receiver side bias, atlas depth units and world units along the normal
+#define SHADOW_DEPTH_BIAS 0.0005f
+#define SHADOW_NORMAL_OFFSET 0.05f
+
+// casters of a frame, index i is the same object in each
+struct ShadowCasters {
+    BoundsSoA bounds;
+    std::vector<Mesh*> meshes;
+    std::vector<LA::mat4> models;
+    std::vector<uint64_t> stamps;
+
+    // Resize then Set lets jobs fill disjoint entries
+    void Resize(size_t count);
+    void Set(size_t i, Mesh* mesh, const LA::mat4& model, const LA::vec3& min, const LA::vec3& max, uint64_t stamp);
+    size_t Size() const;
+};
+
+// a directional or spot light asking for a shadow
+struct ShadowLight {
+    bool spot = false;
+    float position[3] = {0.0f, 0.0f, 0.0f};
+    float direction[3] = {0.0f, 0.0f, -1.0f};
+    // spot lights only, outer cut off as a cosine
+    float outerCutOff = 0.0f;
+    float range = 0.0f;
+};
+
+struct ShadowView {
+    // world to light clip space
+    LA::mat4 viewProjection = LA::mat4();
+    // atlas slot, cascades first then spot maps, and its texel rectangle
+    uint32_t slot = 0;
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t size = 0;
+    // indices into ShadowCasters
+    std::vector<uint32_t> casters;
+    // the slot holds something else and must be drawn this frame
+    bool dirty = true;
+    uint64_t signature = 0;
+};
+
+struct ShadowStats {
+    uint32_t views = 0;
+    uint32_t rendered = 0;
+    uint32_t cacheHits = 0;
+    // casters over the rendered views
+    uint32_t casters = 0;
+    double updateMs = 0.0;
+};
+
+class ShadowMaps {
+public:
+    // plans the maps of lights for this camera, slots are counted as drawn once this returns
+    void Update(const LA::mat4& view, const LA::mat4& projection, const std::vector<ShadowLight>& lights, const ShadowCasters& casters);
+    // forgets what a slot, or every slot, holds so it's drawn again next Update
+    void Invalidate(uint32_t slot);
+    void Invalidate();
+
+    const std::vector<ShadowView>& GetViews() const;
+    const ShadowBlock& GetBlock() const;
+    const ShadowStats& GetStats() const;
+    // map of light i of the last Update: cascade 0 for the directional light, spot map index for spots, -1 for none
+    int32_t GetShadow(uint32_t light) const;
+
+private:
+    std::vector<ShadowView> _views;
+    ShadowBlock _block = ShadowBlock();
+    ShadowStats _stats = ShadowStats();
+    std::vector<int32_t> _lightShadows;
+    // signature each slot was last drawn with, 0 when it holds nothing usable
+    uint64_t _drawn[SHADOW_SLOTS] = {};
+    // per view cull scratch
+    std::vector<std::vector<uint8_t>> _visible;
+
+    void PlanCascades(const LA::mat4& view, const LA::mat4& projection, const ShadowLight& light);
+    void PlanSpot(const ShadowLight& light, uint32_t index);
+    ShadowView& AddView(uint32_t slot, const LA::mat4& viewProjection);
+};
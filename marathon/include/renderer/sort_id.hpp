@@ -0,0 +1,39 @@
+#pragma once
+
+// std libs
+#include <cstdint>
+
+//// NOTES:
+// Shaders, materials and meshes each hold a SortId for the render queue sort key.
+// Ids come from a free list per table, so they stay small, are unique among live objects and are
+// handed back when the object is destroyed, a new object never inherits a dead one's batches.
+// Only with more live objects than the key field holds do ids wrap and share a value.
+
+enum class SortIdTable : uint8_t {
+    SHADER = 0,
+    MATERIAL = 1,
+    MESH = 2
+};
+
+// widths of the shader, material and mesh ids in the sort key
+#define SORT_ID_SHADER_BITS 12
+#define SORT_ID_MATERIAL_BITS 16
+#define SORT_ID_MESH_BITS 13
+
+class SortId {
+public:
+    explicit SortId(SortIdTable table);
+    // a copy is a different object and takes its own id
+    SortId(const SortId& other);
+    SortId& operator=(const SortId& other) { return *this; }
+    ~SortId();
+
+    uint16_t Get() const {
+        return _key;
+    }
+
+private:
+    SortIdTable _table;
+    uint32_t _id;
+    uint16_t _key;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <memory>
+#include <algorithm>
+
+#include "ecs/asset.hpp"
+#include "renderer/renderer_api.hpp"
+
+//// TODO:
+// cube maps and arrays
+// 16 bit channels, pngs are currently narrowed to 8 bit on decode
+// sampler state per material instead of per texture
+
+//// NOTES:
+// Pixels are kept on the CPU as a full mip chain, level 0 first, rows bottom up like GL expects.
+// Loaders build the chain on a worker so the backend only has to upload it.
+// The backend drops the CPU copy once resident unless keepPixels is set.
+
+enum class TextureFormat : uint8_t {
+    R8,
+    RG8,
+    RGB8,
+    RGBA8,
+    R32F,
+    RG32F,
+    RGB32F,
+    RGBA32F,
+    // 4x4 block compressed, see texture_compression.hpp
+    BC1,
+    BC3,
+    BC4,
+    BC5
+};
+
+uint32_t TextureFormatChannels(TextureFormat format);
+bool TextureFormatIsFloat(TextureFormat format);
+bool TextureFormatIsCompressed(TextureFormat format);
+// bytes per pixel, 0 for block compressed formats
+uint32_t TextureFormatPixelSize(TextureFormat format);
+// bytes per 4x4 block, 0 for uncompressed formats
+uint32_t TextureFormatBlockSize(TextureFormat format);
+size_t TextureLevelSize(TextureFormat format, uint32_t width, uint32_t height);
+
+// GPU memory taken by a texture, uncompressed is the same mip chain stored as RGBA8
+struct TextureMemoryUsage {
+    size_t bytes = 0;
+    size_t uncompressedBytes = 0;
+};
+
+// bytes of a mip chain as stored, and as RGBA8 for 8 bit formats
+TextureMemoryUsage GetMipChainMemory(const std::vector<std::vector<uint8_t>>& mips, uint32_t width, uint32_t height, TextureFormat format);
+
+// box filters mips[0] down to 1x1, replacing any existing smaller levels, compress afterwards
+// srgb colour channels are averaged in linear space
+void GenerateMipChain(std::vector<std::vector<uint8_t>>& mips, uint32_t width, uint32_t height, TextureFormat format, bool srgb=false);
+
+class Texture : public Asset {
+public:
+    uint32_t width = 0;
+    uint32_t height = 0;
+    TextureFormat format = TextureFormat::RGBA8;
+    // colour data stored gamma encoded, sampled as linear
+    bool srgb = false;
+    bool keepPixels = false;
+    std::vector<std::vector<uint8_t>> mips;
+
+    Texture(std::string name)
+        : Asset(name) {}
+
+    void GenerateMipmaps() {
+        GenerateMipChain(mips, width, height, format, srgb);
+    }
+
+    uint32_t GetMipWidth(uint32_t level) const {
+        return std::max(1u, width >> level);
+    }
+
+    uint32_t GetMipHeight(uint32_t level) const {
+        return std::max(1u, height >> level);
+    }
+
+    virtual bool IsUsable() = 0;
+    // queue the GPU upload without blocking, IsUsable turns true once every level has landed
+    virtual void RequestUpload() = 0;
+    // binds to the texture unit, requests the upload and binds nothing while not yet resident
+    virtual void Bind(uint32_t unit) = 0;
+    virtual void Unbind(uint32_t unit) = 0;
+    virtual TextureMemoryUsage GetMemoryUsage() const = 0;
+
+    static std::shared_ptr<Texture> Create(std::string name);
+};
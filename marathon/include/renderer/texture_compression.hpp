@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "renderer/texture.hpp"
+
+//// TODO:
+// BC6H/BC7 for hdr and high quality colour
+// ETC2 for GLES targets
+// least squares endpoint refinement for BC1
+
+//// NOTES:
+// Fast range fit encoders, one block at a time: endpoints are the inset bounding box of the
+// block, flipped per channel to follow the colour trend, indices come from projecting each
+// pixel onto the endpoint axis. SSE2 handles the block bounds and projections when available.
+// RGB8 -> BC1, RGBA8 -> BC3 (BC1 if fully opaque), R8 -> BC4, RG8 -> BC5.
+// Normal maps reach the encoder as RG8, TextureLoader keeps only their XY.
+// Rows stay bottom up, block row 0 covers pixel rows 0-3.
+// Whole images are split by block rows across the job system, TEXTURE_COMPRESSION_ROW_GRAIN rows at least per job.
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define TEXTURE_COMPRESSION_SSE2
+#endif
+
+#define TEXTURE_COMPRESSION_ROW_GRAIN 16
+
+// bump when encoder output changes so cached results are rebuilt
+#define TEXTURE_COMPRESSION_VERSION 1
+
+// block format an uncompressed format is encoded to, the format itself if it has none
+TextureFormat GetCompressedFormat(TextureFormat format);
+// format a block format decodes to
+TextureFormat GetDecompressedFormat(TextureFormat format);
+
+void CompressImage(const uint8_t* pixels, uint32_t width, uint32_t height, TextureFormat source, TextureFormat target, uint8_t* out);
+void DecompressImage(const uint8_t* blocks, uint32_t width, uint32_t height, TextureFormat source, uint8_t* out);
+
+// encode every level in place, false and untouched if the format can't be compressed
+bool CompressMipChain(std::vector<std::vector<uint8_t>>& mips, uint32_t width, uint32_t height, TextureFormat& format);
+// decode every level in place, for drivers without S3TC
+bool DecompressMipChain(std::vector<std::vector<uint8_t>>& mips, uint32_t width, uint32_t height, TextureFormat& format);
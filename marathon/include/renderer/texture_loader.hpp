@@ -0,0 +1,272 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+
+#include "ecs/asset.hpp"
+#include "core/filepath.hpp"
+#include "core/mapped_file.hpp"
+#include "core/derived_data_cache.hpp"
+#include "core/profiler.hpp"
+#include "renderer/texture.hpp"
+#include "renderer/texture_compression.hpp"
+#include "renderer/render_assets.hpp"
+
+// implementation is compiled with tinygltf in model_loader.hpp
+#include "stb_image.h"
+
+//// TODO:
+// remove opengl dependancy
+// exr support, the shipped *.exr maps are DWAA compressed which neither stb_image nor tinyexr decode,
+// callers listing folders warn and skip them for now
+// keep 16 bit pngs at full precision
+
+//// NOTES:
+// Decoding, flipping, the mip chain and block compression all happen in Prepare on a worker,
+// the commit only moves the pixels into a new asset.
+// The finished chain, compressed or not, is stored in the derived data cache keyed by a hash of
+// the source file and settings, so later loads map it straight in without decoding.
+// stbi_set_flip_vertically_on_load is global and would also flip gltf images, so rows are flipped here.
+// Usage comes from the map suffix in the file name (polyhaven style, wood_diff_1k, wood_nor_gl_1k),
+// colour maps are gamma encoded and loaded as srgb, everything else is linear data.
+// Normal maps are cut down to XY (RG8, BC5 once compressed), sampling rebuilds z = sqrt(1 - x^2 - y^2).
+
+#define TEXTURE_CACHE_BUCKET "textures"
+#define TEXTURE_CACHE_MAGIC "STEX"
+// bump when decoding or the cached layout changes
+#define TEXTURE_IMPORTER_VERSION 4
+
+// what a texture's pixels hold, decides colour space and encoding
+enum class TextureUsage : uint8_t {
+    COLOUR,
+    NORMAL,
+    DATA
+};
+
+// totals over the textures a loader has committed
+struct TextureImportStats {
+    uint32_t textures = 0;
+    TextureMemoryUsage memory;
+};
+
+class TextureLoader : public IAssetLoader {
+private:
+    std::vector<std::string> _extensions = {".png", ".jpg", ".jpeg", ".tga", ".bmp", ".hdr"};
+    DerivedDataCache& _cache = DerivedDataCache::Instance();
+    TextureImportStats _stats;
+
+    struct DecodedTexture {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        TextureFormat format = TextureFormat::RGBA8;
+        bool srgb = false;
+        std::vector<std::vector<uint8_t>> mips;
+    };
+
+    // true if the name has _tag followed by _ or nothing, so _nor_gl_1k matches nor but _north doesn't
+    static bool HasMapTag(const std::string& name, const std::string& tag) {
+        std::string token = "_" + tag;
+        for (size_t at = name.find(token); at != std::string::npos; at = name.find(token, at + 1)) {
+            size_t end = at + token.size();
+            if (end == name.size() || name[end] == '_')
+                return true;
+        }
+        return false;
+    }
+
+    static void FlipRows(std::vector<uint8_t>& pixels, size_t rowBytes, uint32_t height) {
+        std::vector<uint8_t> row(rowBytes);
+        for (uint32_t y = 0; y < height / 2; y++) {
+            uint8_t* top = pixels.data() + y * rowBytes;
+            uint8_t* bottom = pixels.data() + (height - 1 - y) * rowBytes;
+            std::memcpy(row.data(), top, rowBytes);
+            std::memcpy(top, bottom, rowBytes);
+            std::memcpy(bottom, row.data(), rowBytes);
+        }
+    }
+
+    static std::vector<uint8_t> WriteCached(const DecodedTexture& texture) {
+        BlobWriter writer;
+        writer.WriteBytes(TEXTURE_CACHE_MAGIC, 4);
+        writer.Write(texture.width);
+        writer.Write(texture.height);
+        writer.Write(texture.format);
+        writer.Write<uint8_t>(texture.srgb);
+        writer.Write<uint32_t>(texture.mips.size());
+        for (const std::vector<uint8_t>& mip : texture.mips)
+            writer.WriteVector(mip);
+        return writer.Data();
+    }
+
+    static bool ReadCached(const MappedFile& file, DecodedTexture& texture) {
+        BlobReader reader(file.Data(), file.Size());
+        const uint8_t* magic = reader.Skip(4);
+        uint32_t mipCount = 0;
+        uint8_t srgb = 0;
+        if (magic == nullptr || std::memcmp(magic, TEXTURE_CACHE_MAGIC, 4) != 0)
+            return false;
+        if (!reader.Read(texture.width) || !reader.Read(texture.height) || !reader.Read(texture.format) || !reader.Read(srgb) || !reader.Read(mipCount))
+            return false;
+        texture.srgb = srgb != 0;
+        if (mipCount == 0 || mipCount > 32)
+            return false;
+        texture.mips.resize(mipCount);
+        for (uint32_t level = 0; level < mipCount; level++) {
+            uint32_t mipWidth = std::max(1u, texture.width >> level);
+            uint32_t mipHeight = std::max(1u, texture.height >> level);
+            if (!reader.ReadVector(texture.mips[level]) || texture.mips[level].size() != TextureLevelSize(texture.format, mipWidth, mipHeight))
+                return false;
+        }
+        return true;
+    }
+
+    AssetCommit MakeCommit(const std::string& filepath, std::shared_ptr<DecodedTexture> decoded) {
+        return [this, filepath, decoded]() {
+            std::shared_ptr<Texture> texture = CreateRenderAsset<Texture>(GetFileName(filepath));
+            texture->path = filepath;
+            texture->width = decoded->width;
+            texture->height = decoded->height;
+            texture->format = decoded->format;
+            texture->srgb = decoded->srgb;
+            TextureMemoryUsage memory = GetMipChainMemory(decoded->mips, decoded->width, decoded->height, decoded->format);
+            _stats.textures++;
+            _stats.memory.bytes += memory.bytes;
+            _stats.memory.uncompressedBytes += memory.uncompressedBytes;
+            texture->mips = std::move(decoded->mips);
+            return true;
+        };
+    }
+
+public:
+    // block compress 8 bit textures on import, float textures are always left as they are
+    bool compress = true;
+
+    TextureLoader()
+        : IAssetLoader() {}
+
+    // from the map suffix in the file name, colour when there is none
+    static TextureUsage GetUsage(const std::string& filepath) {
+        std::string name = GetFileName(filepath);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        for (const char* tag : {"nor", "normal", "nrm"}) {
+            if (HasMapTag(name, tag))
+                return TextureUsage::NORMAL;
+        }
+        for (const char* tag : {"rough", "roughness", "disp", "height", "metal", "metallic", "ao", "arm", "spec", "mask"}) {
+            if (HasMapTag(name, tag))
+                return TextureUsage::DATA;
+        }
+        return TextureUsage::COLOUR;
+    }
+
+    bool Load(const std::string& filepath) {
+        AssetCommit commit = Prepare(filepath);
+        return commit && commit();
+    }
+
+    AssetCommit Prepare(const std::string& filepath) override {
+        if (!CanLoad(filepath)) {
+            std::cout << "WARNING (TextureLoader): Trying to open file of unsupported ext @ " << filepath << std::endl;
+            return nullptr;
+        }
+
+        MappedFile file(filepath);
+        if (!file.IsOpen()) {
+            std::cout << "WARNING (TextureLoader): Failed to open file successfully @ " << filepath << std::endl;
+            return nullptr;
+        }
+
+        auto decoded = std::make_shared<DecodedTexture>();
+        TextureUsage usage = GetUsage(filepath);
+        uint64_t settings[4] = {TEXTURE_IMPORTER_VERSION, TEXTURE_COMPRESSION_VERSION, compress, (uint64_t)usage};
+        uint64_t key = HashBytes(file.Data(), file.Size(), HashBytes(settings, sizeof(settings)));
+        MappedFile cached;
+        if (_cache.Map(TEXTURE_CACHE_BUCKET, key, cached)) {
+            if (ReadCached(cached, *decoded))
+                return MakeCommit(filepath, decoded);
+            std::cout << "WARNING (TextureLoader): Ignoring corrupt cache entry for " << filepath << std::endl;
+            _cache.Reject(TEXTURE_CACHE_BUCKET, key);
+            decoded = std::make_shared<DecodedTexture>();
+        }
+
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        void* pixels = nullptr;
+        int size = (int)file.Size();
+        bool hdr = stbi_is_hdr_from_memory(file.Data(), size);
+        {
+            PROFILE_SCOPE("Texture Decode");
+            if (hdr)
+                pixels = stbi_loadf_from_memory(file.Data(), size, &width, &height, &channels, 0);
+            else
+                pixels = stbi_load_from_memory(file.Data(), size, &width, &height, &channels, 0);
+        }
+        if (pixels == nullptr) {
+            std::cout << "WARNING (TextureLoader): Failed to decode " << filepath << ", " << stbi_failure_reason() << std::endl;
+            return nullptr;
+        }
+
+        static const TextureFormat formats[2][4] = {
+            {TextureFormat::R8, TextureFormat::RG8, TextureFormat::RGB8, TextureFormat::RGBA8},
+            {TextureFormat::R32F, TextureFormat::RG32F, TextureFormat::RGB32F, TextureFormat::RGBA32F}
+        };
+        decoded->width = width;
+        decoded->height = height;
+        decoded->format = formats[hdr][channels - 1];
+        // only 8 bit colour is gamma encoded, float and grey/grey alpha images are taken as linear
+        decoded->srgb = usage == TextureUsage::COLOUR && (decoded->format == TextureFormat::RGB8 || decoded->format == TextureFormat::RGBA8);
+        size_t rowBytes = (size_t)width * TextureFormatPixelSize(decoded->format);
+        decoded->mips.emplace_back((uint8_t*)pixels, (uint8_t*)pixels + rowBytes * height);
+        stbi_image_free(pixels);
+        if (usage == TextureUsage::NORMAL && (decoded->format == TextureFormat::RGB8 || decoded->format == TextureFormat::RGBA8)) {
+            // drop z and alpha, packing forward in place never overwrites a pixel not yet read
+            std::vector<uint8_t>& level = decoded->mips[0];
+            size_t pixelCount = (size_t)width * height;
+            for (size_t i = 0; i < pixelCount; i++) {
+                level[i * 2] = level[i * channels];
+                level[i * 2 + 1] = level[i * channels + 1];
+            }
+            level.resize(pixelCount * 2);
+            decoded->format = TextureFormat::RG8;
+            rowBytes = (size_t)width * 2;
+        }
+
+        {
+            PROFILE_SCOPE("Texture Mips");
+            FlipRows(decoded->mips[0], rowBytes, height);
+            GenerateMipChain(decoded->mips, decoded->width, decoded->height, decoded->format, decoded->srgb);
+        }
+
+        if (compress) {
+            PROFILE_SCOPE("Texture Compress");
+            CompressMipChain(decoded->mips, decoded->width, decoded->height, decoded->format);
+        }
+        std::vector<uint8_t> blob = WriteCached(*decoded);
+        _cache.Put(TEXTURE_CACHE_BUCKET, key, blob.data(), blob.size());
+        return MakeCommit(filepath, decoded);
+    }
+
+    TextureImportStats GetStats() const {
+        return _stats;
+    }
+
+    std::vector<std::string> GetSupportedExt() {
+        return _extensions;
+    }
+
+    bool CanLoad(const std::string& filepath) {
+        std::string test_ext = GetFileExtension(filepath);
+        std::transform(test_ext.begin(), test_ext.end(), test_ext.begin(), ::tolower);
+        for (const auto& ext : _extensions) {
+            if (test_ext.compare(ext) == 0)
+                return true;
+        }
+        return false;
+    }
+
+};
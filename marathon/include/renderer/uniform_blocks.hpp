@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+
+#include "la_extended.h"
+
+//// NOTES:
+// CPU mirrors of the std140 uniform blocks shared by every shader.
+// vec3 members take 16 bytes in std140 so they are padded out here.
+// Keep in sync with the block declarations in the GLSL sources.
+// Point and spot lights fade to nothing at their range, a point light with range 0 is an empty slot.
+// Spot cut offs are stored as cosines, the shaders compare them against dot products.
+// With clustered lighting every point and spot light goes to the cluster buffers instead, see
+// renderer/light_clusters.hpp, the Lights block then only carries the directional lights.
+// Shadow casting lights carry the index of their map in the Shadows block, -1 when they have none.
+
+#define CAMERA_BLOCK_NAME "Camera"
+#define CAMERA_BLOCK_BINDING 0
+#define LIGHT_BLOCK_NAME "Lights"
+#define LIGHT_BLOCK_BINDING 1
+#define CLUSTER_BLOCK_NAME "Clusters"
+#define CLUSTER_BLOCK_BINDING 2
+#define SHADOW_BLOCK_NAME "Shadows"
+#define SHADOW_BLOCK_BINDING 3
+
+// cluster buffer samplers, bound to the last units a fragment shader is guaranteed so
+// material textures counting up from 0 never meet them
+#define CLUSTER_LIGHTS_SAMPLER "uClusterLights"
+#define CLUSTER_GRID_SAMPLER "uClusterGrid"
+#define CLUSTER_INDICES_SAMPLER "uClusterIndices"
+#define CLUSTER_LIGHTS_UNIT 13
+#define CLUSTER_GRID_UNIT 14
+#define CLUSTER_INDICES_UNIT 15
+// depth atlas every shadow map is drawn into, sampled with hardware comparison
+#define SHADOW_ATLAS_SAMPLER "uShadowAtlas"
+#define SHADOW_ATLAS_UNIT 12
+// G-buffer attachments read by the deferred lighting pass
+#define GBUFFER_ALBEDO_SAMPLER "uGAlbedo"
+#define GBUFFER_NORMAL_SAMPLER "uGNormal"
+#define GBUFFER_DEPTH_SAMPLER "uGDepth"
+#define GBUFFER_ALBEDO_UNIT 9
+#define GBUFFER_NORMAL_UNIT 10
+#define GBUFFER_DEPTH_UNIT 11
+
+#define DIRECTIONAL_LIGHT_MAX 4
+#define POINT_LIGHT_MAX 16
+#define SPOT_LIGHT_MAX 4
+// cascades of the one shadowed directional light, and spot lights with a shadow map
+#define SHADOW_CASCADES 4
+#define SHADOW_SPOT_MAX 8
+
+// layout(std140) uniform Camera
+struct CameraBlock {
+    LA::mat4 view;
+    LA::mat4 projection;
+    float resolution[3] = {0.0f, 0.0f, 1.0f};
+    float _pad0 = 0.0f;
+    float position[3] = {0.0f, 0.0f, 0.0f};
+    float _pad1 = 0.0f;
+};
+static_assert(sizeof(CameraBlock) == 160, "CameraBlock must match std140 layout");
+
+struct DirectionalLightData {
+    float colour[3] = {0.0f, 0.0f, 0.0f};
+    float intensity = 0.0f;
+    float direction[3] = {0.0f, 0.0f, 0.0f};
+    int32_t enabled = 0;
+};
+static_assert(sizeof(DirectionalLightData) == 32, "DirectionalLightData must match std140 layout");
+
+struct PointLightData {
+    float colour[3] = {0.0f, 0.0f, 0.0f};
+    float intensity = 0.0f;
+    float position[3] = {0.0f, 0.0f, 0.0f};
+    float range = 0.0f;
+};
+static_assert(sizeof(PointLightData) == 32, "PointLightData must match std140 layout");
+
+struct SpotLightData {
+    float colour[3] = {0.0f, 0.0f, 0.0f};
+    float intensity = 0.0f;
+    float position[3] = {0.0f, 0.0f, 0.0f};
+    float range = 0.0f;
+    float direction[3] = {0.0f, 0.0f, 0.0f};
+    float cutOff = 0.0f;
+    float outerCutOff = 0.0f;
+    int32_t enabled = 0;
+    int32_t shadow = -1;
+    float _pad1 = 0.0f;
+};
+static_assert(sizeof(SpotLightData) == 64, "SpotLightData must match std140 layout");
+
+// layout(std140) uniform Lights
+struct LightBlock {
+    DirectionalLightData directional[DIRECTIONAL_LIGHT_MAX];
+    PointLightData point[POINT_LIGHT_MAX];
+    SpotLightData spot[SPOT_LIGHT_MAX];
+};
+static_assert(sizeof(LightBlock) == 896, "LightBlock must match std140 layout");
+
+// layout(std140) uniform Clusters
+struct ClusterBlock {
+    // tiles across, tiles down, depth slices, lights in the cluster buffers
+    uint32_t dims[4] = {0, 0, 0, 0};
+    // slice = log(view depth) * scale + bias
+    float sliceScale = 0.0f;
+    float sliceBias = 0.0f;
+    // pixels covered by one tile
+    float tileSize[2] = {1.0f, 1.0f};
+};
+static_assert(sizeof(ClusterBlock) == 32, "ClusterBlock must match std140 layout");
+
+// one point or spot light in the clustered light buffer, four RGBA32F texels
+struct ClusterLightData {
+    float position[3] = {0.0f, 0.0f, 0.0f};
+    float range = 0.0f;
+    float colour[3] = {0.0f, 0.0f, 0.0f};
+    float intensity = 0.0f;
+    float direction[3] = {0.0f, 0.0f, 0.0f};
+    // 0 for point lights, 1 for spot lights
+    float spot = 0.0f;
+    float cutOff = 0.0f;
+    float outerCutOff = 0.0f;
+    // spot shadow map, -1 for none
+    float shadow = -1.0f;
+    float _pad = 0.0f;
+};
+static_assert(sizeof(ClusterLightData) == 64, "ClusterLightData is read as four RGBA32F texels");
+
+// layout(std140) uniform Shadows
+// matrices go from world space straight to atlas coordinates and depth, see renderer/shadow_maps.hpp
+struct ShadowBlock {
+    LA::mat4 cascades[SHADOW_CASCADES];
+    LA::mat4 spots[SHADOW_SPOT_MAX];
+    // view depth where each cascade ends
+    float splits[SHADOW_CASCADES] = {0.0f, 0.0f, 0.0f, 0.0f};
+    // cascades in use, directional light they belong to (-1 none), spot maps in use, unused
+    int32_t info[4] = {0, -1, 0, 0};
+    // atlas texel size, depth bias, normal offset in world units, unused
+    float params[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+};
+static_assert(sizeof(ShadowBlock) == 816, "ShadowBlock must match std140 layout");
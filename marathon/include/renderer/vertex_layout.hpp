@@ -0,0 +1,71 @@
+#pragma once
+
+// std libs
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//// TODO:
+// octahedral normal encoding
+// quantised positions relative to mesh bounds
+
+//// NOTES:
+// Describes one interleaved vertex buffer, each element has a slot, a storage format and an offset.
+// Slots match the shader attribute locations (see OpenGLAttribLocs).
+// Compact layouts store normals/tangents as signed 2_10_10_10, uvs as half floats and colours as unorm8.
+
+class Mesh;
+
+enum class VertexSlot : uint8_t {
+    POSITION = 0,
+    NORMAL = 1,
+    TANGENT = 2,
+    COLOUR = 3,
+    UV0 = 4,
+    UV1 = 5,
+    UV2 = 6,
+    UV3 = 7
+};
+
+enum class VertexFormat : uint8_t {
+    FLOAT2,
+    FLOAT3,
+    FLOAT4,
+    HALF2,
+    SNORM_2_10_10_10,
+    UNORM8x4
+};
+
+struct VertexElement {
+    VertexSlot slot = VertexSlot::POSITION;
+    VertexFormat format = VertexFormat::FLOAT3;
+    uint32_t offset = 0;
+};
+
+struct VertexLayout {
+    std::vector<VertexElement> elements;
+    uint32_t stride = 0;
+
+    bool IsEmpty() const { return elements.empty(); }
+    void Add(VertexSlot slot, VertexFormat format);
+
+    // layout covering every attribute the mesh has data for
+    static VertexLayout Build(const Mesh& mesh, bool quantise);
+    static uint32_t FormatSize(VertexFormat format);
+    static uint32_t FormatComponents(VertexFormat format);
+};
+
+// packs the mesh attributes into one interleaved buffer described by layout
+void PackVertices(const Mesh& mesh, const VertexLayout& layout, std::vector<uint8_t>& out);
+// writes vertices.size() * layout.stride bytes to dst, e.g. straight into a mapped staging buffer
+void PackVertices(const Mesh& mesh, const VertexLayout& layout, uint8_t* dst);
+
+// bytes the mesh would take unpacked, one float buffer per attribute and 32 bit indices
+size_t UnpackedVertexBytes(const Mesh& mesh);
+
+// 16 bit indices whenever every vertex indexes below 0xFFFF, kept free for primitive restart
+bool UseShortIndices(size_t vertexCount);
+
+uint16_t FloatToHalf(float value);
+// xyz scaled by 511 and w by 1, each clamped to [-1, 1] first
+uint32_t PackSnorm2101010(float x, float y, float z, float w);
@@ -3,8 +3,13 @@
 #include <string>
 #include <memory>
 #include <cassert>
+#include <thread>
+#include <algorithm>
 
 #include "core/tick_timer.hpp"
+#include "core/frame_histogram.hpp"
+#include "core/profiler.hpp"
+#include "core/job_system.hpp"
 #include "runtime/interactive.hpp"
 #include "window/window.hpp"
 #include "renderer/renderer.hpp"
@@ -19,11 +24,47 @@
 // Allow for dynamic opengl config
 // All modules should be boot/shutdown from application
 
+//// NOTES:
+// With fixedStep the loop runs Interactive::FixedUpdate at stepRate from an accumulator of real time,
+// then Update once per frame with alpha set to the leftover fraction of a step for interpolation.
+// A frame never runs more than maxStepsPerFrame steps, time beyond that is dropped so a slow
+// frame can't snowball into ever more steps.
+// With vsync off and targetFrameRate set, each frame sleeps until its slot, spinning the last
+// PACING_SPIN_NANOS as sleeps overshoot.
+// Headless applications never boot the window and render through the NONE backend, which records
+// commands instead of drawing. The loop runs until Stop() or maxFrames, pacing only if targetFrameRate is set.
+// The job system boots before the renderer and shuts down after it, the main thread is job thread 0.
+
+#define PACING_SPIN_NANOS 1000000
+
+struct LoopConfig {
+    bool fixedStep = false;
+    double stepRate = 60.0;
+    int maxStepsPerFrame = 8;
+    // frames per second when vsync is off, 0 runs uncapped
+    double targetFrameRate = 0.0;
+    // stop after this many frames, 0 runs until the window closes or Stop is called
+    uint64_t maxFrames = 0;
+};
+
+// per frame loop counters, frame times cover the histogram window
+struct LoopStats {
+    FrameStats frameTimes;
+    uint32_t fixedSteps = 0;
+    double alpha = 1.0;
+    double sleptMs = 0.0;
+};
+
 struct ApplicationConfig {
     std::string name = "Example Project";
     std::string cwd = "~";
     OpenGLConfig openglConfig = OpenGLConfig();
     WindowConfig windowConfig = WindowConfig();
+    LoopConfig loopConfig = LoopConfig();
+    // no window or GPU, for servers, tests and benchmarks
+    bool headless = false;
+    // threads the job system runs on including main, 0 for every hardware thread
+    uint32_t jobThreads = 0;
 };
 
 class Application {
@@ -31,14 +72,23 @@ public:
 
     Window& window = Window::Instance();
     Renderer& renderer = Renderer::Instance();
+    JobSystem& jobs = JobSystem::Instance();
 
     static Application* Create(ApplicationConfig cfg) {
         assert(_instance == nullptr && "Attempting to create application twice. Only 1 allowed.");
+        // the renderer is picked while constructing, so the API has to be set first
+        if (cfg.headless)
+            RendererAPI::SetAPI(RendererAPI::API::NONE);
         // create new app and return ref
         _instance = new Application(cfg);
         return _instance;
     }
 
+    static Application& Instance() {
+        assert(_instance != nullptr && "Application has not been created.");
+        return *_instance;
+    }
+
     // Accept externally instanced interactive
     void SetInteractive(Interactive* op) {
         if (op == nullptr) {
@@ -50,29 +100,85 @@ public:
     
     // Application loop, independant of game/sim loop
     void Run() {
-        while (window.IsOpen()) {
+        Profiler& profiler = Profiler::Instance();
+        const LoopConfig& loop = _cfg.loopConfig;
+        double step = 1.0 / loop.stepRate;
+        double accumulator = 0.0;
+        _tickTimer->Start();
+        _stopping = false;
+        uint64_t frames = 0;
+        while (!_stopping && (_cfg.headless || window.IsOpen()) && (loop.maxFrames == 0 || frames < loop.maxFrames)) {
+            frames++;
+            // get time delta, first thing so pacing measures whole frames
+            double dt = _tickTimer->Tick();
+            _frameTimes.Add(_tickTimer->GetTickNanos());
+
+            // close the last frame's zones before starting the next
+            profiler.BeginFrame();
+
             // poll events
-            window.PollEvents();
+            if (!_cfg.headless) {
+                PROFILE_SCOPE("Poll Events");
+                window.PollEvents();
+            }
 
-            // get time delta
-            _tickTimer->Tick();
-            double dt = _tickTimer->GetTickElapsed();
+            // fixed steps for the time that has passed, the remainder carries to the next frame
+            _stats.fixedSteps = 0;
+            if (loop.fixedStep) {
+                PROFILE_SCOPE("Fixed Update");
+                accumulator += std::min(dt, step * loop.maxStepsPerFrame);
+                while (accumulator >= step) {
+                    _interactive->FixedUpdate(step);
+                    accumulator -= step;
+                    _stats.fixedSteps++;
+                }
+                _interactive->alpha = accumulator / step;
+            }
+            _stats.alpha = _interactive->alpha;
             
             // interactive tick
-            _interactive->Update(dt);
+            {
+                PROFILE_SCOPE("Update");
+                _interactive->Update(dt);
+            }
+            renderer.EndFrame();
             
             // swap frame shown
-            window.SwapFrame();
+            if (!_cfg.headless) {
+                PROFILE_SCOPE("Swap");
+                window.SwapFrame();
+            }
+            PaceFrame();
         }
     }
 
+    // leaves Run after the current frame
+    void Stop() {
+        _stopping = true;
+    }
+
+    bool IsHeadless() const {
+        return _cfg.headless;
+    }
+
+    const LoopStats& GetLoopStats() {
+        _stats.frameTimes = _frameTimes.GetStats();
+        return _stats;
+    }
+
+    const FrameTimeHistogram& GetFrameTimes() const {
+        return _frameTimes;
+    }
+
     // Shutdown modules and free interactive
     // Shutdown window context
     ~Application() {
         _interactive->End();
         delete _interactive;
         renderer.Shutdown();
-        window.Shutdown();
+        jobs.Shutdown();
+        if (!_cfg.headless)
+            window.Shutdown();
     }
 
 private:
@@ -80,7 +186,11 @@ private:
     // Initialise context and start tick timer
     Application(ApplicationConfig cfg)
         : _cfg(cfg) {
-        window.Boot();
+        Profiler::Instance().SetThreadName("Main");
+        if (!_cfg.headless)
+            window.Boot();
+        jobs.SetThreadCount(_cfg.jobThreads);
+        jobs.Boot();
         renderer.Boot();
         // start timer
         _tickTimer->Start();
@@ -91,6 +201,26 @@ private:
 
     ApplicationConfig _cfg;
     std::unique_ptr<TickTimer> _tickTimer = std::make_unique<TickTimer>();
+    FrameTimeHistogram _frameTimes;
+    LoopStats _stats;
+    bool _stopping = false;
+
+    // sleeps off what is left of this frame's slot, vsync paces the frame itself when on
+    void PaceFrame() {
+        _stats.sleptMs = 0.0;
+        if (_cfg.loopConfig.targetFrameRate <= 0.0 || (!_cfg.headless && window.GetOpenGLConfig().vsync != 0))
+            return;
+        PROFILE_SCOPE("Pace");
+        uint64_t period = 1e9 / _cfg.loopConfig.targetFrameRate;
+        uint64_t elapsed = _tickTimer->GetSinceTickNanos();
+        if (elapsed >= period)
+            return;
+        if (period - elapsed > PACING_SPIN_NANOS)
+            std::this_thread::sleep_for(std::chrono::nanoseconds(period - elapsed - PACING_SPIN_NANOS));
+        while (_tickTimer->GetSinceTickNanos() < period)
+            std::this_thread::yield();
+        _stats.sleptMs = (_tickTimer->GetSinceTickNanos() - elapsed) / 1e6;
+    }
     Interactive* _interactive = nullptr;
     static inline Application* _instance = nullptr;
 };
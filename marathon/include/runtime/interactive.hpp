@@ -5,8 +5,14 @@
 
 class Interactive {
 public:
+    // fraction of a fixed step left over this frame, 0..1, set by the application before Update
+    // draw state interpolated between the last two fixed steps with it, 1 when not running fixed steps
+    double alpha = 1.0;
 
     virtual void Start() = 0;
+    // fixed rate simulation, only called when the application loop runs fixed steps, 0 or more times per frame
+    virtual void FixedUpdate(double step) {}
+    // once per frame, dt is the real time since the last frame in seconds
     virtual void Update(double dt) = 0;
     virtual void End() = 0;
 };
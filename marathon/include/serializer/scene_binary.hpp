@@ -0,0 +1,784 @@
+#pragma once
+
+// std libs
+#include <memory>
+#include <string>
+#include <string_view>
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+// internal libs
+#include "la_extended.h"
+#include "ecs/ngine.hpp"
+#include "core/mapped_file.hpp"
+#include "renderer/components.hpp"
+#include "renderer/render_assets.hpp"
+
+//// TODO:
+// big endian hosts, file is always little endian
+// compress the string table
+
+//// NOTES:
+// Same dependency injection approach as SceneSerializer, pass in the scene to read/write.
+// File is a header, a section table, one section per component type and a string table.
+// Sections store each field as its own packed array (SoA), every array 8 byte aligned,
+// so the loader reads straight out of the mapped file and bulk inserts into the registry.
+// Entities are referred to by their index in the core section, names by string table index.
+// Assets are referred to by UUID with the name kept as a fallback, runtime UUIDs change between sessions.
+
+#define SCENE_BINARY_EXT ".sglb"
+#define SCENE_BINARY_MAGIC "SGLB"
+#define SCENE_BINARY_VERSION 3
+#define SCENE_BINARY_NONE 0xFFFFFFFF
+
+enum class SceneSection : uint32_t {
+    CORE = 0,
+    TRANSFORM = 1,
+    DIRECTIONAL_LIGHT = 2,
+    POINT_LIGHT = 3,
+    SPOT_LIGHT = 4,
+    MESH_RENDERER = 5,
+    CAMERA = 6
+};
+
+struct SceneBinaryHeader {
+    char magic[4] = {'S', 'G', 'L', 'B'};
+    uint32_t version = SCENE_BINARY_VERSION;
+    uint32_t entityCount = 0;
+    uint32_t sectionCount = 0;
+    uint64_t stringTableOffset = 0;
+    uint64_t stringCount = 0;
+};
+static_assert(sizeof(SceneBinaryHeader) == 32, "SceneBinaryHeader layout changed");
+
+struct SceneBinarySection {
+    SceneSection type = SceneSection::CORE;
+    uint32_t count = 0;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+};
+static_assert(sizeof(SceneBinarySection) == 24, "SceneBinarySection layout changed");
+
+class SceneBinarySerializer {
+public:
+    SceneBinarySerializer(Scene& scene)
+        : _scene(scene) {}
+
+    // output scene to binary file
+    bool Serialize(const std::string& filepath) {
+        std::vector<Entity> entities = _scene.GetEntities();
+        std::unordered_map<uint32_t, uint32_t> handleToIndex;
+        handleToIndex.reserve(entities.size());
+        for (uint32_t i = 0; i < entities.size(); i++)
+            handleToIndex[(uint32_t)entities[i]] = i;
+
+        _buffer.clear();
+        _sections.clear();
+        _strings.clear();
+        _stringIndex.clear();
+
+        SceneBinaryHeader header;
+        header.entityCount = entities.size();
+        Write(header);
+
+        WriteCore(entities, handleToIndex);
+        WriteTransforms(entities);
+        WriteDirectionalLights(entities);
+        WritePointLights(entities);
+        WriteSpotLights(entities);
+        WriteMeshRenderers(entities);
+        WriteCameras(entities);
+
+        // section table follows the header, patch offsets once everything is laid out
+        header.sectionCount = _sections.size();
+        std::vector<uint8_t> body = std::move(_buffer);
+        _buffer.clear();
+        Write(header);
+        size_t tableOffset = _buffer.size();
+        size_t bodyOffset = Align(tableOffset + _sections.size() * sizeof(SceneBinarySection));
+        for (SceneBinarySection section : _sections) {
+            section.offset += bodyOffset - sizeof(SceneBinaryHeader);
+            Write(section);
+        }
+        _buffer.resize(bodyOffset, 0);
+        _buffer.insert(_buffer.end(), body.begin() + sizeof(SceneBinaryHeader), body.end());
+
+        header.stringTableOffset = _buffer.size();
+        header.stringCount = _strings.size();
+        WriteStringTable();
+        std::memcpy(_buffer.data(), &header, sizeof(SceneBinaryHeader));
+
+        std::ofstream file(filepath, std::ios::binary);
+        if (!file.is_open()) {
+            std::cout << "WARNING (SceneBinarySerializer): Can't open file: " << filepath << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(_buffer.data()), _buffer.size());
+        _buffer.clear();
+        _buffer.shrink_to_fit();
+        return true;
+    }
+
+    // read binary file into scene, the scene is only replaced once the whole file checked out
+    bool Deserialize(const std::string& filepath) {
+        MappedFile file(filepath);
+        if (!file.IsOpen())
+            return false;
+        _data = file.Data();
+        _size = file.Size();
+        SceneData data;
+        bool read = ReadFile(filepath, data);
+        _stringViews.clear();
+        _data = nullptr;
+        _size = 0;
+        if (!read)
+            return false;
+
+        _scene.Clear();
+        uint32_t n = (uint32_t)data.cores.size();
+        std::vector<entt::entity> entities = _scene.CreateEntities(n);
+        std::vector<HierarchyComponent> hierarchies(n);
+        for (uint32_t i = 0; i < n; i++) {
+            hierarchies[i].depth = data.depths[i];
+            uint32_t parent = data.parents[i];
+            if (parent == SCENE_BINARY_NONE)
+                continue;
+            hierarchies[i].parent = entities[parent];
+            hierarchies[parent].children.push_back(entities[i]);
+        }
+        _scene.InsertComponents(entities, data.cores);
+        _scene.InsertComponents(entities, hierarchies);
+        _scene.InsertComponents(entities, data.transforms);
+        Insert(entities, data.directionalLights);
+        Insert(entities, data.pointLights);
+        Insert(entities, data.spotLights);
+        Insert(entities, data.meshRenderers);
+        Insert(entities, data.cameras);
+        return true;
+    }
+
+private:
+    Scene& _scene;
+
+    // writing
+    std::vector<uint8_t> _buffer;
+    std::vector<SceneBinarySection> _sections;
+    std::vector<std::string> _strings;
+    std::unordered_map<std::string, uint32_t> _stringIndex;
+
+    // reading, only valid during Deserialize
+    const uint8_t* _data = nullptr;
+    size_t _size = 0;
+    std::vector<std::string_view> _stringViews;
+    uint32_t _entityCount = 0;
+
+    static size_t Align(size_t offset) {
+        return (offset + 7) & ~(size_t)7;
+    }
+
+    template<typename T>
+    void Write(const T& value) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        _buffer.insert(_buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    template<typename T>
+    void WriteArray(const std::vector<T>& values) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values.data());
+        _buffer.insert(_buffer.end(), bytes, bytes + values.size() * sizeof(T));
+        _buffer.resize(Align(_buffer.size()), 0);
+    }
+
+    void BeginSection(SceneSection type, uint32_t count) {
+        _buffer.resize(Align(_buffer.size()), 0);
+        SceneBinarySection section;
+        section.type = type;
+        section.count = count;
+        section.offset = _buffer.size();
+        _sections.push_back(section);
+    }
+
+    void EndSection() {
+        _sections.back().size = _buffer.size() - _sections.back().offset;
+    }
+
+    uint32_t AddString(const std::string& s) {
+        auto it = _stringIndex.find(s);
+        if (it != _stringIndex.end())
+            return it->second;
+        uint32_t idx = _strings.size();
+        _strings.push_back(s);
+        _stringIndex.emplace(s, idx);
+        return idx;
+    }
+
+    // offsets[count + 1] followed by the characters, no terminators
+    void WriteStringTable() {
+        std::vector<uint32_t> offsets;
+        offsets.reserve(_strings.size() + 1);
+        uint32_t offset = 0;
+        for (const std::string& s : _strings) {
+            offsets.push_back(offset);
+            offset += s.size();
+        }
+        offsets.push_back(offset);
+        WriteArray(offsets);
+        for (const std::string& s : _strings)
+            _buffer.insert(_buffer.end(), s.begin(), s.end());
+    }
+
+    // entities with T and their indices, in the same order
+    template<typename T>
+    std::vector<uint32_t> CollectWith(std::vector<Entity>& entities) {
+        std::vector<uint32_t> indices;
+        for (uint32_t i = 0; i < entities.size(); i++) {
+            if (entities[i].HasComponent<T>())
+                indices.push_back(i);
+        }
+        return indices;
+    }
+
+    void WriteCore(std::vector<Entity>& entities, const std::unordered_map<uint32_t, uint32_t>& handleToIndex) {
+        size_t n = entities.size();
+        std::vector<int64_t> uuids(n);
+        std::vector<uint32_t> names(n);
+        std::vector<uint32_t> parents(n);
+        std::vector<uint8_t> active(n);
+        for (size_t i = 0; i < n; i++) {
+            CoreComponent& cc = entities[i].GetComponent<CoreComponent>();
+            uuids[i] = (int64_t)cc.uuid;
+            names[i] = AddString(cc.name);
+            active[i] = cc.active ? 1 : 0;
+            Entity parent = entities[i].GetParent();
+            parents[i] = parent ? handleToIndex.at((uint32_t)parent) : SCENE_BINARY_NONE;
+        }
+        BeginSection(SceneSection::CORE, n);
+        WriteArray(uuids);
+        WriteArray(names);
+        WriteArray(parents);
+        WriteArray(active);
+        EndSection();
+    }
+
+    void WriteTransforms(std::vector<Entity>& entities) {
+        size_t n = entities.size();
+        // position xyz, rotation xyz, scale xyz, one array each
+        std::vector<float> fields[9];
+        for (auto& field : fields)
+            field.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            TransformComponent& tc = entities[i].GetComponent<TransformComponent>();
+            for (int axis = 0; axis < 3; axis++) {
+                fields[axis][i] = tc.position.m[axis];
+                fields[3 + axis][i] = tc.rotation.m[axis];
+                fields[6 + axis][i] = tc.scale.m[axis];
+            }
+        }
+        BeginSection(SceneSection::TRANSFORM, n);
+        for (auto& field : fields)
+            WriteArray(field);
+        EndSection();
+    }
+
+    void WriteDirectionalLights(std::vector<Entity>& entities) {
+        std::vector<uint32_t> indices = CollectWith<DirectionalLightComponent>(entities);
+        if (indices.empty())
+            return;
+        std::vector<float> r, g, b, intensity;
+        std::vector<uint8_t> castShadows;
+        for (uint32_t idx : indices) {
+            DirectionalLightComponent& dlc = entities[idx].GetComponent<DirectionalLightComponent>();
+            r.push_back(dlc.colour.r);
+            g.push_back(dlc.colour.g);
+            b.push_back(dlc.colour.b);
+            intensity.push_back(dlc.intensity);
+            castShadows.push_back(dlc.castShadows ? 1 : 0);
+        }
+        BeginSection(SceneSection::DIRECTIONAL_LIGHT, indices.size());
+        WriteArray(indices);
+        WriteArray(r);
+        WriteArray(g);
+        WriteArray(b);
+        WriteArray(intensity);
+        WriteArray(castShadows);
+        EndSection();
+    }
+
+    void WritePointLights(std::vector<Entity>& entities) {
+        std::vector<uint32_t> indices = CollectWith<PointLightComponent>(entities);
+        if (indices.empty())
+            return;
+        std::vector<float> r, g, b, intensity, range;
+        for (uint32_t idx : indices) {
+            PointLightComponent& plc = entities[idx].GetComponent<PointLightComponent>();
+            r.push_back(plc.colour.r);
+            g.push_back(plc.colour.g);
+            b.push_back(plc.colour.b);
+            intensity.push_back(plc.intensity);
+            range.push_back(plc.range);
+        }
+        BeginSection(SceneSection::POINT_LIGHT, indices.size());
+        WriteArray(indices);
+        WriteArray(r);
+        WriteArray(g);
+        WriteArray(b);
+        WriteArray(intensity);
+        WriteArray(range);
+        EndSection();
+    }
+
+    void WriteSpotLights(std::vector<Entity>& entities) {
+        std::vector<uint32_t> indices = CollectWith<SpotLightComponent>(entities);
+        if (indices.empty())
+            return;
+        std::vector<float> r, g, b, intensity, cutOff, outerCutOff, range;
+        std::vector<uint8_t> castShadows;
+        for (uint32_t idx : indices) {
+            SpotLightComponent& slc = entities[idx].GetComponent<SpotLightComponent>();
+            r.push_back(slc.colour.r);
+            g.push_back(slc.colour.g);
+            b.push_back(slc.colour.b);
+            intensity.push_back(slc.intensity);
+            cutOff.push_back(slc.cutOff);
+            outerCutOff.push_back(slc.outerCutOff);
+            range.push_back(slc.range);
+            castShadows.push_back(slc.castShadows ? 1 : 0);
+        }
+        BeginSection(SceneSection::SPOT_LIGHT, indices.size());
+        WriteArray(indices);
+        WriteArray(r);
+        WriteArray(g);
+        WriteArray(b);
+        WriteArray(intensity);
+        WriteArray(cutOff);
+        WriteArray(outerCutOff);
+        WriteArray(range);
+        WriteArray(castShadows);
+        EndSection();
+    }
+
+    void WriteMeshRenderers(std::vector<Entity>& entities) {
+        std::vector<uint32_t> indices = CollectWith<MeshRendererComponent>(entities);
+        if (indices.empty())
+            return;
+        std::vector<int64_t> meshUuids, materialUuids;
+        std::vector<uint32_t> meshNames, materialNames;
+        std::vector<uint8_t> castShadows;
+        for (uint32_t idx : indices) {
+            MeshRendererComponent& mrc = entities[idx].GetComponent<MeshRendererComponent>();
+            meshUuids.push_back(mrc.mesh != nullptr ? (int64_t)mrc.mesh->uuid : 0);
+            meshNames.push_back(mrc.mesh != nullptr ? AddString(mrc.mesh->name) : SCENE_BINARY_NONE);
+            materialUuids.push_back(mrc.material != nullptr ? (int64_t)mrc.material->uuid : 0);
+            materialNames.push_back(mrc.material != nullptr ? AddString(mrc.material->name) : SCENE_BINARY_NONE);
+            castShadows.push_back(mrc.castShadows ? 1 : 0);
+        }
+        BeginSection(SceneSection::MESH_RENDERER, indices.size());
+        WriteArray(meshUuids);
+        WriteArray(materialUuids);
+        WriteArray(indices);
+        WriteArray(meshNames);
+        WriteArray(materialNames);
+        WriteArray(castShadows);
+        EndSection();
+    }
+
+    void WriteCameras(std::vector<Entity>& entities) {
+        std::vector<uint32_t> indices = CollectWith<CameraComponent>(entities);
+        if (indices.empty())
+            return;
+        std::vector<float> fov, near, far;
+        for (uint32_t idx : indices) {
+            CameraComponent& cc = entities[idx].GetComponent<CameraComponent>();
+            fov.push_back(cc.fov);
+            near.push_back(cc.near);
+            far.push_back(cc.far);
+        }
+        BeginSection(SceneSection::CAMERA, indices.size());
+        WriteArray(indices);
+        WriteArray(fov);
+        WriteArray(near);
+        WriteArray(far);
+        EndSection();
+    }
+
+    // components of one section and the entity index each belongs to
+    template<typename T>
+    struct SectionRows {
+        std::vector<uint32_t> indices;
+        std::vector<T> components;
+        bool read = false;
+    };
+
+    // everything in a file, kept apart from the scene until every section has been read
+    struct SceneData {
+        std::vector<CoreComponent> cores;
+        std::vector<uint32_t> parents;
+        std::vector<uint32_t> depths;
+        std::vector<TransformComponent> transforms;
+        SectionRows<DirectionalLightComponent> directionalLights;
+        SectionRows<PointLightComponent> pointLights;
+        SectionRows<SpotLightComponent> spotLights;
+        SectionRows<MeshRendererComponent> meshRenderers;
+        SectionRows<CameraComponent> cameras;
+    };
+
+    // offset and size lie inside the file, without overflowing
+    bool InRange(uint64_t offset, uint64_t size) const {
+        return offset <= _size && size <= _size - offset;
+    }
+
+    bool ReadFile(const std::string& filepath, SceneData& data) {
+        if (_size < sizeof(SceneBinaryHeader)) {
+            std::cout << "WARNING (SceneBinarySerializer): File too small: " << filepath << std::endl;
+            return false;
+        }
+        SceneBinaryHeader header;
+        std::memcpy(&header, _data, sizeof(SceneBinaryHeader));
+        if (std::memcmp(header.magic, SCENE_BINARY_MAGIC, 4) != 0 || header.version != SCENE_BINARY_VERSION) {
+            std::cout << "WARNING (SceneBinarySerializer): Not a supported scene file: " << filepath << std::endl;
+            return false;
+        }
+        if (!ReadStringTable(header))
+            return false;
+
+        if (!InRange(sizeof(SceneBinaryHeader), (uint64_t)header.sectionCount * sizeof(SceneBinarySection))) {
+            std::cout << "WARNING (SceneBinarySerializer): Section table out of range." << std::endl;
+            return false;
+        }
+        const SceneBinarySection* sections = reinterpret_cast<const SceneBinarySection*>(_data + sizeof(SceneBinaryHeader));
+        for (uint32_t i = 0; i < header.sectionCount; i++) {
+            // every array in a section starts 8 byte aligned, so the section must too
+            if (!InRange(sections[i].offset, sections[i].size) || sections[i].offset % 8 != 0) {
+                std::cout << "WARNING (SceneBinarySerializer): Section out of range." << std::endl;
+                return false;
+            }
+        }
+
+        const SceneBinarySection* core = FindSection(sections, header.sectionCount, SceneSection::CORE);
+        const SceneBinarySection* transform = FindSection(sections, header.sectionCount, SceneSection::TRANSFORM);
+        if (core == nullptr || transform == nullptr || core->count != header.entityCount || transform->count != header.entityCount) {
+            std::cout << "WARNING (SceneBinarySerializer): Missing core/transform section." << std::endl;
+            return false;
+        }
+        if (!ReadCore(*core, data) || !ReadTransforms(*transform, data))
+            return false;
+        for (uint32_t i = 0; i < header.sectionCount; i++) {
+            bool read = true;
+            switch (sections[i].type) {
+                case SceneSection::CORE:
+                case SceneSection::TRANSFORM:
+                    read = &sections[i] == core || &sections[i] == transform;
+                    if (!read)
+                        std::cout << "WARNING (SceneBinarySerializer): Core/transform section repeated." << std::endl;
+                    break;
+                case SceneSection::DIRECTIONAL_LIGHT:   read = ReadDirectionalLights(sections[i], data.directionalLights); break;
+                case SceneSection::POINT_LIGHT:         read = ReadPointLights(sections[i], data.pointLights); break;
+                case SceneSection::SPOT_LIGHT:          read = ReadSpotLights(sections[i], data.spotLights); break;
+                case SceneSection::MESH_RENDERER:       read = ReadMeshRenderers(sections[i], data.meshRenderers); break;
+                case SceneSection::CAMERA:              read = ReadCameras(sections[i], data.cameras); break;
+                default: break;
+            }
+            if (!read)
+                return false;
+        }
+        return true;
+    }
+
+    template<typename T>
+    void Insert(const std::vector<entt::entity>& entities, const SectionRows<T>& rows) {
+        if (rows.indices.empty())
+            return;
+        std::vector<entt::entity> handles(rows.indices.size());
+        for (size_t i = 0; i < rows.indices.size(); i++)
+            handles[i] = entities[rows.indices[i]];
+        _scene.InsertComponents(handles, rows.components);
+    }
+
+    static const SceneBinarySection* FindSection(const SceneBinarySection* sections, uint32_t count, SceneSection type) {
+        for (uint32_t i = 0; i < count; i++) {
+            if (sections[i].type == type)
+                return &sections[i];
+        }
+        return nullptr;
+    }
+
+    // walks a section's arrays in the order they were written, null once an array runs past the section
+    struct SectionReader {
+        const uint8_t* data;
+        uint64_t used;
+        uint64_t size;
+        uint32_t count;
+
+        template<typename T>
+        const T* Next() {
+            uint64_t bytes = Align((uint64_t)count * sizeof(T));
+            if (used > size || bytes > size - used) {
+                used = size + 1;
+                return nullptr;
+            }
+            const T* array = reinterpret_cast<const T*>(data + used);
+            used += bytes;
+            return array;
+        }
+    };
+
+    SectionReader Reader(const SceneBinarySection& section) {
+        return SectionReader{ _data + section.offset, 0, section.size, section.count };
+    }
+
+    bool ReadStringTable(const SceneBinaryHeader& header) {
+        // offsets[count + 1] must fit before any size is worked out from the count
+        if (header.stringCount >= _size / sizeof(uint32_t) || header.stringTableOffset % alignof(uint32_t) != 0) {
+            std::cout << "WARNING (SceneBinarySerializer): String table out of range." << std::endl;
+            return false;
+        }
+        uint64_t offsetsSize = (header.stringCount + 1) * sizeof(uint32_t);
+        if (!InRange(header.stringTableOffset, Align(offsetsSize))) {
+            std::cout << "WARNING (SceneBinarySerializer): String table out of range." << std::endl;
+            return false;
+        }
+        const uint32_t* offsets = reinterpret_cast<const uint32_t*>(_data + header.stringTableOffset);
+        uint64_t charsOffset = header.stringTableOffset + Align(offsetsSize);
+        uint64_t charsSize = _size - charsOffset;
+        for (uint64_t i = 0; i < header.stringCount; i++) {
+            if (offsets[i] > offsets[i + 1]) {
+                std::cout << "WARNING (SceneBinarySerializer): String table offsets out of order." << std::endl;
+                return false;
+            }
+        }
+        // ordered offsets only need the last one checked against the characters
+        if (offsets[header.stringCount] > charsSize) {
+            std::cout << "WARNING (SceneBinarySerializer): String table out of range." << std::endl;
+            return false;
+        }
+        const char* chars = reinterpret_cast<const char*>(_data + charsOffset);
+        _stringViews.resize(header.stringCount);
+        for (uint64_t i = 0; i < header.stringCount; i++)
+            _stringViews[i] = std::string_view(chars + offsets[i], offsets[i + 1] - offsets[i]);
+        return true;
+    }
+
+    std::string_view GetString(uint32_t idx) const {
+        return idx < _stringViews.size() ? _stringViews[idx] : std::string_view();
+    }
+
+    // component rows must point inside the core section, each entity once
+    bool ReadIndices(const uint32_t* indices, uint32_t count, uint32_t entityCount, std::vector<uint32_t>& out) const {
+        std::vector<uint8_t> seen(entityCount, 0);
+        for (uint32_t i = 0; i < count; i++) {
+            if (indices[i] >= entityCount || seen[indices[i]]) {
+                std::cout << "WARNING (SceneBinarySerializer): Component refers to missing or repeated entity." << std::endl;
+                return false;
+            }
+            seen[indices[i]] = 1;
+        }
+        out.assign(indices, indices + count);
+        return true;
+    }
+
+    // a section type may only appear once, its rows must fit and refer to loaded entities
+    template<typename T>
+    bool BeginRows(const SceneBinarySection& section, const void* last, const uint32_t* indices, SectionRows<T>& rows, const char* name) {
+        if (rows.read || last == nullptr) {
+            std::cout << "WARNING (SceneBinarySerializer): " << name << " section " << (rows.read ? "repeated." : "truncated.") << std::endl;
+            return false;
+        }
+        rows.read = true;
+        if (!ReadIndices(indices, section.count, _entityCount, rows.indices))
+            return false;
+        rows.components.resize(section.count);
+        return true;
+    }
+
+    bool ReadCore(const SceneBinarySection& section, SceneData& data) {
+        SectionReader reader = Reader(section);
+        const int64_t* uuids = reader.Next<int64_t>();
+        const uint32_t* names = reader.Next<uint32_t>();
+        const uint32_t* parents = reader.Next<uint32_t>();
+        const uint8_t* active = reader.Next<uint8_t>();
+        uint32_t n = section.count;
+        if (active == nullptr) {
+            std::cout << "WARNING (SceneBinarySerializer): Core section truncated." << std::endl;
+            return false;
+        }
+
+        data.cores.resize(n);
+        data.parents.assign(parents, parents + n);
+        for (uint32_t i = 0; i < n; i++) {
+            data.cores[i].uuid = UUID(uuids[i]);
+            data.cores[i].name = std::string(GetString(names[i]));
+            data.cores[i].active = active[i] != 0;
+            if (parents[i] != SCENE_BINARY_NONE && parents[i] >= n) {
+                std::cout << "WARNING (SceneBinarySerializer): Parent refers to missing entity." << std::endl;
+                return false;
+            }
+        }
+        // depth from parent links, file order need not be parent first
+        // walk up to the first ancestor with a known depth then fill in on the way back down,
+        // a walk longer than the entity count went round a cycle and never reaches a root
+        data.depths.assign(n, SCENE_BINARY_NONE);
+        std::vector<uint32_t> chain;
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t at = i;
+            while (data.depths[at] == SCENE_BINARY_NONE && parents[at] != SCENE_BINARY_NONE) {
+                if (chain.size() == n) {
+                    std::cout << "WARNING (SceneBinarySerializer): Hierarchy has a cycle." << std::endl;
+                    return false;
+                }
+                chain.push_back(at);
+                at = parents[at];
+            }
+            if (data.depths[at] == SCENE_BINARY_NONE)
+                data.depths[at] = 0;
+            uint32_t d = data.depths[at];
+            while (!chain.empty()) {
+                data.depths[chain.back()] = ++d;
+                chain.pop_back();
+            }
+        }
+        _entityCount = n;
+        return true;
+    }
+
+    bool ReadTransforms(const SceneBinarySection& section, SceneData& data) {
+        SectionReader reader = Reader(section);
+        const float* fields[9];
+        for (auto& field : fields)
+            field = reader.Next<float>();
+        uint32_t n = section.count;
+        if (fields[8] == nullptr) {
+            std::cout << "WARNING (SceneBinarySerializer): Transform section truncated." << std::endl;
+            return false;
+        }
+
+        data.transforms.resize(n);
+        for (uint32_t i = 0; i < n; i++) {
+            data.transforms[i].position = LA::vec3({fields[0][i], fields[1][i], fields[2][i]});
+            data.transforms[i].rotation = LA::vec3({fields[3][i], fields[4][i], fields[5][i]});
+            data.transforms[i].scale = LA::vec3({fields[6][i], fields[7][i], fields[8][i]});
+        }
+        return true;
+    }
+
+    bool ReadDirectionalLights(const SceneBinarySection& section, SectionRows<DirectionalLightComponent>& rows) {
+        SectionReader reader = Reader(section);
+        const uint32_t* indices = reader.Next<uint32_t>();
+        const float* r = reader.Next<float>();
+        const float* g = reader.Next<float>();
+        const float* b = reader.Next<float>();
+        const float* intensity = reader.Next<float>();
+        const uint8_t* castShadows = reader.Next<uint8_t>();
+        if (!BeginRows(section, castShadows, indices, rows, "Directional light"))
+            return false;
+        for (uint32_t i = 0; i < section.count; i++) {
+            rows.components[i].colour = LA::vec3({r[i], g[i], b[i]});
+            rows.components[i].intensity = intensity[i];
+            rows.components[i].castShadows = castShadows[i] != 0;
+        }
+        return true;
+    }
+
+    bool ReadPointLights(const SceneBinarySection& section, SectionRows<PointLightComponent>& rows) {
+        SectionReader reader = Reader(section);
+        const uint32_t* indices = reader.Next<uint32_t>();
+        const float* r = reader.Next<float>();
+        const float* g = reader.Next<float>();
+        const float* b = reader.Next<float>();
+        const float* intensity = reader.Next<float>();
+        const float* range = reader.Next<float>();
+        if (!BeginRows(section, range, indices, rows, "Point light"))
+            return false;
+        for (uint32_t i = 0; i < section.count; i++) {
+            rows.components[i].colour = LA::vec3({r[i], g[i], b[i]});
+            rows.components[i].intensity = intensity[i];
+            rows.components[i].range = range[i];
+        }
+        return true;
+    }
+
+    bool ReadSpotLights(const SceneBinarySection& section, SectionRows<SpotLightComponent>& rows) {
+        SectionReader reader = Reader(section);
+        const uint32_t* indices = reader.Next<uint32_t>();
+        const float* r = reader.Next<float>();
+        const float* g = reader.Next<float>();
+        const float* b = reader.Next<float>();
+        const float* intensity = reader.Next<float>();
+        const float* cutOff = reader.Next<float>();
+        const float* outerCutOff = reader.Next<float>();
+        const float* range = reader.Next<float>();
+        const uint8_t* castShadows = reader.Next<uint8_t>();
+        if (!BeginRows(section, castShadows, indices, rows, "Spot light"))
+            return false;
+        for (uint32_t i = 0; i < section.count; i++) {
+            rows.components[i].colour = LA::vec3({r[i], g[i], b[i]});
+            rows.components[i].intensity = intensity[i];
+            rows.components[i].cutOff = cutOff[i];
+            rows.components[i].outerCutOff = outerCutOff[i];
+            rows.components[i].range = range[i];
+            rows.components[i].castShadows = castShadows[i] != 0;
+        }
+        return true;
+    }
+
+    // UUID first, name when the UUID is stale, each distinct reference is only looked up once
+    template<typename Base>
+    std::shared_ptr<Base> ResolveAsset(int64_t uuid, uint32_t name, std::map<std::pair<int64_t, uint32_t>, std::shared_ptr<Base>>& cache) {
+        if (uuid == 0 && name == SCENE_BINARY_NONE)
+            return nullptr;
+        auto key = std::make_pair(uuid, name);
+        auto it = cache.find(key);
+        if (it != cache.end())
+            return it->second;
+        std::shared_ptr<Base> asset = nullptr;
+        if (uuid != 0)
+            asset = GetRenderAssetByUUID<Base>(UUID(uuid));
+        if (asset == nullptr && name != SCENE_BINARY_NONE)
+            asset = FindRenderAsset<Base>(GetString(name));
+        if (asset == nullptr)
+            std::cout << "WARNING (SceneBinarySerializer): Asset not found: " << GetString(name) << std::endl;
+        cache.emplace(key, asset);
+        return asset;
+    }
+
+    bool ReadMeshRenderers(const SceneBinarySection& section, SectionRows<MeshRendererComponent>& rows) {
+        SectionReader reader = Reader(section);
+        const int64_t* meshUuids = reader.Next<int64_t>();
+        const int64_t* materialUuids = reader.Next<int64_t>();
+        const uint32_t* indices = reader.Next<uint32_t>();
+        const uint32_t* meshNames = reader.Next<uint32_t>();
+        const uint32_t* materialNames = reader.Next<uint32_t>();
+        const uint8_t* castShadows = reader.Next<uint8_t>();
+        if (!BeginRows(section, castShadows, indices, rows, "Mesh renderer"))
+            return false;
+
+        std::map<std::pair<int64_t, uint32_t>, std::shared_ptr<Mesh>> meshCache;
+        std::map<std::pair<int64_t, uint32_t>, std::shared_ptr<Material>> materialCache;
+        for (uint32_t i = 0; i < section.count; i++) {
+            rows.components[i].mesh = ResolveAsset(meshUuids[i], meshNames[i], meshCache);
+            rows.components[i].material = ResolveAsset(materialUuids[i], materialNames[i], materialCache);
+            rows.components[i].castShadows = castShadows[i] != 0;
+        }
+        return true;
+    }
+
+    bool ReadCameras(const SceneBinarySection& section, SectionRows<CameraComponent>& rows) {
+        SectionReader reader = Reader(section);
+        const uint32_t* indices = reader.Next<uint32_t>();
+        const float* fov = reader.Next<float>();
+        const float* near = reader.Next<float>();
+        const float* far = reader.Next<float>();
+        if (!BeginRows(section, far, indices, rows, "Camera"))
+            return false;
+        for (uint32_t i = 0; i < section.count; i++) {
+            rows.components[i].fov = fov[i];
+            rows.components[i].near = near[i];
+            rows.components[i].far = far[i];
+        }
+        return true;
+    }
+};
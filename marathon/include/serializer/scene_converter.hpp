@@ -0,0 +1,51 @@
+#pragma once
+
+// std libs
+#include <string>
+#include <iostream>
+
+// internal libs
+#include "core/filepath.hpp"
+#include "ecs/ngine.hpp"
+#include "serializer/scene_serializer.hpp"
+#include "serializer/scene_binary.hpp"
+
+//// NOTES:
+// Picks the json or binary serializer from the file extension.
+// Converting loads into a scratch scene so the caller's scene is untouched.
+
+inline bool IsBinaryScene(const std::string& filepath) {
+    return GetFileExtension(filepath) == SCENE_BINARY_EXT;
+}
+
+inline bool LoadSceneFile(Scene& scene, const std::string& filepath) {
+    if (IsBinaryScene(filepath)) {
+        SceneBinarySerializer sbs = SceneBinarySerializer(scene);
+        return sbs.Deserialize(filepath);
+    }
+    SceneSerializer ss = SceneSerializer(scene);
+    ss.Deserialize(filepath);
+    return true;
+}
+
+inline bool SaveSceneFile(Scene& scene, const std::string& filepath) {
+    if (IsBinaryScene(filepath)) {
+        SceneBinarySerializer sbs = SceneBinarySerializer(scene);
+        return sbs.Serialize(filepath);
+    }
+    SceneSerializer ss = SceneSerializer(scene);
+    ss.Serialize(filepath);
+    return true;
+}
+
+// json -> binary or binary -> json, by extension of each path
+inline bool ConvertScene(const std::string& srcPath, const std::string& dstPath) {
+    if (IsBinaryScene(srcPath) == IsBinaryScene(dstPath)) {
+        std::cout << "WARNING (ConvertScene): Source and destination are the same format." << std::endl;
+        return false;
+    }
+    Scene scratch;
+    if (!LoadSceneFile(scratch, srcPath))
+        return false;
+    return SaveSceneFile(scratch, dstPath);
+}
@@ -5,6 +5,8 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <vector>
 
 // external libs
 #include "json.hpp"
@@ -14,8 +16,7 @@ using namespace nlohmann;
 #include "la_extended.h"
 #include "ecs/ngine.hpp"
 #include "renderer/components.hpp"
-#include "platform/opengl/opengl_mesh.hpp"
-#include "platform/opengl/opengl_material.hpp"
+#include "renderer/render_assets.hpp"
 
 //// TODO:
 // Might want to replace with Method Injection
@@ -40,23 +41,40 @@ public:
     }
 
     // read in json file to scene
+    // parents are linked after every entity exists so file order does not matter
     void Deserialize(const std::string &filepath) {
         _scene.Clear();
         json j = LoadJson(filepath);
+        std::map<int64_t, Entity> uuidToEntity;
+        std::vector<std::pair<Entity, int64_t>> parentLinks;
         for (const auto &entityJson : j) {
-            DeserializeEntity(entityJson);
+            Entity entity = DeserializeEntity(entityJson);
+            uuidToEntity[(int64_t)entity.GetComponent<CoreComponent>().uuid] = entity;
+            if (entityJson.contains("parent"))
+                parentLinks.push_back({entity, entityJson["parent"].get<int64_t>()});
+        }
+        for (auto& [entity, parentUuid] : parentLinks) {
+            auto it = uuidToEntity.find(parentUuid);
+            if (it == uuidToEntity.end()) {
+                std::cout << "WARNING (SceneSerializer): Parent uuid not found, entity left at root." << std::endl;
+                continue;
+            }
+            entity.SetParent(it->second);
         }
     }
 
 private:
     Scene& _scene;
-    AssetManager& _assetManager = AssetManager::Instance();
 
     json SerializeEntity(Entity e) {
         json j;
         // create entity
         CoreComponent& cc = e.GetComponent<CoreComponent>();
         j["name"] = cc.name;
+        j["uuid"] = (int64_t)cc.uuid;
+        Entity parent = e.GetParent();
+        if (parent)
+            j["parent"] = (int64_t)parent.GetComponent<CoreComponent>().uuid;
         // extract transform
         TransformComponent& tc = e.GetComponent<TransformComponent>();
         j["transform"]["position"] = SerializeVec3(tc.position);
@@ -71,6 +89,7 @@ private:
             DirectionalLightComponent& dlc = e.GetComponent<DirectionalLightComponent>();
             next["directionalLight"]["colour"] = SerializeColour3(dlc.colour);
             next["directionalLight"]["intensity"] = dlc.intensity;
+            next["directionalLight"]["castShadows"] = dlc.castShadows;
             j["components"].push_back(next);
         }
 
@@ -90,6 +109,8 @@ private:
             next["spotLight"]["intensity"] = slc.intensity;
             next["spotLight"]["cutOff"] = slc.cutOff;
             next["spotLight"]["outerCutOff"] = slc.outerCutOff;
+            next["spotLight"]["range"] = slc.range;
+            next["spotLight"]["castShadows"] = slc.castShadows;
             j["components"].push_back(next);
         }
 
@@ -100,6 +121,7 @@ private:
                 next["meshRenderer"]["meshName"] = mrc.mesh->name;
             if (mrc.material != nullptr)
                 next["meshRenderer"]["materialName"] = mrc.material->name;
+            next["meshRenderer"]["castShadows"] = mrc.castShadows;
             j["components"].push_back(next);
         }
 
@@ -115,10 +137,12 @@ private:
     }
         
 
-    void DeserializeEntity(json j) {
+    Entity DeserializeEntity(json j) {
         // create entity
         std::string name = j["name"];
         Entity entity = _scene.CreateEntity(name);
+        if (j.contains("uuid"))
+            entity.GetComponent<CoreComponent>().uuid = UUID(j["uuid"].get<int64_t>());
         // extract transform
         TransformComponent &transform = entity.GetComponent<TransformComponent>();
         json transformJson = j["transform"];
@@ -133,6 +157,9 @@ private:
                 DirectionalLightComponent &plc = entity.AddComponent<DirectionalLightComponent>();
                 plc.colour = DeserializeColour3(value["directionalLight"]["colour"]);
                 plc.intensity = value["directionalLight"]["intensity"];
+                // scenes saved before shadows keep the component defaults
+                if (value["directionalLight"].contains("castShadows"))
+                    plc.castShadows = value["directionalLight"]["castShadows"];
 
             } else if (value.contains("pointLight")) {
                 PointLightComponent &plc = entity.AddComponent<PointLightComponent>();
@@ -146,12 +173,17 @@ private:
                 slc.intensity = value["spotLight"]["intensity"];
                 slc.cutOff = value["spotLight"]["cutOff"];
                 slc.outerCutOff = value["spotLight"]["outerCutOff"];
+                // scenes saved before spot lights had a range keep the default
+                if (value["spotLight"].contains("range"))
+                    slc.range = value["spotLight"]["range"];
+                if (value["spotLight"].contains("castShadows"))
+                    slc.castShadows = value["spotLight"]["castShadows"];
 
             } else if (value.contains("meshRenderer")) {
                 MeshRendererComponent &mrc = entity.AddComponent<MeshRendererComponent>();
                 try {
                     std::string meshName = value["meshRenderer"]["meshName"];
-                    mrc.mesh = _assetManager.FindAsset<OpenGLMesh>(meshName);
+                    mrc.mesh = FindRenderAsset<Mesh>(meshName);
                 } catch (const std::exception& e) {
                     std::cout << "WARNING (Serializer): mesh name bad." << std::endl;
                     std::cout << e.what() << std::endl;
@@ -159,12 +191,15 @@ private:
 
                 try {
                     std::string materialName = value["meshRenderer"]["materialName"];
-                    mrc.material = _assetManager.FindAsset<OpenGLMaterial>(materialName);
+                    mrc.material = FindRenderAsset<Material>(materialName);
                 } catch (const std::exception& e) {
                     std::cout << "WARNING (Serializer): material name bad." << std::endl;
                     std::cout << e.what() << std::endl;
                 }
 
+                if (value["meshRenderer"].contains("castShadows"))
+                    mrc.castShadows = value["meshRenderer"]["castShadows"];
+
             } else if (value.contains("camera")) {
                 CameraComponent &cc = entity.AddComponent<CameraComponent>();
                 cc.fov = value["camera"]["fov"];
@@ -175,6 +210,7 @@ private:
                 std::cout << value << std::endl;
             }
         }
+        return entity;
     }
 
     json LoadJson(const std::string &filepath)
@@ -1,4 +1,5 @@
 #include "ecs/asset.hpp"
+#include "core/profiler.hpp"
 
 Asset::Asset(const std::string& name, const std::string& path)
     : name(name), path(path) {}
@@ -14,17 +15,113 @@ AssetLoaderManager& AssetLoaderManager::Instance() {
     return instance;
 }
 
+AssetLoaderManager::~AssetLoaderManager() {
+    // release any worker waiting on a full queue so the pool can join
+    {
+        std::lock_guard<std::mutex> lock(_commitMutex);
+        _stopping = true;
+    }
+    _commitSpace.notify_all();
+    _pool.reset();
+}
+
 void AssetLoaderManager::AddLoader(std::shared_ptr<IAssetLoader> loader) {
     _loaders.push_back(loader);
 }
 
-bool AssetLoaderManager::Load(const std::string& filepath) {
+std::shared_ptr<IAssetLoader> AssetLoaderManager::FindLoader(const std::string& filepath) {
     for (auto loader : _loaders) {
         if (loader != nullptr && loader->CanLoad(filepath)) {
-            return loader->Load(filepath);
+            return loader;
         }
     }
     std::cout << "ERROR (AssetLoaderManager): Unsupported file extension @ " << filepath << std::endl;
-    return false;
+    return nullptr;
+}
+
+bool AssetLoaderManager::Load(const std::string& filepath) {
+    std::shared_ptr<IAssetLoader> loader = FindLoader(filepath);
+    return loader != nullptr && loader->Load(filepath);
+}
+
+std::vector<AssetLoadHandle> AssetLoaderManager::LoadAsync(const std::vector<std::string>& filepaths) {
+    if (_pool == nullptr)
+        _pool = std::make_unique<ThreadPool>();
+
+    std::vector<AssetLoadHandle> handles;
+    handles.reserve(filepaths.size());
+    for (const std::string& filepath : filepaths) {
+        auto promise = std::make_shared<std::promise<bool>>();
+        handles.push_back(AssetLoadHandle{filepath, promise->get_future().share()});
+
+        std::shared_ptr<IAssetLoader> loader = FindLoader(filepath);
+        if (loader == nullptr) {
+            promise->set_value(false);
+            continue;
+        }
+
+        _pool->Submit([this, loader, filepath, promise]() {
+            AssetCommit commit;
+            try {
+                PROFILE_SCOPE("Asset Prepare");
+                commit = loader->Prepare(filepath);
+            } catch (const std::exception& e) {
+                std::cout << "ERROR (AssetLoaderManager): Exception preparing " << filepath << ": " << e.what() << std::endl;
+            }
+            if (!commit) {
+                promise->set_value(false);
+                return;
+            }
+            std::unique_lock<std::mutex> lock(_commitMutex);
+            _commitSpace.wait(lock, [this]() { return _stopping || _commits.size() < ASSET_COMMIT_QUEUE_MAX; });
+            if (_stopping) {
+                promise->set_value(false);
+                return;
+            }
+            _commits.push_back(PendingCommit{std::move(commit), promise});
+            _commitReady.notify_one();
+        });
+    }
+    return handles;
 }
 
+uint32_t AssetLoaderManager::ProcessCommits(uint32_t maxCommits) {
+    PROFILE_SCOPE("Asset Commits");
+    uint32_t processed = 0;
+    while (maxCommits == 0 || processed < maxCommits) {
+        PendingCommit pending;
+        {
+            std::lock_guard<std::mutex> lock(_commitMutex);
+            if (_commits.empty())
+                break;
+            pending = std::move(_commits.front());
+            _commits.pop_front();
+        }
+        _commitSpace.notify_one();
+        bool result = false;
+        try {
+            result = pending.commit();
+        } catch (const std::exception& e) {
+            std::cout << "ERROR (AssetLoaderManager): Exception committing asset: " << e.what() << std::endl;
+        }
+        pending.promise->set_value(result);
+        processed++;
+    }
+    return processed;
+}
+
+bool AssetLoaderManager::Wait(const std::vector<AssetLoadHandle>& handles) {
+    for (const AssetLoadHandle& handle : handles) {
+        while (!handle.IsReady()) {
+            if (ProcessCommits() > 0)
+                continue;
+            // failed prepares resolve without a commit so don't wait forever on the queue
+            std::unique_lock<std::mutex> lock(_commitMutex);
+            _commitReady.wait_for(lock, std::chrono::milliseconds(1), [this]() { return !_commits.empty(); });
+        }
+    }
+    bool success = true;
+    for (const AssetLoadHandle& handle : handles)
+        success &= handle.result.get();
+    return success;
+}
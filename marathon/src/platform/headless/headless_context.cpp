@@ -0,0 +1,57 @@
+#include "platform/headless/headless_context.hpp"
+
+void HeadlessContext::SetDrawMode(DrawMode drawMode) {
+    _drawMode = drawMode;
+}
+
+DrawMode HeadlessContext::GetDrawMode() {
+    return _drawMode;
+}
+
+void HeadlessContext::SetPointSize(float size) {
+    _pointSize = size;
+}
+
+float HeadlessContext::GetPointSize() {
+    return _pointSize;
+}
+
+void HeadlessContext::SetLineWidth(float width) {
+    _lineWidth = width;
+}
+
+float HeadlessContext::GetLineWidth() {
+    return _lineWidth;
+}
+
+void HeadlessContext::SetWinding(Winding winding) {
+    _winding = winding;
+}
+
+Winding HeadlessContext::GetWinding() {
+    return _winding;
+}
+
+void HeadlessContext::SetClearColour(const LA::vec4& c) {
+    _clearColour = c;
+}
+
+LA::vec4 HeadlessContext::GetClearColour() {
+    return _clearColour;
+}
+
+void HeadlessContext::SetCulling(bool enabled) {
+    _culling = enabled;
+}
+
+bool HeadlessContext::IsCulling() {
+    return _culling;
+}
+
+void HeadlessContext::SetDepthTesting(bool enabled) {
+    _depthTesting = enabled;
+}
+
+bool HeadlessContext::IsDepthTesting() {
+    return _depthTesting;
+}
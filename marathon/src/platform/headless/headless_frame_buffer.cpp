@@ -0,0 +1,23 @@
+#include "platform/headless/headless_frame_buffer.hpp"
+
+HeadlessFrameBuffer::HeadlessFrameBuffer(const std::string& name, int width, int height, const FrameBufferSpec& spec)
+    : FrameBuffer(name, width, height, spec) {}
+
+void HeadlessFrameBuffer::Resize(int width, int height) {
+    _width = width;
+    _height = height;
+}
+
+void HeadlessFrameBuffer::Bind() {}
+
+void HeadlessFrameBuffer::Unbind() {}
+
+uint32_t HeadlessFrameBuffer::GetColourAttachment(uint32_t index) {
+    return 0;
+}
+
+uint32_t HeadlessFrameBuffer::GetDepthStencilAttachment() {
+    return 0;
+}
+
+void HeadlessFrameBuffer::Clear() {}
@@ -0,0 +1,41 @@
+#include "platform/headless/headless_material.hpp"
+
+HeadlessMaterial::HeadlessMaterial(std::string name)
+    : Material(name) {}
+
+bool HeadlessMaterial::IsUsable() const {
+    return shader != nullptr && shader->IsUsable();
+}
+
+void HeadlessMaterial::Bind() {
+    if (!IsUsable()) {
+        std::cout << "WARNING (Headless): Shader is not valid, can't bind material." << std::endl;
+        return;
+    }
+    shader->Bind();
+    Apply();
+}
+
+uint32_t HeadlessMaterial::Apply() {
+    if (!IsUsable()) {
+        return 0;
+    }
+    uint32_t uploads = 0;
+    // samplers take texture units in property order
+    uint32_t unit = 0;
+    for (auto& [key, value] : properties) {
+        if (!shader->Locate(key).IsValid())
+            continue;
+        uploads++;
+        if (const std::shared_ptr<Texture>* texture = std::get_if<std::shared_ptr<Texture>>(&value)) {
+            if (*texture)
+                (*texture)->Bind(unit);
+            unit++;
+        }
+    }
+    return uploads;
+}
+
+void HeadlessMaterial::Unbind() {
+    shader->Unbind();
+}
@@ -0,0 +1,34 @@
+#include "platform/headless/headless_mesh.hpp"
+
+HeadlessMesh::HeadlessMesh(std::string name)
+    : Mesh(name) {}
+
+bool HeadlessMesh::IsUsable() {
+    return _isGenerated;
+}
+
+void HeadlessMesh::RequestUpload() {
+    if (_isGenerated)
+        return;
+    if (layout.IsEmpty() && vertices.size() > 0)
+        layout = VertexLayout::Build(*this, quantise);
+    // same sizes as OpenGLMesh, 16 bit indices leave 0xFFFF free for primitive restart
+    _memory.vertexBytes = vertices.size() * layout.stride;
+    _memory.indexBytes = GetTotalIndexCount() * (UseShortIndices(vertices.size()) ? sizeof(uint16_t) : sizeof(uint32_t));
+    _memory.unpackedBytes = UnpackedVertexBytes(*this);
+    _isGenerated = true;
+}
+
+void HeadlessMesh::Bind() {
+    RequestUpload();
+}
+
+void HeadlessMesh::Unbind() {}
+
+void HeadlessMesh::Draw(uint32_t lod) {}
+
+void HeadlessMesh::DrawInstanced(uint32_t instanceCount, uint32_t lod) {}
+
+MeshMemoryUsage HeadlessMesh::GetMemoryUsage() const {
+    return _memory;
+}
@@ -0,0 +1,236 @@
+#include "platform/headless/headless_renderer.hpp"
+#include "core/profiler.hpp"
+
+#include <algorithm>
+
+void HeadlessRenderer::Boot() {
+    std::cout << "DEBUG (HeadlessRenderer): Boot." << std::endl;
+    context = Context::Create();
+    _commands.Clear();
+    _lastFrame.Clear();
+    _frameCount = 0;
+    _frameDataDirty = true;
+}
+
+void HeadlessRenderer::Shutdown() {
+    std::cout << "DEBUG (HeadlessRenderer): Shutdown after " << _frameCount << " frames." << std::endl;
+    _commands.Clear();
+    _lastFrame.Clear();
+    _gBuffer = nullptr;
+}
+
+RenderCommand& HeadlessRenderer::Record(RenderCommandType type) {
+    RenderCommand& command = _commands.commands.emplace_back();
+    command.type = type;
+    command.frameBuffer = _drawingGBuffer ? _gBuffer.get() : _frameBuffer.get();
+    return command;
+}
+
+void HeadlessRenderer::SetFrameBuffer(std::shared_ptr<FrameBuffer> fb) {
+    _frameBuffer = fb;
+    if (fb != nullptr)
+        fb->Bind();
+    Record(RenderCommandType::SET_FRAME_BUFFER);
+}
+
+std::shared_ptr<FrameBuffer> HeadlessRenderer::GetFrameBuffer() {
+    return _frameBuffer;
+}
+
+void HeadlessRenderer::SetProjection(const LA::mat4& proj) {
+    _projection = proj;
+    _cameraBlock.projection = proj;
+    _frameDataDirty = true;
+}
+
+LA::mat4 HeadlessRenderer::GetProjection() {
+    return _projection;
+}
+
+void HeadlessRenderer::SetView(const LA::mat4& view) {
+    _view = view;
+    _cameraBlock.view = view;
+    _frameDataDirty = true;
+}
+
+LA::mat4 HeadlessRenderer::GetView() {
+    return _view;
+}
+
+void HeadlessRenderer::Clear() {
+    if (_frameBuffer)
+        _frameBuffer->Clear();
+    Record(RenderCommandType::CLEAR);
+}
+
+void HeadlessRenderer::RenderMesh(std::shared_ptr<Shader> shader, std::shared_ptr<Mesh> mesh, const LA::mat4& transform) {
+    if (!shader || !mesh) {
+        std::cout << "ERROR (HeadlessRenderer): Attempting to render with null shader or mesh" << std::endl;
+        return;
+    }
+    UploadFrameData();
+    shader->Bind();
+    Record(RenderCommandType::BIND_SHADER).shader = shader.get();
+    mesh->Bind();
+    Record(RenderCommandType::BIND_MESH).mesh = mesh.get();
+    RenderCommand& draw = Record(RenderCommandType::DRAW);
+    draw.shader = shader.get();
+    draw.mesh = mesh.get();
+    draw.first = (uint32_t)_commands.transforms.size();
+    draw.count = 1;
+    _commands.transforms.push_back(transform);
+    _stats.programBinds++;
+    _stats.vaoBinds++;
+    _stats.uniformUploads += 3;
+    _stats.draws++;
+    _stats.triangles += mesh->GetTriangleCount();
+}
+
+// nothing to upload, the frame data only has to be marked as used
+// clusters are still built so their cost and contents match the GL backend
+void HeadlessRenderer::UploadFrameData() {
+    if (!_frameDataDirty)
+        return;
+    BuildLightClusters();
+    _frameDataDirty = false;
+}
+
+void HeadlessRenderer::Flush() {
+    if (_queue.empty())
+        return;
+    PROFILE_SCOPE("Flush");
+    {
+        PROFILE_SCOPE("Sort");
+        UploadFrameData();
+        SortQueue();
+        BuildBatches();
+    }
+
+    // uploads land immediately, the bytes are what the GL backend would have copied
+    for (const DrawBatch& batch : _batches) {
+        Mesh* mesh = _queue[_order[batch.first]].mesh;
+        if (mesh->IsUsable())
+            continue;
+        mesh->RequestUpload();
+        MeshMemoryUsage memory = mesh->GetMemoryUsage();
+        _stats.uploadBytes += memory.vertexBytes + memory.indexBytes;
+    }
+    _stats.uploadsPending = 0;
+
+    DrawState state;
+    state.drawMode = context->GetDrawMode();
+    bool deferred = IsDeferredFlush();
+    if (deferred) {
+        BeginGBuffer();
+        DrawBatches(true, deferred, state);
+        LightGBuffer(state);
+    }
+    DrawBatches(false, deferred, state);
+
+    if (state.mesh)
+        state.mesh->Unbind();
+    _queue.clear();
+}
+
+void HeadlessRenderer::OnSetDrawMode(DrawMode mode) {
+    Record(RenderCommandType::SET_DRAW_MODE).drawMode = mode;
+}
+
+void HeadlessRenderer::OnBindShader(const Shader* shader, ShaderVariant variant) {
+    RenderCommand& bind = Record(RenderCommandType::BIND_SHADER);
+    bind.shader = shader;
+    bind.variant = variant;
+}
+
+void HeadlessRenderer::OnApplyMaterial(const Material* material) {
+    Record(RenderCommandType::APPLY_MATERIAL).material = material;
+}
+
+void HeadlessRenderer::OnBindMesh(const Mesh* mesh) {
+    Record(RenderCommandType::BIND_MESH).mesh = mesh;
+}
+
+void HeadlessRenderer::IssueDraw(const DrawCall& draw, const DrawState& state) {
+    RenderCommand& command = Record(draw.instanced ? RenderCommandType::DRAW_INSTANCED : RenderCommandType::DRAW);
+    command.shader = state.shader;
+    command.material = state.material;
+    command.mesh = draw.mesh;
+    command.variant = state.variant;
+    command.drawMode = state.drawMode;
+    command.pass = draw.pass;
+    command.lod = draw.lod;
+    command.first = (uint32_t)_commands.transforms.size();
+    command.count = draw.count;
+    _commands.transforms.insert(_commands.transforms.end(), draw.transforms, draw.transforms + draw.count);
+}
+
+void HeadlessRenderer::BeginGBuffer() {
+    int width = std::max(_frameBuffer ? _frameBuffer->GetWidth() : (int)_cameraBlock.resolution[0], 1);
+    int height = std::max(_frameBuffer ? _frameBuffer->GetHeight() : (int)_cameraBlock.resolution[1], 1);
+    if (!_gBuffer) {
+        FrameBufferSpec spec;
+        spec.colour = {FrameBufferFormat::RGBA8, FrameBufferFormat::RG16F};
+        _gBuffer = std::make_shared<HeadlessFrameBuffer>("G-Buffer", width, height, spec);
+    } else if (width != _gBuffer->GetWidth() || height != _gBuffer->GetHeight()) {
+        _gBuffer->Resize(width, height);
+    }
+    _drawingGBuffer = true;
+    _gBuffer->Bind();
+    Record(RenderCommandType::SET_FRAME_BUFFER);
+    _gBuffer->Clear();
+    Record(RenderCommandType::CLEAR);
+}
+
+void HeadlessRenderer::ResolveGBuffer() {
+    _drawingGBuffer = false;
+    if (_frameBuffer)
+        _frameBuffer->Bind();
+    Record(RenderCommandType::SET_FRAME_BUFFER);
+}
+
+void HeadlessRenderer::DrawLightingPass(const DrawState& state) {
+    RenderCommand& lighting = Record(RenderCommandType::LIGHTING_PASS);
+    lighting.shader = state.shader;
+    lighting.variant = state.variant;
+}
+
+void HeadlessRenderer::DrawShadows(const Shader* shader) {
+    PROFILE_SCOPE("Shadows");
+    for (const ShadowBatch& batch : _shadowBatches) {
+        if (batch.mesh->IsUsable())
+            continue;
+        batch.mesh->RequestUpload();
+        MeshMemoryUsage memory = batch.mesh->GetMemoryUsage();
+        _stats.uploadBytes += memory.vertexBytes + memory.indexBytes;
+    }
+    DrawShadowBatches(shader);
+}
+
+void HeadlessRenderer::BeginShadowView(const ShadowView& view) {
+    Record(RenderCommandType::SHADOW_VIEW).first = view.slot;
+}
+
+void HeadlessRenderer::EndFrame() {
+    std::swap(_commands, _lastFrame);
+    _commands.Clear();
+    _frameCount++;
+}
+
+const RenderCommandList& HeadlessRenderer::GetCommands() const {
+    return _commands;
+}
+
+const RenderCommandList& HeadlessRenderer::GetLastFrame() const {
+    return _lastFrame;
+}
+
+uint64_t HeadlessRenderer::GetFrameCount() const {
+    return _frameCount;
+}
+
+HeadlessRenderer& HeadlessRenderer::Instance() {
+    static HeadlessRenderer* instance;
+    if (!instance)
+        instance = new HeadlessRenderer();
+    return *instance;
+}
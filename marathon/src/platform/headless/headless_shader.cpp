@@ -0,0 +1,110 @@
+#include "platform/headless/headless_shader.hpp"
+
+#include <sstream>
+#include <algorithm>
+
+HeadlessShader::HeadlessShader(std::string name, std::shared_ptr<ShaderSource> vs, std::shared_ptr<ShaderSource> fs, std::shared_ptr<ShaderSource> gs)
+    : Shader(name, vs, fs, gs) {
+    Compile();
+}
+
+bool HeadlessShader::IsUsable() const {
+    return _validShader;
+}
+
+void HeadlessShader::Compile() {
+    _validShader = false;
+    _uniformToHandle.clear();
+    if (vs == nullptr) {
+        std::cout << "WARNING (Shader): Can't compile shader with null vertex shader source." << std::endl;
+        return;
+    }
+    if (fs == nullptr) {
+        std::cout << "WARNING (Shader): Can't compile shader with null fragment shader source." << std::endl;
+        return;
+    }
+    if (vs->stage != ShaderStage::VERTEX || fs->stage != ShaderStage::FRAGMENT) {
+        std::cout << "WARNING (Shader): Trying to compile non-matching stages." << std::endl;
+        return;
+    }
+
+    _validShader = true;
+    for (uint32_t v = 0; v < SHADER_VARIANT_COUNT; v++)
+        _hasVariant[v] = SourcesMention((ShaderVariant)v);
+    ReflectUniforms(vs->source);
+    ReflectUniforms(fs->source);
+    if (gs)
+        ReflectUniforms(gs->source);
+}
+
+// blanks out // and /* */ comments so commented declarations aren't reflected
+static std::string StripComments(const std::string& source) {
+    std::string out = source;
+    size_t i = 0;
+    while (i + 1 < out.size()) {
+        if (out[i] == '/' && out[i + 1] == '/') {
+            size_t end = out.find('\n', i);
+            end = end == std::string::npos ? out.size() : end;
+            std::fill(out.begin() + i, out.begin() + end, ' ');
+            i = end;
+        } else if (out[i] == '/' && out[i + 1] == '*') {
+            size_t end = out.find("*/", i + 2);
+            end = end == std::string::npos ? out.size() : end + 2;
+            std::fill(out.begin() + i, out.begin() + end, ' ');
+            i = end;
+        } else {
+            i++;
+        }
+    }
+    return out;
+}
+
+void HeadlessShader::ReflectUniforms(const std::string& source) {
+    std::istringstream stream(StripComments(source));
+    std::string token;
+    while (stream >> token) {
+        if (token != "uniform")
+            continue;
+        // "uniform type name;" or "uniform precision type name[n];", blocks are "uniform Name {"
+        std::string type, name;
+        if (!(stream >> type >> name))
+            break;
+        if (type == "lowp" || type == "mediump" || type == "highp") {
+            if (!(stream >> name))
+                break;
+        }
+        if (type.find('{') != std::string::npos || name[0] == '{')
+            continue;
+        size_t end = name.find_first_of("[;=");
+        bool array = end != std::string::npos && name[end] == '[';
+        name = name.substr(0, end);
+        if (name.empty())
+            continue;
+        int32_t handle = (int32_t)_uniformToHandle.size();
+        _uniformToHandle.try_emplace(name, handle);
+        if (array)
+            _uniformToHandle.try_emplace(name + "[0]", _uniformToHandle.at(name));
+    }
+}
+
+UniformHandle HeadlessShader::Locate(const std::string& name) const {
+    auto it = _uniformToHandle.find(name);
+    if (it == _uniformToHandle.end())
+        return UniformHandle();
+    return UniformHandle{it->second};
+}
+
+void HeadlessShader::Bind() const {
+    Bind(ShaderVariant::DEFAULT);
+}
+
+void HeadlessShader::Bind(ShaderVariant variant) const {
+    if (!IsUsable())
+        std::cout << "WARNING (HeadlessShader): Cannot bind invalid shader." << std::endl;
+}
+
+bool HeadlessShader::HasVariant(ShaderVariant variant) const {
+    return _validShader && _hasVariant[(int)variant];
+}
+
+void HeadlessShader::Unbind() const {}
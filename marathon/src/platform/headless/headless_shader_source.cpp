@@ -0,0 +1,12 @@
+#include "platform/headless/headless_shader_source.hpp"
+
+#include <iostream>
+
+HeadlessShaderSource::HeadlessShaderSource(const std::string& name, const std::string& source, ShaderStage stage)
+    : ShaderSource(name, source, stage) {}
+
+uint32_t HeadlessShaderSource::Compile(const std::vector<std::string>& defines) {
+    if (stage == ShaderStage::INVALID)
+        std::cout << "WARNING (HeadlessShaderSource): Invalid stage for '" << name << "'." << std::endl;
+    return 0;
+}
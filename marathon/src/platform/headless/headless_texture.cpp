@@ -0,0 +1,37 @@
+#include "platform/headless/headless_texture.hpp"
+
+#include <iostream>
+
+HeadlessTexture::HeadlessTexture(std::string name)
+    : Texture(name) {}
+
+bool HeadlessTexture::IsUsable() {
+    return _isGenerated;
+}
+
+void HeadlessTexture::RequestUpload() {
+    if (_isGenerated) {
+        return;
+    }
+    if (mips.empty() || width == 0 || height == 0) {
+        std::cout << "WARNING (HeadlessTexture): No pixels to upload for '" << name << "'." << std::endl;
+        return;
+    }
+
+    _memory = GetMipChainMemory(mips, width, height, format);
+    _isGenerated = true;
+    if (!keepPixels) {
+        mips.clear();
+        mips.shrink_to_fit();
+    }
+}
+
+void HeadlessTexture::Bind(uint32_t unit) {
+    RequestUpload();
+}
+
+void HeadlessTexture::Unbind(uint32_t unit) {}
+
+TextureMemoryUsage HeadlessTexture::GetMemoryUsage() const {
+    return _memory;
+}
@@ -1,57 +1,95 @@
 #include "platform/opengl/opengl_frame_buffer.hpp"
 
 /// TODO: Use glTexImage2DMultisample with a sample count for antialiasing affects
-/// implement more openly to allow multiple colour attachments
 
+struct GLTextureFormat {
+    GLint internalFormat;
+    GLenum format;
+    GLenum type;
+};
 
-OpenGLFrameBuffer::OpenGLFrameBuffer(const std::string& name, int width, int height)
-    : FrameBuffer(name, width, height) {
+static GLTextureFormat ToGL(FrameBufferFormat format) {
+    switch (format) {
+        case FrameBufferFormat::RGBA16F:    return {GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT};
+        case FrameBufferFormat::RG16F:      return {GL_RG16F, GL_RG, GL_HALF_FLOAT};
+        case FrameBufferFormat::R11G11B10F: return {GL_R11F_G11F_B10F, GL_RGB, GL_FLOAT};
+        case FrameBufferFormat::R32F:       return {GL_R32F, GL_RED, GL_FLOAT};
+        case FrameBufferFormat::RGBA8:
+        default:                            return {GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE};
+    }
+}
+
+OpenGLFrameBuffer::OpenGLFrameBuffer(const std::string& name, int width, int height, const FrameBufferSpec& spec)
+    : FrameBuffer(name, width, height, spec) {
     // create fbo
     glGenFramebuffers(1, &_fbo);
     glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
 
-    // create colour texture for attachment
-    glGenTextures(1, &_texColour);
-    glBindTexture(GL_TEXTURE_2D, _texColour);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-    
-    // Note: Must keep otherwise Min/Mag default to using mipmaps that aren't generated.
-    // Causes ImGui to draw the texture as black.
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    
-    // bind to colour attachment
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _texColour, 0);
+    // create a texture for every colour attachment, output location i draws to attachment i
+    _texColours.resize(_spec.colour.size(), 0);
+    if (!_texColours.empty())
+        glGenTextures((GLsizei)_texColours.size(), _texColours.data());
+    std::vector<GLenum> drawBuffers;
+    for (uint32_t i = 0; i < (uint32_t)_texColours.size(); i++) {
+        glBindTexture(GL_TEXTURE_2D, _texColours[i]);
+        // Note: Must keep otherwise Min/Mag default to using mipmaps that aren't generated.
+        // Causes ImGui to draw the texture as black.
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, _texColours[i], 0);
+        drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + i);
+    }
+    if (drawBuffers.empty()) {
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    } else {
+        glDrawBuffers((GLsizei)drawBuffers.size(), drawBuffers.data());
+    }
 
     // create depth and stencil 
-    glGenTextures(1, &_texDepthStencil);
-    glBindTexture(GL_TEXTURE_2D, _texDepthStencil);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+    if (_spec.depthStencil) {
+        glGenTextures(1, &_texDepthStencil);
+        glBindTexture(GL_TEXTURE_2D, _texDepthStencil);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, _texDepthStencil, 0);
+    }
 
-    // bind to depth and stencil
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, _texDepthStencil, 0);
+    AllocateAttachments();
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "WARNING (OpenGLFrameBuffer): " << name << " is incomplete." << std::endl;
     
     // unbind for safety
+    glBindTexture(GL_TEXTURE_2D, 0);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 OpenGLFrameBuffer::~OpenGLFrameBuffer() {
-    glDeleteTextures(1, &_texColour);
+    if (!_texColours.empty())
+        glDeleteTextures((GLsizei)_texColours.size(), _texColours.data());
     glDeleteTextures(1, &_texDepthStencil);
     glDeleteFramebuffers(1, &_fbo);
 }
 
+void OpenGLFrameBuffer::AllocateAttachments() {
+    for (uint32_t i = 0; i < (uint32_t)_texColours.size(); i++) {
+        GLTextureFormat format = ToGL(_spec.colour[i]);
+        glBindTexture(GL_TEXTURE_2D, _texColours[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, format.internalFormat, _width, _height, 0, format.format, format.type, NULL);
+    }
+    if (_texDepthStencil != 0) {
+        glBindTexture(GL_TEXTURE_2D, _texDepthStencil);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, _width, _height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+    }
+}
+
 void OpenGLFrameBuffer::Resize(int width, int height) {
     _width = width;
     _height = height;
-
-    // Resize color texture
-    glBindTexture(GL_TEXTURE_2D, _texColour);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-
-    // Resize depth and stencil texture
-    glBindTexture(GL_TEXTURE_2D, _texDepthStencil);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+    AllocateAttachments();
+    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void OpenGLFrameBuffer::Bind() {
@@ -63,8 +101,8 @@ void OpenGLFrameBuffer::Unbind() {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-uint32_t OpenGLFrameBuffer::GetColourAttachment() {
-    return _texColour;
+uint32_t OpenGLFrameBuffer::GetColourAttachment(uint32_t index) {
+    return index < _texColours.size() ? _texColours[index] : 0;
 }
 
 uint32_t OpenGLFrameBuffer::GetDepthStencilAttachment() {
@@ -75,3 +113,7 @@ void OpenGLFrameBuffer::Clear() {
     glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 }
+
+uint32_t OpenGLFrameBuffer::GetId() const {
+    return _fbo;
+}
@@ -0,0 +1,83 @@
+#include "platform/opengl/opengl_gpu_timer.hpp"
+
+#include <iostream>
+#include <algorithm>
+
+OpenGLGpuTimer& OpenGLGpuTimer::Instance() {
+    static OpenGLGpuTimer instance;
+    return instance;
+}
+
+void OpenGLGpuTimer::Initialise() {
+    _initialised = true;
+    _supported = GLEW_ARB_timer_query;
+    if (!_supported) {
+        std::cout << "WARNING (OpenGLGpuTimer): No timer queries, GPU zones are disabled." << std::endl;
+        return;
+    }
+    for (QuerySet& set : _sets)
+        glGenQueries(GPU_TIMER_MAX_ZONES, set.queries);
+}
+
+void OpenGLGpuTimer::Begin(const char* name) {
+    if (!_initialised)
+        Initialise();
+    QuerySet& set = _sets[_current];
+    if (!_supported || !Profiler::Instance().IsRecording() || _open || set.count == GPU_TIMER_MAX_ZONES)
+        return;
+    if (set.count == 0)
+        set.frameIndex = Profiler::Instance().GetFrameIndex();
+    Zone& zone = set.zones[set.count];
+    zone.name = name;
+    zone.submitted = Profiler::Instance().Now();
+    glBeginQuery(GL_TIME_ELAPSED, set.queries[set.count]);
+    _open = true;
+}
+
+void OpenGLGpuTimer::End() {
+    if (!_open)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    _sets[_current].count++;
+    _open = false;
+}
+
+void OpenGLGpuTimer::Resolve(QuerySet& set) {
+    Profiler& profiler = Profiler::Instance();
+    uint64_t cursor = 0;
+    for (uint32_t i = 0; i < set.count; i++) {
+        GLint available = 0;
+        glGetQueryObjectiv(set.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        // results complete in order, nothing after an unfinished query is ready either
+        if (!available)
+            break;
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(set.queries[i], GL_QUERY_RESULT, &elapsed);
+        uint64_t start = std::max(set.zones[i].submitted, cursor);
+        cursor = start + elapsed;
+        profiler.RecordGpuZone(set.frameIndex, set.zones[i].name, start, cursor);
+    }
+    set.count = 0;
+}
+
+void OpenGLGpuTimer::EndFrame() {
+    if (!_supported)
+        return;
+    End();
+    // the oldest set was issued GPU_TIMER_LATENCY frames ago and is reused next
+    _current = (_current + 1) % GPU_TIMER_LATENCY;
+    Resolve(_sets[_current]);
+}
+
+void OpenGLGpuTimer::Shutdown() {
+    if (_supported) {
+        End();
+        for (QuerySet& set : _sets) {
+            glDeleteQueries(GPU_TIMER_MAX_ZONES, set.queries);
+            std::fill(std::begin(set.queries), std::end(set.queries), 0);
+            set.count = 0;
+        }
+    }
+    _initialised = false;
+    _supported = false;
+}
@@ -13,32 +13,53 @@ void OpenGLMaterial::Bind() {
         return;
     }
     shader->Bind();
+    Apply();
+}
+
+uint32_t OpenGLMaterial::Apply() {
+    if (!IsUsable()) {
+        return 0;
+    }
+    uint32_t uploads = 0;
+    // samplers take texture units in property order
+    uint32_t unit = 0;
     for (auto& [key, value] : properties) {
-        std::visit([this, &key](auto&& arg) {
+        UniformHandle h = shader->Locate(key);
+        if (!h.IsValid())
+            continue;
+        uploads++;
+        std::visit([this, h, &unit](auto&& arg) {
             using T = std::decay_t<decltype(arg)>;
             if constexpr (std::is_same_v<T, bool>) {
-                shader->SetBool(key, arg);
+                shader->SetBool(h, arg);
             } else if constexpr (std::is_same_v<T, int>) {
-                shader->SetInt(key, arg);
+                shader->SetInt(h, arg);
             } else if constexpr (std::is_same_v<T, float>) {
-                shader->SetFloat(key, arg);
+                shader->SetFloat(h, arg);
             } else if constexpr (std::is_same_v<T, uint32_t>) {
-                shader->SetUint(key, arg);
+                shader->SetUint(h, arg);
             } else if constexpr (std::is_same_v<T, LA::vec2>) {
-                shader->SetVec2(key, arg);
+                shader->SetVec2(h, arg);
             } else if constexpr (std::is_same_v<T, LA::vec3>) {
-                shader->SetVec3(key, arg);
+                shader->SetVec3(h, arg);
             } else if constexpr (std::is_same_v<T, LA::vec4>) {
-                shader->SetVec4(key, arg);
+                shader->SetVec4(h, arg);
             } else if constexpr (std::is_same_v<T, LA::mat2>) {
-                shader->SetMat2(key, arg);
+                shader->SetMat2(h, arg);
             } else if constexpr (std::is_same_v<T, LA::mat3>) {
-                shader->SetMat3(key, arg);
+                shader->SetMat3(h, arg);
             } else if constexpr (std::is_same_v<T, LA::mat4>) {
-                shader->SetMat4(key, arg);
+                shader->SetMat4(h, arg);
+            } else if constexpr (std::is_same_v<T, std::shared_ptr<Texture>>) {
+                if (arg) {
+                    arg->Bind(unit);
+                }
+                shader->SetInt(h, unit);
+                unit++;
             }
         }, value);
     }
+    return uploads;
 }
 
 void OpenGLMaterial::Unbind() {
@@ -1,56 +1,171 @@
 #include "platform/opengl/opengl_mesh.hpp"
+#include "platform/opengl/opengl_upload_queue.hpp"
+
+#include <cstring>
+#include <algorithm>
 
 OpenGLMesh::OpenGLMesh(std::string name)
     : Mesh(name) {}
 
 OpenGLMesh::~OpenGLMesh() {
+    if (_uploadPending) {
+        OpenGLUploadQueue::Instance().Cancel(this);
+    }
+    if (!_isGenerated) {
+        return;
+    }
     glDeleteVertexArrays(1, &_vaBuffer);
     glDeleteBuffers(1, &_vertexBuffer);
-    glDeleteBuffers(1, &_normalBuffer);
-    glDeleteBuffers(1, &_tangentBuffer);
-    glDeleteBuffers(1, &_colourBuffer);
-    glDeleteBuffers(1, &_indexBuffer);
-    glDeleteBuffers(1, &_uv0Buffer);
-    glDeleteBuffers(1, &_uv1Buffer);
-    glDeleteBuffers(1, &_uv2Buffer);
-    glDeleteBuffers(1, &_uv3Buffer);
+    if (_isIndexed) {
+        glDeleteBuffers(1, &_indexBuffer);
+    }
 }
 
 bool OpenGLMesh::IsUsable() {
     return _isGenerated;
 }
 
-void OpenGLMesh::Draw() {
+void OpenGLMesh::RequestUpload() {
+    if (_isGenerated || _uploadPending) {
+        return;
+    }
+
+    _uploadPending = true;
+    PrepareLayout();
+    UploadJob job;
+    job.owner = this;
+    job.bytes = GetUploadSize();
+    job.fill = [this](uint8_t* dst) { WriteUpload(dst); };
+    job.finish = [this](GLuint source, size_t offset, const uint8_t* data) { CreateBuffers(source, offset, data); };
+    OpenGLUploadQueue::Instance().Enqueue(std::move(job));
+}
+
+void OpenGLMesh::Bind() {
     if (!_isGenerated) {
         Generate();
-        if (!_isGenerated) {
-            return;
-        }
     }
-
     glBindVertexArray(_vaBuffer);
+}
+
+void OpenGLMesh::Unbind() {
+    glBindVertexArray(0);
+}
+
+void OpenGLMesh::Draw(uint32_t lod) {
+    if (!_isGenerated) {
+        return;
+    }
+
     if (_isIndexed) {
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, nullptr);
+        const IndexRange& range = RangeOf(lod);
+        glDrawElements(GL_TRIANGLES, range.count, _indexType, (void*)(uintptr_t)range.offset);
     } else {
-        glDrawArrays(GL_TRIANGLES, 0, vertices.size());
+        glDrawArrays(GL_TRIANGLES, 0, _drawCount);
     }
-    glBindVertexArray(0);
 }
 
-template <typename T>
-uint32_t OpenGLMesh::GenerateBuffer(GLenum target, const std::vector<T>& data) {
-    uint32_t buf = 0;
-    glGenBuffers(1, &buf);
-    glBindBuffer(target, buf);
-    glBufferData(target, data.size() * sizeof(T), &data.front(), GL_STATIC_DRAW);
-    return buf;
+void OpenGLMesh::DrawInstanced(uint32_t instanceCount, uint32_t lod) {
+    if (!_isGenerated) {
+        return;
+    }
+
+    if (_isIndexed) {
+        const IndexRange& range = RangeOf(lod);
+        glDrawElementsInstanced(GL_TRIANGLES, range.count, _indexType, (void*)(uintptr_t)range.offset, instanceCount);
+    } else {
+        glDrawArraysInstanced(GL_TRIANGLES, 0, _drawCount, instanceCount);
+    }
 }
 
-void OpenGLMesh::Generate() {
-    if (_isGenerated) {
+const OpenGLMesh::IndexRange& OpenGLMesh::RangeOf(uint32_t lod) const {
+    return _lodRanges[std::min(lod, (uint32_t)_lodRanges.size() - 1)];
+}
+
+MeshMemoryUsage OpenGLMesh::GetMemoryUsage() const {
+    return _memory;
+}
+
+void OpenGLMesh::EnableAttribute(const VertexElement& element, uint32_t stride) {
+    uint32_t loc = (uint32_t)element.slot;
+    uint32_t components = VertexLayout::FormatComponents(element.format);
+    void* offset = (void*)(uintptr_t)element.offset;
+
+    switch (element.format) {
+        case VertexFormat::FLOAT2:
+        case VertexFormat::FLOAT3:
+        case VertexFormat::FLOAT4:
+            glVertexAttribPointer(loc, components, GL_FLOAT, GL_FALSE, stride, offset);
+            break;
+        case VertexFormat::HALF2:
+            glVertexAttribPointer(loc, components, GL_HALF_FLOAT, GL_FALSE, stride, offset);
+            break;
+        case VertexFormat::SNORM_2_10_10_10:
+            glVertexAttribPointer(loc, components, GL_INT_2_10_10_10_REV, GL_TRUE, stride, offset);
+            break;
+        case VertexFormat::UNORM8x4:
+            glVertexAttribPointer(loc, components, GL_UNSIGNED_BYTE, GL_TRUE, stride, offset);
+            break;
+    }
+    glEnableVertexAttribArray(loc);
+}
+
+void OpenGLMesh::PrepareLayout() {
+    if (layout.IsEmpty() && vertices.size() > 0) {
+        layout = VertexLayout::Build(*this, quantise);
+    }
+    _memory.vertexBytes = vertices.size() * layout.stride;
+
+    // 0xFFFF is left free so it can be used as a primitive restart index
+    _indexType = UseShortIndices(vertices.size()) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    size_t indexSize = _indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+    _memory.indexBytes = GetTotalIndexCount() * indexSize;
+    // levels without indices of their own can't be drawn as a range, LOD 0 stands in
+    _lodRanges.clear();
+    size_t offset = 0;
+    for (uint32_t lod = 0; lod < GetLODCount() && !indices.empty(); lod++) {
+        const std::vector<uint32_t>& levelIndices = GetLODIndices(lod);
+        _lodRanges.push_back({offset, (uint32_t)levelIndices.size()});
+        offset += levelIndices.size() * indexSize;
+    }
+    _indexOffset = (_memory.vertexBytes + 3) & ~(size_t)3;
+    _memory.unpackedBytes = UnpackedVertexBytes(*this);
+}
+
+size_t OpenGLMesh::GetUploadSize() const {
+    return _indexOffset + _memory.indexBytes;
+}
+
+void OpenGLMesh::WriteUpload(uint8_t* dst) const {
+    if (vertices.size() > 0) {
+        PackVertices(*this, layout, dst);
+    }
+    for (uint32_t lod = 0; lod < (uint32_t)_lodRanges.size(); lod++) {
+        const std::vector<uint32_t>& levelIndices = GetLODIndices(lod);
+        uint8_t* indexDst = dst + _indexOffset + _lodRanges[lod].offset;
+        if (_indexType == GL_UNSIGNED_SHORT) {
+            uint16_t* shortIndices = reinterpret_cast<uint16_t*>(indexDst);
+            for (size_t i = 0; i < levelIndices.size(); i++) {
+                shortIndices[i] = (uint16_t)levelIndices[i];
+            }
+        } else {
+            std::memcpy(indexDst, levelIndices.data(), levelIndices.size() * sizeof(uint32_t));
+        }
+    }
+}
+
+void OpenGLMesh::FillBuffer(GLenum target, size_t bytes, GLuint source, size_t offset, const uint8_t* data) {
+    if (source == 0) {
+        glBufferData(target, bytes, data, GL_STATIC_DRAW);
         return;
     }
+    glBufferData(target, bytes, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, source);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, target, offset, 0, bytes);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+}
 
+void OpenGLMesh::CreateBuffers(GLuint source, size_t offset, const uint8_t* data) {
+    _uploadPending = false;
     _isGenerated = true;
     glGenVertexArrays(1, &_vaBuffer);
     glBindVertexArray(_vaBuffer);
@@ -58,59 +173,41 @@ void OpenGLMesh::Generate() {
     if (vertices.size() == 0) {
         std::cout << "DEBUG (Mesh): Trying to generate buffers for mesh with no vertices." << std::endl;
     } else {
-        _vertexBuffer = GenerateBuffer<LA::vec3>(GL_ARRAY_BUFFER, vertices);
-        glVertexAttribPointer(OpenGLAttribLocs::POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(LA::vec3), (void*)0);
-        glEnableVertexAttribArray(OpenGLAttribLocs::POSITION);
+        glGenBuffers(1, &_vertexBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
+        FillBuffer(GL_ARRAY_BUFFER, _memory.vertexBytes, source, offset, data);
+        for (const VertexElement& element : layout.elements) {
+            EnableAttribute(element, layout.stride);
+        }
     }
 
     if (indices.size() == 0) {
         _isIndexed = false;
+        _drawCount = vertices.size();
     } else {
         _isIndexed = true;
-        _indexBuffer = GenerateBuffer<uint32_t>(GL_ELEMENT_ARRAY_BUFFER, indices);
-    }
-
-    if (normals.size() > 0) {
-        _normalBuffer = GenerateBuffer<LA::vec3>(GL_ARRAY_BUFFER, normals);
-        glVertexAttribPointer(OpenGLAttribLocs::NORMAL, 3, GL_FLOAT, GL_FALSE, sizeof(LA::vec3), (void*)0);
-        glEnableVertexAttribArray(OpenGLAttribLocs::NORMAL);
-    }
-
-    if (tangents.size() > 0) {
-        _tangentBuffer = GenerateBuffer<LA::vec4>(GL_ARRAY_BUFFER, tangents);
-        glVertexAttribPointer(OpenGLAttribLocs::TANGENT, 4, GL_FLOAT, GL_FALSE, sizeof(LA::vec4), (void*)0);
-        glEnableVertexAttribArray(OpenGLAttribLocs::TANGENT);
-    }
-
-    if (colours.size() > 0) {
-        _colourBuffer = GenerateBuffer<LA::vec4>(GL_ARRAY_BUFFER, colours);
-        glVertexAttribPointer(OpenGLAttribLocs::COLOUR, 4, GL_FLOAT, GL_FALSE, sizeof(LA::vec4), (void*)0);
-        glEnableVertexAttribArray(OpenGLAttribLocs::COLOUR);
-    }
-
-    if (uv0.size() > 0) {
-        _uv0Buffer = GenerateBuffer<LA::vec2>(GL_ARRAY_BUFFER, uv0);
-        glVertexAttribPointer(OpenGLAttribLocs::UV0, 2, GL_FLOAT, GL_FALSE, sizeof(LA::vec2), (void*)0);
-        glEnableVertexAttribArray(OpenGLAttribLocs::UV0);
+        _drawCount = indices.size();
+        glGenBuffers(1, &_indexBuffer);
+        // element binding is recorded in the vao
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer);
+        FillBuffer(GL_ELEMENT_ARRAY_BUFFER, _memory.indexBytes, source, offset + _indexOffset,
+            data == nullptr ? nullptr : data + _indexOffset);
     }
 
-    if (uv1.size() > 0) {
-        _uv1Buffer = GenerateBuffer<LA::vec2>(GL_ARRAY_BUFFER, uv1);
-        glVertexAttribPointer(OpenGLAttribLocs::UV1, 2, GL_FLOAT, GL_FALSE, sizeof(LA::vec2), (void*)0);
-        glEnableVertexAttribArray(OpenGLAttribLocs::UV1);
-    }
+    glBindVertexArray(0);
+}
 
-    if (uv2.size() > 0) {
-        _uv2Buffer = GenerateBuffer<LA::vec2>(GL_ARRAY_BUFFER, uv2);
-        glVertexAttribPointer(OpenGLAttribLocs::UV2, 2, GL_FLOAT, GL_FALSE, sizeof(LA::vec2), (void*)0);
-        glEnableVertexAttribArray(OpenGLAttribLocs::UV2);
+void OpenGLMesh::Generate() {
+    if (_isGenerated) {
+        return;
     }
-
-    if (uv3.size() > 0) {
-        _uv3Buffer = GenerateBuffer<LA::vec2>(GL_ARRAY_BUFFER, uv3);
-        glVertexAttribPointer(OpenGLAttribLocs::UV3, 2, GL_FLOAT, GL_FALSE, sizeof(LA::vec2), (void*)0);
-        glEnableVertexAttribArray(OpenGLAttribLocs::UV3);
+    // drawn before the queue got to it, upload now instead
+    if (_uploadPending) {
+        OpenGLUploadQueue::Instance().Cancel(this);
     }
 
-    glBindVertexArray(0);
+    PrepareLayout();
+    std::vector<uint8_t> data(GetUploadSize());
+    WriteUpload(data.data());
+    CreateBuffers(0, 0, data.data());
 }
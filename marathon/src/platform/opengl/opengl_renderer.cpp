@@ -1,4 +1,9 @@
 #include "platform/opengl/opengl_renderer.hpp"
+#include "platform/opengl/opengl_upload_queue.hpp"
+#include "platform/opengl/opengl_gpu_timer.hpp"
+
+#include <cstring>
+#include <algorithm>
 
 void OpenGLRenderer::Boot() {
     std::cout << "DEBUG (OpenGLRenderer): Boot." << std::endl;
@@ -8,10 +13,184 @@ void OpenGLRenderer::Boot() {
         std::cerr << "OpenGL error: " << err << std::endl;
     }
     context = Context::Create();
+
+    // shared uniform blocks, offsets must respect the driver alignment
+    int alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    _lightBlockOffset = ((sizeof(CameraBlock) + alignment - 1) / alignment) * alignment;
+    _clusterBlockOffset = ((_lightBlockOffset + sizeof(LightBlock) + alignment - 1) / alignment) * alignment;
+    _shadowBlockOffset = ((_clusterBlockOffset + sizeof(ClusterBlock) + alignment - 1) / alignment) * alignment;
+    _frameUniformStaging.resize(_shadowBlockOffset + sizeof(ShadowBlock), 0);
+
+    glGenBuffers(1, &_frameUniformBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, _frameUniformBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, _frameUniformStaging.size(), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferRange(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, _frameUniformBuffer, 0, sizeof(CameraBlock));
+    glBindBufferRange(GL_UNIFORM_BUFFER, LIGHT_BLOCK_BINDING, _frameUniformBuffer, _lightBlockOffset, sizeof(LightBlock));
+    glBindBufferRange(GL_UNIFORM_BUFFER, CLUSTER_BLOCK_BINDING, _frameUniformBuffer, _clusterBlockOffset, sizeof(ClusterBlock));
+    glBindBufferRange(GL_UNIFORM_BUFFER, SHADOW_BLOCK_BINDING, _frameUniformBuffer, _shadowBlockOffset, sizeof(ShadowBlock));
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    _frameDataDirty = true;
+
+    // cluster lights, grid and indices as buffer textures, the textures stay attached as buffers are reallocated
+    const GLenum clusterFormats[3] = {GL_RGBA32F, GL_RG32UI, GL_R32UI};
+    glGenBuffers(3, _clusterBuffers);
+    glGenTextures(3, _clusterTextures);
+    for (int i = 0; i < 3; i++) {
+        glBindBuffer(GL_TEXTURE_BUFFER, _clusterBuffers[i]);
+        glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+        glBindTexture(GL_TEXTURE_BUFFER, _clusterTextures[i]);
+        glTexBuffer(GL_TEXTURE_BUFFER, clusterFormats[i], _clusterBuffers[i]);
+    }
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    _maxTextureBufferTexels = 65536;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &_maxTextureBufferTexels);
+
+    // per instance model matrices, sized on first use
+    glGenBuffers(1, &_instanceBuffer);
+    _instanceCapacity = 0;
+
+    // shadow atlas, sampled with hardware comparison so linear filtering gives 2x2 pcf per tap
+    glGenTextures(1, &_shadowAtlas);
+    glBindTexture(GL_TEXTURE_2D, _shadowAtlas);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, SHADOW_ATLAS_SIZE, SHADOW_ATLAS_SIZE, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &_shadowFrameBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, _shadowFrameBuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, _shadowAtlas, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "WARNING (OpenGLRenderer): Shadow atlas framebuffer is incomplete, shadows are off." << std::endl;
+        _shadows = false;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    _shadowMaps.Invalidate();
+
+    // the deferred lighting triangle is made from gl_VertexID, core profiles still want a vao bound
+    glGenVertexArrays(1, &_emptyVertexArray);
 }
 
 void OpenGLRenderer::Shutdown() {
     std::cout << "DEBUG (OpenGLRenderer): Shutdown." << std::endl;
+    glDeleteBuffers(1, &_frameUniformBuffer);
+    _frameUniformBuffer = 0;
+    glDeleteBuffers(1, &_instanceBuffer);
+    _instanceBuffer = 0;
+    glDeleteFramebuffers(1, &_shadowFrameBuffer);
+    _shadowFrameBuffer = 0;
+    glDeleteTextures(1, &_shadowAtlas);
+    _shadowAtlas = 0;
+    glDeleteVertexArrays(1, &_emptyVertexArray);
+    _emptyVertexArray = 0;
+    _gBuffer = nullptr;
+    glDeleteTextures(3, _clusterTextures);
+    glDeleteBuffers(3, _clusterBuffers);
+    for (int i = 0; i < 3; i++) {
+        _clusterTextures[i] = 0;
+        _clusterBuffers[i] = 0;
+    }
+    OpenGLUploadQueue::Instance().Shutdown();
+    OpenGLGpuTimer::Instance().Shutdown();
+}
+
+void OpenGLRenderer::UploadFrameData() {
+    if (!_frameDataDirty || _frameUniformBuffer == 0)
+        return;
+    BuildLightClusters();
+    std::memcpy(_frameUniformStaging.data(), &_cameraBlock, sizeof(CameraBlock));
+    std::memcpy(_frameUniformStaging.data() + _lightBlockOffset, &_lightBlock, sizeof(LightBlock));
+    std::memcpy(_frameUniformStaging.data() + _clusterBlockOffset, &_lightClusters.GetBlock(), sizeof(ClusterBlock));
+    std::memcpy(_frameUniformStaging.data() + _shadowBlockOffset, &_shadowBlock, sizeof(ShadowBlock));
+    glBindBuffer(GL_UNIFORM_BUFFER, _frameUniformBuffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, _frameUniformStaging.size(), _frameUniformStaging.data());
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    if (_clusteredLighting)
+        UploadClusters();
+    _frameDataDirty = false;
+}
+
+void OpenGLRenderer::UploadClusters() {
+    const std::vector<uint32_t>& grid = _lightClusters.GetGrid();
+    const std::vector<uint32_t>& indices = _lightClusters.GetIndices();
+    if (indices.size() > (size_t)_maxTextureBufferTexels || _clusterLights.size() * 4 > (size_t)_maxTextureBufferTexels) {
+        static bool warned = false;
+        if (!warned)
+            std::cout << "WARNING (OpenGLRenderer): Cluster buffers exceed GL_MAX_TEXTURE_BUFFER_SIZE, lights will be missing." << std::endl;
+        warned = true;
+    }
+    const void* data[3] = {_clusterLights.data(), grid.data(), indices.data()};
+    size_t bytes[3] = {_clusterLights.size() * sizeof(ClusterLightData), grid.size() * sizeof(uint32_t), indices.size() * sizeof(uint32_t)};
+    for (int i = 0; i < 3; i++) {
+        // orphan every frame, last frame's lists may still be in use
+        glBindBuffer(GL_TEXTURE_BUFFER, _clusterBuffers[i]);
+        glBufferData(GL_TEXTURE_BUFFER, std::max(bytes[i], (size_t)16), nullptr, GL_STREAM_DRAW);
+        if (bytes[i] > 0)
+            glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes[i], data[i]);
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void OpenGLRenderer::BindClusters() {
+    const uint32_t units[3] = {CLUSTER_LIGHTS_UNIT, CLUSTER_GRID_UNIT, CLUSTER_INDICES_UNIT};
+    for (int i = 0; i < 3; i++) {
+        glActiveTexture(GL_TEXTURE0 + units[i]);
+        glBindTexture(GL_TEXTURE_BUFFER, _clusterTextures[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void OpenGLRenderer::DrawShadows(const Shader* shader) {
+    if (_shadowFrameBuffer == 0)
+        return;
+    PROFILE_GPU_SCOPE("Shadows");
+    // a view with a caster that isn't resident yet is drawn without it and redrawn once it is
+    const std::vector<ShadowView>& views = _shadowMaps.GetViews();
+    for (const ShadowBatch& batch : _shadowBatches) {
+        if (batch.mesh->IsUsable())
+            continue;
+        batch.mesh->RequestUpload();
+        _shadowMaps.Invalidate(views[batch.view].slot);
+    }
+    UploadInstances(_shadowInstances);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, _shadowFrameBuffer);
+    glEnable(GL_SCISSOR_TEST);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(SHADOW_POLYGON_OFFSET_FACTOR, SHADOW_POLYGON_OFFSET_UNITS);
+    DrawMode drawMode = context->GetDrawMode();
+    if (drawMode != DrawMode::FILL)
+        context->SetDrawMode(DrawMode::FILL);
+    DrawShadowBatches(shader);
+    if (drawMode != DrawMode::FILL)
+        context->SetDrawMode(drawMode);
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glDisable(GL_SCISSOR_TEST);
+    BindTarget();
+}
+
+void OpenGLRenderer::BeginShadowView(const ShadowView& view) {
+    // every dirty view starts empty, views nothing casts into stay that way
+    glViewport(view.x, view.y, view.size, view.size);
+    glScissor(view.x, view.y, view.size, view.size);
+    glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void OpenGLRenderer::BindTarget() {
+    if (_frameBuffer)
+        _frameBuffer->Bind();
+    else {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, (int)_cameraBlock.resolution[0], (int)_cameraBlock.resolution[1]);
+    }
 }
 
 void OpenGLRenderer::SetFrameBuffer(std::shared_ptr<FrameBuffer> fb) {
@@ -28,6 +207,8 @@ std::shared_ptr<FrameBuffer> OpenGLRenderer::GetFrameBuffer() {
 
 void OpenGLRenderer::SetProjection(const LA::mat4& proj) {
     _projection = proj;
+    _cameraBlock.projection = proj;
+    _frameDataDirty = true;
 }
 
 LA::mat4 OpenGLRenderer::GetProjection() {
@@ -36,6 +217,8 @@ LA::mat4 OpenGLRenderer::GetProjection() {
 
 void OpenGLRenderer::SetView(const LA::mat4& view) {
     _view = view;
+    _cameraBlock.view = view;
+    _frameDataDirty = true;
 }
 
 LA::mat4 OpenGLRenderer::GetView() {
@@ -43,6 +226,7 @@ LA::mat4 OpenGLRenderer::GetView() {
 }
 
 void OpenGLRenderer::Clear() {
+    PROFILE_GPU_SCOPE("Clear");
     if (_frameBuffer)
         _frameBuffer->Clear();
     else
@@ -54,11 +238,164 @@ void OpenGLRenderer::RenderMesh(std::shared_ptr<Shader> shader, std::shared_ptr<
         std::cout << "ERROR (OpenGLRenderer): Attempting to render with null shader or mesh" << std::endl;
         return;
     }
+    UploadFrameData();
     shader->Bind();
+    // shaders without the camera block still get loose matrices
     shader->SetMat4("uView", _view);
     shader->SetMat4("uProjection", _projection);
     shader->SetMat4("uModel", transform);
+    mesh->Bind();
     mesh->Draw();
+    mesh->Unbind();
+    _stats.programBinds++;
+    _stats.vaoBinds++;
+    _stats.uniformUploads += 3;
+    _stats.draws++;
+    _stats.triangles += mesh->GetTriangleCount();
+}
+
+void OpenGLRenderer::UploadInstances(const std::vector<LA::mat4>& instances) {
+    if (instances.empty())
+        return;
+    size_t bytes = instances.size() * sizeof(LA::mat4);
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffer);
+    // grow with headroom, otherwise orphan so the driver need not wait on last frame
+    if (bytes > _instanceCapacity)
+        _instanceCapacity = bytes + bytes / 2;
+    glBufferData(GL_ARRAY_BUFFER, _instanceCapacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void OpenGLRenderer::BindInstanceAttributes(uint32_t instanceOffset) {
+    // GL 3.3 has no base instance, so re-point the bound vao at this batch
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffer);
+    size_t base = instanceOffset * sizeof(LA::mat4);
+    for (uint32_t column = 0; column < 4; column++) {
+        uint32_t loc = OpenGLAttribLocs::INSTANCE_MODEL + column;
+        glEnableVertexAttribArray(loc);
+        glVertexAttribPointer(loc, 4, GL_FLOAT, GL_FALSE, sizeof(LA::mat4), (void*)(base + column * sizeof(LA::vec4)));
+        glVertexAttribDivisor(loc, 1);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void OpenGLRenderer::UnbindInstanceAttributes() {
+    for (uint32_t column = 0; column < 4; column++) {
+        uint32_t loc = OpenGLAttribLocs::INSTANCE_MODEL + column;
+        glVertexAttribDivisor(loc, 0);
+        glDisableVertexAttribArray(loc);
+    }
+}
+
+void OpenGLRenderer::Flush() {
+    if (_queue.empty())
+        return;
+    PROFILE_SCOPE("Flush");
+    {
+        PROFILE_SCOPE("Sort");
+        UploadFrameData();
+        SortQueue();
+        BuildBatches();
+        UploadInstances(_instanceStaging);
+        if (_clusteredLighting)
+            BindClusters();
+        glActiveTexture(GL_TEXTURE0 + SHADOW_ATLAS_UNIT);
+        glBindTexture(GL_TEXTURE_2D, _shadowAtlas);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // meshes not yet on the GPU queue up, whatever fits this frame's budget lands before drawing
+    OpenGLUploadQueue& uploads = OpenGLUploadQueue::Instance();
+    {
+        PROFILE_GPU_SCOPE("Uploads");
+        for (const DrawBatch& batch : _batches) {
+            Mesh* mesh = _queue[_order[batch.first]].mesh;
+            if (!mesh->IsUsable())
+                mesh->RequestUpload();
+        }
+        uploads.Process();
+    }
+    _stats.uploadBytes += uploads.GetStats().bytes;
+    _stats.uploadsPending = uploads.GetStats().pending;
+
+    DrawState state;
+    state.drawMode = context->GetDrawMode();
+    bool deferred = IsDeferredFlush();
+    if (deferred) {
+        PROFILE_GPU_SCOPE("G-Buffer");
+        BeginGBuffer();
+        DrawBatches(true, deferred, state);
+    }
+    if (deferred) {
+        PROFILE_GPU_SCOPE("Lighting");
+        LightGBuffer(state);
+    }
+    {
+        PROFILE_GPU_SCOPE("Draw");
+        DrawBatches(false, deferred, state);
+    }
+
+    if (state.mesh)
+        state.mesh->Unbind();
+    _queue.clear();
+}
+
+void OpenGLRenderer::IssueDraw(const DrawCall& draw, const DrawState& state) {
+    if (!draw.instanced) {
+        draw.mesh->Draw(draw.lod);
+        return;
+    }
+    BindInstanceAttributes(draw.instanceOffset);
+    draw.mesh->DrawInstanced(draw.count, draw.lod);
+    UnbindInstanceAttributes();
+}
+
+void OpenGLRenderer::BeginGBuffer() {
+    int width = std::max(_frameBuffer ? _frameBuffer->GetWidth() : (int)_cameraBlock.resolution[0], 1);
+    int height = std::max(_frameBuffer ? _frameBuffer->GetHeight() : (int)_cameraBlock.resolution[1], 1);
+    if (!_gBuffer) {
+        FrameBufferSpec spec;
+        spec.colour = {FrameBufferFormat::RGBA8, FrameBufferFormat::RG16F};
+        _gBuffer = std::make_shared<OpenGLFrameBuffer>("G-Buffer", width, height, spec);
+    } else if (width != _gBuffer->GetWidth() || height != _gBuffer->GetHeight()) {
+        _gBuffer->Resize(width, height);
+    }
+    _gBuffer->Bind();
+    _gBuffer->Clear();
+}
+
+void OpenGLRenderer::ResolveGBuffer() {
+    // forward packets drawn after lighting are depth tested against the G-buffer's surfaces
+    int width = _gBuffer->GetWidth();
+    int height = _gBuffer->GetHeight();
+    BindTarget();
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, _gBuffer->GetId());
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    BindTarget();
+
+    const uint32_t units[3] = {GBUFFER_ALBEDO_UNIT, GBUFFER_NORMAL_UNIT, GBUFFER_DEPTH_UNIT};
+    const uint32_t textures[3] = {_gBuffer->GetColourAttachment(0), _gBuffer->GetColourAttachment(1), _gBuffer->GetDepthStencilAttachment()};
+    for (int i = 0; i < 3; i++) {
+        glActiveTexture(GL_TEXTURE0 + units[i]);
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void OpenGLRenderer::DrawLightingPass(const DrawState& state) {
+    // one write per pixel, the surfaces were already depth tested into the G-buffer
+    bool depthTesting = context->IsDepthTesting();
+    glDisable(GL_DEPTH_TEST);
+    glBindVertexArray(_emptyVertexArray);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    if (depthTesting)
+        glEnable(GL_DEPTH_TEST);
+}
+
+void OpenGLRenderer::EndFrame() {
+    OpenGLGpuTimer::Instance().EndFrame();
 }
 
 Renderer& OpenGLRenderer::Instance() {
@@ -1,12 +1,25 @@
 #include "platform/opengl/opengl_shader.hpp"
 
-OpenGLShader::OpenGLShader(std::string name, std::shared_ptr<ShaderSource> vs, std::shared_ptr<ShaderSource> fs)
-    : Shader(name, vs, fs) {
+#define SHADER_CACHE_MAGIC 0x4D505247u
+
+static bool IsProgramBinarySupported() {
+    if (!GLEW_ARB_get_program_binary || !DerivedDataCache::Instance().IsEnabled())
+        return false;
+    int formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+OpenGLShader::OpenGLShader(std::string name, std::shared_ptr<ShaderSource> vs, std::shared_ptr<ShaderSource> fs, std::shared_ptr<ShaderSource> gs)
+    : Shader(name, vs, fs, gs) {
     Compile();
 }
 
 OpenGLShader::~OpenGLShader() {
-    glDeleteProgram(_programId);
+    for (uint32_t& program : _programIds) {
+        glDeleteProgram(program);
+        program = 0;
+    }
 }
 
 bool OpenGLShader::IsUsable() const {
@@ -15,6 +28,12 @@ bool OpenGLShader::IsUsable() const {
 
 void OpenGLShader::Compile() {
     _validShader = false;
+    _uniformToHandle.clear();
+    for (uint32_t v = 0; v < SHADER_VARIANT_COUNT; v++) {
+        _locations[v].clear();
+        glDeleteProgram(_programIds[v]);
+        _programIds[v] = 0;
+    }
     if (vs == nullptr) {
         std::cout << "WARNING (Shader): Can't compile shader with null vertex shader source." << std::endl;
         return;
@@ -28,61 +47,303 @@ void OpenGLShader::Compile() {
         return;
     }
 
+    _programIds[(int)ShaderVariant::DEFAULT] = LinkProgram({});
+    if (_programIds[(int)ShaderVariant::DEFAULT] == 0)
+        return;
+
+    // success
+    _validShader = true;
+    ReflectUniforms(ShaderVariant::DEFAULT);
+    BindUniformBlocks(_programIds[(int)ShaderVariant::DEFAULT]);
+
+    // optional variants, a failure here leaves the default usable
+    for (uint32_t v = 1; v < SHADER_VARIANT_COUNT; v++) {
+        ShaderVariant variant = (ShaderVariant)v;
+        if (!SourcesMention(variant))
+            continue;
+        bool geometry = (uint8_t)variant & (uint8_t)ShaderVariant::WIREFRAME;
+        _programIds[v] = LinkProgram(GetVariantDefines(variant), geometry);
+        if (_programIds[v] != 0) {
+            ReflectUniforms(variant);
+            BindUniformBlocks(_programIds[v]);
+        }
+    }
+}
+
+uint32_t OpenGLShader::LinkProgram(const std::vector<std::string>& defines, bool geometry) {
+    // try the cached binary first, its sources still had to be read to hash them
+    uint64_t key = GetProgramKey(defines, geometry);
+    uint32_t cached = LoadProgramBinary(key);
+    if (cached != 0)
+        return cached;
+
     // compile vertex shader
     uint32_t vertex = 0;
     try {
-        vertex = vs->Compile();
+        vertex = vs->Compile(defines);
     } catch (const char* err) {
         std::cout << "Error (OpenGLShader): VERTEX shader compile failed:" << std::endl;
         std::cout << vs->name << std::endl;
         std::cout << err << std::endl;
-        return;
+        return 0;
     }
 
     // compile fragment shader
     uint32_t fragment = 0;
     try {
-        fragment = fs->Compile();
+        fragment = fs->Compile(defines);
     } catch (const char* err) {
         std::cout << "Error (OpenGLShader): FRAGMENT shader compile failed:" << std::endl;
         std::cout << fs->name << std::endl;
         std::cout << err << std::endl;
-        return;
+        glDeleteShader(vertex);
+        return 0;
+    }
+
+    // compile geometry shader
+    uint32_t geom = 0;
+    if (geometry) {
+        try {
+            geom = gs->Compile(defines);
+        } catch (const char* err) {
+            std::cout << "Error (OpenGLShader): GEOMETRY shader compile failed:" << std::endl;
+            std::cout << gs->name << std::endl;
+            std::cout << err << std::endl;
+            glDeleteShader(vertex);
+            glDeleteShader(fragment);
+            return 0;
+        }
     }
 
     // link shader program
-    _programId = glCreateProgram();
-    glAttachShader(_programId, vertex);
-    glAttachShader(_programId, fragment);
-    glBindFragDataLocation(_programId, 0, "oColour");
-    glLinkProgram(_programId);
+    uint32_t program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    if (geom != 0)
+        glAttachShader(program, geom);
+    glBindFragDataLocation(program, 0, "oColour");
+    if (IsProgramBinarySupported())
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(program);
 
     // free shaders as they are copied on linking
     glDeleteShader(vertex);
     glDeleteShader(fragment);
+    if (geom != 0)
+        glDeleteShader(geom);
 
     // validate shader program correct
     int success;
     static char infoLog[1024];
-    glGetProgramiv(_programId, GL_LINK_STATUS, &success);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
     if (!success) {
-        glGetProgramInfoLog(_programId, 1024, NULL, infoLog);
+        glGetProgramInfoLog(program, 1024, NULL, infoLog);
         std::cout << "Error (OpenGLShader): Shader program linking failed:" << std::endl;
         std::cout << name << std::endl;
         std::cout << infoLog << std::endl;
+        glDeleteProgram(program);
+        return 0;
+    }
+    SaveProgramBinary(program, key);
+    return program;
+}
+
+uint64_t OpenGLShader::GetProgramKey(const std::vector<std::string>& defines, bool geometry) const {
+    // binaries are only valid for the driver that produced them
+    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    std::string driver = std::string(renderer ? renderer : "") + "|" + (version ? version : "");
+
+    uint64_t key = HashBytes(driver.data(), driver.size(), SHADER_CACHE_VERSION);
+    key = HashBytes(vs->source.data(), vs->source.size(), key);
+    key = HashBytes(fs->source.data(), fs->source.size(), key);
+    if (geometry)
+        key = HashBytes(gs->source.data(), gs->source.size(), key);
+    for (const std::string& define : defines)
+        key = HashBytes(define.data(), define.size(), key);
+    return key;
+}
+
+uint32_t OpenGLShader::LoadProgramBinary(uint64_t key) const {
+    if (!IsProgramBinarySupported())
+        return 0;
+    DerivedDataCache& cache = DerivedDataCache::Instance();
+    MappedFile file;
+    if (!cache.Map(SHADER_CACHE_BUCKET, key, file))
+        return 0;
+
+    BlobReader reader(file.Data(), file.Size());
+    uint32_t magic = 0;
+    GLenum format = 0;
+    uint64_t length = 0;
+    const uint8_t* binary = nullptr;
+    if (reader.Read(magic) && magic == SHADER_CACHE_MAGIC && reader.Read(format) && reader.Read(length))
+        binary = reader.Skip(length);
+    if (binary == nullptr || reader.Remaining() != 0) {
+        std::cout << "WARNING (OpenGLShader): Ignoring corrupt program cache entry for " << name << std::endl;
+        cache.Reject(SHADER_CACHE_BUCKET, key);
+        return 0;
+    }
+
+    uint32_t program = glCreateProgram();
+    glProgramBinary(program, format, binary, (GLsizei)length);
+    int success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        // drivers may refuse binaries after an update even with matching strings
+        glDeleteProgram(program);
+        cache.Reject(SHADER_CACHE_BUCKET, key);
+        return 0;
+    }
+    return program;
+}
+
+void OpenGLShader::SaveProgramBinary(uint32_t program, uint64_t key) const {
+    if (!IsProgramBinarySupported())
+        return;
+    int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
         return;
+    std::vector<uint8_t> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    binary.resize(length);
+
+    BlobWriter writer;
+    writer.Write<uint32_t>(SHADER_CACHE_MAGIC);
+    writer.Write(format);
+    writer.WriteVector(binary);
+    DerivedDataCache::Instance().Put(SHADER_CACHE_BUCKET, key, writer.Data().data(), writer.Data().size());
+}
+
+void OpenGLShader::BindUniformBlocks(uint32_t program) {
+    // attach shared blocks to their fixed binding points if the program declares them
+    uint32_t camera = glGetUniformBlockIndex(program, CAMERA_BLOCK_NAME);
+    if (camera != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, camera, CAMERA_BLOCK_BINDING);
+    uint32_t lights = glGetUniformBlockIndex(program, LIGHT_BLOCK_NAME);
+    if (lights != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, lights, LIGHT_BLOCK_BINDING);
+    uint32_t clusters = glGetUniformBlockIndex(program, CLUSTER_BLOCK_NAME);
+    if (clusters != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, clusters, CLUSTER_BLOCK_BINDING);
+    uint32_t shadows = glGetUniformBlockIndex(program, SHADOW_BLOCK_NAME);
+    if (shadows != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, shadows, SHADOW_BLOCK_BINDING);
+
+    // cluster buffers, the shadow atlas and the G-buffer sit on fixed units too, samplers keep their unit for the program's life
+    const std::pair<const char*, int> samplers[] = {
+        {CLUSTER_LIGHTS_SAMPLER, CLUSTER_LIGHTS_UNIT},
+        {CLUSTER_GRID_SAMPLER, CLUSTER_GRID_UNIT},
+        {CLUSTER_INDICES_SAMPLER, CLUSTER_INDICES_UNIT},
+        {SHADOW_ATLAS_SAMPLER, SHADOW_ATLAS_UNIT},
+        {GBUFFER_ALBEDO_SAMPLER, GBUFFER_ALBEDO_UNIT},
+        {GBUFFER_NORMAL_SAMPLER, GBUFFER_NORMAL_UNIT},
+        {GBUFFER_DEPTH_SAMPLER, GBUFFER_DEPTH_UNIT}
+    };
+    glUseProgram(program);
+    for (const auto& [sampler, unit] : samplers) {
+        int32_t location = glGetUniformLocation(program, sampler);
+        if (location >= 0)
+            glUniform1i(location, unit);
     }
+    glUseProgram(0);
+}
 
-    // success
-    _validShader = true;
+void OpenGLShader::ReflectUniforms(ShaderVariant variant) {
+    uint32_t program = _programIds[(int)variant];
+    int count = 0;
+    int maxLength = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> buffer(maxLength + 1, 0);
+
+    for (int i = 0; i < count; i++) {
+        int length = 0;
+        int size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, i, buffer.size(), &length, &size, &type, buffer.data());
+        std::string name(buffer.data(), length);
+        int32_t location = glGetUniformLocation(program, name.c_str());
+        // uniform block members have no location
+        if (location < 0)
+            continue;
+        AddUniform(name, variant, location);
+
+        // arrays of basic types are reported once as "name[0]"
+        // expose the bare name and every element
+        size_t bracket = name.rfind("[0]");
+        if (size > 1 && bracket != std::string::npos && bracket + 3 == name.size()) {
+            std::string base = name.substr(0, bracket);
+            AddUniform(base, variant, location);
+            for (int j = 1; j < size; j++) {
+                std::string element = base + "[" + std::to_string(j) + "]";
+                AddUniform(element, variant, glGetUniformLocation(program, element.c_str()));
+            }
+        }
+    }
+}
+
+void OpenGLShader::AddUniform(const std::string& name, ShaderVariant variant, int32_t location) {
+    auto it = _uniformToHandle.find(name);
+    int32_t index = 0;
+    if (it == _uniformToHandle.end()) {
+        index = (int32_t)_uniformToHandle.size();
+        _uniformToHandle.emplace(name, index);
+        // every variant gets a slot, -1 where the variant lacks the uniform
+        for (std::vector<int32_t>& locations : _locations)
+            locations.resize(index + 1, -1);
+    } else {
+        index = it->second;
+    }
+    _locations[(int)variant][index] = location;
+}
+
+int32_t OpenGLShader::GetLocation(const std::string& name) const {
+    auto it = _uniformToHandle.find(name);
+    if (it == _uniformToHandle.end())
+        return -1;
+    return _locations[(int)_boundVariant][it->second];
+}
+
+int32_t OpenGLShader::GetLocation(UniformHandle h) const {
+    const std::vector<int32_t>& locations = _locations[(int)_boundVariant];
+    if (h.index < 0 || h.index >= (int32_t)locations.size())
+        return -1;
+    return locations[h.index];
+}
+
+size_t OpenGLShader::GetUniformCount() const {
+    return _uniformToHandle.size();
+}
+
+UniformHandle OpenGLShader::Locate(const std::string& name) const {
+    auto it = _uniformToHandle.find(name);
+    if (it == _uniformToHandle.end())
+        return UniformHandle();
+    return UniformHandle{it->second};
 }
 
 void OpenGLShader::Bind() const {
+    Bind(ShaderVariant::DEFAULT);
+}
+
+void OpenGLShader::Bind(ShaderVariant variant) const {
     if (!IsUsable()) {
         std::cout << "WARNING (OpenGLShader): Cannot bind invalid shader." << std::endl;
         return;
     }
-    glUseProgram(_programId);
+    if (!HasVariant(variant)) {
+        std::cout << "WARNING (OpenGLShader): Shader has no such variant, binding default." << std::endl;
+        variant = ShaderVariant::DEFAULT;
+    }
+    glUseProgram(_programIds[(int)variant]);
+    _boundVariant = variant;
+}
+
+bool OpenGLShader::HasVariant(ShaderVariant variant) const {
+    return _validShader && _programIds[(int)variant] != 0;
 }
 
 void OpenGLShader::Unbind() const {
@@ -90,65 +351,157 @@ void OpenGLShader::Unbind() const {
 }
 
 void OpenGLShader::SetBool(const std::string& name, bool value) const {
-    glUniform1i(glGetUniformLocation(_programId, name.c_str()), value);
+    int32_t loc = GetLocation(name);
+    if (loc >= 0)
+        glUniform1i(loc, value);
 }
 
 void OpenGLShader::SetInt(const std::string& name, int value) const {
-    glUniform1i(glGetUniformLocation(_programId, name.c_str()), value);
+    int32_t loc = GetLocation(name);
+    if (loc >= 0)
+        glUniform1i(loc, value);
 }
 
 void OpenGLShader::SetUint(const std::string& name, uint32_t value) const {
-    glUniform1ui(glGetUniformLocation(_programId, name.c_str()), value);
+    int32_t loc = GetLocation(name);
+    if (loc >= 0)
+        glUniform1ui(loc, value);
 }
 
 void OpenGLShader::SetFloat(const std::string& name, float value) const {
-    glUniform1f(glGetUniformLocation(_programId, name.c_str()), value);
+    int32_t loc = GetLocation(name);
+    if (loc >= 0)
+        glUniform1f(loc, value);
 }
 
 void OpenGLShader::SetVec2(const std::string& name, const LA::vec2& v) const {
-    glUniform2f(glGetUniformLocation(_programId, name.c_str()), v.x, v.y);
+    int32_t loc = GetLocation(name);
+    if (loc >= 0)
+        glUniform2f(loc, v.x, v.y);
 }
 
 void OpenGLShader::SetVec2(const std::string& name, float x, float y) const {
-    glUniform2f(glGetUniformLocation(_programId, name.c_str()), x, y);
+    int32_t loc = GetLocation(name);
+    if (loc >= 0)
+        glUniform2f(loc, x, y);
 }
 
 void OpenGLShader::SetVec3(const std::string& name, const LA::vec3& v) const {
-    glUniform3f(glGetUniformLocation(_programId, name.c_str()), v.x, v.y, v.z);
+    int32_t loc = GetLocation(name);
+    if (loc >= 0)
+        glUniform3f(loc, v.x, v.y, v.z);
 }
 
 void OpenGLShader::SetVec3(const std::string& name, float x, float y, float z) const {
-    glUniform3f(glGetUniformLocation(_programId, name.c_str()), x, y, z);
+    int32_t loc = GetLocation(name);
+    if (loc >= 0)
+        glUniform3f(loc, x, y, z);
 }
 
 void OpenGLShader::SetVec4(const std::string& name, const LA::vec4& v) const {
-    glUniform4f(glGetUniformLocation(_programId, name.c_str()), v.x, v.y, v.z, v.w);
+    int32_t loc = GetLocation(name);
+    if (loc >= 0)
+        glUniform4f(loc, v.x, v.y, v.z, v.w);
 }
 
 void OpenGLShader::SetVec4(const std::string& name, float x, float y, float z, float w) const {
-    glUniform4f(glGetUniformLocation(_programId, name.c_str()), x, y, z, w);
+    int32_t loc = GetLocation(name);
+    if (loc >= 0)
+        glUniform4f(loc, x, y, z, w);
 }
 
 void OpenGLShader::SetMat2(const std::string& name, const LA::mat2& m) const {
-    glUniformMatrix2fv(glGetUniformLocation(_programId, name.c_str()), 1, GL_FALSE, &(m)[0][0]);
+    int32_t loc = GetLocation(name);
+    if (loc >= 0)
+        glUniformMatrix2fv(loc, 1, GL_FALSE, &(m)[0][0]);
 }
 
 void OpenGLShader::SetMat2(const std::string& name, float* mPtr) const {
-    glUniformMatrix2fv(glGetUniformLocation(_programId, name.c_str()), 1, GL_FALSE, mPtr);
+    int32_t loc = GetLocation(name);
+    if (loc >= 0)
+        glUniformMatrix2fv(loc, 1, GL_FALSE, mPtr);
 }
 
 void OpenGLShader::SetMat3(const std::string& name, const LA::mat3& m) const {
-    glUniformMatrix3fv(glGetUniformLocation(_programId, name.c_str()), 1, GL_FALSE, &(m)[0][0]);
+    int32_t loc = GetLocation(name);
+    if (loc >= 0)
+        glUniformMatrix3fv(loc, 1, GL_FALSE, &(m)[0][0]);
 }
 
 void OpenGLShader::SetMat3(const std::string& name, float* mPtr) const {
-    glUniformMatrix3fv(glGetUniformLocation(_programId, name.c_str()), 1, GL_FALSE, mPtr);
+    int32_t loc = GetLocation(name);
+    if (loc >= 0)
+        glUniformMatrix3fv(loc, 1, GL_FALSE, mPtr);
 }
 
 void OpenGLShader::SetMat4(const std::string& name, const LA::mat4& m) const {
-    glUniformMatrix4fv(glGetUniformLocation(_programId, name.c_str()), 1, GL_FALSE, &(m)[0][0]);
+    int32_t loc = GetLocation(name);
+    if (loc >= 0)
+        glUniformMatrix4fv(loc, 1, GL_FALSE, &(m)[0][0]);
 }
 
 void OpenGLShader::SetMat4(const std::string& name, float* mPtr) const {
-    glUniformMatrix4fv(glGetUniformLocation(_programId, name.c_str()), 1, GL_FALSE, mPtr);
+    int32_t loc = GetLocation(name);
+    if (loc >= 0)
+        glUniformMatrix4fv(loc, 1, GL_FALSE, mPtr);
+}
+
+void OpenGLShader::SetBool(UniformHandle h, bool value) const {
+    int32_t loc = GetLocation(h);
+    if (loc >= 0)
+        glUniform1i(loc, value);
+}
+
+void OpenGLShader::SetInt(UniformHandle h, int value) const {
+    int32_t loc = GetLocation(h);
+    if (loc >= 0)
+        glUniform1i(loc, value);
+}
+
+void OpenGLShader::SetUint(UniformHandle h, uint32_t value) const {
+    int32_t loc = GetLocation(h);
+    if (loc >= 0)
+        glUniform1ui(loc, value);
+}
+
+void OpenGLShader::SetFloat(UniformHandle h, float value) const {
+    int32_t loc = GetLocation(h);
+    if (loc >= 0)
+        glUniform1f(loc, value);
+}
+
+void OpenGLShader::SetVec2(UniformHandle h, const LA::vec2& v) const {
+    int32_t loc = GetLocation(h);
+    if (loc >= 0)
+        glUniform2f(loc, v.x, v.y);
+}
+
+void OpenGLShader::SetVec3(UniformHandle h, const LA::vec3& v) const {
+    int32_t loc = GetLocation(h);
+    if (loc >= 0)
+        glUniform3f(loc, v.x, v.y, v.z);
+}
+
+void OpenGLShader::SetVec4(UniformHandle h, const LA::vec4& v) const {
+    int32_t loc = GetLocation(h);
+    if (loc >= 0)
+        glUniform4f(loc, v.x, v.y, v.z, v.w);
+}
+
+void OpenGLShader::SetMat2(UniformHandle h, const LA::mat2& m) const {
+    int32_t loc = GetLocation(h);
+    if (loc >= 0)
+        glUniformMatrix2fv(loc, 1, GL_FALSE, &(m)[0][0]);
+}
+
+void OpenGLShader::SetMat3(UniformHandle h, const LA::mat3& m) const {
+    int32_t loc = GetLocation(h);
+    if (loc >= 0)
+        glUniformMatrix3fv(loc, 1, GL_FALSE, &(m)[0][0]);
+}
+
+void OpenGLShader::SetMat4(UniformHandle h, const LA::mat4& m) const {
+    int32_t loc = GetLocation(h);
+    if (loc >= 0)
+        glUniformMatrix4fv(loc, 1, GL_FALSE, &(m)[0][0]);
 }
@@ -13,10 +13,30 @@ const std::map<ShaderStage, GLenum> OpenGLShaderSource::_stageToGL = {
 OpenGLShaderSource::OpenGLShaderSource(const std::string& name, const std::string& source, ShaderStage stage)
     : ShaderSource(name, source, stage) {}
 
-uint32_t OpenGLShaderSource::Compile() {
+uint32_t OpenGLShaderSource::Compile(const std::vector<std::string>& defines) {
+    // #version must stay the first line, so defines go straight after it
+    std::string variant = source;
+    if (!defines.empty()) {
+        std::string block = "";
+        for (const std::string& define : defines)
+            block += "#define " + define + "\n";
+        size_t insert = 0;
+        size_t version = variant.find("#version");
+        if (version != std::string::npos) {
+            size_t eol = variant.find('\n', version);
+            if (eol == std::string::npos) {
+                insert = variant.size();
+                block = "\n" + block;
+            } else {
+                insert = eol + 1;
+            }
+        }
+        variant.insert(insert, block);
+    }
+
     // create and attempt to compile shader from source
     uint32_t shader = glCreateShader(_stageToGL.at(stage));
-    const GLchar* sourceCStr = source.c_str();
+    const GLchar* sourceCStr = variant.c_str();
     glShaderSource(shader, 1, &sourceCStr, NULL);
     glCompileShader(shader);
 
@@ -0,0 +1,147 @@
+#include "platform/opengl/opengl_texture.hpp"
+#include "platform/opengl/opengl_upload_queue.hpp"
+#include "renderer/texture_compression.hpp"
+
+#include <cstring>
+
+static void GetFormats(TextureFormat format, bool srgb, GLint& internalFormat, GLenum& pixelFormat, GLenum& type) {
+    type = TextureFormatIsFloat(format) ? GL_FLOAT : GL_UNSIGNED_BYTE;
+    switch (format) {
+        case TextureFormat::R8:      internalFormat = GL_R8;      pixelFormat = GL_RED;  break;
+        case TextureFormat::RG8:     internalFormat = GL_RG8;     pixelFormat = GL_RG;   break;
+        case TextureFormat::RGB8:    internalFormat = srgb ? GL_SRGB8 : GL_RGB8; pixelFormat = GL_RGB; break;
+        case TextureFormat::RGBA8:   internalFormat = srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8; pixelFormat = GL_RGBA; break;
+        case TextureFormat::R32F:    internalFormat = GL_R32F;    pixelFormat = GL_RED;  break;
+        case TextureFormat::RG32F:   internalFormat = GL_RG32F;   pixelFormat = GL_RG;   break;
+        case TextureFormat::RGB32F:  internalFormat = GL_RGB32F;  pixelFormat = GL_RGB;  break;
+        case TextureFormat::RGBA32F: internalFormat = GL_RGBA32F; pixelFormat = GL_RGBA; break;
+        // pixel format and type are unused for compressed uploads
+        case TextureFormat::BC1:     internalFormat = srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT; pixelFormat = GL_RGB; break;
+        case TextureFormat::BC3:     internalFormat = srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; pixelFormat = GL_RGBA; break;
+        case TextureFormat::BC4:     internalFormat = GL_COMPRESSED_RED_RGTC1; pixelFormat = GL_RED; break;
+        case TextureFormat::BC5:     internalFormat = GL_COMPRESSED_RG_RGTC2;  pixelFormat = GL_RG;  break;
+    }
+}
+
+OpenGLTexture::OpenGLTexture(std::string name)
+    : Texture(name) {}
+
+OpenGLTexture::~OpenGLTexture() {
+    if (_uploadPending) {
+        OpenGLUploadQueue::Instance().Cancel(this);
+    }
+    if (_texture != 0) {
+        glDeleteTextures(1, &_texture);
+    }
+}
+
+bool OpenGLTexture::IsUsable() {
+    return _isGenerated;
+}
+
+void OpenGLTexture::RequestUpload() {
+    if (_isGenerated || _uploadPending) {
+        return;
+    }
+    if (mips.empty() || width == 0 || height == 0) {
+        std::cout << "WARNING (OpenGLTexture): No pixels to upload for '" << name << "'." << std::endl;
+        return;
+    }
+
+    // RGTC is core, S3TC is an extension albeit a near universal one
+    if ((format == TextureFormat::BC1 || format == TextureFormat::BC3) && !GLEW_EXT_texture_compression_s3tc) {
+        std::cout << "WARNING (OpenGLTexture): No S3TC support, decompressing '" << name << "'." << std::endl;
+        DecompressMipChain(mips, width, height, format);
+    }
+
+    _memory = GetMipChainMemory(mips, width, height, format);
+
+    _uploadPending = true;
+    _levelCount = mips.size();
+    _levelsUploaded = 0;
+    OpenGLUploadQueue& uploads = OpenGLUploadQueue::Instance();
+    for (uint32_t level = 0; level < _levelCount; level++) {
+        UploadJob job;
+        job.owner = this;
+        job.bytes = mips[level].size();
+        job.fill = [this, level](uint8_t* dst) {
+            std::memcpy(dst, mips[level].data(), mips[level].size());
+        };
+        job.finish = [this, level](GLuint source, size_t offset, const uint8_t* data) {
+            UploadLevel(level, source, offset, data);
+        };
+        uploads.Enqueue(std::move(job));
+    }
+}
+
+void OpenGLTexture::Bind(uint32_t unit) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    if (!_isGenerated) {
+        RequestUpload();
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, _texture);
+}
+
+void OpenGLTexture::Unbind(uint32_t unit) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+TextureMemoryUsage OpenGLTexture::GetMemoryUsage() const {
+    return _memory;
+}
+
+void OpenGLTexture::CreateTexture() {
+    glGenTextures(1, &_texture);
+    glBindTexture(GL_TEXTURE_2D, _texture);
+    // limit to the levels we have so the texture is complete once they are all in
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, _levelCount - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+}
+
+void OpenGLTexture::UploadLevel(uint32_t level, GLuint source, size_t offset, const uint8_t* data) {
+    if (_texture == 0) {
+        CreateTexture();
+    } else {
+        glBindTexture(GL_TEXTURE_2D, _texture);
+    }
+
+    GLint internalFormat;
+    GLenum pixelFormat, type;
+    GetFormats(format, srgb, internalFormat, pixelFormat, type);
+    // rows are tightly packed, RGB rows are not 4 byte multiples
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    // with a staging source the pointer is an offset into GL_PIXEL_UNPACK_BUFFER
+    const void* pixels = data;
+    if (source != 0) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, source);
+        pixels = (const void*)offset;
+    }
+    if (TextureFormatIsCompressed(format)) {
+        GLsizei size = TextureLevelSize(format, GetMipWidth(level), GetMipHeight(level));
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, GetMipWidth(level), GetMipHeight(level), 0, size, pixels);
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, level, internalFormat, GetMipWidth(level), GetMipHeight(level), 0, pixelFormat, type, pixels);
+    }
+    if (source != 0) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (++_levelsUploaded < _levelCount) {
+        return;
+    }
+    _uploadPending = false;
+    _isGenerated = true;
+    if (!keepPixels) {
+        mips.clear();
+        mips.shrink_to_fit();
+    }
+}
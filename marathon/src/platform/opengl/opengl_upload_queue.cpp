@@ -0,0 +1,155 @@
+#include "platform/opengl/opengl_upload_queue.hpp"
+
+#include <iostream>
+#include <algorithm>
+
+OpenGLUploadQueue& OpenGLUploadQueue::Instance() {
+    static OpenGLUploadQueue instance;
+    return instance;
+}
+
+void OpenGLUploadQueue::Enqueue(UploadJob job) {
+    _jobs.push_back(std::move(job));
+    _stats.pending = _jobs.size();
+}
+
+void OpenGLUploadQueue::Cancel(const void* owner) {
+    _jobs.erase(std::remove_if(_jobs.begin(), _jobs.end(),
+        [owner](const UploadJob& job) { return job.owner == owner; }), _jobs.end());
+    _stats.pending = _jobs.size();
+}
+
+void OpenGLUploadQueue::Initialise() {
+    _initialised = true;
+    glGenBuffers(1, &_stagingBuffer);
+    glBindBuffer(GL_COPY_READ_BUFFER, _stagingBuffer);
+    _persistent = GLEW_ARB_buffer_storage;
+    if (_persistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_READ_BUFFER, UPLOAD_SEGMENT_SIZE * UPLOAD_SEGMENT_COUNT, nullptr, flags);
+        _mapped = (uint8_t*)glMapBufferRange(GL_COPY_READ_BUFFER, 0, UPLOAD_SEGMENT_SIZE * UPLOAD_SEGMENT_COUNT, flags);
+        if (_mapped == nullptr) {
+            std::cout << "WARNING (OpenGLUploadQueue): Persistent map failed, falling back to orphaning." << std::endl;
+            glDeleteBuffers(1, &_stagingBuffer);
+            glGenBuffers(1, &_stagingBuffer);
+            glBindBuffer(GL_COPY_READ_BUFFER, _stagingBuffer);
+            _persistent = false;
+        }
+    }
+    if (!_persistent)
+        glBufferData(GL_COPY_READ_BUFFER, UPLOAD_SEGMENT_SIZE, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    std::cout << "DEBUG (OpenGLUploadQueue): Staging " << (_persistent ? "persistent mapped." : "orphaned.") << std::endl;
+}
+
+void OpenGLUploadQueue::Shutdown() {
+    for (GLsync& fence : _fences) {
+        if (fence != nullptr)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (_stagingBuffer != 0) {
+        if (_persistent) {
+            glBindBuffer(GL_COPY_READ_BUFFER, _stagingBuffer);
+            glUnmapBuffer(GL_COPY_READ_BUFFER);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &_stagingBuffer);
+    }
+    _stagingBuffer = 0;
+    _mapped = nullptr;
+    _initialised = false;
+}
+
+void OpenGLUploadQueue::WaitForSegment(uint32_t segment) {
+    GLsync& fence = _fences[segment];
+    if (fence == nullptr)
+        return;
+    // segment was used UPLOAD_SEGMENT_COUNT processes ago, this rarely blocks
+    GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    while (result == GL_TIMEOUT_EXPIRED)
+        result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void OpenGLUploadQueue::UploadDirect(UploadJob& job) {
+    std::vector<uint8_t> data(job.bytes);
+    job.fill(data.data());
+    job.finish(0, 0, data.data());
+}
+
+void OpenGLUploadQueue::Process() {
+    _stats.bytes = 0;
+    _stats.jobs = 0;
+    if (_jobs.empty()) {
+        _stats.pending = 0;
+        return;
+    }
+    if (!_initialised)
+        Initialise();
+
+    // take jobs in order until the next would overflow the budget
+    std::vector<UploadJob> batch;
+    std::vector<size_t> offsets;
+    size_t used = 0;
+    while (!_jobs.empty()) {
+        UploadJob& job = _jobs.front();
+        if (job.bytes > UPLOAD_SEGMENT_SIZE) {
+            // too big to stage, only go direct when nothing else used this frame's budget
+            if (used > 0)
+                break;
+            UploadDirect(job);
+            _stats.bytes += job.bytes;
+            _stats.jobs++;
+            _jobs.pop_front();
+            break;
+        }
+        size_t offset = (used + UPLOAD_ALIGNMENT - 1) & ~(size_t)(UPLOAD_ALIGNMENT - 1);
+        if (offset + job.bytes > UPLOAD_SEGMENT_SIZE)
+            break;
+        offsets.push_back(offset);
+        used = offset + job.bytes;
+        batch.push_back(std::move(job));
+        _jobs.pop_front();
+    }
+
+    if (!batch.empty()) {
+        size_t base = 0;
+        uint8_t* dst = nullptr;
+        glBindBuffer(GL_COPY_READ_BUFFER, _stagingBuffer);
+        if (_persistent) {
+            WaitForSegment(_segment);
+            base = (size_t)_segment * UPLOAD_SEGMENT_SIZE;
+            dst = _mapped + base;
+        } else {
+            // orphan so the driver hands back fresh storage instead of waiting on last copies
+            glBufferData(GL_COPY_READ_BUFFER, UPLOAD_SEGMENT_SIZE, nullptr, GL_STREAM_DRAW);
+            dst = (uint8_t*)glMapBufferRange(GL_COPY_READ_BUFFER, 0, used,
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        }
+
+        if (dst == nullptr) {
+            std::cout << "WARNING (OpenGLUploadQueue): Failed to map staging, uploading directly." << std::endl;
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            for (UploadJob& job : batch)
+                UploadDirect(job);
+        } else {
+            for (size_t i = 0; i < batch.size(); i++)
+                batch[i].fill(dst + offsets[i]);
+            if (!_persistent)
+                glUnmapBuffer(GL_COPY_READ_BUFFER);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            for (size_t i = 0; i < batch.size(); i++)
+                batch[i].finish(_stagingBuffer, base + offsets[i], nullptr);
+            if (_persistent) {
+                _fences[_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                _segment = (_segment + 1) % UPLOAD_SEGMENT_COUNT;
+            }
+        }
+        for (UploadJob& job : batch)
+            _stats.bytes += job.bytes;
+        _stats.jobs += batch.size();
+    }
+    _stats.pending = _jobs.size();
+}
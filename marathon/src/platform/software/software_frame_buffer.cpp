@@ -0,0 +1,52 @@
+#include "platform/software/software_frame_buffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+SoftwareFrameBuffer::SoftwareFrameBuffer(const std::string& name, int width, int height, const FrameBufferSpec& spec)
+    : FrameBuffer(name, width, height, spec) {
+    if (spec.colour.size() > 1 || (spec.colour.size() == 1 && spec.colour[0] != FrameBufferFormat::RGBA8)) {
+        static bool warned = false;
+        if (!warned)
+            std::cout << "WARNING (SoftwareFrameBuffer): Only one RGBA8 colour attachment is supported, the rest of the spec is ignored." << std::endl;
+        warned = true;
+    }
+    Resize(width, height);
+}
+
+void SoftwareFrameBuffer::Resize(int width, int height) {
+    _width = std::max(width, 1);
+    _height = std::max(height, 1);
+    _stride = (_width + 3) & ~3;
+    _colour.assign((size_t)_stride * _height, 0);
+    _depth.assign((size_t)_stride * _height, 1.0f);
+}
+
+void SoftwareFrameBuffer::Bind() {}
+
+void SoftwareFrameBuffer::Unbind() {}
+
+uint32_t SoftwareFrameBuffer::GetColourAttachment(uint32_t index) {
+    return 0;
+}
+
+uint32_t SoftwareFrameBuffer::GetDepthStencilAttachment() {
+    return 0;
+}
+
+void SoftwareFrameBuffer::Clear() {
+    auto toByte = [](float c) {
+        return (uint32_t)(std::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+    };
+    uint32_t packed = toByte(clearColour.r) | toByte(clearColour.g) << 8
+        | toByte(clearColour.b) << 16 | toByte(clearColour.a) << 24;
+    std::fill(_colour.begin(), _colour.end(), packed);
+    std::fill(_depth.begin(), _depth.end(), 1.0f);
+}
+
+void SoftwareFrameBuffer::ReadPixels(std::vector<uint8_t>& out) const {
+    out.resize((size_t)_width * _height * 4);
+    for (int y = 0; y < _height; y++)
+        std::memcpy(out.data() + (size_t)y * _width * 4, _colour.data() + (size_t)y * _stride, (size_t)_width * 4);
+}
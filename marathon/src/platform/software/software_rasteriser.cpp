@@ -0,0 +1,622 @@
+#include "platform/software/software_rasteriser.hpp"
+
+#include <cmath>
+#include <chrono>
+#include <atomic>
+#include <future>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RASTER_SSE2
+#include <emmintrin.h>
+#endif
+
+// 4 wide float ops, SSE2 when available otherwise plain loops the compiler can still vectorise
+#ifdef RASTER_SSE2
+typedef __m128 Float4;
+static inline Float4 Set1(float v) { return _mm_set1_ps(v); }
+static inline Float4 Set4(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+static inline Float4 Load4(const float* p) { return _mm_loadu_ps(p); }
+static inline void Store4(float* p, Float4 v) { _mm_storeu_ps(p, v); }
+static inline Float4 Add(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+static inline Float4 Sub(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+static inline Float4 Mul(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+static inline Float4 Div(Float4 a, Float4 b) { return _mm_div_ps(a, b); }
+static inline Float4 Min(Float4 a, Float4 b) { return _mm_min_ps(a, b); }
+static inline Float4 Max(Float4 a, Float4 b) { return _mm_max_ps(a, b); }
+static inline Float4 And(Float4 a, Float4 b) { return _mm_and_ps(a, b); }
+static inline Float4 AndNot(Float4 a, Float4 b) { return _mm_andnot_ps(a, b); }
+static inline Float4 Or(Float4 a, Float4 b) { return _mm_or_ps(a, b); }
+static inline Float4 Greater(Float4 a, Float4 b) { return _mm_cmpgt_ps(a, b); }
+static inline Float4 GreaterEqual(Float4 a, Float4 b) { return _mm_cmpge_ps(a, b); }
+static inline Float4 Less(Float4 a, Float4 b) { return _mm_cmplt_ps(a, b); }
+static inline Float4 LessEqual(Float4 a, Float4 b) { return _mm_cmple_ps(a, b); }
+static inline int MoveMask(Float4 a) { return _mm_movemask_ps(a); }
+#else
+struct Float4 {
+    float v[4];
+};
+static inline uint32_t Bits(float f) { uint32_t u; std::memcpy(&u, &f, 4); return u; }
+static inline float Float(uint32_t u) { float f; std::memcpy(&f, &u, 4); return f; }
+#define FLOAT4_OP(name, expr) \
+    static inline Float4 name(Float4 a, Float4 b) { Float4 r; for (int i = 0; i < 4; i++) r.v[i] = expr; return r; }
+#define FLOAT4_CMP(name, op) FLOAT4_OP(name, Float(a.v[i] op b.v[i] ? 0xFFFFFFFFu : 0u))
+static inline Float4 Set1(float v) { return {{v, v, v, v}}; }
+static inline Float4 Set4(float a, float b, float c, float d) { return {{a, b, c, d}}; }
+static inline Float4 Load4(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+static inline void Store4(float* p, Float4 v) { std::memcpy(p, v.v, sizeof(v.v)); }
+FLOAT4_OP(Add, a.v[i] + b.v[i])
+FLOAT4_OP(Sub, a.v[i] - b.v[i])
+FLOAT4_OP(Mul, a.v[i] * b.v[i])
+FLOAT4_OP(Div, a.v[i] / b.v[i])
+FLOAT4_OP(Min, std::min(a.v[i], b.v[i]))
+FLOAT4_OP(Max, std::max(a.v[i], b.v[i]))
+FLOAT4_OP(And, Float(Bits(a.v[i]) & Bits(b.v[i])))
+FLOAT4_OP(AndNot, Float(~Bits(a.v[i]) & Bits(b.v[i])))
+FLOAT4_OP(Or, Float(Bits(a.v[i]) | Bits(b.v[i])))
+FLOAT4_CMP(Greater, >)
+FLOAT4_CMP(GreaterEqual, >=)
+FLOAT4_CMP(Less, <)
+FLOAT4_CMP(LessEqual, <=)
+static inline int MoveMask(Float4 a) {
+    int mask = 0;
+    for (int i = 0; i < 4; i++)
+        mask |= (Bits(a.v[i]) >> 31) << i;
+    return mask;
+}
+#endif
+
+typedef SoftwareRasteriser::Vertex Vertex;
+typedef SoftwareRasteriser::Triangle Triangle;
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+SoftwareRasteriser::SoftwareRasteriser(uint32_t threadCount) {
+    SetThreadCount(threadCount);
+}
+
+void SoftwareRasteriser::SetThreadCount(uint32_t threadCount) {
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    if (threadCount == _threadCount && _threads.size() == threadCount)
+        return;
+    _threadCount = threadCount;
+    // the caller takes a share of every stage, so one less worker
+    _pool = threadCount > 1 ? std::make_unique<ThreadPool>(threadCount - 1) : nullptr;
+    _threads.clear();
+    _threads.resize(threadCount);
+}
+
+uint32_t SoftwareRasteriser::GetThreadCount() const {
+    return _threadCount;
+}
+
+const RasterStats& SoftwareRasteriser::GetStats() const {
+    return _stats;
+}
+
+void SoftwareRasteriser::RunParallel(const std::function<void(uint32_t)>& job) {
+    std::vector<std::future<void>> jobs;
+    jobs.reserve(_threadCount);
+    for (uint32_t t = 1; t < _threadCount; t++)
+        jobs.push_back(_pool->Submit([&job, t]() { job(t); }));
+    job(0);
+    for (std::future<void>& done : jobs)
+        done.get();
+}
+
+void SoftwareRasteriser::Draw(SoftwareFrameBuffer& target, const std::vector<RasterDraw>& draws, const RasterState& state) {
+    PROFILE_SCOPE("Rasterise");
+    _stats = RasterStats();
+    int width = target.GetWidth();
+    int height = target.GetHeight();
+    int tilesX = (width + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    int tilesY = (height + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    uint32_t tileCount = tilesX * tilesY;
+
+    _vertexOffsets.assign(1, 0);
+    _triangleOffsets.assign(1, 0);
+    for (const RasterDraw& draw : draws) {
+        size_t vertices = draw.mesh ? draw.mesh->vertices.size() : 0;
+        size_t indices = !draw.mesh ? 0 : draw.mesh->GetLODIndices(draw.lod).empty() ? vertices : draw.mesh->GetLODIndices(draw.lod).size();
+        _vertexOffsets.push_back(_vertexOffsets.back() + (uint32_t)vertices);
+        _triangleOffsets.push_back(_triangleOffsets.back() + (uint32_t)(indices / 3));
+    }
+    _vertices.resize(_vertexOffsets.back());
+
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<uint32_t> nextDraw = 0;
+    RunParallel([&](uint32_t) {
+        PROFILE_SCOPE("Raster Vertices");
+        for (uint32_t d = nextDraw++; d < draws.size(); d = nextDraw++) {
+            if (draws[d].mesh)
+                TransformDraw(draws[d], state.viewProjection, _vertices.data() + _vertexOffsets[d]);
+        }
+    });
+    _stats.vertexMs = MillisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (ThreadData& data : _threads) {
+        data.triangles.clear();
+        data.clipped.clear();
+        data.bins.resize(tileCount);
+        if (state.deferred)
+            data.surfaces.resize(RASTER_TILE_SIZE * RASTER_TILE_SIZE);
+        for (std::vector<uint32_t>& bin : data.bins)
+            bin.clear();
+        data.stats = RasterStats();
+    }
+    RunParallel([&](uint32_t thread) {
+        PROFILE_SCOPE("Raster Setup");
+        SetupTriangles(thread, draws, state, width, height, tilesX);
+    });
+    _stats.setupMs = MillisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    std::atomic<uint32_t> nextTile = 0;
+    RunParallel([&](uint32_t thread) {
+        PROFILE_SCOPE("Raster Tiles");
+        for (uint32_t tile = nextTile++; tile < tileCount; tile = nextTile++)
+            RasteriseTile(thread, tile, target, draws, state, tilesX);
+    });
+    _stats.rasterMs = MillisecondsSince(start);
+
+    for (const ThreadData& data : _threads) {
+        _stats.triangles += data.stats.triangles;
+        _stats.clipped += data.stats.clipped;
+        _stats.culled += data.stats.culled;
+        _stats.binned += data.stats.binned;
+        _stats.fragments += data.stats.fragments;
+        _stats.pixelsShaded += data.stats.pixelsShaded;
+    }
+}
+
+void SoftwareRasteriser::TransformDraw(const RasterDraw& draw, const LA::mat4& viewProjection, Vertex* out) {
+    const Mesh& mesh = *draw.mesh;
+    // column major, m[col * 4 + row]
+    float mvp[16], model[16];
+    LA::mat4 combined = viewProjection * draw.model;
+    for (int c = 0; c < 4; c++) {
+        for (int r = 0; r < 4; r++) {
+            mvp[c * 4 + r] = combined[c][r];
+            model[c * 4 + r] = draw.model[c][r];
+        }
+    }
+    bool hasNormals = mesh.normals.size() >= mesh.vertices.size();
+    for (size_t i = 0; i < mesh.vertices.size(); i++) {
+        const LA::vec3& p = mesh.vertices[i];
+        Vertex& v = out[i];
+        for (int r = 0; r < 4; r++)
+            v.clip[r] = mvp[r] * p.x + mvp[4 + r] * p.y + mvp[8 + r] * p.z + mvp[12 + r];
+        for (int r = 0; r < 3; r++)
+            v.world[r] = model[r] * p.x + model[4 + r] * p.y + model[8 + r] * p.z + model[12 + r];
+        // lighting.vert passes the normal on without the model transform
+        v.normal[0] = hasNormals ? mesh.normals[i].x : 0.0f;
+        v.normal[1] = hasNormals ? mesh.normals[i].y : 0.0f;
+        v.normal[2] = hasNormals ? mesh.normals[i].z : 0.0f;
+        v.local[0] = p.x;
+        v.local[1] = p.y;
+        v.local[2] = p.z;
+    }
+}
+
+static Vertex Lerp(const Vertex& a, const Vertex& b, float t) {
+    Vertex v;
+    for (int i = 0; i < 4; i++)
+        v.clip[i] = a.clip[i] + (b.clip[i] - a.clip[i]) * t;
+    for (int i = 0; i < 3; i++) {
+        v.world[i] = a.world[i] + (b.world[i] - a.world[i]) * t;
+        v.normal[i] = a.normal[i] + (b.normal[i] - a.normal[i]) * t;
+        v.local[i] = a.local[i] + (b.local[i] - a.local[i]) * t;
+    }
+    return v;
+}
+
+// every vertex on the outside of one clip plane
+static bool OutsideFrustum(const Vertex* a, const Vertex* b, const Vertex* c) {
+    for (int axis = 0; axis < 3; axis++) {
+        if (a->clip[axis] < -a->clip[3] && b->clip[axis] < -b->clip[3] && c->clip[axis] < -c->clip[3])
+            return true;
+        if (a->clip[axis] > a->clip[3] && b->clip[axis] > b->clip[3] && c->clip[axis] > c->clip[3])
+            return true;
+    }
+    return false;
+}
+
+void SoftwareRasteriser::SetupTriangles(uint32_t thread, const std::vector<RasterDraw>& draws, const RasterState& state, int width, int height, int tilesX) {
+    ThreadData& data = _threads[thread];
+    uint32_t total = _triangleOffsets.back();
+    uint32_t chunk = (total + _threadCount - 1) / _threadCount;
+    uint32_t begin = std::min(total, thread * chunk);
+    uint32_t end = std::min(total, begin + chunk);
+    if (begin >= end)
+        return;
+    data.stats.triangles = end - begin;
+
+    // front faces have negative area with y pointing down the screen when wound counter clockwise
+    float frontSign = state.winding == Winding::CCW ? -1.0f : 1.0f;
+    const Float4 half = Set1(0.5f);
+    const Float4 one = Set1(1.0f);
+    const Float4 w4 = Set1((float)width);
+    const Float4 h4 = Set1((float)height);
+
+    // triangles waiting for setup, four at a time
+    const Vertex* group[4][3];
+    uint32_t groupDraw[4];
+    int groupSize = 0;
+
+    auto setupGroup = [&]() {
+        // pad with the last triangle, the extra lanes are ignored
+        for (int i = groupSize; i < 4; i++) {
+            for (int k = 0; k < 3; k++)
+                group[i][k] = group[groupSize - 1][k];
+        }
+        Float4 sx[3], sy[3], sz[3], iw[3];
+        for (int k = 0; k < 3; k++) {
+            Float4 x = Set4(group[0][k]->clip[0], group[1][k]->clip[0], group[2][k]->clip[0], group[3][k]->clip[0]);
+            Float4 y = Set4(group[0][k]->clip[1], group[1][k]->clip[1], group[2][k]->clip[1], group[3][k]->clip[1]);
+            Float4 z = Set4(group[0][k]->clip[2], group[1][k]->clip[2], group[2][k]->clip[2], group[3][k]->clip[2]);
+            Float4 w = Set4(group[0][k]->clip[3], group[1][k]->clip[3], group[2][k]->clip[3], group[3][k]->clip[3]);
+            iw[k] = Div(one, w);
+            // window space, origin at the top left
+            sx[k] = Mul(Add(Mul(Mul(x, iw[k]), half), half), w4);
+            sy[k] = Mul(Sub(half, Mul(Mul(y, iw[k]), half)), h4);
+            sz[k] = Add(Mul(Mul(z, iw[k]), half), half);
+        }
+        Float4 area = Sub(Mul(Sub(sx[1], sx[0]), Sub(sy[2], sy[0])), Mul(Sub(sx[2], sx[0]), Sub(sy[1], sy[0])));
+        Float4 invArea = Div(one, area);
+        alignas(16) float lanes[3][3][4], depth[3][4], invW[3][4], bounds[4][4], areas[4];
+        for (int e = 0; e < 3; e++) {
+            // edge e is opposite vertex e, from a to b
+            int a = (e + 1) % 3, b = (e + 2) % 3;
+            Float4 dx = Sub(sx[b], sx[a]);
+            Float4 dy = Sub(sy[b], sy[a]);
+            Store4(lanes[e][0], Mul(Sub(Set1(0.0f), dy), invArea));
+            Store4(lanes[e][1], Mul(dx, invArea));
+            Store4(lanes[e][2], Mul(Sub(Mul(dy, sx[a]), Mul(dx, sy[a])), invArea));
+            Store4(depth[e], sz[e]);
+            Store4(invW[e], iw[e]);
+        }
+        Store4(bounds[0], Min(Min(sx[0], sx[1]), sx[2]));
+        Store4(bounds[1], Min(Min(sy[0], sy[1]), sy[2]));
+        Store4(bounds[2], Max(Max(sx[0], sx[1]), sx[2]));
+        Store4(bounds[3], Max(Max(sy[0], sy[1]), sy[2]));
+        Store4(areas, area);
+
+        for (int i = 0; i < groupSize; i++) {
+            float signedArea = areas[i] * frontSign;
+            if (!(std::fabs(areas[i]) > 0.0f) || (state.culling && signedArea < 0.0f)) {
+                data.stats.culled++;
+                continue;
+            }
+            // pixels whose centre is inside the bounds, clamped before converting as they can be far off screen
+            auto first = [](float v, int limit) { return (int)std::ceil(std::clamp(v, -1.0f, (float)limit + 1.0f) - 0.5f); };
+            Triangle tri;
+            tri.minX = std::max(0, first(bounds[0][i], width));
+            tri.minY = std::max(0, first(bounds[1][i], height));
+            tri.maxX = std::min(width, (int)std::floor(std::clamp(bounds[2][i], -1.0f, (float)width + 1.0f) - 0.5f) + 1);
+            tri.maxY = std::min(height, (int)std::floor(std::clamp(bounds[3][i], -1.0f, (float)height + 1.0f) - 0.5f) + 1);
+            if (tri.minX >= tri.maxX || tri.minY >= tri.maxY) {
+                data.stats.culled++;
+                continue;
+            }
+            for (int e = 0; e < 3; e++) {
+                for (int c = 0; c < 3; c++)
+                    tri.edges[e][c] = lanes[e][c][i];
+                tri.depth[e] = depth[e][i];
+                tri.invW[e] = invW[e][i];
+                tri.vertices[e] = group[i][e];
+                // barycentric grows to the right on a left edge, downwards on a top edge
+                float a = tri.edges[e][0], b = tri.edges[e][1];
+                if (a > 0.0f || (a == 0.0f && b > 0.0f))
+                    tri.topLeft |= 1 << e;
+            }
+            tri.draw = groupDraw[i];
+
+            uint32_t index = (uint32_t)data.triangles.size();
+            data.triangles.push_back(tri);
+            for (int ty = tri.minY / RASTER_TILE_SIZE; ty <= (tri.maxY - 1) / RASTER_TILE_SIZE; ty++) {
+                for (int tx = tri.minX / RASTER_TILE_SIZE; tx <= (tri.maxX - 1) / RASTER_TILE_SIZE; tx++) {
+                    data.bins[ty * tilesX + tx].push_back(index);
+                    data.stats.binned++;
+                }
+            }
+        }
+        groupSize = 0;
+    };
+    auto queue = [&](const Vertex* a, const Vertex* b, const Vertex* c, uint32_t draw) {
+        group[groupSize][0] = a;
+        group[groupSize][1] = b;
+        group[groupSize][2] = c;
+        groupDraw[groupSize] = draw;
+        if (++groupSize == 4)
+            setupGroup();
+    };
+
+    uint32_t d = (uint32_t)(std::upper_bound(_triangleOffsets.begin(), _triangleOffsets.end(), begin) - _triangleOffsets.begin()) - 1;
+    for (uint32_t g = begin; g < end; g++) {
+        while (g >= _triangleOffsets[d + 1])
+            d++;
+        const std::vector<uint32_t>& indices = draws[d].mesh->GetLODIndices(draws[d].lod);
+        const Vertex* base = _vertices.data() + _vertexOffsets[d];
+        uint32_t vertexCount = _vertexOffsets[d + 1] - _vertexOffsets[d];
+        uint32_t local = g - _triangleOffsets[d];
+        const Vertex* v[3];
+        bool valid = true;
+        for (int k = 0; k < 3; k++) {
+            uint32_t index = indices.empty() ? local * 3 + k : indices[local * 3 + k];
+            valid &= index < vertexCount;
+            v[k] = base + std::min(index, vertexCount - 1);
+        }
+        if (!valid || OutsideFrustum(v[0], v[1], v[2])) {
+            data.stats.culled++;
+            continue;
+        }
+
+        // distance inside the near plane, z >= -w
+        float dist[3];
+        int inside = 0;
+        for (int k = 0; k < 3; k++) {
+            dist[k] = v[k]->clip[2] + v[k]->clip[3];
+            inside += dist[k] >= 0.0f;
+        }
+        if (inside == 3) {
+            queue(v[0], v[1], v[2], d);
+            continue;
+        }
+        data.stats.clipped++;
+        if (inside == 0)
+            continue;
+
+        // one plane leaves at most a quad, kept in winding order
+        const Vertex* polygon[4];
+        int count = 0;
+        for (int k = 0; k < 3; k++) {
+            int n = (k + 1) % 3;
+            if (dist[k] >= 0.0f)
+                polygon[count++] = v[k];
+            if ((dist[k] >= 0.0f) != (dist[n] >= 0.0f)) {
+                data.clipped.push_back(Lerp(*v[k], *v[n], dist[k] / (dist[k] - dist[n])));
+                polygon[count++] = &data.clipped.back();
+            }
+        }
+        for (int k = 2; k < count; k++)
+            queue(polygon[0], polygon[k - 1], polygon[k], d);
+    }
+    if (groupSize > 0)
+        setupGroup();
+}
+
+static inline float Dot(const float* a, const float* b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static inline void Normalise(float* v) {
+    float length = std::sqrt(Dot(v, v));
+    if (length > 0.0f) {
+        v[0] /= length;
+        v[1] /= length;
+        v[2] /= length;
+    }
+}
+
+// specular term shared by every light, reflect(-lightDir, normal) against the view direction
+static inline float Specular(const float* lightDir, const float* normal, const float* viewDir) {
+    float d = Dot(normal, lightDir);
+    float reflectDir[3];
+    for (int i = 0; i < 3; i++)
+        reflectDir[i] = -lightDir[i] + 2.0f * d * normal[i];
+    // shininess 0.5
+    return std::sqrt(std::max(Dot(viewDir, reflectDir), 0.0f));
+}
+
+// lighting.frag main()
+static void ShadeLighting(const LightBlock& lights, const CameraBlock& camera, const float* position, const float* normal, float* result) {
+    float viewDir[3] = {camera.position[0] - position[0], camera.position[1] - position[1], camera.position[2] - position[2]};
+    Normalise(viewDir);
+    const float amb = 0.1f;
+
+    for (const DirectionalLightData& light : lights.directional) {
+        if (!light.enabled)
+            continue;
+        float lightDir[3] = {-light.direction[0], -light.direction[1], -light.direction[2]};
+        Normalise(lightDir);
+        float diff = std::max(Dot(normal, lightDir), 0.0f);
+        float spec = Specular(lightDir, normal, viewDir);
+        for (int i = 0; i < 3; i++)
+            result[i] += light.colour[i] * light.intensity * (amb + diff + spec);
+    }
+
+    auto attenuated = [&](const float* colour, float intensity, const float* lightPosition, float range, const float* spotDirection,
+                          float cutOff, float outerCutOff) {
+        float lightDir[3] = {lightPosition[0] - position[0], lightPosition[1] - position[1], lightPosition[2] - position[2]};
+        float distance = std::sqrt(Dot(lightDir, lightDir));
+        Normalise(lightDir);
+        float diff = std::max(Dot(normal, lightDir), 0.0f);
+        float spec = Specular(lightDir, normal, viewDir);
+        float attenuation = intensity / (1.0f + 0.09f * distance + 0.032f * (distance * distance));
+        // RangeWindow()
+        float ratio = distance / range;
+        float window = std::clamp(1.0f - ratio * ratio * ratio * ratio, 0.0f, 1.0f);
+        attenuation *= window * window;
+        if (spotDirection) {
+            float spot[3] = {-spotDirection[0], -spotDirection[1], -spotDirection[2]};
+            Normalise(spot);
+            float theta = Dot(lightDir, spot);
+            attenuation *= std::clamp((theta - outerCutOff) / (cutOff - outerCutOff), 0.0f, 1.0f);
+        }
+        for (int i = 0; i < 3; i++)
+            result[i] += colour[i] * (amb + diff + spec) * attenuation;
+    };
+    for (const PointLightData& light : lights.point) {
+        if (light.range > 0.0f)
+            attenuated(light.colour, light.intensity, light.position, light.range, nullptr, 0.0f, 0.0f);
+    }
+    for (const SpotLightData& light : lights.spot) {
+        if (light.enabled)
+            attenuated(light.colour, light.intensity, light.position, light.range, light.direction, light.cutOff, light.outerCutOff);
+    }
+}
+
+static inline uint32_t PackColour(const float* colour) {
+    uint32_t packed = 0xFF000000u;
+    for (int i = 0; i < 3; i++)
+        packed |= (uint32_t)(std::clamp(colour[i], 0.0f, 1.0f) * 255.0f + 0.5f) << (i * 8);
+    return packed;
+}
+
+void SoftwareRasteriser::RasteriseTile(uint32_t thread, uint32_t tile, SoftwareFrameBuffer& target, const std::vector<RasterDraw>& draws, const RasterState& state, int tilesX) {
+    int tileX = (tile % tilesX) * RASTER_TILE_SIZE;
+    int tileY = (tile / tilesX) * RASTER_TILE_SIZE;
+    int tileMaxX = std::min(tileX + RASTER_TILE_SIZE, target.GetWidth());
+    int tileMaxY = std::min(tileY + RASTER_TILE_SIZE, target.GetHeight());
+    uint32_t stride = target.GetStride();
+    uint32_t* colours = target.GetColour();
+    float* depths = target.GetDepth();
+
+    const Float4 zero = Set1(0.0f);
+    const Float4 one = Set1(1.0f);
+    const Float4 allSet = GreaterEqual(zero, zero);
+    const Float4 offsets = Set4(0.5f, 1.5f, 2.5f, 3.5f);
+    RasterStats& stats = _threads[thread].stats;
+    Surface* surfaces = _threads[thread].surfaces.data();
+    if (state.deferred) {
+        for (int i = 0; i < RASTER_TILE_SIZE * RASTER_TILE_SIZE; i++)
+            surfaces[i].lit = false;
+    }
+
+    // threads set up contiguous runs in draw order, so walking them in turn keeps submission order
+    for (const ThreadData& data : _threads) {
+        for (uint32_t index : data.bins[tile]) {
+            const Triangle& tri = data.triangles[index];
+            int x0 = std::max(tri.minX, tileX), x1 = std::min(tri.maxX, tileMaxX);
+            int y0 = std::max(tri.minY, tileY), y1 = std::min(tri.maxY, tileMaxY);
+            if (x0 >= x1 || y0 >= y1)
+                continue;
+
+            Float4 a[3], topLeft[3];
+            for (int e = 0; e < 3; e++) {
+                a[e] = Set1(tri.edges[e][0]);
+                topLeft[e] = tri.topLeft & (1 << e) ? allSet : zero;
+            }
+            Float4 z0 = Set1(tri.depth[0]), z1 = Set1(tri.depth[1]), z2 = Set1(tri.depth[2]);
+            // lanes are pixel centres, inside the span when between the first and last pixel
+            Float4 spanMin = Set1((float)x0), spanMax = Set1((float)x1);
+            RasterShading shading = draws[tri.draw].shading;
+            // pixels per unit of each barycentric, which is zero along the opposite edge
+            bool wireframe = draws[tri.draw].wireframe && !state.deferred;
+            float edgeScale[3];
+            for (int e = 0; e < 3; e++)
+                edgeScale[e] = wireframe ? 1.0f / std::sqrt(tri.edges[e][0] * tri.edges[e][0] + tri.edges[e][1] * tri.edges[e][1]) : 0.0f;
+
+            for (int y = y0; y < y1; y++) {
+                float py = (float)y + 0.5f;
+                Float4 row[3];
+                for (int e = 0; e < 3; e++)
+                    row[e] = Set1(tri.edges[e][1] * py + tri.edges[e][2]);
+                uint32_t* colourRow = colours + (size_t)y * stride;
+                float* depthRow = depths + (size_t)y * stride;
+
+                // groups of 4 start on a multiple of 4 so they never leave the padded row
+                for (int x = x0 & ~3; x < x1; x += 4) {
+                    Float4 px = Add(Set1((float)x), offsets);
+                    Float4 mask = And(Greater(px, spanMin), Less(px, spanMax));
+                    Float4 b[3];
+                    for (int e = 0; e < 3; e++) {
+                        b[e] = Add(Mul(a[e], px), row[e]);
+                        // pixels exactly on an edge belong to top and left edges only
+                        Float4 inside = Or(And(topLeft[e], GreaterEqual(b[e], zero)), AndNot(topLeft[e], Greater(b[e], zero)));
+                        mask = And(mask, inside);
+                    }
+                    if (!MoveMask(mask))
+                        continue;
+
+                    // window depth is affine in screen space, beyond the far plane is clipped
+                    Float4 z = Add(Add(Mul(b[0], z0), Mul(b[1], z1)), Mul(b[2], z2));
+                    mask = And(mask, LessEqual(z, one));
+                    if (state.depthTesting) {
+                        Float4 stored = Load4(depthRow + x);
+                        mask = And(mask, Less(z, stored));
+                        if (!MoveMask(mask))
+                            continue;
+                        Store4(depthRow + x, Or(And(mask, z), AndNot(mask, stored)));
+                    }
+                    int bits = MoveMask(mask);
+                    if (!bits)
+                        continue;
+
+                    alignas(16) float bary[3][4];
+                    for (int e = 0; e < 3; e++)
+                        Store4(bary[e], b[e]);
+                    for (int lane = 0; lane < 4; lane++) {
+                        if (!(bits & (1 << lane)))
+                            continue;
+                        // perspective correct weights
+                        float w[3];
+                        float sum = 0.0f;
+                        for (int k = 0; k < 3; k++) {
+                            w[k] = bary[k][lane] * tri.invW[k];
+                            sum += w[k];
+                        }
+                        for (int k = 0; k < 3; k++)
+                            w[k] /= sum;
+
+                        stats.fragments++;
+                        Surface* surface = state.deferred
+                            ? &surfaces[(y - tileY) * RASTER_TILE_SIZE + (x + lane - tileX)] : nullptr;
+                        float colour[3] = {0.0f, 0.0f, 0.0f};
+                        if (shading == RasterShading::LIGHTING) {
+                            float position[3], normal[3];
+                            for (int i = 0; i < 3; i++) {
+                                position[i] = w[0] * tri.vertices[0]->world[i] + w[1] * tri.vertices[1]->world[i] + w[2] * tri.vertices[2]->world[i];
+                                normal[i] = w[0] * tri.vertices[0]->normal[i] + w[1] * tri.vertices[1]->normal[i] + w[2] * tri.vertices[2]->normal[i];
+                            }
+                            Normalise(normal);
+                            if (surface) {
+                                std::memcpy(surface->position, position, sizeof(position));
+                                std::memcpy(surface->normal, normal, sizeof(normal));
+                                surface->lit = true;
+                                continue;
+                            }
+                            ShadeLighting(*state.lights, *state.camera, position, normal, colour);
+                        } else {
+                            for (int i = 0; i < 3; i++)
+                                colour[i] = w[0] * tri.vertices[0]->local[i] + w[1] * tri.vertices[1]->local[i] + w[2] * tri.vertices[2]->local[i];
+                            // drawn over a lit surface, which must not be lit on top of it
+                            if (surface)
+                                surface->lit = false;
+                        }
+                        if (wireframe) {
+                            float edge = std::min(std::min(bary[0][lane] * edgeScale[0], bary[1][lane] * edgeScale[1]), bary[2][lane] * edgeScale[2]);
+                            float t = std::clamp(edge - RASTER_WIREFRAME_WIDTH + 0.5f, 0.0f, 1.0f);
+                            float fill = t * t * (3.0f - 2.0f * t);
+                            for (int i = 0; i < 3; i++)
+                                colour[i] = RASTER_WIREFRAME_COLOUR + (colour[i] - RASTER_WIREFRAME_COLOUR) * fill;
+                        }
+                        colourRow[x + lane] = PackColour(colour);
+                        stats.pixelsShaded++;
+                    }
+                }
+            }
+        }
+    }
+
+    if (!state.deferred)
+        return;
+    // lighting pass, the last surface stored at each pixel is the one that passed the depth test last
+    for (int y = tileY; y < tileMaxY; y++) {
+        uint32_t* colourRow = colours + (size_t)y * stride;
+        for (int x = tileX; x < tileMaxX; x++) {
+            const Surface& surface = surfaces[(y - tileY) * RASTER_TILE_SIZE + (x - tileX)];
+            if (!surface.lit)
+                continue;
+            float colour[3] = {0.0f, 0.0f, 0.0f};
+            ShadeLighting(*state.lights, *state.camera, surface.position, surface.normal, colour);
+            colourRow[x] = PackColour(colour);
+            stats.pixelsShaded++;
+        }
+    }
+}
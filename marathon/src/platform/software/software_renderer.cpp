@@ -0,0 +1,156 @@
+#include "platform/software/software_renderer.hpp"
+#include "core/profiler.hpp"
+
+void SoftwareRenderer::Boot() {
+    std::cout << "DEBUG (SoftwareRenderer): Boot with " << _rasteriser.GetThreadCount() << " threads." << std::endl;
+    context = Context::Create();
+    _screen = std::make_shared<SoftwareFrameBuffer>("Screen");
+    _shading.clear();
+    _shadows = false;
+}
+
+void SoftwareRenderer::DrawShadows(const Shader* shader) {
+}
+
+void SoftwareRenderer::Shutdown() {
+    std::cout << "DEBUG (SoftwareRenderer): Shutdown." << std::endl;
+    _target = nullptr;
+    _frameBuffer = nullptr;
+    _screen = nullptr;
+    _shading.clear();
+}
+
+void SoftwareRenderer::SetFrameBuffer(std::shared_ptr<FrameBuffer> fb) {
+    std::shared_ptr<SoftwareFrameBuffer> target = std::dynamic_pointer_cast<SoftwareFrameBuffer>(fb);
+    if (fb && !target) {
+        std::cout << "WARNING (SoftwareRenderer): Frame buffer " << fb->name << " is not a software frame buffer, drawing to screen." << std::endl;
+        fb = nullptr;
+    }
+    _frameBuffer = fb;
+    _target = target;
+}
+
+std::shared_ptr<FrameBuffer> SoftwareRenderer::GetFrameBuffer() {
+    return _frameBuffer;
+}
+
+void SoftwareRenderer::SetProjection(const LA::mat4& proj) {
+    _projection = proj;
+    _cameraBlock.projection = proj;
+}
+
+LA::mat4 SoftwareRenderer::GetProjection() {
+    return _projection;
+}
+
+void SoftwareRenderer::SetView(const LA::mat4& view) {
+    _view = view;
+    _cameraBlock.view = view;
+}
+
+LA::mat4 SoftwareRenderer::GetView() {
+    return _view;
+}
+
+std::shared_ptr<SoftwareFrameBuffer> SoftwareRenderer::GetScreen() {
+    return _screen;
+}
+
+SoftwareFrameBuffer& SoftwareRenderer::Target() {
+    if (_target)
+        return *_target;
+    // the screen follows the resolution like a window's default frame buffer
+    int width = (int)_cameraBlock.resolution[0];
+    int height = (int)_cameraBlock.resolution[1];
+    if (width > 0 && height > 0 && (width != _screen->GetWidth() || height != _screen->GetHeight()))
+        _screen->Resize(width, height);
+    return *_screen;
+}
+
+void SoftwareRenderer::Clear() {
+    SoftwareFrameBuffer& target = Target();
+    target.clearColour = context->GetClearColour();
+    target.Clear();
+}
+
+RasterShading SoftwareRenderer::ShadingOf(const Shader* shader) {
+    auto it = _shading.find(shader);
+    if (it != _shading.end())
+        return it->second;
+    bool lit = shader->fs && shader->fs->source.find(LIGHT_BLOCK_NAME) != std::string::npos;
+    RasterShading shading = lit ? RasterShading::LIGHTING : RasterShading::POSITION;
+    _shading[shader] = shading;
+    return shading;
+}
+
+void SoftwareRenderer::Rasterise() {
+    RasterState state;
+    state.viewProjection = _projection * _view;
+    state.camera = &_cameraBlock;
+    state.lights = &_lightBlock;
+    state.culling = context->IsCulling();
+    state.winding = context->GetWinding();
+    state.depthTesting = context->IsDepthTesting();
+    state.deferred = _renderPath == RenderPath::DEFERRED;
+    _rasteriser.Draw(Target(), _draws, state);
+    _frameDataDirty = false;
+    _draws.clear();
+}
+
+void SoftwareRenderer::RenderMesh(std::shared_ptr<Shader> shader, std::shared_ptr<Mesh> mesh, const LA::mat4& transform) {
+    if (!shader || !mesh) {
+        std::cout << "ERROR (SoftwareRenderer): Attempting to render with null shader or mesh" << std::endl;
+        return;
+    }
+    _draws.push_back({mesh.get(), transform, ShadingOf(shader.get())});
+    Rasterise();
+    _stats.draws++;
+    _stats.triangles += mesh->GetTriangleCount();
+}
+
+void SoftwareRenderer::Flush() {
+    if (_queue.empty())
+        return;
+    PROFILE_SCOPE("Flush");
+    SortQueue();
+
+    for (uint32_t index : _order) {
+        const RenderPacket& packet = _queue[index];
+        if (packet.pass == RenderPass::WIREFRAME)
+            continue;
+        Material* material = packet.material;
+        if (!material->IsUsable() || !material->shader)
+            continue;
+        if (!packet.mesh->IsUsable()) {
+            packet.mesh->RequestUpload();
+            MeshMemoryUsage memory = packet.mesh->GetMemoryUsage();
+            _stats.uploadBytes += memory.vertexBytes + memory.indexBytes;
+        }
+        _draws.push_back({packet.mesh, packet.transform, ShadingOf(material->shader.get()), packet.pass == RenderPass::SHADED_WIREFRAME, packet.lod});
+        _stats.triangles += packet.mesh->GetTriangleCount(packet.lod);
+    }
+    _stats.draws += (uint32_t)_draws.size();
+    Rasterise();
+    _queue.clear();
+}
+
+void SoftwareRenderer::EndFrame() {}
+
+void SoftwareRenderer::SetThreadCount(uint32_t threadCount) {
+    _rasteriser.SetThreadCount(threadCount);
+}
+
+uint32_t SoftwareRenderer::GetThreadCount() const {
+    return _rasteriser.GetThreadCount();
+}
+
+const RasterStats& SoftwareRenderer::GetRasterStats() const {
+    return _rasteriser.GetStats();
+}
+
+SoftwareRenderer& SoftwareRenderer::Instance() {
+    static SoftwareRenderer* instance;
+    if (!instance)
+        instance = new SoftwareRenderer();
+    return *instance;
+}
@@ -1,10 +1,12 @@
 #include "renderer/context.hpp"
 #include "platform/opengl/opengl_context.hpp"
+#include "platform/headless/headless_context.hpp"
 
 std::shared_ptr<Context> Context::Create() {
     switch (RendererAPI::GetAPI()) {
         case RendererAPI::API::NONE:
-            nullptr;
+        case RendererAPI::API::SOFTWARE:
+            return std::make_shared<HeadlessContext>();
         case RendererAPI::API::OPENGL:
             return std::make_shared<OpenGLContext>();
         default:
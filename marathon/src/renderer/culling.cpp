@@ -0,0 +1,188 @@
+#include "renderer/culling.hpp"
+#include "core/job_system.hpp"
+
+#include <cmath>
+#include <atomic>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CULLING_SSE2
+#include <emmintrin.h>
+#endif
+
+Frustum Frustum::FromMatrix(const LA::mat4& m) {
+    // row i of a column major matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+    auto row = [&m](int i) {
+        return LA::vec4({m[0][i], m[1][i], m[2][i], m[3][i]});
+    };
+    auto add = [](const LA::vec4& a, const LA::vec4& b) {
+        return LA::vec4({a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w});
+    };
+    auto sub = [](const LA::vec4& a, const LA::vec4& b) {
+        return LA::vec4({a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w});
+    };
+    LA::vec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+
+    Frustum f;
+    f.planes[0] = add(r3, r0);
+    f.planes[1] = sub(r3, r0);
+    f.planes[2] = add(r3, r1);
+    f.planes[3] = sub(r3, r1);
+    f.planes[4] = add(r3, r2);
+    f.planes[5] = sub(r3, r2);
+    return f;
+}
+
+void BoundsSoA::Clear() {
+    cx.clear(); cy.clear(); cz.clear();
+    ex.clear(); ey.clear(); ez.clear();
+}
+
+void BoundsSoA::Reserve(size_t count) {
+    cx.reserve(count); cy.reserve(count); cz.reserve(count);
+    ex.reserve(count); ey.reserve(count); ez.reserve(count);
+}
+
+void BoundsSoA::Push(const LA::vec3& min, const LA::vec3& max) {
+    cx.push_back((min.x + max.x) * 0.5f);
+    cy.push_back((min.y + max.y) * 0.5f);
+    cz.push_back((min.z + max.z) * 0.5f);
+    ex.push_back((max.x - min.x) * 0.5f);
+    ey.push_back((max.y - min.y) * 0.5f);
+    ez.push_back((max.z - min.z) * 0.5f);
+}
+
+void BoundsSoA::Resize(size_t count) {
+    cx.resize(count); cy.resize(count); cz.resize(count);
+    ex.resize(count); ey.resize(count); ez.resize(count);
+}
+
+void BoundsSoA::Set(size_t i, const LA::vec3& min, const LA::vec3& max) {
+    cx[i] = (min.x + max.x) * 0.5f;
+    cy[i] = (min.y + max.y) * 0.5f;
+    cz[i] = (min.z + max.z) * 0.5f;
+    ex[i] = (max.x - min.x) * 0.5f;
+    ey[i] = (max.y - min.y) * 0.5f;
+    ez[i] = (max.z - min.z) * 0.5f;
+}
+
+size_t BoundsSoA::Size() const {
+    return cx.size();
+}
+
+void TransformBounds(const LA::vec3& localMin, const LA::vec3& localMax, const LA::mat4& t, LA::vec3& worldMin, LA::vec3& worldMax) {
+    // Arvo: centre moves by the full matrix, extent by its absolute rotation/scale
+    float c[3] = {
+        (localMin.x + localMax.x) * 0.5f,
+        (localMin.y + localMax.y) * 0.5f,
+        (localMin.z + localMax.z) * 0.5f
+    };
+    float e[3] = {
+        (localMax.x - localMin.x) * 0.5f,
+        (localMax.y - localMin.y) * 0.5f,
+        (localMax.z - localMin.z) * 0.5f
+    };
+    for (int row = 0; row < 3; row++) {
+        float centre = t[3][row];
+        float extent = 0.0f;
+        for (int col = 0; col < 3; col++) {
+            centre += t[col][row] * c[col];
+            extent += std::fabs(t[col][row]) * e[col];
+        }
+        worldMin[row] = centre - extent;
+        worldMax[row] = centre + extent;
+    }
+}
+
+static inline bool TestBox(const Frustum& frustum, const BoundsSoA& bounds, size_t i) {
+    for (const LA::vec4& p : frustum.planes) {
+        float d = p.x * bounds.cx[i] + p.y * bounds.cy[i] + p.z * bounds.cz[i] + p.w;
+        float r = std::fabs(p.x) * bounds.ex[i] + std::fabs(p.y) * bounds.ey[i] + std::fabs(p.z) * bounds.ez[i];
+        if (d + r < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+uint32_t CullBoundsScalar(const Frustum& frustum, const BoundsSoA& bounds, std::vector<uint8_t>& visible) {
+    size_t count = bounds.Size();
+    visible.resize(count);
+    uint32_t visibleCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        visible[i] = TestBox(frustum, bounds, i) ? 1 : 0;
+        visibleCount += visible[i];
+    }
+    return visibleCount;
+}
+
+#ifdef CULLING_SSE2
+// tests boxes [begin, end)
+static uint32_t CullRange(const Frustum& frustum, const BoundsSoA& bounds, uint8_t* visible, size_t begin, size_t end) {
+    // broadcast plane terms once, |n| precomputed for the extent projection
+    __m128 nx[6], ny[6], nz[6], nw[6], ax[6], ay[6], az[6];
+    for (int p = 0; p < 6; p++) {
+        const LA::vec4& plane = frustum.planes[p];
+        nx[p] = _mm_set1_ps(plane.x);
+        ny[p] = _mm_set1_ps(plane.y);
+        nz[p] = _mm_set1_ps(plane.z);
+        nw[p] = _mm_set1_ps(plane.w);
+        ax[p] = _mm_set1_ps(std::fabs(plane.x));
+        ay[p] = _mm_set1_ps(std::fabs(plane.y));
+        az[p] = _mm_set1_ps(std::fabs(plane.z));
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    uint32_t visibleCount = 0;
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 cx = _mm_loadu_ps(&bounds.cx[i]);
+        __m128 cy = _mm_loadu_ps(&bounds.cy[i]);
+        __m128 cz = _mm_loadu_ps(&bounds.cz[i]);
+        __m128 ex = _mm_loadu_ps(&bounds.ex[i]);
+        __m128 ey = _mm_loadu_ps(&bounds.ey[i]);
+        __m128 ez = _mm_loadu_ps(&bounds.ez[i]);
+
+        // lanes go to zero once any plane rejects them
+        __m128 outside = _mm_setzero_ps();
+        for (int p = 0; p < 6; p++) {
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], cx), _mm_mul_ps(ny[p], cy)),
+                                  _mm_add_ps(_mm_mul_ps(nz[p], cz), nw[p]));
+            __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)),
+                                  _mm_mul_ps(az[p], ez));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(d, r), zero));
+        }
+        int mask = _mm_movemask_ps(outside);
+        for (int lane = 0; lane < 4; lane++) {
+            uint8_t in = (mask >> lane) & 1 ? 0 : 1;
+            visible[i + lane] = in;
+            visibleCount += in;
+        }
+    }
+
+    // scalar tail
+    for (; i < end; i++) {
+        visible[i] = TestBox(frustum, bounds, i) ? 1 : 0;
+        visibleCount += visible[i];
+    }
+    return visibleCount;
+}
+#else
+static uint32_t CullRange(const Frustum& frustum, const BoundsSoA& bounds, uint8_t* visible, size_t begin, size_t end) {
+    uint32_t visibleCount = 0;
+    for (size_t i = begin; i < end; i++) {
+        visible[i] = TestBox(frustum, bounds, i) ? 1 : 0;
+        visibleCount += visible[i];
+    }
+    return visibleCount;
+}
+#endif
+
+uint32_t CullBounds(const Frustum& frustum, const BoundsSoA& bounds, std::vector<uint8_t>& visible) {
+    size_t count = bounds.Size();
+    visible.resize(count);
+    // chunks write neighbouring bytes of visible, never the same one
+    std::atomic<uint32_t> visibleCount = 0;
+    JobSystem::Instance().ParallelFor((uint32_t)count, CULL_GRAIN, [&](uint32_t begin, uint32_t end) {
+        visibleCount += CullRange(frustum, bounds, visible.data(), begin, end);
+    });
+    return visibleCount;
+}
@@ -1,12 +1,16 @@
 #include "renderer/frame_buffer.hpp"
 #include "platform/opengl/opengl_frame_buffer.hpp"
+#include "platform/headless/headless_frame_buffer.hpp"
+#include "platform/software/software_frame_buffer.hpp"
 
-std::shared_ptr<FrameBuffer> FrameBuffer::Create(const std::string& name, int width, int height) {
+std::shared_ptr<FrameBuffer> FrameBuffer::Create(const std::string& name, int width, int height, const FrameBufferSpec& spec) {
     switch (RendererAPI::GetAPI()) {
         case RendererAPI::API::NONE:
-            return nullptr;
+            return std::make_shared<HeadlessFrameBuffer>(name, width, height, spec);
         case RendererAPI::API::OPENGL:
-            return std::make_shared<OpenGLFrameBuffer>(name, width, height);
+            return std::make_shared<OpenGLFrameBuffer>(name, width, height, spec);
+        case RendererAPI::API::SOFTWARE:
+            return std::make_shared<SoftwareFrameBuffer>(name, width, height, spec);
         default:
             throw std::runtime_error("Unknown Graphics API");
     }
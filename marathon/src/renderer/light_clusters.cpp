@@ -0,0 +1,291 @@
+#include "renderer/light_clusters.hpp"
+#include "core/job_system.hpp"
+#include "core/profiler.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CLUSTERS_SSE2
+#include <emmintrin.h>
+#endif
+
+static const uint32_t CLUSTER_TILES[2] = {CLUSTER_TILES_X, CLUSTER_TILES_Y};
+
+void LightClusters::Build(const LA::mat4& view, const LA::mat4& projection, float width, float height, const std::vector<ClusterLightData>& lights) {
+    PROFILE_SCOPE("Light Clusters");
+    auto start = std::chrono::steady_clock::now();
+    width = std::max(width, 1.0f);
+    height = std::max(height, 1.0f);
+    if (width != _boundsWidth || height != _boundsHeight || std::memcmp(&projection, &_boundsProjection, sizeof(LA::mat4)) != 0)
+        BuildBounds(projection, width, height);
+
+    _stats = LightClusterStats();
+    _stats.lights = (uint32_t)lights.size();
+    _block.dims[3] = (uint32_t)lights.size();
+
+    // lights to view space
+    _viewLights.resize(lights.size());
+    JobSystem::Instance().ParallelFor((uint32_t)lights.size(), CLUSTER_LIGHT_GRAIN, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            const ClusterLightData& light = lights[i];
+            ViewLight& out = _viewLights[i];
+            for (int r = 0; r < 3; r++) {
+                out.centre[r] = view[0][r] * light.position[0] + view[1][r] * light.position[1] + view[2][r] * light.position[2] + view[3][r];
+                out.direction[r] = view[0][r] * light.direction[0] + view[1][r] * light.direction[1] + view[2][r] * light.direction[2];
+            }
+            out.radius = light.range;
+            out.spot = light.spot != 0.0f;
+            float length = std::sqrt(out.direction[0] * out.direction[0] + out.direction[1] * out.direction[1] + out.direction[2] * out.direction[2]);
+            if (length > 0.0f) {
+                for (int r = 0; r < 3; r++)
+                    out.direction[r] /= length;
+            } else {
+                out.spot = false;
+            }
+            out.cosOuter = light.outerCutOff;
+            out.sinOuter = std::sqrt(std::max(0.0f, 1.0f - light.outerCutOff * light.outerCutOff));
+        }
+    });
+
+    // lights overlapping each slice, lights wholly in front of the near plane touch nothing
+    _sliceLights.resize(CLUSTER_SLICES);
+    for (std::vector<uint32_t>& slice : _sliceLights)
+        slice.clear();
+    for (uint32_t i = 0; i < (uint32_t)_viewLights.size(); i++) {
+        const ViewLight& light = _viewLights[i];
+        float depth = -light.centre[2];
+        if (!(light.radius > 0.0f) || depth + light.radius < _sliceDepths[0] || depth - light.radius > _sliceDepths[CLUSTER_SLICES])
+            continue;
+        int first = SliceOf(depth - light.radius);
+        int last = SliceOf(depth + light.radius);
+        for (int s = first; s <= last; s++)
+            _sliceLights[s].push_back(i);
+    }
+
+    _clusterLights.resize(CLUSTER_COUNT);
+    JobSystem::Instance().ParallelFor(CLUSTER_SLICES, 1, [this](uint32_t begin, uint32_t end) {
+        for (uint32_t slice = begin; slice < end; slice++)
+            AssignSlice(slice);
+    });
+
+    // join the per cluster lists
+    _grid.resize(CLUSTER_COUNT * 2);
+    _indices.clear();
+    for (uint32_t c = 0; c < CLUSTER_COUNT; c++) {
+        const std::vector<uint32_t>& list = _clusterLights[c];
+        uint32_t count = std::min((uint32_t)list.size(), (uint32_t)CLUSTER_LIGHTS_MAX);
+        _grid[c * 2] = (uint32_t)_indices.size();
+        _grid[c * 2 + 1] = count;
+        _indices.insert(_indices.end(), list.begin(), list.begin() + count);
+        _stats.dropped += (uint32_t)list.size() - count;
+        _stats.occupied += count > 0;
+        _stats.maxPerCluster = std::max(_stats.maxPerCluster, count);
+    }
+    _stats.references = (uint32_t)_indices.size();
+    _stats.buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void LightClusters::BuildBounds(const LA::mat4& projection, float width, float height) {
+    _boundsProjection = projection;
+    _boundsWidth = width;
+    _boundsHeight = height;
+
+    // near and far planes back out of the depth row, column major so m[col][row]
+    const LA::mat4& p = projection;
+    _perspective = p[2][3] != 0.0f;
+    float near = 0.0f, far = 0.0f;
+    if (_perspective) {
+        near = p[3][2] / (p[2][2] - 1.0f);
+        far = p[2][2] != -1.0f ? p[3][2] / (p[2][2] + 1.0f) : CLUSTER_FAR_MAX;
+    } else {
+        near = (p[3][2] + 1.0f) / p[2][2];
+        far = (p[3][2] - 1.0f) / p[2][2];
+    }
+    near = std::max(near, CLUSTER_NEAR_MIN);
+    far = far > near ? std::min(far, CLUSTER_FAR_MAX) : CLUSTER_FAR_MAX;
+    if (far <= near)
+        far = near * 2.0f;
+    float logRatio = std::log(far / near);
+    for (int s = 0; s <= CLUSTER_SLICES; s++)
+        _sliceDepths[s] = near * std::pow(far / near, (float)s / CLUSTER_SLICES);
+    _sliceDepths[0] = near;
+    _sliceDepths[CLUSTER_SLICES] = far;
+
+    _block.dims[0] = CLUSTER_TILES_X;
+    _block.dims[1] = CLUSTER_TILES_Y;
+    _block.dims[2] = CLUSTER_SLICES;
+    _block.sliceScale = CLUSTER_SLICES / logRatio;
+    _block.sliceBias = -CLUSTER_SLICES * std::log(near) / logRatio;
+    // tiles round up so the last one may hang over the edge
+    _block.tileSize[0] = std::ceil(width / CLUSTER_TILES_X);
+    _block.tileSize[1] = std::ceil(height / CLUSTER_TILES_Y);
+
+    // view space aabb of every froxel, its sides pass through the tile corners at both slice depths
+    float size[2] = {width, height};
+    _minX.assign(CLUSTER_COUNT + 3, 1e30f); _minY.assign(CLUSTER_COUNT + 3, 1e30f); _minZ.assign(CLUSTER_COUNT + 3, 1e30f);
+    _maxX.assign(CLUSTER_COUNT + 3, -1e30f); _maxY.assign(CLUSTER_COUNT + 3, -1e30f); _maxZ.assign(CLUSTER_COUNT + 3, -1e30f);
+    for (uint32_t s = 0; s < CLUSTER_SLICES; s++) {
+        float depths[2] = {_sliceDepths[s], _sliceDepths[s + 1]};
+        for (uint32_t ty = 0; ty < CLUSTER_TILES_Y; ty++) {
+            for (uint32_t tx = 0; tx < CLUSTER_TILES_X; tx++) {
+                uint32_t tile[2] = {tx, ty};
+                float lo[2], hi[2];
+                for (int a = 0; a < 2; a++) {
+                    float ndc[2] = {
+                        2.0f * std::min(tile[a] * _block.tileSize[a], size[a]) / size[a] - 1.0f,
+                        2.0f * std::min((tile[a] + 1) * _block.tileSize[a], size[a]) / size[a] - 1.0f
+                    };
+                    lo[a] = 1e30f;
+                    hi[a] = -1e30f;
+                    for (float n : ndc) {
+                        for (float d : depths) {
+                            // invert ndc = (p[a][a] * v + p[2][a] * z + p[3][a]) / w at z = -d
+                            float z = -d;
+                            float w = p[2][3] * z + p[3][3];
+                            float v = (n * w - p[2][a] * z - p[3][a]) / p[a][a];
+                            lo[a] = std::min(lo[a], v);
+                            hi[a] = std::max(hi[a], v);
+                        }
+                    }
+                }
+                uint32_t c = (s * CLUSTER_TILES_Y + ty) * CLUSTER_TILES_X + tx;
+                _minX[c] = lo[0]; _maxX[c] = hi[0];
+                _minY[c] = lo[1]; _maxY[c] = hi[1];
+                _minZ[c] = -depths[1]; _maxZ[c] = -depths[0];
+            }
+        }
+    }
+}
+
+int LightClusters::SliceOf(float viewDepth) const {
+    if (!(viewDepth > 0.0f))
+        return 0;
+    int slice = (int)std::floor(std::log(viewDepth) * _block.sliceScale + _block.sliceBias);
+    return std::clamp(slice, 0, CLUSTER_SLICES - 1);
+}
+
+bool LightClusters::TileRange(int axis, float low, float high, float near, float far, int& first, int& last) const {
+    const LA::mat4& p = _boundsProjection;
+    float size = axis == 0 ? _boundsWidth : _boundsHeight;
+    // ndc is monotonic in the extent and the depth, so the corners bound it
+    float lo = 1e30f, hi = -1e30f;
+    for (float v : {low, high}) {
+        for (float d : {near, far}) {
+            float z = -d;
+            float w = p[2][3] * z + p[3][3];
+            float ndc = (p[axis][axis] * v + p[2][axis] * z + p[3][axis]) / w;
+            lo = std::min(lo, ndc);
+            hi = std::max(hi, ndc);
+        }
+    }
+    float tile = _block.tileSize[axis];
+    first = (int)std::floor((lo * 0.5f + 0.5f) * size / tile);
+    last = (int)std::floor((hi * 0.5f + 0.5f) * size / tile);
+    if (last < 0 || first >= (int)CLUSTER_TILES[axis])
+        return false;
+    first = std::max(first, 0);
+    last = std::min(last, (int)CLUSTER_TILES[axis] - 1);
+    return true;
+}
+
+void LightClusters::AssignSlice(uint32_t slice) {
+    for (uint32_t c = slice * CLUSTER_TILES_X * CLUSTER_TILES_Y; c < (slice + 1) * CLUSTER_TILES_X * CLUSTER_TILES_Y; c++)
+        _clusterLights[c].clear();
+
+    for (uint32_t index : _sliceLights[slice]) {
+        const ViewLight& light = _viewLights[index];
+        float depth = -light.centre[2];
+        float r = light.radius;
+        float near = std::max(_sliceDepths[slice], depth - r);
+        float far = std::min(_sliceDepths[slice + 1], depth + r);
+        int x0, x1, y0, y1;
+        if (!TileRange(0, light.centre[0] - r, light.centre[0] + r, near, far, x0, x1)
+            || !TileRange(1, light.centre[1] - r, light.centre[1] + r, near, far, y0, y1))
+            continue;
+
+#ifdef CLUSTERS_SSE2
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 cx = _mm_set1_ps(light.centre[0]);
+        const __m128 cy = _mm_set1_ps(light.centre[1]);
+        const __m128 cz = _mm_set1_ps(light.centre[2]);
+        const __m128 r2 = _mm_set1_ps(r * r);
+#endif
+        for (int ty = y0; ty <= y1; ty++) {
+            uint32_t row = (slice * CLUSTER_TILES_Y + ty) * CLUSTER_TILES_X;
+            for (int tx = x0; tx <= x1; tx += 4) {
+                uint32_t c = row + tx;
+                // squared distance from the centre to each box, zero inside
+#ifdef CLUSTERS_SSE2
+                __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&_minX[c]), cx), _mm_sub_ps(cx, _mm_loadu_ps(&_maxX[c]))), zero);
+                __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&_minY[c]), cy), _mm_sub_ps(cy, _mm_loadu_ps(&_maxY[c]))), zero);
+                __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&_minZ[c]), cz), _mm_sub_ps(cz, _mm_loadu_ps(&_maxZ[c]))), zero);
+                __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+                int hits = _mm_movemask_ps(_mm_cmple_ps(d2, r2));
+#else
+                int hits = 0;
+                for (int lane = 0; lane < 4; lane++) {
+                    float dx = std::max({_minX[c + lane] - light.centre[0], light.centre[0] - _maxX[c + lane], 0.0f});
+                    float dy = std::max({_minY[c + lane] - light.centre[1], light.centre[1] - _maxY[c + lane], 0.0f});
+                    float dz = std::max({_minZ[c + lane] - light.centre[2], light.centre[2] - _maxZ[c + lane], 0.0f});
+                    hits |= (dx * dx + dy * dy + dz * dz <= r * r) << lane;
+                }
+#endif
+                // lanes past the rectangle belong to the next row
+                if (x1 - tx < 3)
+                    hits &= (1 << (x1 - tx + 1)) - 1;
+                for (int lane = 0; hits; lane++, hits >>= 1) {
+                    if (!(hits & 1) || (light.spot && !ConeHits(light, c + lane)))
+                        continue;
+                    _clusterLights[c + lane].push_back(index);
+                }
+            }
+        }
+    }
+}
+
+bool LightClusters::ConeHits(const ViewLight& light, uint32_t cluster) const {
+    // cones wider than a hemisphere are left to the sphere test
+    if (light.cosOuter <= 0.0f)
+        return true;
+    // cone against the cluster's bounding sphere
+    float half[3] = {
+        (_maxX[cluster] - _minX[cluster]) * 0.5f,
+        (_maxY[cluster] - _minY[cluster]) * 0.5f,
+        (_maxZ[cluster] - _minZ[cluster]) * 0.5f
+    };
+    float v[3] = {
+        _minX[cluster] + half[0] - light.centre[0],
+        _minY[cluster] + half[1] - light.centre[1],
+        _minZ[cluster] + half[2] - light.centre[2]
+    };
+    float radius = std::sqrt(half[0] * half[0] + half[1] * half[1] + half[2] * half[2]);
+    float lengthSq = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+    float along = v[0] * light.direction[0] + v[1] * light.direction[1] + v[2] * light.direction[2];
+    float closest = light.cosOuter * std::sqrt(std::max(lengthSq - along * along, 0.0f)) - along * light.sinOuter;
+    return !(closest > radius || along > radius + light.radius || along < -radius);
+}
+
+uint32_t LightClusters::GetClusterIndex(float windowX, float windowY, float viewDepth) const {
+    int tx = std::clamp((int)(windowX / _block.tileSize[0]), 0, CLUSTER_TILES_X - 1);
+    int ty = std::clamp((int)(windowY / _block.tileSize[1]), 0, CLUSTER_TILES_Y - 1);
+    return (SliceOf(viewDepth) * CLUSTER_TILES_Y + ty) * CLUSTER_TILES_X + tx;
+}
+
+const ClusterBlock& LightClusters::GetBlock() const {
+    return _block;
+}
+
+const std::vector<uint32_t>& LightClusters::GetGrid() const {
+    return _grid;
+}
+
+const std::vector<uint32_t>& LightClusters::GetIndices() const {
+    return _indices;
+}
+
+const LightClusterStats& LightClusters::GetStats() const {
+    return _stats;
+}
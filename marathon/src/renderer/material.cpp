@@ -1,10 +1,12 @@
 #include "renderer/material.hpp"
 #include "platform/opengl/opengl_material.hpp"
+#include "platform/headless/headless_material.hpp"
 
 std::shared_ptr<Material> Material::Create(const std::string& name) {
     switch (RendererAPI::GetAPI()) {
         case RendererAPI::API::NONE:
-            return nullptr;
+        case RendererAPI::API::SOFTWARE:
+            return std::make_shared<HeadlessMaterial>(name);
         case RendererAPI::API::OPENGL:
             return std::make_shared<OpenGLMaterial>(name);
         default:
@@ -1,13 +1,75 @@
 #include "renderer/mesh.hpp"
 #include "platform/opengl/opengl_mesh.hpp"
+#include "platform/headless/headless_mesh.hpp"
+
+#include <algorithm>
+#include <cmath>
 
 std::shared_ptr<Mesh> Mesh::Create(std::string name) {
     switch (RendererAPI::GetAPI()) {
         case RendererAPI::API::NONE:   
-            return nullptr;
+        case RendererAPI::API::SOFTWARE:
+            return std::make_shared<HeadlessMesh>(name);
         case RendererAPI::API::OPENGL:
             return std::make_shared<OpenGLMesh>(name);
         default:
             throw std::runtime_error("Unknown Graphics API");
     }
-}
\ No newline at end of file
+}
+
+void Mesh::CalculateBounds() {
+    if (vertices.empty()) {
+        boundsMin = LA::vec3(0.0f);
+        boundsMax = LA::vec3(0.0f);
+        return;
+    }
+    boundsMin = vertices[0];
+    boundsMax = vertices[0];
+    for (const LA::vec3& v : vertices) {
+        boundsMin.x = std::min(boundsMin.x, v.x);
+        boundsMin.y = std::min(boundsMin.y, v.y);
+        boundsMin.z = std::min(boundsMin.z, v.z);
+        boundsMax.x = std::max(boundsMax.x, v.x);
+        boundsMax.y = std::max(boundsMax.y, v.y);
+        boundsMax.z = std::max(boundsMax.z, v.z);
+    }
+}
+
+uint32_t Mesh::GetLODCount() const {
+    return 1 + (uint32_t)lods.size();
+}
+
+const std::vector<uint32_t>& Mesh::GetLODIndices(uint32_t lod) const {
+    if (lod == 0 || lods.empty())
+        return indices;
+    return lods[std::min(lod, (uint32_t)lods.size()) - 1].indices;
+}
+
+uint32_t Mesh::GetTriangleCount(uint32_t lod) const {
+    const std::vector<uint32_t>& levelIndices = GetLODIndices(lod);
+    return (uint32_t)(levelIndices.empty() ? vertices.size() : levelIndices.size()) / 3;
+}
+
+size_t Mesh::GetTotalIndexCount() const {
+    size_t count = indices.size();
+    for (const MeshLOD& lod : lods)
+        count += lod.indices.size();
+    return count;
+}
+
+uint32_t Mesh::SelectLOD(float screenSize, uint32_t current) const {
+    float dx = boundsMax.x - boundsMin.x, dy = boundsMax.y - boundsMin.y, dz = boundsMax.z - boundsMin.z;
+    float diameter = std::sqrt(dx * dx + dy * dy + dz * dz);
+    if (lods.empty() || diameter <= 0.0f)
+        return 0;
+    float pixelsPerUnit = screenSize / diameter;
+    uint32_t lod = 0;
+    for (uint32_t i = 1; i <= (uint32_t)lods.size(); i++) {
+        // moving to a coarser level needs a margin, so a size near the limit doesn't flicker between two
+        float limit = i > current ? MESH_LOD_PIXEL_ERROR * (1.0f - MESH_LOD_HYSTERESIS) : MESH_LOD_PIXEL_ERROR;
+        if (lods[i - 1].error * pixelsPerUnit > limit)
+            break;
+        lod = i;
+    }
+    return lod;
+}
@@ -0,0 +1,315 @@
+#include "renderer/mesh_simplifier.hpp"
+
+#include <cmath>
+#include <map>
+#include <array>
+#include <queue>
+#include <algorithm>
+
+namespace {
+
+// symmetric 4x4 as xx xy xz xw yy yz yw zz zw ww
+struct Quadric {
+    double a[10] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+    void AddPlane(double x, double y, double z, double w) {
+        a[0] += x * x; a[1] += x * y; a[2] += x * z; a[3] += x * w;
+        a[4] += y * y; a[5] += y * z; a[6] += y * w;
+        a[7] += z * z; a[8] += z * w;
+        a[9] += w * w;
+    }
+
+    void Add(const Quadric& q) {
+        for (int i = 0; i < 10; i++)
+            a[i] += q.a[i];
+    }
+
+    // summed squared distance to every plane
+    double Evaluate(const LA::vec3& p) const {
+        double x = p.x, y = p.y, z = p.z;
+        double cost = a[0] * x * x + 2.0 * a[1] * x * y + 2.0 * a[2] * x * z + 2.0 * a[3] * x
+            + a[4] * y * y + 2.0 * a[5] * y * z + 2.0 * a[6] * y
+            + a[7] * z * z + 2.0 * a[8] * z + a[9];
+        return std::max(cost, 0.0);
+    }
+};
+
+struct Collapse {
+    double cost = 0.0;
+    // u merges into v
+    uint32_t u = 0;
+    uint32_t v = 0;
+    // versions of both positions when queued, a stale collapse is dropped when popped
+    uint32_t versionU = 0;
+    uint32_t versionV = 0;
+
+    bool operator>(const Collapse& other) const { return cost > other.cost; }
+};
+
+LA::vec3 Sub(const LA::vec3& a, const LA::vec3& b) {
+    return LA::vec3({a.x - b.x, a.y - b.y, a.z - b.z});
+}
+
+LA::vec3 Cross(const LA::vec3& a, const LA::vec3& b) {
+    return LA::vec3({a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x});
+}
+
+float Dot(const LA::vec3& a, const LA::vec3& b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+// works on welded vertices, triangles keep the index of the first vertex of each weld
+class Simplifier {
+public:
+    Simplifier(const std::vector<LA::vec3>& positions, const std::vector<LA::vec3>& normals, const std::vector<uint32_t>& indices)
+        : _positions(positions) {
+        uint32_t count = (uint32_t)positions.size();
+        bool hasNormals = normals.size() == positions.size();
+        _weld.resize(count);
+        _position.resize(count);
+        std::map<std::array<float, 3>, uint32_t> byPosition;
+        std::map<std::array<float, 6>, uint32_t> byVertex;
+        std::vector<uint32_t> welds;
+        for (uint32_t i = 0; i < count; i++) {
+            const LA::vec3& p = positions[i];
+            LA::vec3 n = hasNormals ? normals[i] : LA::vec3(0.0f);
+            _weld[i] = byVertex.emplace(std::array<float, 6>{p.x, p.y, p.z, n.x, n.y, n.z}, i).first->second;
+            auto placed = byPosition.emplace(std::array<float, 3>{p.x, p.y, p.z}, (uint32_t)welds.size());
+            if (placed.second)
+                welds.push_back(0);
+            _position[i] = placed.first->second;
+            // a position reached by a second distinct weld is a hard edge
+            if (_weld[i] == i)
+                welds[_position[i]]++;
+        }
+        _locked.resize(welds.size());
+        for (uint32_t p = 0; p < (uint32_t)welds.size(); p++)
+            _locked[p] = welds[p] > 1;
+
+        // triangles over welded vertices, open and non manifold edges lock their ends
+        std::map<std::pair<uint32_t, uint32_t>, uint32_t> edgeUse;
+        for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+            std::array<uint32_t, 3> tri;
+            bool valid = true;
+            for (int k = 0; k < 3; k++) {
+                valid &= indices[t + k] < count;
+                tri[k] = valid ? _weld[indices[t + k]] : 0;
+            }
+            if (!valid || _position[tri[0]] == _position[tri[1]] || _position[tri[1]] == _position[tri[2]]
+                || _position[tri[0]] == _position[tri[2]])
+                continue;
+            _triangles.push_back(tri);
+            for (int k = 0; k < 3; k++) {
+                uint32_t a = _position[tri[k]], b = _position[tri[(k + 1) % 3]];
+                edgeUse[{std::min(a, b), std::max(a, b)}]++;
+            }
+        }
+        for (const auto& [edge, uses] : edgeUse) {
+            if (uses != 2) {
+                _locked[edge.first] = true;
+                _locked[edge.second] = true;
+            }
+        }
+
+        _live = (uint32_t)_triangles.size();
+        _dead.assign(_triangles.size(), 0);
+        _quadrics.resize(welds.size());
+        _adjacent.resize(welds.size());
+        _removed.assign(welds.size(), 0);
+        _version.assign(welds.size(), 0);
+        for (uint32_t t = 0; t < (uint32_t)_triangles.size(); t++) {
+            const std::array<uint32_t, 3>& tri = _triangles[t];
+            LA::vec3 normal = Cross(Sub(positions[tri[1]], positions[tri[0]]), Sub(positions[tri[2]], positions[tri[0]]));
+            float length = std::sqrt(Dot(normal, normal));
+            if (length > 0.0f) {
+                double x = normal.x / length, y = normal.y / length, z = normal.z / length;
+                double w = -(x * positions[tri[0]].x + y * positions[tri[0]].y + z * positions[tri[0]].z);
+                for (int k = 0; k < 3; k++)
+                    _quadrics[_position[tri[k]]].AddPlane(x, y, z, w);
+            }
+            for (int k = 0; k < 3; k++)
+                _adjacent[_position[tri[k]]].push_back(t);
+        }
+        for (uint32_t t = 0; t < (uint32_t)_triangles.size(); t++)
+            QueueEdges(t);
+    }
+
+    uint32_t GetTriangleCount() const { return _live; }
+    float GetError() const { return (float)std::sqrt(_maxCost); }
+
+    // collapses until at most target triangles are left or nothing more can go
+    void Run(uint32_t target) {
+        while (_live > target && !_heap.empty()) {
+            Collapse collapse = _heap.top();
+            _heap.pop();
+            uint32_t pu = _position[collapse.u], pv = _position[collapse.v];
+            if (_removed[pu] || _removed[pv] || collapse.versionU != _version[pu] || collapse.versionV != _version[pv])
+                continue;
+            if (!CanCollapse(collapse.u, collapse.v))
+                continue;
+            Apply(collapse);
+        }
+    }
+
+    std::vector<uint32_t> GetIndices() const {
+        std::vector<uint32_t> out;
+        out.reserve(_live * 3);
+        for (uint32_t t = 0; t < (uint32_t)_triangles.size(); t++) {
+            if (!_dead[t])
+                out.insert(out.end(), _triangles[t].begin(), _triangles[t].end());
+        }
+        return out;
+    }
+
+private:
+    const std::vector<LA::vec3>& _positions;
+    // first vertex with the same position and normal, and the shared position id
+    std::vector<uint32_t> _weld;
+    std::vector<uint32_t> _position;
+    std::vector<std::array<uint32_t, 3>> _triangles;
+    std::vector<uint8_t> _dead;
+    // per position id, adjacent triangles are skipped once dead rather than erased
+    std::vector<uint8_t> _locked;
+    std::vector<Quadric> _quadrics;
+    std::vector<std::vector<uint32_t>> _adjacent;
+    std::vector<uint8_t> _removed;
+    std::vector<uint32_t> _version;
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> _heap;
+    uint32_t _live = 0;
+    double _maxCost = 0.0;
+
+    bool Contains(const std::array<uint32_t, 3>& tri, uint32_t position) const {
+        return _position[tri[0]] == position || _position[tri[1]] == position || _position[tri[2]] == position;
+    }
+
+    void QueueEdges(uint32_t t) {
+        const std::array<uint32_t, 3>& tri = _triangles[t];
+        for (int k = 0; k < 3; k++) {
+            for (int side = 0; side < 2; side++) {
+                uint32_t u = tri[k], v = tri[(k + (side ? 2 : 1)) % 3];
+                if (_locked[_position[u]])
+                    continue;
+                Quadric q = _quadrics[_position[u]];
+                q.Add(_quadrics[_position[v]]);
+                _heap.push({q.Evaluate(_positions[v]), u, v, _version[_position[u]], _version[_position[v]]});
+            }
+        }
+    }
+
+    // link condition, u and v may only share the neighbours across the triangles on their edge,
+    // and no triangle moving with u may flip or collapse
+    bool CanCollapse(uint32_t u, uint32_t v) const {
+        uint32_t pu = _position[u], pv = _position[v];
+        std::vector<uint32_t> aroundU, aroundV;
+        uint32_t shared = 0;
+        for (uint32_t t : _adjacent[pu]) {
+            if (_dead[t])
+                continue;
+            const std::array<uint32_t, 3>& tri = _triangles[t];
+            if (Contains(tri, pv)) {
+                shared++;
+                continue;
+            }
+            for (int k = 0; k < 3; k++)
+                aroundU.push_back(_position[tri[k]]);
+
+            LA::vec3 corners[3], moved[3];
+            for (int k = 0; k < 3; k++) {
+                corners[k] = _positions[tri[k]];
+                moved[k] = tri[k] == u ? _positions[v] : corners[k];
+            }
+            LA::vec3 before = Cross(Sub(corners[1], corners[0]), Sub(corners[2], corners[0]));
+            LA::vec3 after = Cross(Sub(moved[1], moved[0]), Sub(moved[2], moved[0]));
+            float afterLength = Dot(after, after);
+            if (afterLength <= 1e-12f * Dot(before, before) || Dot(before, after) <= 0.0f)
+                return false;
+            // beyond ~80 degrees the fold is too sharp even if it didn't flip
+            if (Dot(before, after) * Dot(before, after) < 0.03f * Dot(before, before) * afterLength)
+                return false;
+        }
+        if (shared == 0)
+            return false;
+        for (uint32_t t : _adjacent[pv]) {
+            if (!_dead[t]) {
+                for (int k = 0; k < 3; k++)
+                    aroundV.push_back(_position[_triangles[t][k]]);
+            }
+        }
+        std::sort(aroundU.begin(), aroundU.end());
+        aroundU.erase(std::unique(aroundU.begin(), aroundU.end()), aroundU.end());
+        std::sort(aroundV.begin(), aroundV.end());
+        aroundV.erase(std::unique(aroundV.begin(), aroundV.end()), aroundV.end());
+        uint32_t common = 0;
+        for (uint32_t p : aroundU)
+            common += p != pu && p != pv && std::binary_search(aroundV.begin(), aroundV.end(), p);
+        // each triangle on the edge brings one neighbour both ends already share
+        return common <= shared;
+    }
+
+    void Apply(const Collapse& collapse) {
+        uint32_t u = collapse.u, v = collapse.v;
+        uint32_t pu = _position[u], pv = _position[v];
+        _quadrics[pv].Add(_quadrics[pu]);
+        _maxCost = std::max(_maxCost, collapse.cost);
+
+        // u is unlocked, so it is the only vertex at its position
+        for (uint32_t t : _adjacent[pu]) {
+            if (_dead[t])
+                continue;
+            std::array<uint32_t, 3>& tri = _triangles[t];
+            if (Contains(tri, pv)) {
+                _dead[t] = 1;
+                _live--;
+            } else {
+                for (int k = 0; k < 3; k++) {
+                    if (tri[k] == u)
+                        tri[k] = v;
+                }
+                _adjacent[pv].push_back(t);
+            }
+        }
+        _removed[pu] = 1;
+        _adjacent[pu].clear();
+
+        // only costs involving v changed, the rest are checked again when popped
+        _version[pv]++;
+        for (uint32_t t : _adjacent[pv]) {
+            if (!_dead[t])
+                QueueEdges(t);
+        }
+    }
+};
+
+}
+
+std::vector<uint32_t> SimplifyMesh(const std::vector<LA::vec3>& positions, const std::vector<LA::vec3>& normals,
+    const std::vector<uint32_t>& indices, uint32_t targetTriangles, float& error) {
+    Simplifier simplifier(positions, normals, indices);
+    simplifier.Run(targetTriangles);
+    error = simplifier.GetError();
+    return simplifier.GetIndices();
+}
+
+std::vector<MeshLOD> GenerateLODs(const std::vector<LA::vec3>& positions, const std::vector<LA::vec3>& normals,
+    const std::vector<uint32_t>& indices) {
+    std::vector<MeshLOD> lods;
+    if (indices.size() < 3 || positions.empty())
+        return lods;
+    Simplifier simplifier(positions, normals, indices);
+    uint32_t previous = (uint32_t)(indices.size() / 3);
+    while (lods.size() < MESH_LOD_MAX) {
+        uint32_t target = (uint32_t)(previous * LOD_REDUCTION);
+        if (target < LOD_MIN_TRIANGLES)
+            break;
+        simplifier.Run(target);
+        uint32_t reached = simplifier.GetTriangleCount();
+        if (reached > previous * (1.0f - LOD_MIN_SAVING))
+            break;
+        MeshLOD lod;
+        lod.indices = simplifier.GetIndices();
+        lod.error = simplifier.GetError();
+        lods.push_back(std::move(lod));
+        previous = reached;
+    }
+    return lods;
+}
@@ -1,13 +1,625 @@
 #include "renderer/renderer.hpp"
 #include "platform/opengl/opengl_renderer.hpp"
+#include "platform/headless/headless_renderer.hpp"
+#include "platform/software/software_renderer.hpp"
+#include "core/profiler.hpp"
+
+#include <cstring>
+#include <cmath>
+#include <algorithm>
 
 Renderer& Renderer::Instance() {
     switch (RendererAPI::GetAPI()) {
         case RendererAPI::API::NONE:
-            throw std::runtime_error("No Graphics API");
+            return HeadlessRenderer::Instance();
         case RendererAPI::API::OPENGL:
             return OpenGLRenderer::Instance();
+        case RendererAPI::API::SOFTWARE:
+            return SoftwareRenderer::Instance();
         default:
             throw std::runtime_error("Unknown Graphics API");
     }
 }
+
+static void CopyVec3(float* dst, const LA::vec3& v) {
+    dst[0] = v.x;
+    dst[1] = v.y;
+    dst[2] = v.z;
+}
+
+void Renderer::SetCameraPosition(const LA::vec3& position) {
+    CopyVec3(_cameraBlock.position, position);
+    _frameDataDirty = true;
+}
+
+void Renderer::SetResolution(float width, float height) {
+    _cameraBlock.resolution[0] = width;
+    _cameraBlock.resolution[1] = height;
+    _cameraBlock.resolution[2] = 1.0f;
+    _frameDataDirty = true;
+}
+
+void Renderer::ClearLights() {
+    _lightBlock = LightBlock();
+    _clusterLights.clear();
+    _shadowLights.clear();
+    _shadowSources.clear();
+    _shadowBlock = ShadowBlock();
+    _directionalLightCount = 0;
+    _pointLightCount = 0;
+    _spotLightCount = 0;
+    _frameDataDirty = true;
+}
+
+void Renderer::AddDirectionalLight(const LA::vec3& colour, float intensity, const LA::vec3& direction, bool castShadows) {
+    if (_directionalLightCount >= DIRECTIONAL_LIGHT_MAX) {
+        static bool warned = false;
+        if (!warned)
+            std::cout << "WARNING (Renderer): Too many directional lights, only first " << DIRECTIONAL_LIGHT_MAX << " will be used" << std::endl;
+        warned = true;
+        return;
+    }
+    DirectionalLightData& light = _lightBlock.directional[_directionalLightCount++];
+    CopyVec3(light.colour, colour);
+    light.intensity = intensity;
+    CopyVec3(light.direction, direction);
+    light.enabled = 1;
+    _frameDataDirty = true;
+
+    if (castShadows) {
+        ShadowLight& shadow = _shadowLights.emplace_back();
+        CopyVec3(shadow.direction, direction);
+        _shadowSources.emplace_back().directional = (int32_t)_directionalLightCount - 1;
+    }
+}
+
+void Renderer::AddPointLight(const LA::vec3& colour, float intensity, const LA::vec3& position, float range) {
+    ClusterLightData& clustered = _clusterLights.emplace_back();
+    CopyVec3(clustered.position, position);
+    clustered.range = range;
+    CopyVec3(clustered.colour, colour);
+    clustered.intensity = intensity;
+    _frameDataDirty = true;
+
+    if (_pointLightCount >= POINT_LIGHT_MAX) {
+        static bool warned = false;
+        // clustered shaders still see every light
+        if (!warned && !_clusteredLighting) {
+            std::cout << "WARNING (Renderer): Too many point lights, only first " << POINT_LIGHT_MAX << " will be used" << std::endl;
+            warned = true;
+        }
+        return;
+    }
+    PointLightData& light = _lightBlock.point[_pointLightCount++];
+    CopyVec3(light.colour, colour);
+    light.intensity = intensity;
+    CopyVec3(light.position, position);
+    light.range = range;
+}
+
+void Renderer::AddSpotLight(const LA::vec3& colour, float intensity, const LA::vec3& position, const LA::vec3& direction, float cutOff, float outerCutOff, float range, bool castShadows) {
+    ClusterLightData& clustered = _clusterLights.emplace_back();
+    CopyVec3(clustered.position, position);
+    clustered.range = range;
+    CopyVec3(clustered.colour, colour);
+    clustered.intensity = intensity;
+    CopyVec3(clustered.direction, direction);
+    clustered.spot = 1.0f;
+    clustered.cutOff = std::cos(cutOff);
+    clustered.outerCutOff = std::cos(outerCutOff);
+    _frameDataDirty = true;
+
+    ShadowSource* source = nullptr;
+    if (castShadows) {
+        ShadowLight& shadow = _shadowLights.emplace_back();
+        shadow.spot = true;
+        CopyVec3(shadow.position, position);
+        CopyVec3(shadow.direction, direction);
+        shadow.outerCutOff = clustered.outerCutOff;
+        shadow.range = range;
+        source = &_shadowSources.emplace_back();
+        source->cluster = (int32_t)_clusterLights.size() - 1;
+    }
+
+    if (_spotLightCount >= SPOT_LIGHT_MAX) {
+        static bool warned = false;
+        // clustered shaders still see every light
+        if (!warned && !_clusteredLighting) {
+            std::cout << "WARNING (Renderer): Too many spot lights, only first " << SPOT_LIGHT_MAX << " will be used" << std::endl;
+            warned = true;
+        }
+        return;
+    }
+    SpotLightData& light = _lightBlock.spot[_spotLightCount++];
+    CopyVec3(light.colour, colour);
+    light.intensity = intensity;
+    CopyVec3(light.position, position);
+    light.range = range;
+    CopyVec3(light.direction, direction);
+    light.cutOff = clustered.cutOff;
+    light.outerCutOff = clustered.outerCutOff;
+    light.enabled = 1;
+    if (source)
+        source->spot = (int32_t)_spotLightCount - 1;
+}
+
+void Renderer::SetClusteredLighting(bool clustered) {
+    _clusteredLighting = clustered;
+    _frameDataDirty = true;
+}
+
+bool Renderer::IsClusteredLighting() const {
+    return _clusteredLighting;
+}
+
+const LightClusters& Renderer::GetLightClusters() const {
+    return _lightClusters;
+}
+
+void Renderer::BuildLightClusters() {
+    if (!_clusteredLighting)
+        return;
+    _lightClusters.Build(_view, _projection, _cameraBlock.resolution[0], _cameraBlock.resolution[1], _clusterLights);
+}
+
+void Renderer::RenderShadows(const ShadowCasters& casters, const Shader* shader) {
+    _shadowBlock = ShadowBlock();
+    if (!_shadows || shader == nullptr || _shadowLights.empty())
+        return;
+    PROFILE_SCOPE("Shadows");
+    _shadowMaps.Update(_view, _projection, _shadowLights, casters);
+    _shadowBlock = _shadowMaps.GetBlock();
+    for (uint32_t i = 0; i < (uint32_t)_shadowSources.size(); i++) {
+        int32_t shadow = _shadowMaps.GetShadow(i);
+        if (shadow < 0)
+            continue;
+        const ShadowSource& source = _shadowSources[i];
+        if (source.directional >= 0)
+            _shadowBlock.info[1] = source.directional;
+        if (source.spot >= 0)
+            _lightBlock.spot[source.spot].shadow = shadow;
+        if (source.cluster >= 0)
+            _clusterLights[source.cluster].shadow = (float)shadow;
+    }
+    _frameDataDirty = true;
+
+    const ShadowStats& stats = _shadowMaps.GetStats();
+    _stats.shadowViews += stats.rendered;
+    _stats.shadowCacheHits += stats.cacheHits;
+    if (stats.rendered == 0)
+        return;
+    BuildShadowBatches(casters, shader);
+    DrawShadows(shader);
+}
+
+void Renderer::BuildShadowBatches(const ShadowCasters& casters, const Shader* shader) {
+    _shadowBatches.clear();
+    _shadowInstances.clear();
+    bool instancing = shader->HasVariant(ShaderVariant::INSTANCED);
+    const std::vector<ShadowView>& views = _shadowMaps.GetViews();
+    for (uint32_t v = 0; v < (uint32_t)views.size(); v++) {
+        if (!views[v].dirty)
+            continue;
+        // same meshes next to each other, ties by index so batches don't depend on the sort
+        _shadowOrder = views[v].casters;
+        std::sort(_shadowOrder.begin(), _shadowOrder.end(), [&](uint32_t a, uint32_t b) {
+            return casters.meshes[a] != casters.meshes[b] ? casters.meshes[a] < casters.meshes[b] : a < b;
+        });
+        uint32_t first = 0;
+        while (first < (uint32_t)_shadowOrder.size()) {
+            Mesh* mesh = casters.meshes[_shadowOrder[first]];
+            uint32_t last = first + 1;
+            while (last < (uint32_t)_shadowOrder.size() && casters.meshes[_shadowOrder[last]] == mesh)
+                last++;
+            ShadowBatch& batch = _shadowBatches.emplace_back();
+            batch.view = v;
+            batch.mesh = mesh;
+            batch.first = (uint32_t)_shadowInstances.size();
+            batch.count = last - first;
+            batch.instanced = instancing && batch.count >= INSTANCE_BATCH_MIN;
+            for (uint32_t i = first; i < last; i++)
+                _shadowInstances.push_back(casters.models[_shadowOrder[i]]);
+            first = last;
+        }
+    }
+}
+
+void Renderer::SetShadows(bool shadows) {
+    _shadows = shadows;
+    _frameDataDirty = true;
+}
+
+bool Renderer::IsShadows() const {
+    return _shadows;
+}
+
+const ShadowMaps& Renderer::GetShadowMaps() const {
+    return _shadowMaps;
+}
+
+void Renderer::SetRenderPath(RenderPath path) {
+    _renderPath = path;
+}
+
+RenderPath Renderer::GetRenderPath() const {
+    return _renderPath;
+}
+
+void Renderer::SetDeferredShader(const std::shared_ptr<Shader>& shader) {
+    _deferredShader = shader;
+}
+
+void Renderer::SetSinglePassWireframe(bool singlePass) {
+    _singlePassWireframe = singlePass;
+}
+
+bool Renderer::IsSinglePassWireframe() const {
+    return _singlePassWireframe;
+}
+
+bool Renderer::CanOverlayWireframe(const Shader* shader) const {
+    return _singlePassWireframe && _renderPath == RenderPath::FORWARD && shader
+        && shader->HasVariant(ShaderVariant::WIREFRAME);
+}
+
+void Renderer::SetMeshLOD(bool lod) {
+    _meshLOD = lod;
+}
+
+bool Renderer::IsMeshLOD() const {
+    return _meshLOD;
+}
+
+bool Renderer::IsDeferredFlush() {
+    if (_renderPath != RenderPath::DEFERRED)
+        return false;
+    if (_deferredShader && _deferredShader->IsUsable())
+        return true;
+    static bool warned = false;
+    if (!warned)
+        std::cout << "WARNING (Renderer): Deferred path without a usable deferred shader, drawing forward." << std::endl;
+    warned = true;
+    return false;
+}
+
+bool Renderer::WritesGBuffer(const RenderPacket& packet) const {
+    return packet.pass == RenderPass::OPAQUE && packet.material->shader
+        && packet.material->shader->HasVariant(ShaderVariant::GBUFFER);
+}
+
+ShaderVariant Renderer::SelectVariant(const Shader* shader, bool instanced, bool gBuffer, bool wireframe) const {
+    if (gBuffer)
+        return MakeShaderVariant(instanced, false, true);
+    ShaderVariant clustered = MakeShaderVariant(instanced, true, false, wireframe);
+    if (_clusteredLighting && shader->HasVariant(clustered))
+        return clustered;
+    return MakeShaderVariant(instanced, false, false, wireframe);
+}
+
+uint64_t Renderer::MakeDepthKey(const LA::mat4& transform) const {
+    // view space distance of the object origin, positive floats sort by their bits
+    float viewZ = _view[0][2] * transform[3][0] + _view[1][2] * transform[3][1] + _view[2][2] * transform[3][2] + _view[3][2];
+    float distance = viewZ < 0.0f ? -viewZ : 0.0f;
+    uint32_t depthBits = 0;
+    std::memcpy(&depthBits, &distance, sizeof(float));
+    return (uint64_t)(depthBits >> 16);
+}
+
+uint64_t Renderer::MakeSortKey(RenderPass pass, const Shader* shader, const Material* material, const Mesh* mesh, const LA::mat4& transform) {
+    uint64_t key = 0;
+    key |= (uint64_t)((uint8_t)pass & 0xF) << 60;
+    key |= (uint64_t)(shader ? shader->sortId.Get() : 0) << 48;
+    key |= (uint64_t)material->sortId.Get() << 32;
+    // submitted packets draw LOD 0, the low 3 bits
+    key |= (uint64_t)mesh->sortId.Get() << 19;
+    key |= MakeDepthKey(transform);
+    return key;
+}
+
+void Renderer::Submit(const std::shared_ptr<Mesh>& mesh, const std::shared_ptr<Material>& material, const LA::mat4& transform, RenderPass pass) {
+    if (!mesh || !material) {
+        std::cout << "WARNING (Renderer): Trying to submit null mesh/material." << std::endl;
+        return;
+    }
+    RenderPacket packet;
+    packet.key = MakeSortKey(pass, material->shader.get(), material.get(), mesh.get(), transform);
+    packet.mesh = mesh.get();
+    packet.material = material.get();
+    packet.transform = transform;
+    packet.pass = pass;
+    _queue.push_back(packet);
+}
+
+uint32_t Renderer::ReservePackets(uint32_t count) {
+    uint32_t first = (uint32_t)_queue.size();
+    _queue.resize(first + count);
+    return first;
+}
+
+void Renderer::FillPacket(uint32_t index, Mesh* mesh, Material* material, const LA::mat4& transform, RenderPass pass, uint8_t lod) {
+    RenderPacket& packet = _queue[index];
+    packet.mesh = material ? mesh : nullptr;
+    packet.material = material;
+    packet.transform = transform;
+    packet.pass = pass;
+    packet.lod = std::min(lod, (uint8_t)MESH_LOD_MAX);
+    // ids are added by ResolvePackets
+    packet.key = MakeDepthKey(transform);
+}
+
+void Renderer::ResolvePackets(uint32_t first) {
+    uint32_t kept = first;
+    for (uint32_t i = first; i < (uint32_t)_queue.size(); i++) {
+        RenderPacket packet = _queue[i];
+        if (!packet.mesh)
+            continue;
+        const Shader* shader = packet.material->shader.get();
+        packet.key |= (uint64_t)((uint8_t)packet.pass & 0xF) << 60;
+        packet.key |= (uint64_t)(shader ? shader->sortId.Get() : 0) << 48;
+        packet.key |= (uint64_t)packet.material->sortId.Get() << 32;
+        packet.key |= ((uint64_t)((packet.mesh->sortId.Get() << 3) | (packet.lod & 0x7))) << 16;
+        _queue[kept++] = packet;
+    }
+    _queue.resize(kept);
+}
+
+void Renderer::SortQueue() {
+    size_t count = _queue.size();
+    _order.resize(count);
+    _orderScratch.resize(count);
+    for (size_t i = 0; i < count; i++)
+        _order[i] = (uint32_t)i;
+
+    for (uint32_t shift = 0; shift < 64; shift += 8) {
+        uint32_t histogram[256] = {0};
+        for (size_t i = 0; i < count; i++)
+            histogram[(_queue[i].key >> shift) & 0xFF]++;
+        // every key shares this byte, ordering is unchanged
+        if (count == 0 || histogram[(_queue[0].key >> shift) & 0xFF] == count)
+            continue;
+
+        uint32_t offset = 0;
+        for (uint32_t b = 0; b < 256; b++) {
+            uint32_t n = histogram[b];
+            histogram[b] = offset;
+            offset += n;
+        }
+        for (size_t i = 0; i < count; i++) {
+            uint32_t index = _order[i];
+            _orderScratch[histogram[(_queue[index].key >> shift) & 0xFF]++] = index;
+        }
+        _order.swap(_orderScratch);
+    }
+}
+
+void Renderer::BuildBatches() {
+    _batches.clear();
+    _instanceStaging.clear();
+    uint32_t count = (uint32_t)_order.size();
+    uint32_t first = 0;
+    while (first < count) {
+        // sorted queue keeps identical mesh+LOD+material+pass packets adjacent
+        const RenderPacket& head = _queue[_order[first]];
+        uint32_t last = first + 1;
+        while (last < count) {
+            const RenderPacket& p = _queue[_order[last]];
+            if (p.mesh != head.mesh || p.material != head.material || p.pass != head.pass || p.lod != head.lod)
+                break;
+            last++;
+        }
+
+        DrawBatch batch;
+        batch.first = first;
+        batch.count = last - first;
+        const Shader* shader = head.material->shader.get();
+        ShaderVariant instanced = head.pass == RenderPass::SHADED_WIREFRAME ? ShaderVariant::INSTANCED_WIREFRAME : ShaderVariant::INSTANCED;
+        batch.instanced = batch.count >= INSTANCE_BATCH_MIN
+            && shader != nullptr && shader->HasVariant(instanced);
+        if (batch.instanced) {
+            batch.instanceOffset = (uint32_t)_instanceStaging.size();
+            for (uint32_t i = first; i < last; i++)
+                _instanceStaging.push_back(_queue[_order[i]].transform);
+        }
+        _batches.push_back(batch);
+        first = last;
+    }
+}
+
+void Renderer::DrawBatches(bool gBuffer, bool deferred, DrawState& state) {
+    for (const DrawBatch& batch : _batches) {
+        bool writes = deferred && WritesGBuffer(_queue[_order[batch.first]]);
+        if (writes == gBuffer)
+            IssueBatch(batch, gBuffer, state);
+    }
+}
+
+void Renderer::SetDrawMode(DrawMode mode, DrawState& state) {
+    if (mode == state.drawMode)
+        return;
+    context->SetDrawMode(mode);
+    OnSetDrawMode(mode);
+    state.drawMode = mode;
+    _stats.drawModeChanges++;
+}
+
+void Renderer::IssueBatch(const DrawBatch& batch, bool gBuffer, DrawState& state) {
+    RenderPacket& head = _queue[_order[batch.first]];
+    Material* material = head.material;
+    if (!material->IsUsable() || !head.mesh->IsUsable())
+        return;
+
+    SetDrawMode(head.pass == RenderPass::WIREFRAME ? DrawMode::LINES : DrawMode::FILL, state);
+
+    // program change invalidates every uniform
+    const Shader* shader = material->shader.get();
+    ShaderVariant variant = SelectVariant(shader, batch.instanced, gBuffer, head.pass == RenderPass::SHADED_WIREFRAME);
+    if (shader != state.shader || variant != state.variant) {
+        shader->Bind(variant);
+        OnBindShader(shader, variant);
+        _stats.programBinds++;
+        state.shader = shader;
+        state.variant = variant;
+        state.material = nullptr;
+        state.model = shader->Locate("uModel");
+        // shaders without the camera block still get loose matrices
+        UniformHandle view = shader->Locate("uView");
+        UniformHandle projection = shader->Locate("uProjection");
+        if (view.IsValid()) {
+            shader->SetMat4(view, _view);
+            _stats.uniformUploads++;
+        }
+        if (projection.IsValid()) {
+            shader->SetMat4(projection, _projection);
+            _stats.uniformUploads++;
+        }
+    }
+    if (material != state.material) {
+        _stats.uniformUploads += material->Apply();
+        OnApplyMaterial(material);
+        state.material = material;
+    }
+    if (head.mesh != state.mesh) {
+        head.mesh->Bind();
+        OnBindMesh(head.mesh);
+        _stats.vaoBinds++;
+        state.mesh = head.mesh;
+    }
+
+    DrawCall draw;
+    draw.mesh = head.mesh;
+    draw.lod = head.lod;
+    draw.pass = head.pass;
+    draw.instanced = batch.instanced;
+    if (batch.instanced) {
+        draw.transforms = &_instanceStaging[batch.instanceOffset];
+        draw.count = batch.count;
+        draw.instanceOffset = batch.instanceOffset;
+        IssueDraw(draw, state);
+        _stats.draws++;
+        _stats.instances += batch.count;
+        _stats.triangles += head.mesh->GetTriangleCount(head.lod) * batch.count;
+        if (gBuffer)
+            _stats.gBufferDraws++;
+        return;
+    }
+    for (uint32_t i = batch.first; i < batch.first + batch.count; i++) {
+        RenderPacket& packet = _queue[_order[i]];
+        if (state.model.IsValid()) {
+            shader->SetMat4(state.model, packet.transform);
+            _stats.uniformUploads++;
+        }
+        draw.transforms = &packet.transform;
+        IssueDraw(draw, state);
+        _stats.draws++;
+        _stats.triangles += packet.mesh->GetTriangleCount(packet.lod);
+    }
+    if (gBuffer)
+        _stats.gBufferDraws += batch.count;
+}
+
+void Renderer::LightGBuffer(DrawState& state) {
+    ResolveGBuffer();
+    SetDrawMode(DrawMode::FILL, state);
+    const Shader* shader = _deferredShader.get();
+    ShaderVariant variant = SelectVariant(shader, false);
+    shader->Bind(variant);
+    OnBindShader(shader, variant);
+    _stats.programBinds++;
+    state.shader = shader;
+    state.variant = variant;
+    state.material = nullptr;
+    state.model = UniformHandle();
+    UniformHandle inverseViewProjection = shader->Locate("uInverseViewProjection");
+    if (inverseViewProjection.IsValid()) {
+        shader->SetMat4(inverseViewProjection, LA::inverse(_projection * _view));
+        _stats.uniformUploads++;
+    }
+    if (state.mesh) {
+        state.mesh->Unbind();
+        state.mesh = nullptr;
+    }
+
+    DrawLightingPass(state);
+    _stats.draws++;
+    _stats.lightingPasses++;
+}
+
+void Renderer::DrawShadowBatches(const Shader* shader) {
+    // batches are in view order, every dirty view is cleared even when nothing casts into it
+    const std::vector<ShadowView>& views = _shadowMaps.GetViews();
+    DrawState state;
+    UniformHandle viewProjection;
+    size_t next = 0;
+    for (uint32_t v = 0; v < (uint32_t)views.size(); v++) {
+        if (!views[v].dirty)
+            continue;
+        BeginShadowView(views[v]);
+        bool uploaded = false;
+        for (; next < _shadowBatches.size() && _shadowBatches[next].view == v; next++) {
+            const ShadowBatch& batch = _shadowBatches[next];
+            if (!batch.mesh->IsUsable())
+                continue;
+
+            ShaderVariant variant = batch.instanced ? ShaderVariant::INSTANCED : ShaderVariant::DEFAULT;
+            if (shader != state.shader || variant != state.variant) {
+                shader->Bind(variant);
+                OnBindShader(shader, variant);
+                _stats.programBinds++;
+                state.shader = shader;
+                state.variant = variant;
+                state.model = shader->Locate("uModel");
+                viewProjection = shader->Locate("uLightViewProjection");
+                uploaded = false;
+            }
+            if (!uploaded && viewProjection.IsValid()) {
+                shader->SetMat4(viewProjection, views[v].viewProjection);
+                _stats.uniformUploads++;
+                uploaded = true;
+            }
+            if (batch.mesh != state.mesh) {
+                batch.mesh->Bind();
+                OnBindMesh(batch.mesh);
+                _stats.vaoBinds++;
+                state.mesh = batch.mesh;
+            }
+
+            DrawCall draw;
+            draw.mesh = batch.mesh;
+            draw.pass = RenderPass::SHADOW;
+            draw.instanced = batch.instanced;
+            _stats.shadowCasters += batch.count;
+            if (batch.instanced) {
+                draw.transforms = &_shadowInstances[batch.first];
+                draw.count = batch.count;
+                draw.instanceOffset = batch.first;
+                IssueDraw(draw, state);
+                _stats.shadowDraws++;
+                continue;
+            }
+            for (uint32_t i = batch.first; i < batch.first + batch.count; i++) {
+                if (state.model.IsValid()) {
+                    shader->SetMat4(state.model, _shadowInstances[i]);
+                    _stats.uniformUploads++;
+                }
+                draw.transforms = &_shadowInstances[i];
+                IssueDraw(draw, state);
+                _stats.shadowDraws++;
+            }
+        }
+    }
+    if (state.mesh)
+        state.mesh->Unbind();
+}
+
+const RenderStats& Renderer::GetStats() const {
+    return _stats;
+}
+
+void Renderer::ResetStats() {
+    _stats = RenderStats();
+}
+
+void Renderer::RecordCulling(uint32_t visible, uint32_t culled) {
+    _stats.visible += visible;
+    _stats.culled += culled;
+}
@@ -1,12 +1,14 @@
 #include "renderer/shader.hpp"
 #include "platform/opengl/opengl_shader.hpp"
+#include "platform/headless/headless_shader.hpp"
 
-std::shared_ptr<Shader> Shader::Create(const std::string& name, std::shared_ptr<ShaderSource> vs, std::shared_ptr<ShaderSource> fs) {
+std::shared_ptr<Shader> Shader::Create(const std::string& name, std::shared_ptr<ShaderSource> vs, std::shared_ptr<ShaderSource> fs, std::shared_ptr<ShaderSource> gs) {
     switch (RendererAPI::GetAPI()) {
         case RendererAPI::API::NONE:
-            return nullptr;
+        case RendererAPI::API::SOFTWARE:
+            return std::make_shared<HeadlessShader>(name, vs, fs, gs);
         case RendererAPI::API::OPENGL:
-            return std::make_shared<OpenGLShader>(name, vs, fs);
+            return std::make_shared<OpenGLShader>(name, vs, fs, gs);
         default:
             throw std::runtime_error("Unknown Graphics API");
     }
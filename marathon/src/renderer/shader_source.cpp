@@ -1,10 +1,12 @@
 #include "renderer/shader_source.hpp"
 #include "platform/opengl/opengl_shader_source.hpp"
+#include "platform/headless/headless_shader_source.hpp"
 
 std::shared_ptr<ShaderSource> ShaderSource::Create(const std::string& name, const std::string& source, const ShaderStage& stage) {
     switch (RendererAPI::GetAPI()) {
         case RendererAPI::API::NONE:
-            return nullptr;
+        case RendererAPI::API::SOFTWARE:
+            return std::make_shared<HeadlessShaderSource>(name, source, stage);
         case RendererAPI::API::OPENGL:
             return std::make_shared<OpenGLShaderSource>(name, source, stage);
         default:
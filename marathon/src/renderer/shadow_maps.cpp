@@ -0,0 +1,302 @@
+#include "renderer/shadow_maps.hpp"
+#include "core/job_system.hpp"
+#include "core/profiler.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+
+void ShadowCasters::Resize(size_t count) {
+    bounds.Resize(count);
+    meshes.resize(count);
+    models.resize(count);
+    stamps.resize(count);
+}
+
+void ShadowCasters::Set(size_t i, Mesh* mesh, const LA::mat4& model, const LA::vec3& min, const LA::vec3& max, uint64_t stamp) {
+    bounds.Set(i, min, max);
+    meshes[i] = mesh;
+    models[i] = model;
+    stamps[i] = stamp;
+}
+
+size_t ShadowCasters::Size() const {
+    return meshes.size();
+}
+
+static float Dot3(const float* a, const float* b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+// right, up and forward of a light looking along direction, right x up points back at the light
+static void LightBasis(const float* direction, float* right, float* up, float* forward) {
+    float length = std::sqrt(Dot3(direction, direction));
+    for (int i = 0; i < 3; i++)
+        forward[i] = length > 0.0f ? direction[i] / length : (i == 2 ? -1.0f : 0.0f);
+    // world up unless the light points along it
+    float hint[3] = {0.0f, 1.0f, 0.0f};
+    if (std::abs(forward[1]) > 0.99f) {
+        hint[0] = 1.0f;
+        hint[1] = 0.0f;
+    }
+    right[0] = forward[1] * hint[2] - forward[2] * hint[1];
+    right[1] = forward[2] * hint[0] - forward[0] * hint[2];
+    right[2] = forward[0] * hint[1] - forward[1] * hint[0];
+    length = std::sqrt(Dot3(right, right));
+    for (int i = 0; i < 3; i++)
+        right[i] /= length;
+    up[0] = right[1] * forward[2] - right[2] * forward[1];
+    up[1] = right[2] * forward[0] - right[0] * forward[2];
+    up[2] = right[0] * forward[1] - right[1] * forward[0];
+}
+
+// rows of a column major matrix, m[col][row]
+static void SetRow(LA::mat4& m, int row, const float* xyz, float w) {
+    m[0][row] = xyz[0];
+    m[1][row] = xyz[1];
+    m[2][row] = xyz[2];
+    m[3][row] = w;
+}
+
+static uint64_t Hash(uint64_t hash, const void* data, size_t bytes) {
+    // FNV-1a
+    const uint8_t* p = (const uint8_t*)data;
+    for (size_t i = 0; i < bytes; i++) {
+        hash ^= p[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+void ShadowMaps::Update(const LA::mat4& view, const LA::mat4& projection, const std::vector<ShadowLight>& lights, const ShadowCasters& casters) {
+    PROFILE_SCOPE("Shadow Maps");
+    auto start = std::chrono::steady_clock::now();
+    _views.clear();
+    _block = ShadowBlock();
+    _stats = ShadowStats();
+    _lightShadows.assign(lights.size(), -1);
+
+    bool directional = false;
+    uint32_t spots = 0;
+    for (uint32_t i = 0; i < (uint32_t)lights.size(); i++) {
+        const ShadowLight& light = lights[i];
+        if (!light.spot && !directional) {
+            PlanCascades(view, projection, light);
+            directional = _block.info[0] > 0;
+            if (directional)
+                _lightShadows[i] = 0;
+        } else if (light.spot && spots < SHADOW_SPOT_MAX && light.range > 0.0f) {
+            PlanSpot(light, spots);
+            _lightShadows[i] = (int32_t)spots++;
+        }
+    }
+    _block.info[2] = (int32_t)spots;
+    _block.params[0] = 1.0f / SHADOW_ATLAS_SIZE;
+    _block.params[1] = SHADOW_DEPTH_BIAS;
+    _block.params[2] = SHADOW_NORMAL_OFFSET;
+
+    // casters of each view and its signature
+    _visible.resize(_views.size());
+    JobSystem::Instance().ParallelFor((uint32_t)_views.size(), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t v = begin; v < end; v++) {
+            ShadowView& shadow = _views[v];
+            std::vector<uint8_t>& visible = _visible[v];
+            shadow.casters.clear();
+            if (casters.Size() > 0)
+                CullBounds(Frustum::FromMatrix(shadow.viewProjection), casters.bounds, visible);
+            uint64_t hash = Hash(14695981039346656037ull, &shadow.viewProjection, sizeof(LA::mat4));
+            for (uint32_t i = 0; i < (uint32_t)casters.Size(); i++) {
+                if (!visible[i])
+                    continue;
+                shadow.casters.push_back(i);
+                hash = Hash(hash, &casters.stamps[i], sizeof(uint64_t));
+                hash = Hash(hash, &casters.meshes[i], sizeof(Mesh*));
+            }
+            // 0 is kept for empty slots
+            shadow.signature = hash | 1;
+        }
+    });
+
+    for (ShadowView& shadow : _views) {
+        shadow.dirty = _drawn[shadow.slot] != shadow.signature;
+        _drawn[shadow.slot] = shadow.signature;
+        _stats.views++;
+        if (shadow.dirty) {
+            _stats.rendered++;
+            _stats.casters += (uint32_t)shadow.casters.size();
+        } else {
+            _stats.cacheHits++;
+        }
+    }
+    _stats.updateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+ShadowView& ShadowMaps::AddView(uint32_t slot, const LA::mat4& viewProjection) {
+    ShadowView& shadow = _views.emplace_back();
+    shadow.slot = slot;
+    shadow.viewProjection = viewProjection;
+    if (slot < SHADOW_CASCADES) {
+        shadow.size = SHADOW_CASCADE_SIZE;
+        shadow.x = slot * SHADOW_CASCADE_SIZE;
+        shadow.y = 0;
+    } else {
+        uint32_t spot = slot - SHADOW_CASCADES;
+        uint32_t perRow = SHADOW_ATLAS_SIZE / SHADOW_SPOT_SIZE;
+        shadow.size = SHADOW_SPOT_SIZE;
+        shadow.x = (spot % perRow) * SHADOW_SPOT_SIZE;
+        shadow.y = SHADOW_CASCADE_SIZE + (spot / perRow) * SHADOW_SPOT_SIZE;
+    }
+
+    // clip space to the slot's atlas coordinates, depth to [0, 1]
+    const LA::mat4& m = viewProjection;
+    float scale = (float)shadow.size / SHADOW_ATLAS_SIZE;
+    float offset[2] = {(float)shadow.x / SHADOW_ATLAS_SIZE, (float)shadow.y / SHADOW_ATLAS_SIZE};
+    LA::mat4 atlas = m;
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 2; row++)
+            atlas[col][row] = 0.5f * scale * m[col][row] + (0.5f * scale + offset[row]) * m[col][3];
+        atlas[col][2] = 0.5f * m[col][2] + 0.5f * m[col][3];
+    }
+    if (slot < SHADOW_CASCADES)
+        _block.cascades[slot] = atlas;
+    else
+        _block.spots[slot - SHADOW_CASCADES] = atlas;
+    return shadow;
+}
+
+void ShadowMaps::PlanCascades(const LA::mat4& view, const LA::mat4& projection, const ShadowLight& light) {
+    // near and far planes back out of the depth row, as LightClusters does
+    const LA::mat4& p = projection;
+    float near = 0.0f, far = 0.0f;
+    if (p[2][3] != 0.0f) {
+        near = p[3][2] / (p[2][2] - 1.0f);
+        far = p[2][2] != -1.0f ? p[3][2] / (p[2][2] + 1.0f) : SHADOW_DISTANCE;
+    } else {
+        near = (p[3][2] + 1.0f) / p[2][2];
+        far = (p[3][2] - 1.0f) / p[2][2];
+    }
+    near = std::max(near, SHADOW_SPOT_NEAR);
+    far = std::min(far, SHADOW_DISTANCE);
+    if (!(far > near))
+        return;
+
+    float right[3], up[3], forward[3];
+    LightBasis(light.direction, right, up, forward);
+    float splitNear = near;
+    for (uint32_t c = 0; c < SHADOW_CASCADES; c++) {
+        float t = (float)(c + 1) / SHADOW_CASCADES;
+        float splitFar = SHADOW_CASCADE_LAMBDA * near * std::pow(far / near, t) + (1.0f - SHADOW_CASCADE_LAMBDA) * (near + (far - near) * t);
+        if (c == SHADOW_CASCADES - 1)
+            splitFar = far;
+
+        // bounding sphere of the slice in view space, where it doesn't change as the camera moves so
+        // neither do the box size and snap step, down to the last bit
+        float corners[8][3];
+        int k = 0;
+        for (float d : {splitNear, splitFar}) {
+            for (float ny : {-1.0f, 1.0f}) {
+                for (float nx : {-1.0f, 1.0f}) {
+                    float z = -d;
+                    float w = p[2][3] * z + p[3][3];
+                    corners[k][0] = (nx * w - p[2][0] * z - p[3][0]) / p[0][0];
+                    corners[k][1] = (ny * w - p[2][1] * z - p[3][1]) / p[1][1];
+                    corners[k][2] = z;
+                    k++;
+                }
+            }
+        }
+        float local[3] = {0.0f, 0.0f, 0.0f};
+        for (const float* corner : corners) {
+            for (int i = 0; i < 3; i++)
+                local[i] += corner[i] / 8.0f;
+        }
+        float radius = 0.0f;
+        for (const float* corner : corners) {
+            float d[3] = {corner[0] - local[0], corner[1] - local[1], corner[2] - local[2]};
+            radius = std::max(radius, std::sqrt(Dot3(d, d)));
+        }
+        // only the centre goes to world space, through the inverse of the rigid view
+        float centre[3];
+        for (int i = 0; i < 3; i++)
+            centre[i] = view[i][0] * (local[0] - view[3][0]) + view[i][1] * (local[1] - view[3][1]) + view[i][2] * (local[2] - view[3][2]);
+
+        // snap the centre to a whole number of texels, the padding keeps the slice inside
+        float half = radius * (1.0f + 1.0f / SHADOW_CASCADE_SNAP);
+        float texel = 2.0f * half / SHADOW_CASCADE_SIZE;
+        float step = texel * std::max(1.0f, std::floor(2.0f * radius / SHADOW_CASCADE_SNAP / texel));
+        float cx = std::round(Dot3(centre, right) / step) * step;
+        float cy = std::round(Dot3(centre, up) / step) * step;
+        float cz = std::round(Dot3(centre, forward) / step) * step;
+        float zMin = cz - half - SHADOW_CASTER_DISTANCE;
+        float zMax = cz + half;
+
+        LA::mat4 viewProjection = LA::mat4();
+        float rows[3][3];
+        for (int i = 0; i < 3; i++) {
+            rows[0][i] = right[i] / half;
+            rows[1][i] = up[i] / half;
+            rows[2][i] = forward[i] * 2.0f / (zMax - zMin);
+        }
+        SetRow(viewProjection, 0, rows[0], -cx / half);
+        SetRow(viewProjection, 1, rows[1], -cy / half);
+        SetRow(viewProjection, 2, rows[2], -2.0f * zMin / (zMax - zMin) - 1.0f);
+        const float none[3] = {0.0f, 0.0f, 0.0f};
+        SetRow(viewProjection, 3, none, 1.0f);
+
+        AddView(c, viewProjection);
+        _block.splits[c] = splitFar;
+        splitNear = splitFar;
+    }
+    _block.info[0] = SHADOW_CASCADES;
+}
+
+void ShadowMaps::PlanSpot(const ShadowLight& light, uint32_t index) {
+    float right[3], up[3], forward[3];
+    LightBasis(light.direction, right, up, forward);
+    float fov = std::min(2.0f * std::acos(std::clamp(light.outerCutOff, -1.0f, 1.0f)), SHADOW_SPOT_FOV_MAX * 3.14159265f / 180.0f);
+    float focal = 1.0f / std::tan(fov * 0.5f);
+    float near = std::min(SHADOW_SPOT_NEAR, light.range * 0.5f);
+    float far = light.range;
+    float a = (far + near) / (far - near);
+    float b = -2.0f * far * near / (far - near);
+
+    LA::mat4 viewProjection = LA::mat4();
+    float rows[3][3];
+    for (int i = 0; i < 3; i++) {
+        rows[0][i] = focal * right[i];
+        rows[1][i] = focal * up[i];
+        rows[2][i] = a * forward[i];
+    }
+    SetRow(viewProjection, 0, rows[0], -focal * Dot3(right, light.position));
+    SetRow(viewProjection, 1, rows[1], -focal * Dot3(up, light.position));
+    SetRow(viewProjection, 2, rows[2], -a * Dot3(forward, light.position) + b);
+    SetRow(viewProjection, 3, forward, -Dot3(forward, light.position));
+    AddView(SHADOW_CASCADES + index, viewProjection);
+}
+
+void ShadowMaps::Invalidate(uint32_t slot) {
+    if (slot < SHADOW_SLOTS)
+        _drawn[slot] = 0;
+}
+
+void ShadowMaps::Invalidate() {
+    for (uint64_t& signature : _drawn)
+        signature = 0;
+}
+
+const std::vector<ShadowView>& ShadowMaps::GetViews() const {
+    return _views;
+}
+
+const ShadowBlock& ShadowMaps::GetBlock() const {
+    return _block;
+}
+
+const ShadowStats& ShadowMaps::GetStats() const {
+    return _stats;
+}
+
+int32_t ShadowMaps::GetShadow(uint32_t light) const {
+    return light < _lightShadows.size() ? _lightShadows[light] : -1;
+}
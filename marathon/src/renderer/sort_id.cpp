@@ -0,0 +1,44 @@
+#include "renderer/sort_id.hpp"
+
+#include <vector>
+#include <mutex>
+
+static const uint32_t SORT_ID_BITS[3] = {SORT_ID_SHADER_BITS, SORT_ID_MATERIAL_BITS, SORT_ID_MESH_BITS};
+
+// assets are created and freed from loader workers as well as the main thread
+struct SortIdPool {
+    std::mutex mutex;
+    uint32_t next = 0;
+    std::vector<uint32_t> free;
+};
+
+// never freed, assets held by other statics still hand their ids back at exit
+static SortIdPool& GetPool(SortIdTable table) {
+    static SortIdPool* pools = new SortIdPool[3];
+    return pools[(uint32_t)table];
+}
+
+static uint32_t Acquire(SortIdTable table) {
+    SortIdPool& pool = GetPool(table);
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    if (pool.free.empty())
+        return pool.next++;
+    uint32_t id = pool.free.back();
+    pool.free.pop_back();
+    return id;
+}
+
+SortId::SortId(SortIdTable table)
+    : _table(table), _id(Acquire(table)) {
+    // wrap within the key field rather than spill into the bits next to it
+    _key = (uint16_t)(_id & ((1u << SORT_ID_BITS[(uint32_t)table]) - 1));
+}
+
+SortId::SortId(const SortId& other)
+    : SortId(other._table) {}
+
+SortId::~SortId() {
+    SortIdPool& pool = GetPool(_table);
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    pool.free.push_back(_id);
+}
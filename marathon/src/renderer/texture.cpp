@@ -0,0 +1,184 @@
+#include "renderer/texture.hpp"
+#include "platform/opengl/opengl_texture.hpp"
+#include "platform/headless/headless_texture.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+
+std::shared_ptr<Texture> Texture::Create(std::string name) {
+    switch (RendererAPI::GetAPI()) {
+        case RendererAPI::API::NONE:
+        case RendererAPI::API::SOFTWARE:
+            return std::make_shared<HeadlessTexture>(name);
+        case RendererAPI::API::OPENGL:
+            return std::make_shared<OpenGLTexture>(name);
+        default:
+            throw std::runtime_error("Unknown Graphics API");
+    }
+}
+
+uint32_t TextureFormatChannels(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::R8:
+        case TextureFormat::R32F:
+        case TextureFormat::BC4:
+            return 1;
+        case TextureFormat::RG8:
+        case TextureFormat::RG32F:
+        case TextureFormat::BC5:
+            return 2;
+        case TextureFormat::RGB8:
+        case TextureFormat::RGB32F:
+        case TextureFormat::BC1:
+            return 3;
+        case TextureFormat::RGBA8:
+        case TextureFormat::RGBA32F:
+        case TextureFormat::BC3:
+            return 4;
+    }
+    return 0;
+}
+
+bool TextureFormatIsFloat(TextureFormat format) {
+    return format == TextureFormat::R32F || format == TextureFormat::RG32F
+        || format == TextureFormat::RGB32F || format == TextureFormat::RGBA32F;
+}
+
+bool TextureFormatIsCompressed(TextureFormat format) {
+    return format == TextureFormat::BC1 || format == TextureFormat::BC3
+        || format == TextureFormat::BC4 || format == TextureFormat::BC5;
+}
+
+uint32_t TextureFormatPixelSize(TextureFormat format) {
+    if (TextureFormatIsCompressed(format))
+        return 0;
+    return TextureFormatChannels(format) * (TextureFormatIsFloat(format) ? sizeof(float) : sizeof(uint8_t));
+}
+
+uint32_t TextureFormatBlockSize(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::BC1:
+        case TextureFormat::BC4:
+            return 8;
+        case TextureFormat::BC3:
+        case TextureFormat::BC5:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+size_t TextureLevelSize(TextureFormat format, uint32_t width, uint32_t height) {
+    if (TextureFormatIsCompressed(format))
+        return (size_t)((width + 3) / 4) * ((height + 3) / 4) * TextureFormatBlockSize(format);
+    return (size_t)width * height * TextureFormatPixelSize(format);
+}
+
+TextureMemoryUsage GetMipChainMemory(const std::vector<std::vector<uint8_t>>& mips, uint32_t width, uint32_t height, TextureFormat format) {
+    TextureMemoryUsage memory;
+    for (uint32_t level = 0; level < mips.size(); level++) {
+        memory.bytes += mips[level].size();
+        memory.uncompressedBytes += TextureFormatIsFloat(format) ? mips[level].size()
+            : (size_t)std::max(1u, width >> level) * std::max(1u, height >> level) * 4;
+    }
+    return memory;
+}
+
+// averages each 2x2 block, the last row/column is repeated for odd sizes
+template<typename T>
+static void Downsample(const T* src, uint32_t width, uint32_t height, T* dst, uint32_t channels) {
+    uint32_t dstWidth = std::max(1u, width / 2);
+    uint32_t dstHeight = std::max(1u, height / 2);
+    for (uint32_t y = 0; y < dstHeight; y++) {
+        const T* row0 = src + (size_t)std::min(y * 2, height - 1) * width * channels;
+        const T* row1 = src + (size_t)std::min(y * 2 + 1, height - 1) * width * channels;
+        for (uint32_t x = 0; x < dstWidth; x++) {
+            size_t x0 = (size_t)std::min(x * 2, width - 1) * channels;
+            size_t x1 = (size_t)std::min(x * 2 + 1, width - 1) * channels;
+            T* out = dst + ((size_t)y * dstWidth + x) * channels;
+            for (uint32_t c = 0; c < channels; c++) {
+                if constexpr (std::is_floating_point_v<T>) {
+                    out[c] = (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c]) * 0.25f;
+                } else {
+                    out[c] = (T)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+                }
+            }
+        }
+    }
+}
+
+// srgb byte to linear and back, both through lookup tables
+static float SrgbToLinear(uint8_t value) {
+    static const std::vector<float> table = []() {
+        std::vector<float> t(256);
+        for (uint32_t i = 0; i < 256; i++) {
+            float c = i / 255.0f;
+            t[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return t;
+    }();
+    return table[value];
+}
+
+static uint8_t LinearToSrgb(float value) {
+    static const std::vector<uint8_t> table = []() {
+        std::vector<uint8_t> t(4096);
+        for (uint32_t i = 0; i < 4096; i++) {
+            float c = i / 4095.0f;
+            c = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+            t[i] = (uint8_t)std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f);
+        }
+        return t;
+    }();
+    return table[(uint32_t)std::clamp(value * 4095.0f + 0.5f, 0.0f, 4095.0f)];
+}
+
+// Downsample for gamma encoded colour, averages in linear space, alpha stays linear
+static void DownsampleSrgb(const uint8_t* src, uint32_t width, uint32_t height, uint8_t* dst, uint32_t channels) {
+    uint32_t dstWidth = std::max(1u, width / 2);
+    uint32_t dstHeight = std::max(1u, height / 2);
+    for (uint32_t y = 0; y < dstHeight; y++) {
+        const uint8_t* row0 = src + (size_t)std::min(y * 2, height - 1) * width * channels;
+        const uint8_t* row1 = src + (size_t)std::min(y * 2 + 1, height - 1) * width * channels;
+        for (uint32_t x = 0; x < dstWidth; x++) {
+            size_t x0 = (size_t)std::min(x * 2, width - 1) * channels;
+            size_t x1 = (size_t)std::min(x * 2 + 1, width - 1) * channels;
+            uint8_t* out = dst + ((size_t)y * dstWidth + x) * channels;
+            for (uint32_t c = 0; c < std::min(channels, 3u); c++) {
+                float sum = SrgbToLinear(row0[x0 + c]) + SrgbToLinear(row0[x1 + c]) + SrgbToLinear(row1[x0 + c]) + SrgbToLinear(row1[x1 + c]);
+                out[c] = LinearToSrgb(sum * 0.25f);
+            }
+            if (channels == 4)
+                out[3] = (uint8_t)((row0[x0 + 3] + row0[x1 + 3] + row1[x0 + 3] + row1[x1 + 3] + 2) / 4);
+        }
+    }
+}
+
+void GenerateMipChain(std::vector<std::vector<uint8_t>>& mips, uint32_t width, uint32_t height, TextureFormat format, bool srgb) {
+    if (mips.empty() || width == 0 || height == 0)
+        return;
+    if (TextureFormatIsCompressed(format)) {
+        std::cout << "WARNING (Texture): Can't build mips from block compressed pixels." << std::endl;
+        return;
+    }
+    mips.resize(1);
+
+    uint32_t channels = TextureFormatChannels(format);
+    uint32_t pixelSize = TextureFormatPixelSize(format);
+    while (width > 1 || height > 1) {
+        uint32_t mipWidth = std::max(1u, width / 2);
+        uint32_t mipHeight = std::max(1u, height / 2);
+        std::vector<uint8_t> mip((size_t)mipWidth * mipHeight * pixelSize);
+        const uint8_t* src = mips.back().data();
+        if (TextureFormatIsFloat(format))
+            Downsample((const float*)src, width, height, (float*)mip.data(), channels);
+        else if (srgb)
+            DownsampleSrgb(src, width, height, mip.data(), channels);
+        else
+            Downsample(src, width, height, mip.data(), channels);
+        mips.push_back(std::move(mip));
+        width = mipWidth;
+        height = mipHeight;
+    }
+}
@@ -0,0 +1,431 @@
+#include "renderer/texture_compression.hpp"
+#include "core/job_system.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+#ifdef TEXTURE_COMPRESSION_SSE2
+#include <emmintrin.h>
+#endif
+
+TextureFormat GetCompressedFormat(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::R8:    return TextureFormat::BC4;
+        case TextureFormat::RG8:   return TextureFormat::BC5;
+        case TextureFormat::RGB8:  return TextureFormat::BC1;
+        case TextureFormat::RGBA8: return TextureFormat::BC3;
+        default:                   return format;
+    }
+}
+
+TextureFormat GetDecompressedFormat(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::BC1: return TextureFormat::RGBA8;
+        case TextureFormat::BC3: return TextureFormat::RGBA8;
+        case TextureFormat::BC4: return TextureFormat::R8;
+        case TextureFormat::BC5: return TextureFormat::RG8;
+        default:                 return format;
+    }
+}
+
+// gathers a 4x4 block as RGBA, edge pixels repeat past the image bounds
+static void LoadColourBlock(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels,
+                            uint32_t bx, uint32_t by, uint8_t block[64]) {
+    for (uint32_t y = 0; y < 4; y++) {
+        uint32_t py = std::min(by * 4 + y, height - 1);
+        for (uint32_t x = 0; x < 4; x++) {
+            uint32_t px = std::min(bx * 4 + x, width - 1);
+            const uint8_t* src = pixels + ((size_t)py * width + px) * channels;
+            uint8_t* dst = block + (y * 4 + x) * 4;
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+            dst[3] = channels == 4 ? src[3] : 255;
+        }
+    }
+}
+
+static void LoadChannelBlock(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels,
+                             uint32_t channel, uint32_t bx, uint32_t by, uint8_t block[16]) {
+    for (uint32_t y = 0; y < 4; y++) {
+        uint32_t py = std::min(by * 4 + y, height - 1);
+        for (uint32_t x = 0; x < 4; x++) {
+            uint32_t px = std::min(bx * 4 + x, width - 1);
+            block[y * 4 + x] = pixels[((size_t)py * width + px) * channels + channel];
+        }
+    }
+}
+
+static void ColourBounds(const uint8_t block[64], uint8_t lo[4], uint8_t hi[4]) {
+#ifdef TEXTURE_COMPRESSION_SSE2
+    __m128i p0 = _mm_loadu_si128((const __m128i*)(block + 0));
+    __m128i p1 = _mm_loadu_si128((const __m128i*)(block + 16));
+    __m128i p2 = _mm_loadu_si128((const __m128i*)(block + 32));
+    __m128i p3 = _mm_loadu_si128((const __m128i*)(block + 48));
+    __m128i mn = _mm_min_epu8(_mm_min_epu8(p0, p1), _mm_min_epu8(p2, p3));
+    __m128i mx = _mm_max_epu8(_mm_max_epu8(p0, p1), _mm_max_epu8(p2, p3));
+    // fold the four pixels in each register down to one
+    mn = _mm_min_epu8(mn, _mm_shuffle_epi32(mn, _MM_SHUFFLE(1, 0, 3, 2)));
+    mx = _mm_max_epu8(mx, _mm_shuffle_epi32(mx, _MM_SHUFFLE(1, 0, 3, 2)));
+    mn = _mm_min_epu8(mn, _mm_shuffle_epi32(mn, _MM_SHUFFLE(2, 3, 0, 1)));
+    mx = _mm_max_epu8(mx, _mm_shuffle_epi32(mx, _MM_SHUFFLE(2, 3, 0, 1)));
+    int32_t mnBits = _mm_cvtsi128_si32(mn);
+    int32_t mxBits = _mm_cvtsi128_si32(mx);
+    std::memcpy(lo, &mnBits, 4);
+    std::memcpy(hi, &mxBits, 4);
+#else
+    for (uint32_t c = 0; c < 4; c++) {
+        lo[c] = 255;
+        hi[c] = 0;
+    }
+    for (uint32_t i = 0; i < 16; i++) {
+        for (uint32_t c = 0; c < 4; c++) {
+            lo[c] = std::min(lo[c], block[i * 4 + c]);
+            hi[c] = std::max(hi[c], block[i * 4 + c]);
+        }
+    }
+#endif
+}
+
+static void ChannelBounds(const uint8_t block[16], uint8_t& lo, uint8_t& hi) {
+#ifdef TEXTURE_COMPRESSION_SSE2
+    __m128i v = _mm_loadu_si128((const __m128i*)block);
+    __m128i mn = _mm_min_epu8(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    __m128i mx = _mm_max_epu8(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    mn = _mm_min_epu8(mn, _mm_shuffle_epi32(mn, _MM_SHUFFLE(2, 3, 0, 1)));
+    mx = _mm_max_epu8(mx, _mm_shuffle_epi32(mx, _MM_SHUFFLE(2, 3, 0, 1)));
+    mn = _mm_min_epu8(mn, _mm_shufflelo_epi16(mn, _MM_SHUFFLE(2, 3, 0, 1)));
+    mx = _mm_max_epu8(mx, _mm_shufflelo_epi16(mx, _MM_SHUFFLE(2, 3, 0, 1)));
+    mn = _mm_min_epu8(mn, _mm_srli_epi16(mn, 8));
+    mx = _mm_max_epu8(mx, _mm_srli_epi16(mx, 8));
+    lo = (uint8_t)_mm_cvtsi128_si32(mn);
+    hi = (uint8_t)_mm_cvtsi128_si32(mx);
+#else
+    lo = 255;
+    hi = 0;
+    for (uint32_t i = 0; i < 16; i++) {
+        lo = std::min(lo, block[i]);
+        hi = std::max(hi, block[i]);
+    }
+#endif
+}
+
+// dot((pixel - origin).rgb, axis) for all 16 pixels
+static void ProjectColours(const uint8_t block[64], const int32_t origin[3], const int32_t axis[3], int32_t out[16]) {
+#ifdef TEXTURE_COMPRESSION_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i o = _mm_setr_epi16(origin[0], origin[1], origin[2], 0, origin[0], origin[1], origin[2], 0);
+    const __m128i a = _mm_setr_epi16(axis[0], axis[1], axis[2], 0, axis[0], axis[1], axis[2], 0);
+    for (uint32_t i = 0; i < 4; i++) {
+        __m128i p = _mm_loadu_si128((const __m128i*)(block + i * 16));
+        // two pixels per register as 16 bit, madd leaves rg and b sums per pixel
+        __m128i lo = _mm_madd_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(p, zero), o), a);
+        __m128i hi = _mm_madd_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(p, zero), o), a);
+        lo = _mm_add_epi32(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 3, 0, 1)));
+        hi = _mm_add_epi32(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 3, 0, 1)));
+        // pixel sums sit in lanes 0 and 2 of each
+        __m128i sums = _mm_unpacklo_epi64(_mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 2, 0)), _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 2, 0)));
+        _mm_storeu_si128((__m128i*)(out + i * 4), sums);
+    }
+#else
+    for (uint32_t i = 0; i < 16; i++) {
+        const uint8_t* p = block + i * 4;
+        out[i] = (p[0] - origin[0]) * axis[0] + (p[1] - origin[1]) * axis[1] + (p[2] - origin[2]) * axis[2];
+    }
+#endif
+}
+
+static uint16_t To565(const int32_t c[3]) {
+    return (uint16_t)((((c[0] * 31 + 127) / 255) << 11) | (((c[1] * 63 + 127) / 255) << 5) | ((c[2] * 31 + 127) / 255));
+}
+
+static void From565(uint16_t v, int32_t c[3]) {
+    int32_t r = (v >> 11) & 31;
+    int32_t g = (v >> 5) & 63;
+    int32_t b = v & 31;
+    c[0] = (r << 3) | (r >> 2);
+    c[1] = (g << 2) | (g >> 4);
+    c[2] = (b << 3) | (b >> 2);
+}
+
+static void EncodeBC1Block(const uint8_t block[64], uint8_t out[8]) {
+    uint8_t lo[4], hi[4];
+    ColourBounds(block, lo, hi);
+
+    // inset the box a little, extremes are rarely worth an endpoint
+    int32_t mn[3], mx[3], centre[3];
+    for (uint32_t c = 0; c < 3; c++) {
+        int32_t inset = (hi[c] - lo[c]) >> 4;
+        mn[c] = lo[c] + inset;
+        mx[c] = hi[c] - inset;
+        centre[c] = (lo[c] + hi[c] + 1) / 2;
+    }
+
+    // pick the box diagonal that follows the colours, by covariance sign against red (or green)
+    int32_t covRG = 0, covRB = 0, covGB = 0;
+    for (uint32_t i = 0; i < 16; i++) {
+        int32_t r = block[i * 4 + 0] - centre[0];
+        int32_t g = block[i * 4 + 1] - centre[1];
+        int32_t b = block[i * 4 + 2] - centre[2];
+        covRG += r * g;
+        covRB += r * b;
+        covGB += g * b;
+    }
+    int32_t e0[3] = {mx[0], mx[1], mx[2]};
+    int32_t e1[3] = {mn[0], mn[1], mn[2]};
+    if (hi[0] != lo[0]) {
+        if (covRG < 0)
+            std::swap(e0[1], e1[1]);
+        if (covRB < 0)
+            std::swap(e0[2], e1[2]);
+    } else if (covGB < 0) {
+        std::swap(e0[2], e1[2]);
+    }
+
+    uint16_t c0 = To565(e0);
+    uint16_t c1 = To565(e1);
+    uint32_t indices = 0;
+    if (c0 != c1) {
+        // project against the endpoints the decoder will actually see
+        int32_t q0[3], q1[3], axis[3];
+        From565(c0, q0);
+        From565(c1, q1);
+        int32_t length = 0;
+        for (uint32_t c = 0; c < 3; c++) {
+            axis[c] = q0[c] - q1[c];
+            length += axis[c] * axis[c];
+        }
+        int32_t t[16];
+        ProjectColours(block, q1, axis, t);
+        // q1 -> 1, 1/3 -> 3, 2/3 -> 2, q0 -> 0
+        static const uint32_t remap[4] = {1, 3, 2, 0};
+        for (uint32_t i = 0; i < 16; i++) {
+            int32_t step = (int32_t)(((int64_t)t[i] * 6 + length) / (2 * (int64_t)length));
+            step = std::clamp(step, 0, 3);
+            indices |= remap[step] << (i * 2);
+        }
+        // four colour mode needs c0 > c1, swapping endpoints flips 0<->1 and 2<->3
+        if (c0 < c1) {
+            std::swap(c0, c1);
+            indices ^= 0x55555555u;
+        }
+    }
+
+    std::memcpy(out + 0, &c0, 2);
+    std::memcpy(out + 2, &c1, 2);
+    std::memcpy(out + 4, &indices, 4);
+}
+
+static void EncodeBC4Block(const uint8_t block[16], uint8_t out[8]) {
+    uint8_t lo, hi;
+    ChannelBounds(block, lo, hi);
+    out[0] = hi;
+    out[1] = lo;
+    uint64_t indices = 0;
+    if (hi != lo) {
+        // eight value mode as a0 > a1: a0 -> 0, a1 -> 1, interpolants 6/7..1/7 -> 2..7
+        int32_t range = hi - lo;
+        for (uint32_t i = 0; i < 16; i++) {
+            int32_t step = ((block[i] - lo) * 14 + range) / (2 * range);
+            uint64_t index = step == 7 ? 0 : (step == 0 ? 1 : 8 - step);
+            indices |= index << (i * 3);
+        }
+    }
+    for (uint32_t i = 0; i < 6; i++)
+        out[2 + i] = (uint8_t)(indices >> (i * 8));
+}
+
+static void DecodeBC1Block(const uint8_t in[8], uint8_t block[64], bool forceFourColour) {
+    uint16_t c0, c1;
+    uint32_t indices;
+    std::memcpy(&c0, in + 0, 2);
+    std::memcpy(&c1, in + 2, 2);
+    std::memcpy(&indices, in + 4, 4);
+    int32_t palette[4][4];
+    From565(c0, palette[0]);
+    From565(c1, palette[1]);
+    palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+    for (uint32_t c = 0; c < 3; c++) {
+        if (c0 > c1 || forceFourColour) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        } else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    if (c0 <= c1 && !forceFourColour)
+        palette[3][3] = 0;
+    for (uint32_t i = 0; i < 16; i++) {
+        const int32_t* p = palette[(indices >> (i * 2)) & 3];
+        for (uint32_t c = 0; c < 4; c++)
+            block[i * 4 + c] = (uint8_t)p[c];
+    }
+}
+
+static void DecodeBC4Block(const uint8_t in[8], uint8_t block[16]) {
+    int32_t a0 = in[0];
+    int32_t a1 = in[1];
+    int32_t palette[8] = {a0, a1};
+    if (a0 > a1) {
+        for (int32_t i = 2; i < 8; i++)
+            palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+    } else {
+        for (int32_t i = 2; i < 6; i++)
+            palette[i] = ((6 - i) * a0 + (i - 1) * a1) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    uint64_t indices = 0;
+    for (uint32_t i = 0; i < 6; i++)
+        indices |= (uint64_t)in[2 + i] << (i * 8);
+    for (uint32_t i = 0; i < 16; i++)
+        block[i] = (uint8_t)palette[(indices >> (i * 3)) & 7];
+}
+
+// encodes block rows [rowBegin, rowEnd), out points at the first block of rowBegin
+static void CompressRows(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels, TextureFormat target,
+                         uint32_t rowBegin, uint32_t rowEnd, uint8_t* out) {
+    uint32_t blocksX = (width + 3) / 4;
+    uint8_t colour[64];
+    uint8_t channel[16];
+    for (uint32_t by = rowBegin; by < rowEnd; by++) {
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            switch (target) {
+                case TextureFormat::BC1:
+                    LoadColourBlock(pixels, width, height, channels, bx, by, colour);
+                    EncodeBC1Block(colour, out);
+                    out += 8;
+                    break;
+                case TextureFormat::BC3:
+                    LoadChannelBlock(pixels, width, height, channels, 3, bx, by, channel);
+                    EncodeBC4Block(channel, out);
+                    LoadColourBlock(pixels, width, height, channels, bx, by, colour);
+                    EncodeBC1Block(colour, out + 8);
+                    out += 16;
+                    break;
+                case TextureFormat::BC4:
+                    LoadChannelBlock(pixels, width, height, channels, 0, bx, by, channel);
+                    EncodeBC4Block(channel, out);
+                    out += 8;
+                    break;
+                case TextureFormat::BC5:
+                    LoadChannelBlock(pixels, width, height, channels, 0, bx, by, channel);
+                    EncodeBC4Block(channel, out);
+                    LoadChannelBlock(pixels, width, height, channels, 1, bx, by, channel);
+                    EncodeBC4Block(channel, out + 8);
+                    out += 16;
+                    break;
+                default:
+                    return;
+            }
+        }
+    }
+}
+
+void CompressImage(const uint8_t* pixels, uint32_t width, uint32_t height, TextureFormat source, TextureFormat target, uint8_t* out) {
+    uint32_t channels = TextureFormatChannels(source);
+    uint32_t blocksX = (width + 3) / 4;
+    uint32_t blocksY = (height + 3) / 4;
+    size_t rowBytes = (size_t)blocksX * TextureFormatBlockSize(target);
+    // block rows are independent, large images are split across the job system
+    JobSystem::Instance().ParallelFor(blocksY, TEXTURE_COMPRESSION_ROW_GRAIN, [&](uint32_t begin, uint32_t end) {
+        CompressRows(pixels, width, height, channels, target, begin, end, out + begin * rowBytes);
+    });
+}
+
+// decodes block rows [rowBegin, rowEnd) into the full image
+static void DecompressRows(const uint8_t* blocks, uint32_t width, uint32_t height, uint32_t channels, uint32_t blockSize,
+                           TextureFormat source, uint32_t rowBegin, uint32_t rowEnd, uint8_t* out) {
+    uint32_t blocksX = (width + 3) / 4;
+    uint8_t colour[64];
+    uint8_t red[16];
+    uint8_t green[16];
+    for (uint32_t by = rowBegin; by < rowEnd; by++) {
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            const uint8_t* in = blocks + ((size_t)by * blocksX + bx) * blockSize;
+            switch (source) {
+                case TextureFormat::BC1:
+                    DecodeBC1Block(in, colour, false);
+                    break;
+                case TextureFormat::BC3:
+                    DecodeBC1Block(in + 8, colour, true);
+                    DecodeBC4Block(in, red);
+                    for (uint32_t i = 0; i < 16; i++)
+                        colour[i * 4 + 3] = red[i];
+                    break;
+                case TextureFormat::BC4:
+                    DecodeBC4Block(in, red);
+                    break;
+                case TextureFormat::BC5:
+                    DecodeBC4Block(in, red);
+                    DecodeBC4Block(in + 8, green);
+                    break;
+                default:
+                    return;
+            }
+            // write back the part of the block inside the image
+            for (uint32_t y = 0; y < 4 && by * 4 + y < height; y++) {
+                for (uint32_t x = 0; x < 4 && bx * 4 + x < width; x++) {
+                    uint8_t* dst = out + ((size_t)(by * 4 + y) * width + bx * 4 + x) * channels;
+                    uint32_t i = y * 4 + x;
+                    if (channels == 4) {
+                        std::memcpy(dst, colour + i * 4, 4);
+                    } else {
+                        dst[0] = red[i];
+                        if (channels == 2)
+                            dst[1] = green[i];
+                    }
+                }
+            }
+        }
+    }
+}
+
+void DecompressImage(const uint8_t* blocks, uint32_t width, uint32_t height, TextureFormat source, uint8_t* out) {
+    uint32_t channels = TextureFormatChannels(GetDecompressedFormat(source));
+    uint32_t blockSize = TextureFormatBlockSize(source);
+    uint32_t blocksY = (height + 3) / 4;
+    JobSystem::Instance().ParallelFor(blocksY, TEXTURE_COMPRESSION_ROW_GRAIN, [&](uint32_t begin, uint32_t end) {
+        DecompressRows(blocks, width, height, channels, blockSize, source, begin, end, out);
+    });
+}
+
+bool CompressMipChain(std::vector<std::vector<uint8_t>>& mips, uint32_t width, uint32_t height, TextureFormat& format) {
+    TextureFormat target = GetCompressedFormat(format);
+    if (target == format || mips.empty())
+        return false;
+    // fully opaque RGBA gets the half size colour only format
+    if (format == TextureFormat::RGBA8) {
+        const std::vector<uint8_t>& base = mips[0];
+        bool opaque = true;
+        for (size_t i = 3; i < base.size() && opaque; i += 4)
+            opaque = base[i] == 255;
+        if (opaque)
+            target = TextureFormat::BC1;
+    }
+    for (size_t level = 0; level < mips.size(); level++) {
+        uint32_t mipWidth = std::max(1u, width >> level);
+        uint32_t mipHeight = std::max(1u, height >> level);
+        std::vector<uint8_t> blocks(TextureLevelSize(target, mipWidth, mipHeight));
+        CompressImage(mips[level].data(), mipWidth, mipHeight, format, target, blocks.data());
+        mips[level] = std::move(blocks);
+    }
+    format = target;
+    return true;
+}
+
+bool DecompressMipChain(std::vector<std::vector<uint8_t>>& mips, uint32_t width, uint32_t height, TextureFormat& format) {
+    if (!TextureFormatIsCompressed(format))
+        return false;
+    TextureFormat target = GetDecompressedFormat(format);
+    for (size_t level = 0; level < mips.size(); level++) {
+        uint32_t mipWidth = std::max(1u, width >> level);
+        uint32_t mipHeight = std::max(1u, height >> level);
+        std::vector<uint8_t> pixels(TextureLevelSize(target, mipWidth, mipHeight));
+        DecompressImage(mips[level].data(), mipWidth, mipHeight, format, pixels.data());
+        mips[level] = std::move(pixels);
+    }
+    format = target;
+    return true;
+}
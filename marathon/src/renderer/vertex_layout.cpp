@@ -0,0 +1,175 @@
+#include "renderer/vertex_layout.hpp"
+#include "renderer/mesh.hpp"
+
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+void VertexLayout::Add(VertexSlot slot, VertexFormat format) {
+    VertexElement element;
+    element.slot = slot;
+    element.format = format;
+    element.offset = stride;
+    elements.push_back(element);
+    // keep every element 4 byte aligned
+    stride += (FormatSize(format) + 3) & ~3u;
+}
+
+VertexLayout VertexLayout::Build(const Mesh& mesh, bool quantise) {
+    VertexLayout layout;
+    layout.Add(VertexSlot::POSITION, VertexFormat::FLOAT3);
+    if (!mesh.normals.empty())
+        layout.Add(VertexSlot::NORMAL, quantise ? VertexFormat::SNORM_2_10_10_10 : VertexFormat::FLOAT3);
+    if (!mesh.tangents.empty())
+        layout.Add(VertexSlot::TANGENT, quantise ? VertexFormat::SNORM_2_10_10_10 : VertexFormat::FLOAT4);
+    if (!mesh.colours.empty())
+        layout.Add(VertexSlot::COLOUR, quantise ? VertexFormat::UNORM8x4 : VertexFormat::FLOAT4);
+    const std::vector<LA::vec2>* uvs[4] = { &mesh.uv0, &mesh.uv1, &mesh.uv2, &mesh.uv3 };
+    for (uint32_t i = 0; i < 4; i++) {
+        if (!uvs[i]->empty())
+            layout.Add((VertexSlot)((uint32_t)VertexSlot::UV0 + i), quantise ? VertexFormat::HALF2 : VertexFormat::FLOAT2);
+    }
+    return layout;
+}
+
+uint32_t VertexLayout::FormatSize(VertexFormat format) {
+    switch (format) {
+        case VertexFormat::FLOAT2:              return 8;
+        case VertexFormat::FLOAT3:              return 12;
+        case VertexFormat::FLOAT4:              return 16;
+        case VertexFormat::HALF2:               return 4;
+        case VertexFormat::SNORM_2_10_10_10:    return 4;
+        case VertexFormat::UNORM8x4:            return 4;
+    }
+    return 0;
+}
+
+uint32_t VertexLayout::FormatComponents(VertexFormat format) {
+    switch (format) {
+        case VertexFormat::FLOAT2:              return 2;
+        case VertexFormat::FLOAT3:              return 3;
+        case VertexFormat::FLOAT4:              return 4;
+        case VertexFormat::HALF2:               return 2;
+        case VertexFormat::SNORM_2_10_10_10:    return 4;
+        case VertexFormat::UNORM8x4:            return 4;
+    }
+    return 0;
+}
+
+bool UseShortIndices(size_t vertexCount) {
+    return vertexCount < 0xFFFF;
+}
+
+uint16_t FloatToHalf(float value) {
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(float));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int32_t exponent = (int32_t)((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    // nan/inf
+    if (((bits >> 23) & 0xFF) == 0xFF)
+        return (uint16_t)(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+    // overflow clamps to inf
+    if (exponent >= 31)
+        return (uint16_t)(sign | 0x7C00);
+    // subnormal or zero
+    if (exponent <= 0) {
+        if (exponent < -10)
+            return (uint16_t)sign;
+        mantissa |= 0x800000;
+        uint32_t shift = (uint32_t)(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        // round to nearest
+        if ((mantissa >> (shift - 1)) & 1)
+            half++;
+        return (uint16_t)(sign | half);
+    }
+    uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+    // round to nearest, carry into the exponent is correct behaviour
+    if (mantissa & 0x1000)
+        half++;
+    return (uint16_t)half;
+}
+
+uint32_t PackSnorm2101010(float x, float y, float z, float w) {
+    auto snorm = [](float v, float scale) {
+        v = std::clamp(v, -1.0f, 1.0f);
+        return (int32_t)std::lround(v * scale);
+    };
+    uint32_t px = (uint32_t)snorm(x, 511.0f) & 0x3FF;
+    uint32_t py = (uint32_t)snorm(y, 511.0f) & 0x3FF;
+    uint32_t pz = (uint32_t)snorm(z, 511.0f) & 0x3FF;
+    uint32_t pw = (uint32_t)snorm(w, 1.0f) & 0x3;
+    return px | (py << 10) | (pz << 20) | (pw << 30);
+}
+
+static void WriteElement(uint8_t* dst, VertexFormat format, const float* src, uint32_t srcComponents) {
+    float v[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    for (uint32_t i = 0; i < srcComponents && i < 4; i++)
+        v[i] = src[i];
+
+    switch (format) {
+        case VertexFormat::FLOAT2:
+        case VertexFormat::FLOAT3:
+        case VertexFormat::FLOAT4:
+            std::memcpy(dst, v, VertexLayout::FormatSize(format));
+            break;
+        case VertexFormat::HALF2: {
+            uint16_t h[2] = { FloatToHalf(v[0]), FloatToHalf(v[1]) };
+            std::memcpy(dst, h, sizeof(h));
+            break;
+        }
+        case VertexFormat::SNORM_2_10_10_10: {
+            uint32_t packed = PackSnorm2101010(v[0], v[1], v[2], v[3]);
+            std::memcpy(dst, &packed, sizeof(uint32_t));
+            break;
+        }
+        case VertexFormat::UNORM8x4:
+            for (uint32_t i = 0; i < 4; i++)
+                dst[i] = (uint8_t)std::lround(std::clamp(v[i], 0.0f, 1.0f) * 255.0f);
+            break;
+    }
+}
+
+void PackVertices(const Mesh& mesh, const VertexLayout& layout, std::vector<uint8_t>& out) {
+    out.resize(mesh.vertices.size() * layout.stride);
+    PackVertices(mesh, layout, out.data());
+}
+
+void PackVertices(const Mesh& mesh, const VertexLayout& layout, uint8_t* dst) {
+    size_t count = mesh.vertices.size();
+    // padding and missing attributes read as zero
+    std::memset(dst, 0, count * layout.stride);
+
+    for (const VertexElement& element : layout.elements) {
+        const float* src = nullptr;
+        uint32_t components = 0;
+        size_t available = 0;
+        switch (element.slot) {
+            case VertexSlot::POSITION:  src = mesh.vertices.empty() ? nullptr : mesh.vertices[0].m; components = 3; available = mesh.vertices.size(); break;
+            case VertexSlot::NORMAL:    src = mesh.normals.empty() ? nullptr : mesh.normals[0].m; components = 3; available = mesh.normals.size(); break;
+            case VertexSlot::TANGENT:   src = mesh.tangents.empty() ? nullptr : mesh.tangents[0].m; components = 4; available = mesh.tangents.size(); break;
+            case VertexSlot::COLOUR:    src = mesh.colours.empty() ? nullptr : mesh.colours[0].m; components = 4; available = mesh.colours.size(); break;
+            case VertexSlot::UV0:       src = mesh.uv0.empty() ? nullptr : mesh.uv0[0].m; components = 2; available = mesh.uv0.size(); break;
+            case VertexSlot::UV1:       src = mesh.uv1.empty() ? nullptr : mesh.uv1[0].m; components = 2; available = mesh.uv1.size(); break;
+            case VertexSlot::UV2:       src = mesh.uv2.empty() ? nullptr : mesh.uv2[0].m; components = 2; available = mesh.uv2.size(); break;
+            case VertexSlot::UV3:       src = mesh.uv3.empty() ? nullptr : mesh.uv3[0].m; components = 2; available = mesh.uv3.size(); break;
+        }
+        if (src == nullptr)
+            continue;
+        size_t n = std::min(count, available);
+        for (size_t i = 0; i < n; i++) {
+            WriteElement(dst + i * layout.stride + element.offset, element.format, src + i * components, components);
+        }
+    }
+}
+
+size_t UnpackedVertexBytes(const Mesh& mesh) {
+    return mesh.vertices.size() * sizeof(LA::vec3)
+        + mesh.normals.size() * sizeof(LA::vec3)
+        + mesh.tangents.size() * sizeof(LA::vec4)
+        + mesh.colours.size() * sizeof(LA::vec4)
+        + (mesh.uv0.size() + mesh.uv1.size() + mesh.uv2.size() + mesh.uv3.size()) * sizeof(LA::vec2)
+        + mesh.GetTotalIndexCount() * sizeof(uint32_t);
+}
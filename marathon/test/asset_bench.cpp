@@ -0,0 +1,82 @@
+// std libs
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+
+// internal libs
+#include "ecs/asset.hpp"
+
+// Times FindAsset, GetAssetByUUID and full iteration over the asset manager.
+// Each size gets its own asset type so the runs don't share storage.
+
+#define BENCH_LOOKUPS 100000
+#define BENCH_FIND_LOOKUPS 1000
+#define BENCH_ITERATIONS 100
+
+template<int N>
+struct BenchAsset : public Asset {
+    float value = 1.0f;
+
+    BenchAsset(const std::string& name)
+        : Asset(name) {}
+};
+
+double Millis(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<int N>
+int Run() {
+    AssetManager& assetManager = AssetManager::Instance();
+    std::vector<UUID> uuids;
+    uuids.reserve(N);
+    for (int i = 0; i < N; i++)
+        uuids.push_back(assetManager.CreateAsset<BenchAsset<N>>("asset-" + std::to_string(i))->uuid);
+
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> pick(0, N - 1);
+    std::vector<int> order(BENCH_LOOKUPS);
+    for (int& i : order)
+        i = pick(rng);
+    std::vector<std::string> names(BENCH_FIND_LOOKUPS);
+    for (int i = 0; i < BENCH_FIND_LOOKUPS; i++)
+        names[i] = "asset-" + std::to_string(order[i]);
+
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string& name : names)
+        found += assetManager.FindAsset<BenchAsset<N>>(name) != nullptr;
+    double findMs = Millis(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i : order)
+        found += assetManager.GetAssetByUUID<BenchAsset<N>>(uuids[i]) != nullptr;
+    double uuidMs = Millis(start);
+
+    float sum = 0.0f;
+    start = std::chrono::steady_clock::now();
+    for (int it = 0; it < BENCH_ITERATIONS; it++) {
+        for (const auto& asset : assetManager.GetAssets<BenchAsset<N>>())
+            sum += static_cast<BenchAsset<N>*>(asset.get())->value;
+    }
+    double iterateMs = Millis(start);
+
+    if (found != BENCH_FIND_LOOKUPS + BENCH_LOOKUPS || sum != (float)N * BENCH_ITERATIONS) {
+        std::cout << "ERROR (asset_bench): Lookups missed assets." << std::endl;
+        return 1;
+    }
+
+    std::cout << N << " assets" << std::endl;
+    std::cout << "  FindAsset:      " << findMs * 1000000.0 / BENCH_FIND_LOOKUPS << " ns/lookup" << std::endl;
+    std::cout << "  GetAssetByUUID: " << uuidMs * 1000000.0 / BENCH_LOOKUPS << " ns/lookup" << std::endl;
+    std::cout << "  iterate:        " << iterateMs / BENCH_ITERATIONS << " ms/pass" << std::endl;
+    return 0;
+}
+
+int main() {
+    int result = Run<10000>();
+    result |= Run<100000>();
+    return result;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+// std libs
+#include <vector>
+#include <string>
+#include <cmath>
+#include <chrono>
+#include <memory>
+
+// internal libs
+#include "la_extended.h"
+#include "ecs/asset.hpp"
+#include "renderer/model_loader.hpp"
+#include "renderer/shader_loader.hpp"
+#include "renderer/scene_renderer.hpp"
+
+// Helpers shared by the renderer tests and benches, which all run from the repository root.
+
+const std::vector<std::string> PRESET_MODELS = {
+    "marathon/assets/models/presets/cone.gltf",
+    "marathon/assets/models/presets/cube.gltf",
+    "marathon/assets/models/presets/cylinder.gltf",
+    "marathon/assets/models/presets/dome.gltf",
+    "marathon/assets/models/presets/ico_sphere.gltf",
+    "marathon/assets/models/presets/plane.gltf",
+    "marathon/assets/models/presets/prism.gltf",
+    "marathon/assets/models/presets/sphere.gltf"
+};
+
+// the preset models and the given shader sources, false when any of them failed
+inline bool LoadPresets(const std::vector<std::string>& shaders) {
+    AssetLoaderManager& loaderManager = AssetLoaderManager::Instance();
+    loaderManager.AddLoader(std::make_shared<ModelLoader>());
+    loaderManager.AddLoader(std::make_shared<ShaderLoader>());
+    bool loaded = true;
+    for (const std::string& path : PRESET_MODELS)
+        loaded &= loaderManager.Load(path);
+    for (const std::string& path : shaders)
+        loaded &= loaderManager.Load(path);
+    return loaded;
+}
+
+inline double Millis(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// right handed look at, column major m[col][row]
+inline LA::mat4 LookAt(const LA::vec3& eye, const LA::vec3& target) {
+    auto normalise = [](LA::vec3 v) {
+        float length = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+        return LA::vec3({v.x / length, v.y / length, v.z / length});
+    };
+    auto cross = [](const LA::vec3& a, const LA::vec3& b) {
+        return LA::vec3({a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x});
+    };
+    auto dot = [](const LA::vec3& a, const LA::vec3& b) {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    };
+    LA::vec3 f = normalise(target - eye);
+    LA::vec3 s = normalise(cross(f, LA::vec3({0.0f, 1.0f, 0.0f})));
+    LA::vec3 u = cross(s, f);
+    LA::mat4 view = LA::mat4();
+    for (int c = 0; c < 3; c++) {
+        view[c][0] = s[c];
+        view[c][1] = u[c];
+        view[c][2] = -f[c];
+        view[c][3] = 0.0f;
+    }
+    view[3][0] = -dot(s, eye);
+    view[3][1] = -dot(u, eye);
+    view[3][2] = dot(f, eye);
+    view[3][3] = 1.0f;
+    return view;
+}
+
+// 45 degree perspective camera at eye looking at target
+inline SceneView MakeView(const LA::vec3& eye, const LA::vec3& target, uint32_t width, uint32_t height, float farPlane=100.0f) {
+    SceneView view;
+    view.position = eye;
+    view.view = LookAt(eye, target);
+    view.projection = LA::Perspective(45.0f, (float)width / (float)height, 0.1f, farPlane);
+    view.width = width;
+    view.height = height;
+    return view;
+}
@@ -0,0 +1,239 @@
+// std libs
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <thread>
+
+// internal libs
+#include "la_extended.h"
+#include "core/job_system.hpp"
+#include "renderer/light_clusters.hpp"
+#include "platform/headless/headless_renderer.hpp"
+#include "bench_common.hpp"
+
+// Clustered light assignment over a few thousand point and spot lights:
+//      conservative    random points in the frustum, every light reaching a point must be in the list of its cluster
+//      threads         builds at 1, 2, 4 ... threads up to the hardware count (or argv[1]) match the 1 thread build
+//      variant         a headless frame binds the CLUSTERED variant of lighting.frag while clustered lighting is on
+// Run from the repository root. Usage: cluster_bench [max threads]
+
+#define BENCH_LIGHTS 4096
+#define BENCH_SAMPLES 200000
+#define BENCH_ITERATIONS 20
+#define BENCH_WIDTH 1920
+#define BENCH_HEIGHT 1080
+// MakeView's near plane
+#define BENCH_NEAR 0.1f
+#define BENCH_FAR 200.0f
+// camera turned 30 degrees about y
+#define BENCH_YAW 30.0f
+
+class ClusterBench {
+public:
+    ClusterBench() {
+        float yaw = LA::Radians(BENCH_YAW);
+        LA::vec3 eye = LA::vec3({5.0f, 2.0f, 10.0f});
+        _view = MakeView(eye, eye + LA::vec3({-std::sin(yaw), 0.0f, -std::cos(yaw)}), BENCH_WIDTH, BENCH_HEIGHT, BENCH_FAR);
+
+        // lights spread through and around the frustum, a third of them spots
+        std::mt19937 rng(4321);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> depth(-5.0f, BENCH_FAR * 0.6f);
+        std::uniform_real_distribution<float> range(0.5f, 8.0f);
+        std::uniform_real_distribution<float> angle(5.0f, 60.0f);
+        _lights.resize(BENCH_LIGHTS);
+        for (uint32_t i = 0; i < BENCH_LIGHTS; i++) {
+            ClusterLightData& light = _lights[i];
+            float d = depth(rng);
+            float spread = std::max(d, 1.0f) * 0.8f;
+            ToWorld(unit(rng) * spread * 1.8f, unit(rng) * spread, -d, light.position);
+            light.range = range(rng);
+            light.colour[0] = light.colour[1] = light.colour[2] = 1.0f;
+            light.intensity = 1.0f;
+            if (i % 3 == 0) {
+                float direction[3] = {unit(rng), unit(rng), unit(rng)};
+                float length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+                for (int a = 0; a < 3; a++)
+                    light.direction[a] = direction[a] / std::max(length, 1e-3f);
+                float outer = angle(rng);
+                light.spot = 1.0f;
+                light.cutOff = std::cos(LA::Radians(outer * 0.8f));
+                light.outerCutOff = std::cos(LA::Radians(outer));
+            }
+        }
+    }
+
+    bool passed = true;
+
+    void Run(uint32_t threads) {
+        JobSystem& jobs = JobSystem::Instance();
+        jobs.SetThreadCount(threads);
+        jobs.Boot();
+
+        LightClusters clusters;
+        double total = 0.0;
+        for (int i = 0; i <= BENCH_ITERATIONS; i++) {
+            clusters.Build(_view.view, _view.projection, BENCH_WIDTH, BENCH_HEIGHT, _lights);
+            // first build also makes the cluster bounds
+            if (i > 0)
+                total += clusters.GetStats().buildMs;
+        }
+        const LightClusterStats& stats = clusters.GetStats();
+
+        if (threads == 1) {
+            _baseMs = total / BENCH_ITERATIONS;
+            _grid = clusters.GetGrid();
+            _indices = clusters.GetIndices();
+            CheckConservative(clusters);
+        } else if (clusters.GetGrid() != _grid || clusters.GetIndices() != _indices) {
+            std::cout << "ERROR (cluster_bench): clusters with " << threads << " threads differ from 1 thread." << std::endl;
+            passed = false;
+        }
+
+        double ms = total / BENCH_ITERATIONS;
+        std::cout << threads << " thread" << (threads == 1 ? " " : "s") << ": " << ms << " ms, x" << _baseMs / ms
+            << " (" << stats.lights << " lights, " << stats.references << " references, " << stats.occupied << " of "
+            << CLUSTER_COUNT << " clusters occupied, " << stats.maxPerCluster << " max, " << stats.dropped << " dropped)" << std::endl;
+        jobs.Shutdown();
+    }
+
+    // the renderer binds the clustered variant only while clustered lighting is on
+    void CheckVariant() {
+        HeadlessRenderer& renderer = HeadlessRenderer::Instance();
+        std::shared_ptr<Shader> shader = CreateRenderAsset<Shader>("lighting",
+            FindRenderAsset<ShaderSource>("lighting_vert"), FindRenderAsset<ShaderSource>("lighting_frag"));
+        std::shared_ptr<Material> material = CreateRenderAsset<Material>("cluster-material");
+        material->shader = shader;
+        material->SetProperty("colour", LA::vec4(1.0f));
+        std::shared_ptr<Mesh> mesh = FindRenderAsset<Mesh>("Cube-Mesh");
+
+        renderer.SetProjection(_view.projection);
+        renderer.SetView(_view.view);
+        renderer.SetResolution(BENCH_WIDTH, BENCH_HEIGHT);
+        renderer.ClearLights();
+        for (const ClusterLightData& light : _lights) {
+            LA::vec3 colour = LA::vec3({light.colour[0], light.colour[1], light.colour[2]});
+            LA::vec3 position = LA::vec3({light.position[0], light.position[1], light.position[2]});
+            if (light.spot != 0.0f)
+                renderer.AddSpotLight(colour, light.intensity, position, LA::vec3({light.direction[0], light.direction[1], light.direction[2]}),
+                    std::acos(light.cutOff), std::acos(light.outerCutOff), light.range);
+            else
+                renderer.AddPointLight(colour, light.intensity, position, light.range);
+        }
+
+        for (bool clustered : {true, false}) {
+            renderer.SetClusteredLighting(clustered);
+            renderer.Submit(mesh, material, LA::mat4());
+            renderer.Flush();
+            renderer.EndFrame();
+            ShaderVariant expected = clustered ? ShaderVariant::CLUSTERED : ShaderVariant::DEFAULT;
+            bool bound = false;
+            for (const RenderCommand& command : renderer.GetLastFrame().commands)
+                bound |= command.type == RenderCommandType::BIND_SHADER && command.variant == expected;
+            if (!bound) {
+                std::cout << "ERROR (cluster_bench): " << (clustered ? "clustered" : "default") << " variant was not bound." << std::endl;
+                passed = false;
+            }
+        }
+        if (renderer.GetLightClusters().GetStats().lights != BENCH_LIGHTS) {
+            std::cout << "ERROR (cluster_bench): renderer clusters hold " << renderer.GetLightClusters().GetStats().lights
+                << " lights, expected " << BENCH_LIGHTS << "." << std::endl;
+            passed = false;
+        }
+        renderer.SetClusteredLighting(true);
+    }
+
+private:
+    SceneView _view;
+    std::vector<ClusterLightData> _lights;
+
+    // 1 thread results
+    double _baseMs = 0.0;
+    std::vector<uint32_t> _grid;
+    std::vector<uint32_t> _indices;
+
+    // camera to world, the view's rotation transposed, then the eye
+    void ToWorld(float x, float y, float z, float* out) const {
+        for (int row = 0; row < 3; row++)
+            out[row] = _view.view[row][0] * x + _view.view[row][1] * y + _view.view[row][2] * z + _view.position[row];
+    }
+
+    // what lighting.frag would light the point with, range window and outer cone
+    static bool Reaches(const ClusterLightData& light, const float* point) {
+        float toPoint[3] = {point[0] - light.position[0], point[1] - light.position[1], point[2] - light.position[2]};
+        float distance = std::sqrt(toPoint[0] * toPoint[0] + toPoint[1] * toPoint[1] + toPoint[2] * toPoint[2]);
+        if (distance >= light.range)
+            return false;
+        if (light.spot == 0.0f || distance == 0.0f)
+            return true;
+        float theta = (toPoint[0] * light.direction[0] + toPoint[1] * light.direction[1] + toPoint[2] * light.direction[2]) / distance;
+        return theta > light.outerCutOff;
+    }
+
+    void CheckConservative(const LightClusters& clusters) {
+        std::mt19937 rng(99);
+        std::uniform_real_distribution<float> ndc(-1.0f, 1.0f);
+        // log depth so near slices get their share of samples
+        std::uniform_real_distribution<float> logDepth(std::log(BENCH_NEAR), std::log(BENCH_FAR * 0.6f));
+        const std::vector<uint32_t>& grid = clusters.GetGrid();
+        const std::vector<uint32_t>& indices = clusters.GetIndices();
+        uint32_t missed = 0, capped = 0, lit = 0;
+        std::vector<uint8_t> listed(_lights.size());
+        for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+            float x = ndc(rng), y = ndc(rng), depth = std::exp(logDepth(rng));
+            float point[3];
+            ToWorld(x * depth / _view.projection[0][0], y * depth / _view.projection[1][1], -depth, point);
+            uint32_t cluster = clusters.GetClusterIndex((x * 0.5f + 0.5f) * BENCH_WIDTH, (y * 0.5f + 0.5f) * BENCH_HEIGHT, depth);
+            uint32_t offset = grid[cluster * 2], count = grid[cluster * 2 + 1];
+            // a full cluster may have dropped the light
+            if (count == CLUSTER_LIGHTS_MAX) {
+                capped++;
+                continue;
+            }
+            for (uint32_t j = 0; j < count; j++)
+                listed[indices[offset + j]] = 1;
+            for (uint32_t l = 0; l < (uint32_t)_lights.size(); l++) {
+                if (!Reaches(_lights[l], point))
+                    continue;
+                lit++;
+                missed += !listed[l];
+            }
+            for (uint32_t j = 0; j < count; j++)
+                listed[indices[offset + j]] = 0;
+        }
+        std::cout << "conservative: " << lit << " light contributions over " << BENCH_SAMPLES << " samples, "
+            << missed << " missed, " << capped << " samples in full clusters" << std::endl;
+        if (missed > 0 || lit == 0) {
+            std::cout << "ERROR (cluster_bench): clusters are missing lights that reach their fragments." << std::endl;
+            passed = false;
+        }
+    }
+};
+
+int main(int argc, char** argv) {
+    uint32_t maxThreads = argc > 1 ? std::atoi(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    RendererAPI::SetAPI(RendererAPI::API::NONE);
+    Renderer& renderer = Renderer::Instance();
+    renderer.Boot();
+    if (!LoadPresets({"marathon/assets/shaders/lighting.vert", "marathon/assets/shaders/lighting.frag"})) {
+        std::cout << "ERROR (cluster_bench): Failed to load the presets, run from the repository root." << std::endl;
+        return 1;
+    }
+
+    ClusterBench* bench = new ClusterBench();
+    for (uint32_t threads = 1; threads <= maxThreads; threads *= 2) {
+        bench->Run(threads);
+        // always finish on the full count
+        if (threads < maxThreads && threads * 2 > maxThreads)
+            bench->Run(maxThreads);
+    }
+    bench->CheckVariant();
+    bool passed = bench->passed;
+    delete bench;
+    renderer.Shutdown();
+    return passed ? 0 : 1;
+}
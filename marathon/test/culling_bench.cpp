@@ -0,0 +1,58 @@
+// std libs
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+
+// internal libs
+#include "la_extended.h"
+#include "renderer/culling.hpp"
+
+// Culls a field of random boxes around a camera at the origin looking down -z.
+// Checks the SIMD kernel against the scalar one and times both.
+
+#define BENCH_ENTITIES 100000
+#define BENCH_ITERATIONS 100
+
+double TimeKernel(uint32_t (*kernel)(const Frustum&, const BoundsSoA&, std::vector<uint8_t>&),
+                  const Frustum& frustum, const BoundsSoA& bounds, std::vector<uint8_t>& visible, uint32_t& visibleCount) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        visibleCount = kernel(frustum, bounds, visible);
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / BENCH_ITERATIONS;
+}
+
+int main() {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+    std::uniform_real_distribution<float> size(0.1f, 4.0f);
+
+    BoundsSoA bounds;
+    bounds.Reserve(BENCH_ENTITIES);
+    for (int i = 0; i < BENCH_ENTITIES; i++) {
+        LA::vec3 centre = LA::vec3({position(rng), position(rng), position(rng)});
+        float half = size(rng);
+        bounds.Push(centre - LA::vec3(half), centre + LA::vec3(half));
+    }
+
+    // identity view, camera at the origin looking down -z
+    LA::mat4 projection = LA::Perspective(45.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+    Frustum frustum = Frustum::FromMatrix(projection * LA::mat4());
+
+    std::vector<uint8_t> scalarVisible, simdVisible;
+    uint32_t scalarCount = 0, simdCount = 0;
+    double scalarMs = TimeKernel(CullBoundsScalar, frustum, bounds, scalarVisible, scalarCount);
+    double simdMs = TimeKernel(CullBounds, frustum, bounds, simdVisible, simdCount);
+
+    if (scalarVisible != simdVisible) {
+        std::cout << "ERROR (culling_bench): SIMD and scalar kernels disagree." << std::endl;
+        return 1;
+    }
+
+    std::cout << BENCH_ENTITIES << " boxes, " << simdCount << " visible, "
+        << BENCH_ENTITIES - simdCount << " culled" << std::endl;
+    std::cout << "scalar: " << scalarMs << " ms/pass" << std::endl;
+    std::cout << "simd:   " << simdMs << " ms/pass" << std::endl;
+    return 0;
+}
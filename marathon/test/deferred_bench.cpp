@@ -0,0 +1,255 @@
+// std libs
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+
+// internal libs
+#include "la_extended.h"
+#include "ecs/asset.hpp"
+#include "renderer/model_loader.hpp"
+#include "renderer/shader_loader.hpp"
+#include "renderer/render_assets.hpp"
+#include "renderer/scene_renderer.hpp"
+#include "serializer/scene_converter.hpp"
+#include "platform/software/software_renderer.hpp"
+#include "platform/headless/headless_renderer.hpp"
+#include "bench_common.hpp"
+
+// Forward against deferred shading on a scene of interpenetrating slabs lit by every point light slot.
+// Each cluster of slabs shares an origin, so the front to back sort can't stop them overdrawing.
+//      image       the software rasteriser draws the same frame with both paths, images must match
+//      layers      frame time and pixels shaded per path as slabs per cluster (depth complexity) grows,
+//                  deferred shades each covered pixel once however many surfaces were drawn into it
+//      commands    the headless renderer's deferred frame, G-buffer draws then one lighting pass on the
+//                  target then the forward wireframe, and a plain forward frame for contrast
+// Run from the repository root. Usage: deferred_bench
+
+#define BENCH_WIDTH 640
+#define BENCH_HEIGHT 360
+#define BENCH_FRAMES 10
+#define BENCH_CLUSTERS 4
+// per channel difference still counted as a match, and the share of pixels allowed beyond it
+#define BENCH_TOLERANCE 2
+#define BENCH_MAX_MISMATCH 0.001
+
+// camera at (0, 4, 18) looking down at the origin
+SceneView BenchView() {
+    return MakeView(LA::vec3({0.0f, 4.0f, 18.0f}), LA::vec3({0.0f, 0.0f, 0.0f}), BENCH_WIDTH, BENCH_HEIGHT);
+}
+
+// clusters of thin slabs fanned around the y axis, a floor, a sun and every point light slot
+void BuildScene(Scene& scene, uint32_t slabs) {
+    std::shared_ptr<Mesh> cube = FindRenderAsset<Mesh>("Cube-Mesh");
+    std::shared_ptr<Mesh> plane = FindRenderAsset<Mesh>("Plane-Mesh");
+    std::shared_ptr<Material> material = FindRenderAsset<Material>("default-material");
+    for (uint32_t c = 0; c < BENCH_CLUSTERS; c++) {
+        for (uint32_t i = 0; i < slabs; i++) {
+            Entity slab = scene.CreateEntity("Slab");
+            TransformComponent& tc = slab.GetComponent<TransformComponent>();
+            tc.position = LA::vec3({((float)c - 1.5f) * 5.0f, 2.0f, -(float)c * 3.0f});
+            tc.rotation = LA::vec3({0.0f, 180.0f * (float)i / (float)slabs, 10.0f});
+            tc.scale = LA::vec3({3.0f, 2.5f, 0.1f});
+            MeshRendererComponent& mrc = slab.AddComponent<MeshRendererComponent>();
+            mrc.mesh = cube;
+            mrc.material = material;
+        }
+    }
+    Entity floor = scene.CreateEntity("Floor");
+    floor.GetComponent<TransformComponent>().scale = LA::vec3({30.0f, 1.0f, 30.0f});
+    MeshRendererComponent& mrc = floor.AddComponent<MeshRendererComponent>();
+    mrc.mesh = plane;
+    mrc.material = material;
+
+    Entity sun = scene.CreateEntity("Sun");
+    sun.GetComponent<TransformComponent>().rotation = LA::vec3({-50.0f, 30.0f, 0.0f});
+    sun.AddComponent<DirectionalLightComponent>().intensity = 0.4f;
+    for (uint32_t i = 0; i < POINT_LIGHT_MAX; i++) {
+        Entity light = scene.CreateEntity("Point");
+        float angle = 6.2831853f * (float)i / (float)POINT_LIGHT_MAX;
+        light.GetComponent<TransformComponent>().position = LA::vec3({std::cos(angle) * 9.0f, 3.0f, std::sin(angle) * 6.0f - 4.0f});
+        PointLightComponent& plc = light.AddComponent<PointLightComponent>();
+        plc.colour = LA::vec3({0.5f + 0.5f * std::cos(angle), 0.6f, 0.5f + 0.5f * std::sin(angle)});
+        plc.range = 12.0f;
+    }
+}
+
+class DeferredBench {
+public:
+    bool passed = true;
+
+    void Run() {
+        Image();
+        Layers();
+        Commands();
+    }
+
+private:
+    SceneView _view = BenchView();
+
+    void Check(bool condition, const std::string& message) {
+        if (condition)
+            return;
+        std::cout << "ERROR (deferred_bench): " << message << "." << std::endl;
+        passed = false;
+    }
+
+    void Frame(Scene& scene, RenderPath path, ShadingMode mode=ShadingMode::SHADED) {
+        Renderer& renderer = Renderer::Instance();
+        renderer.SetRenderPath(path);
+        renderer.Clear();
+        SceneRenderer(scene).Render(_view, mode);
+    }
+
+    void Image() {
+        SoftwareRenderer& renderer = SoftwareRenderer::Instance();
+        std::shared_ptr<SoftwareFrameBuffer> target = std::static_pointer_cast<SoftwareFrameBuffer>(
+            FrameBuffer::Create("deferred-bench", BENCH_WIDTH, BENCH_HEIGHT));
+        renderer.SetFrameBuffer(target);
+        Scene scene;
+        BuildScene(scene, 12);
+
+        std::vector<uint8_t> images[2];
+        RasterStats stats[2];
+        for (RenderPath path : {RenderPath::FORWARD, RenderPath::DEFERRED}) {
+            Frame(scene, path);
+            target->ReadPixels(images[(int)path]);
+            stats[(int)path] = renderer.GetRasterStats();
+        }
+        uint32_t pixels = BENCH_WIDTH * BENCH_HEIGHT;
+        uint32_t mismatched = 0;
+        for (uint32_t i = 0; i < pixels; i++) {
+            int worst = 0;
+            for (int c = 0; c < 3; c++)
+                worst = std::max(worst, std::abs((int)images[0][i * 4 + c] - (int)images[1][i * 4 + c]));
+            mismatched += worst > BENCH_TOLERANCE;
+        }
+        const RasterStats& forward = stats[(int)RenderPath::FORWARD];
+        const RasterStats& deferred = stats[(int)RenderPath::DEFERRED];
+        std::cout << "image:    " << forward.fragments << " fragments, forward shaded " << forward.pixelsShaded
+            << ", deferred shaded " << deferred.pixelsShaded << ", " << mismatched << " of " << pixels << " pixels differ" << std::endl;
+        Check((double)mismatched / pixels <= BENCH_MAX_MISMATCH, "forward and deferred images differ");
+        Check(forward.fragments == deferred.fragments, "both paths must rasterise the same fragments");
+        Check(forward.pixelsShaded == forward.fragments, "forward must shade every fragment");
+        Check(deferred.pixelsShaded < forward.pixelsShaded, "deferred shaded as many pixels as forward");
+        renderer.SetFrameBuffer(nullptr);
+    }
+
+    void Layers() {
+        SoftwareRenderer& renderer = SoftwareRenderer::Instance();
+        std::shared_ptr<SoftwareFrameBuffer> target = std::static_pointer_cast<SoftwareFrameBuffer>(
+            FrameBuffer::Create("deferred-bench", BENCH_WIDTH, BENCH_HEIGHT));
+        renderer.SetFrameBuffer(target);
+        std::cout << BENCH_WIDTH << "x" << BENCH_HEIGHT << ", " << POINT_LIGHT_MAX << " point lights, "
+            << BENCH_FRAMES << " frames per path" << std::endl;
+        for (uint32_t slabs : {1u, 4u, 16u, 32u}) {
+            Scene scene;
+            BuildScene(scene, slabs);
+            std::cout << "layers " << slabs << ":";
+            for (RenderPath path : {RenderPath::FORWARD, RenderPath::DEFERRED}) {
+                // first frame sizes the bins and tile buffers
+                Frame(scene, path);
+                double rasterMs = 0.0;
+                auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < BENCH_FRAMES; i++) {
+                    Frame(scene, path);
+                    rasterMs += renderer.GetRasterStats().rasterMs;
+                }
+                const RasterStats& stats = renderer.GetRasterStats();
+                std::cout << (path == RenderPath::FORWARD ? " forward " : ", deferred ") << Millis(start) / BENCH_FRAMES
+                    << " ms/frame (tiles " << rasterMs / BENCH_FRAMES << " ms), " << stats.pixelsShaded << " shaded of "
+                    << stats.fragments << " fragments";
+            }
+            std::cout << std::endl;
+        }
+        renderer.SetFrameBuffer(nullptr);
+    }
+
+    void Commands() {
+        RendererAPI::SetAPI(RendererAPI::API::NONE);
+        HeadlessRenderer& renderer = HeadlessRenderer::Instance();
+        renderer.Boot();
+        Scene scene;
+        BuildScene(scene, 4);
+
+        Frame(scene, RenderPath::DEFERRED, ShadingMode::SHADED_WIREFRAME);
+        renderer.EndFrame();
+        const RenderCommandList& frame = renderer.GetLastFrame();
+        uint32_t lighting = frame.CountOf(RenderCommandType::LIGHTING_PASS);
+        uint32_t gBufferDraws = 0, forwardDraws = 0;
+        bool seenLighting = false, ordered = true;
+        for (const RenderCommand& command : frame.commands) {
+            if (command.type == RenderCommandType::LIGHTING_PASS) {
+                seenLighting = true;
+                ordered &= command.frameBuffer == nullptr;
+            }
+            if (command.type != RenderCommandType::DRAW && command.type != RenderCommandType::DRAW_INSTANCED)
+                continue;
+            bool gBuffer = (uint8_t)command.variant & (uint8_t)ShaderVariant::GBUFFER;
+            if (gBuffer) {
+                gBufferDraws++;
+                // G-buffer draws come first, opaque, into the owned G-buffer rather than the target
+                ordered &= !seenLighting && command.pass == RenderPass::OPAQUE && command.frameBuffer != nullptr;
+            } else {
+                forwardDraws++;
+                ordered &= seenLighting && command.frameBuffer == nullptr;
+            }
+        }
+        const RenderStats& stats = renderer.GetStats();
+        std::cout << "commands: deferred " << gBufferDraws << " G-buffer draws, " << lighting << " lighting pass, "
+            << forwardDraws << " forward draws after it" << std::endl;
+        Check(lighting == 1 && stats.lightingPasses == 1, "expected one lighting pass");
+        Check(gBufferDraws > 0 && stats.gBufferDraws == gBufferDraws, "no draws went to the G-buffer");
+        Check(forwardDraws > 0, "the wireframe wasn't drawn forward");
+        Check(ordered, "G-buffer draws, lighting pass and forward draws are out of order or on the wrong target");
+
+        Frame(scene, RenderPath::FORWARD, ShadingMode::SHADED_WIREFRAME);
+        renderer.EndFrame();
+        uint32_t gBufferBinds = 0;
+        for (const RenderCommand& command : renderer.GetLastFrame().commands)
+            gBufferBinds += command.type == RenderCommandType::BIND_SHADER && ((uint8_t)command.variant & (uint8_t)ShaderVariant::GBUFFER);
+        std::cout << "commands: forward " << renderer.GetLastFrame().CountOf(RenderCommandType::LIGHTING_PASS) << " lighting passes, "
+            << gBufferBinds << " G-buffer binds" << std::endl;
+        Check(renderer.GetLastFrame().CountOf(RenderCommandType::LIGHTING_PASS) == 0 && gBufferBinds == 0, "forward frame used the G-buffer");
+        renderer.Shutdown();
+    }
+};
+
+int main(int argc, char** argv) {
+    RendererAPI::SetAPI(RendererAPI::API::SOFTWARE);
+    SoftwareRenderer& renderer = SoftwareRenderer::Instance();
+    renderer.Boot();
+
+    // software and headless share their assets, so everything is loaded once
+    bool loaded = LoadPresets({
+        "marathon/assets/shaders/base.vert",
+        "marathon/assets/shaders/base.frag",
+        "marathon/assets/shaders/lighting.vert",
+        "marathon/assets/shaders/lighting.frag",
+        "marathon/assets/shaders/deferred.vert",
+        "marathon/assets/shaders/deferred.frag"
+    });
+    if (!loaded) {
+        std::cout << "ERROR (deferred_bench): Failed to load the presets, run from the repository root." << std::endl;
+        return 1;
+    }
+
+    std::shared_ptr<Shader> base = CreateRenderAsset<Shader>("base",
+        FindRenderAsset<ShaderSource>("base_vert"), FindRenderAsset<ShaderSource>("base_frag"));
+    std::shared_ptr<Shader> lighting = CreateRenderAsset<Shader>("lighting",
+        FindRenderAsset<ShaderSource>("lighting_vert"), FindRenderAsset<ShaderSource>("lighting_frag"));
+    CreateRenderAsset<Shader>(DEFERRED_SHADER_NAME,
+        FindRenderAsset<ShaderSource>("deferred_vert"), FindRenderAsset<ShaderSource>("deferred_frag"));
+    std::shared_ptr<Material> material = CreateRenderAsset<Material>("default-material");
+    material->SetProperty("colour", LA::vec4(1.0f));
+    material->shader = lighting;
+    std::shared_ptr<Material> wireframe = CreateRenderAsset<Material>(WIREFRAME_MATERIAL_NAME);
+    wireframe->shader = base;
+
+    DeferredBench bench;
+    bench.Run();
+    renderer.Shutdown();
+    return bench.passed ? 0 : 1;
+}
@@ -48,6 +48,60 @@ void test_ngine() {
     std::cout << uint32_t(entity) << std::endl;
 }
 
+void test_hierarchy() {
+    std::cout << "test_hierarchy" << std::endl;
+    Scene scene = Scene();
+
+    // create child before parent so the depth sort has work to do
+    Entity child = scene.CreateEntity("child");
+    Entity parent = scene.CreateEntity("parent");
+    child.SetParent(parent);
+    parent.GetComponent<TransformComponent>().position = LA::vec3({1.0f, 2.0f, 3.0f});
+    child.GetComponent<TransformComponent>().position = LA::vec3({1.0f, 0.0f, 0.0f});
+
+    scene.UpdateTransforms();
+    LA::vec3 world = child.GetComponent<TransformComponent>().GetWorldPosition();
+    std::cout << "Child world pos: " << world.x << "," << world.y << "," << world.z << " (expect 2,2,3)" << std::endl;
+
+    // static scene, versions must not move
+    uint32_t version = child.GetComponent<TransformComponent>().GetVersion();
+    scene.UpdateTransforms();
+    std::cout << "Static update rebuilt: " << (child.GetComponent<TransformComponent>().GetVersion() != version) << " (expect 0)" << std::endl;
+
+    // moving the parent dirties the child
+    parent.GetComponent<TransformComponent>().position = LA::vec3(0.0f);
+    scene.UpdateTransforms();
+    world = child.GetComponent<TransformComponent>().GetWorldPosition();
+    std::cout << "Child world pos: " << world.x << "," << world.y << "," << world.z << " (expect 1,0,0)" << std::endl;
+
+    // cycles are refused
+    parent.SetParent(child);
+    std::cout << "Parent is root: " << !parent.GetParent() << " (expect 1)" << std::endl;
+}
+
+// destroying swaps the last transform into the hole, the next update must sort the pool again
+bool test_destroy() {
+    std::cout << "test_destroy" << std::endl;
+    Scene scene = Scene();
+
+    Entity root = scene.CreateEntity("root");
+    Entity grandparent = scene.CreateEntity("grandparent");
+    Entity parent = scene.CreateEntity("parent");
+    Entity child = scene.CreateEntity("child");
+    parent.SetParent(grandparent);
+    child.SetParent(parent);
+    child.GetComponent<TransformComponent>().position = LA::vec3({1.0f, 0.0f, 0.0f});
+    scene.UpdateTransforms();
+
+    // a childless root, the deepest transform can land in its slot ahead of its parent
+    scene.DestroyEntity(root);
+    parent.GetComponent<TransformComponent>().position = LA::vec3({0.0f, 5.0f, 0.0f});
+    scene.UpdateTransforms();
+    LA::vec3 world = child.GetComponent<TransformComponent>().GetWorldPosition();
+    std::cout << "Child world pos: " << world.x << "," << world.y << "," << world.z << " (expect 1,5,0)" << std::endl;
+    return world.x == 1.0f && world.y == 5.0f && world.z == 0.0f;
+}
+
 // void test_serializer() {
 //     std::cout << "test_serializer" << std::endl;
 //     std::shared_ptr<Scene> scene = std::make_shared<Scene>();
@@ -58,5 +112,8 @@ void test_ngine() {
 
 int main() {
     test_ngine();
+    test_hierarchy();
+    bool passed = test_destroy();
     // test_serializer();
+    return passed ? 0 : 1;
 }
\ No newline at end of file
@@ -0,0 +1,243 @@
+// std libs
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+
+// internal libs
+#include "la_extended.h"
+#include "core/job_system.hpp"
+#include "ecs/ngine.hpp"
+#include "renderer/components.hpp"
+#include "renderer/culling.hpp"
+#include "renderer/scene_renderer.hpp"
+#include "renderer/texture_compression.hpp"
+#include "platform/headless/headless_renderer.hpp"
+#include "platform/headless/headless_mesh.hpp"
+#include "bench_common.hpp"
+
+// Times each job system fan out at 1, 2, 4 ... threads up to the hardware count (or argv[1]):
+//      parallel for    synthetic per element work
+//      transforms      Scene::UpdateTransforms over a hierarchy with every root moving
+//      culling         CullBounds over a large box field
+//      frame           a whole headless SceneRenderer::Render (transforms, gather, cull, packets, flush)
+//      compression     BC3 encode of a large RGBA image
+// Results at every thread count are checked against the single thread run.
+// Run from the repository root. Usage: job_bench [max threads]
+
+#define BENCH_ELEMENTS 1000000
+#define BENCH_ROOTS 25000
+#define BENCH_CHILDREN 3
+#define BENCH_BOXES 1000000
+#define BENCH_IMAGE_SIZE 2048
+#define BENCH_MATERIALS 4
+#define BENCH_ITERATIONS 10
+#define BENCH_WIDTH 1280
+#define BENCH_HEIGHT 720
+
+// average ms of one run, run(i) is handed the iteration
+double Time(const std::function<void(int)>& run) {
+    run(0);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 1; i <= BENCH_ITERATIONS; i++)
+        run(i);
+    return Millis(start) / BENCH_ITERATIONS;
+}
+
+class JobBench {
+public:
+    JobBench() {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> spread(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> depth(-200.0f, 0.0f);
+        std::uniform_real_distribution<float> size(0.1f, 4.0f);
+
+        _input.resize(BENCH_ELEMENTS);
+        for (float& value : _input)
+            value = spread(rng);
+
+        std::shared_ptr<Shader> shader = CreateRenderAsset<Shader>("lighting",
+            FindRenderAsset<ShaderSource>("lighting_vert"), FindRenderAsset<ShaderSource>("lighting_frag"));
+        for (const auto& mesh : AssetManager::Instance().GetAssets<HeadlessMesh>())
+            _meshes.push_back(mesh);
+        for (int i = 0; i < BENCH_MATERIALS; i++) {
+            std::shared_ptr<Material> material = CreateRenderAsset<Material>("bench-material-" + std::to_string(i));
+            material->shader = shader;
+            material->SetProperty("colour", LA::vec4(1.0f));
+            _materials.push_back(material);
+        }
+        // roots move, each carries a short chain of children so updates run over several depths
+        for (int i = 0; i < BENCH_ROOTS; i++) {
+            Entity parent = _scene.CreateEntity("root-" + std::to_string(i));
+            parent.GetComponent<TransformComponent>().position = LA::vec3({spread(rng), spread(rng), depth(rng)});
+            _roots.push_back(parent);
+            _entities.push_back(parent);
+            for (int c = 0; c < BENCH_CHILDREN; c++) {
+                Entity child = _scene.CreateEntity("child-" + std::to_string(i) + "-" + std::to_string(c));
+                child.GetComponent<TransformComponent>().position = LA::vec3({1.0f, 0.0f, 0.0f});
+                child.SetParent(parent);
+                _entities.push_back(child);
+                parent = child;
+            }
+        }
+        for (Entity& e : _entities) {
+            MeshRendererComponent& mrc = e.AddComponent<MeshRendererComponent>();
+            mrc.mesh = _meshes[rng() % _meshes.size()];
+            mrc.material = _materials[rng() % BENCH_MATERIALS];
+        }
+        // looking down -z from the origin, into the field of roots and boxes
+        _view = MakeView(LA::vec3(0.0f), LA::vec3({0.0f, 0.0f, -1.0f}), BENCH_WIDTH, BENCH_HEIGHT, 150.0f);
+
+        _bounds.Reserve(BENCH_BOXES);
+        for (int i = 0; i < BENCH_BOXES; i++) {
+            LA::vec3 centre = LA::vec3({spread(rng), spread(rng), depth(rng)});
+            float half = size(rng);
+            _bounds.Push(centre - LA::vec3(half), centre + LA::vec3(half));
+        }
+        _frustum = Frustum::FromMatrix(_view.projection * _view.view);
+
+        _image.resize((size_t)BENCH_IMAGE_SIZE * BENCH_IMAGE_SIZE * 4);
+        for (size_t i = 0; i < _image.size(); i++)
+            _image[i] = (uint8_t)((i * 7 + (i >> 10) * 13) ^ (rng() & 15));
+        uint32_t blocks = BENCH_IMAGE_SIZE / 4;
+        _blocks.resize((size_t)blocks * blocks * TextureFormatBlockSize(TextureFormat::BC3));
+    }
+
+    bool passed = true;
+
+    void Run(uint32_t threads) {
+        JobSystem& jobs = JobSystem::Instance();
+        jobs.SetThreadCount(threads);
+        jobs.Boot();
+
+        std::vector<float> output(_input.size());
+        double parallelMs = Time([&](int) {
+            jobs.ParallelFor((uint32_t)_input.size(), JOB_DEFAULT_GRAIN * 16, [&](uint32_t begin, uint32_t end) {
+                for (uint32_t i = begin; i < end; i++)
+                    output[i] = std::sqrt(std::abs(_input[i])) * std::sin(_input[i]) + std::cos(_input[i] * 0.5f);
+            });
+        });
+        double sum = 0.0;
+        for (float value : output)
+            sum += value;
+
+        double transformMs = Time([&](int i) {
+            for (Entity& root : _roots)
+                root.GetComponent<TransformComponent>().rotation = LA::vec3({0.0f, (float)i * 10.0f, 0.0f});
+            _scene.UpdateTransforms();
+        });
+        double positions = 0.0;
+        for (Entity& e : _entities) {
+            LA::vec3 position = e.GetComponent<TransformComponent>().GetWorldPosition();
+            positions += position[0] + position[1] + position[2];
+        }
+
+        std::vector<uint8_t> visible;
+        uint32_t visibleCount = 0;
+        double cullMs = Time([&](int) {
+            visibleCount = CullBounds(_frustum, _bounds, visible);
+        });
+
+        double frameMs = Time([&](int i) {
+            for (Entity& root : _roots)
+                root.GetComponent<TransformComponent>().rotation = LA::vec3({0.0f, (float)i * 10.0f, 0.0f});
+            _sceneRenderer.Render(_view, ShadingMode::SHADED);
+            _renderer.EndFrame();
+        });
+        const RenderStats& stats = _renderer.GetStats();
+        size_t commands = _renderer.GetLastFrame().commands.size();
+
+        double compressMs = Time([&](int) {
+            CompressImage(_image.data(), BENCH_IMAGE_SIZE, BENCH_IMAGE_SIZE, TextureFormat::RGBA8, TextureFormat::BC3, _blocks.data());
+        });
+
+        if (threads == 1) {
+            _baseMs = {parallelMs, transformMs, cullMs, frameMs, compressMs};
+            _sum = sum;
+            _positions = positions;
+            _visible = visible;
+            _visibleCount = visibleCount;
+            _drawn = stats.visible;
+            _commands = commands;
+            _reference = _blocks;
+        } else {
+            Check(std::abs(sum - _sum) < 1e-6 * std::abs(_sum) + 1e-3, "parallel for sum", threads);
+            Check(positions == _positions, "world transforms", threads);
+            Check(visibleCount == _visibleCount && visible == _visible, "culling", threads);
+            Check(stats.visible == _drawn && commands == _commands, "frame commands", threads);
+            Check(_blocks == _reference, "compressed blocks", threads);
+        }
+
+        std::cout << threads << " thread" << (threads == 1 ? " " : "s") << std::endl;
+        Report("parallel for", parallelMs, _baseMs[0]);
+        Report("transforms", transformMs, _baseMs[1]);
+        Report("culling", cullMs, _baseMs[2]);
+        Report("frame", frameMs, _baseMs[3]);
+        Report("compression", compressMs, _baseMs[4]);
+        jobs.Shutdown();
+    }
+
+private:
+    std::vector<float> _input;
+    std::vector<std::shared_ptr<Mesh>> _meshes;
+    std::vector<std::shared_ptr<Material>> _materials;
+    Scene _scene;
+    SceneRenderer _sceneRenderer = SceneRenderer(_scene);
+    SceneView _view;
+    HeadlessRenderer& _renderer = HeadlessRenderer::Instance();
+    std::vector<Entity> _roots;
+    std::vector<Entity> _entities;
+    BoundsSoA _bounds;
+    Frustum _frustum;
+    std::vector<uint8_t> _image;
+    std::vector<uint8_t> _blocks;
+
+    // single thread results
+    std::vector<double> _baseMs;
+    double _sum = 0.0;
+    double _positions = 0.0;
+    std::vector<uint8_t> _visible;
+    uint32_t _visibleCount = 0;
+    uint32_t _drawn = 0;
+    size_t _commands = 0;
+    std::vector<uint8_t> _reference;
+
+    void Check(bool matches, const std::string& what, uint32_t threads) {
+        if (matches)
+            return;
+        std::cout << "ERROR (job_bench): " << what << " with " << threads << " threads differ from 1 thread." << std::endl;
+        passed = false;
+    }
+
+    void Report(const std::string& name, double ms, double baseMs) {
+        std::cout << "    " << name << ": " << std::string(14 - name.size(), ' ') << ms << " ms, x" << baseMs / ms << std::endl;
+    }
+};
+
+int main(int argc, char** argv) {
+    uint32_t maxThreads = argc > 1 ? std::atoi(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    // headless renderer, records commands instead of drawing
+    RendererAPI::SetAPI(RendererAPI::API::NONE);
+    Renderer& renderer = Renderer::Instance();
+    renderer.Boot();
+    if (!LoadPresets({"marathon/assets/shaders/lighting.vert", "marathon/assets/shaders/lighting.frag"})) {
+        std::cout << "ERROR (job_bench): Failed to load the presets, run from the repository root." << std::endl;
+        return 1;
+    }
+
+    JobBench* bench = new JobBench();
+    for (uint32_t threads = 1; threads <= maxThreads; threads *= 2) {
+        bench->Run(threads);
+        // always finish on the full count
+        if (threads < maxThreads && threads * 2 > maxThreads)
+            bench->Run(maxThreads);
+    }
+    bool passed = bench->passed;
+    delete bench;
+    renderer.Shutdown();
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+// std libs
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <filesystem>
+
+// internal libs
+#include "ecs/asset.hpp"
+#include "renderer/model_loader.hpp"
+#include "renderer/shader_loader.hpp"
+
+// Loads N copies of the preset models and shader sources serially, then through LoadAsync.
+// Then loads the presets once each through a fresh derived data cache, cold (parse) and warm (mapped hits).
+// Headless, commits only create assets, nothing is uploaded to GL.
+// Run from the repository root. Usage: loader_bench [copies]
+
+#define BENCH_COPIES 32
+#define BENCH_CACHE "loader_bench_cache"
+
+const std::vector<std::string> PRESETS = {
+    "marathon/assets/models/presets/cone.gltf",
+    "marathon/assets/models/presets/cube.gltf",
+    "marathon/assets/models/presets/cylinder.gltf",
+    "marathon/assets/models/presets/dome.gltf",
+    "marathon/assets/models/presets/ico_sphere.gltf",
+    "marathon/assets/models/presets/plane.gltf",
+    "marathon/assets/models/presets/prism.gltf",
+    "marathon/assets/models/presets/sphere.gltf",
+    "marathon/assets/shaders/base.vert",
+    "marathon/assets/shaders/base.frag",
+    "marathon/assets/shaders/lighting.vert",
+    "marathon/assets/shaders/lighting.frag"
+};
+
+double Millis(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    int copies = argc > 1 ? std::atoi(argv[1]) : BENCH_COPIES;
+    AssetLoaderManager& loaderManager = AssetLoaderManager::Instance();
+    loaderManager.AddLoader(std::make_shared<ModelLoader>());
+    loaderManager.AddLoader(std::make_shared<ShaderLoader>());
+    DerivedDataCache& cache = DerivedDataCache::Instance();
+    cache.SetRoot(BENCH_CACHE);
+    std::filesystem::remove_all(BENCH_CACHE);
+
+    // serial and async rows measure parsing, not cache hits
+    cache.SetEnabled(false);
+
+    std::vector<std::string> paths;
+    for (int i = 0; i < copies; i++)
+        paths.insert(paths.end(), PRESETS.begin(), PRESETS.end());
+
+    bool serialOk = true;
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string& path : paths)
+        serialOk &= loaderManager.Load(path);
+    double serialMs = Millis(start);
+
+    // first call spins up the pool, keep that out of the timing
+    loaderManager.Wait(loaderManager.LoadAsync({}));
+    start = std::chrono::steady_clock::now();
+    std::vector<AssetLoadHandle> handles = loaderManager.LoadAsync(paths);
+    bool asyncOk = loaderManager.Wait(handles);
+    double asyncMs = Millis(start);
+
+    cache.SetEnabled(true);
+    bool cacheOk = true;
+    start = std::chrono::steady_clock::now();
+    for (const std::string& path : PRESETS)
+        cacheOk &= loaderManager.Load(path);
+    double coldMs = Millis(start);
+    DerivedDataStats cold = cache.GetStats();
+    cache.ResetStats();
+    start = std::chrono::steady_clock::now();
+    for (const std::string& path : PRESETS)
+        cacheOk &= loaderManager.Load(path);
+    double warmMs = Millis(start);
+    DerivedDataStats warm = cache.GetStats();
+    std::filesystem::remove_all(BENCH_CACHE);
+
+    if (!serialOk || !asyncOk || !cacheOk) {
+        std::cout << "ERROR (loader_bench): Some loads failed, run from the repository root." << std::endl;
+        return 1;
+    }
+
+    std::cout << paths.size() << " files, " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+    std::cout << "serial: " << serialMs << " ms" << std::endl;
+    std::cout << "async:  " << asyncMs << " ms (" << serialMs / asyncMs << "x)" << std::endl;
+    std::cout << "cold:   " << coldMs << " ms for " << PRESETS.size() << " files, hit rate "
+        << cold.GetHitRate() * 100.0f << "%, " << cold.bytesWritten / 1024 << " KB cached" << std::endl;
+    std::cout << "warm:   " << warmMs << " ms (" << coldMs / warmMs << "x), hit rate "
+        << warm.GetHitRate() * 100.0f << "%" << std::endl;
+    return 0;
+}
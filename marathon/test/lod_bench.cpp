@@ -0,0 +1,269 @@
+// std libs
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <chrono>
+
+// internal libs
+#include "la_extended.h"
+#include "ecs/asset.hpp"
+#include "renderer/model_loader.hpp"
+#include "renderer/shader_loader.hpp"
+#include "renderer/render_assets.hpp"
+#include "renderer/scene_renderer.hpp"
+#include "platform/headless/headless_mesh.hpp"
+#include "platform/headless/headless_renderer.hpp"
+#include "platform/software/software_renderer.hpp"
+#include "bench_common.hpp"
+
+// Mesh LODs generated on import and picked by screen size:
+//      import      every preset's level chain, triangles per level and error, indices must stay inside the
+//                  shared vertices and each level must be coarser than the last
+//      select      Mesh::SelectLOD only gets coarser as the screen size falls, and a size between the
+//                  coarsen and refine limits keeps whichever level was drawn last
+//      dolly       a sphere walked away from the camera and back switches levels at different distances,
+//                  and jittering around a switch distance doesn't flicker
+//      frame       triangles per frame over a field of spheres with LOD off and on, headless and software
+// Run from the repository root. Usage: lod_bench
+
+#define BENCH_WIDTH 640
+#define BENCH_HEIGHT 360
+#define BENCH_FRAMES 20
+#define BENCH_ROWS 16
+#define BENCH_COLUMNS 9
+
+// meshes expected to simplify, the other presets are flat shaded (every position a hard edge) or too small
+const std::vector<std::string> SIMPLIFIED = {"Sphere-Mesh"};
+
+// camera at (0, 2, z) looking down -z
+SceneView BenchView(float z) {
+    return MakeView(LA::vec3({0.0f, 2.0f, z}), LA::vec3({0.0f, 2.0f, z - 1.0f}), BENCH_WIDTH, BENCH_HEIGHT, 200.0f);
+}
+
+class LODBench {
+public:
+    bool passed = true;
+
+    void Import() {
+        for (const auto& asset : AssetManager::Instance().GetAssets<HeadlessMesh>()) {
+            const Mesh& mesh = *asset;
+            std::cout << "import  " << mesh.name << ": " << mesh.GetTriangleCount();
+            for (uint32_t lod = 1; lod < mesh.GetLODCount(); lod++)
+                std::cout << " > " << mesh.GetTriangleCount(lod) << " (" << mesh.lods[lod - 1].error << ")";
+            std::cout << " triangles (error)" << std::endl;
+
+            for (uint32_t lod = 1; lod < mesh.GetLODCount(); lod++) {
+                const MeshLOD& level = mesh.lods[lod - 1];
+                bool inside = level.indices.size() % 3 == 0;
+                for (uint32_t index : level.indices)
+                    inside &= index < mesh.vertices.size();
+                Check(inside, mesh.name + " LOD " + std::to_string(lod) + " indexes past its vertices");
+                Check(mesh.GetTriangleCount(lod) < mesh.GetTriangleCount(lod - 1),
+                    mesh.name + " LOD " + std::to_string(lod) + " is no coarser than the one before");
+                Check(level.error >= (lod > 1 ? mesh.lods[lod - 2].error : 0.0f),
+                    mesh.name + " LOD " + std::to_string(lod) + " has less error than the one before");
+            }
+        }
+        for (const std::string& name : SIMPLIFIED) {
+            std::shared_ptr<Mesh> mesh = FindRenderAsset<Mesh>(name);
+            Check(mesh && mesh->GetLODCount() > 2, name + " should import with at least two coarser levels");
+        }
+    }
+
+    void Select() {
+        const Mesh& sphere = *FindRenderAsset<Mesh>("Sphere-Mesh");
+        if (sphere.lods.empty())
+            return;
+        uint32_t previous = 0;
+        for (float size = 4096.0f; size >= 1.0f; size *= 0.9f) {
+            uint32_t lod = sphere.SelectLOD(size);
+            Check(lod >= previous, "a smaller screen size picked a finer level");
+            previous = lod;
+        }
+        Check(previous > 0, "a one pixel sphere should not draw LOD 0");
+
+        // between the coarsen and refine limits of LOD 1 the level drawn last is kept
+        float dx = sphere.boundsMax.x - sphere.boundsMin.x, dy = sphere.boundsMax.y - sphere.boundsMin.y, dz = sphere.boundsMax.z - sphere.boundsMin.z;
+        float diameter = std::sqrt(dx * dx + dy * dy + dz * dz);
+        float refine = MESH_LOD_PIXEL_ERROR * diameter / sphere.lods[0].error;
+        float coarsen = refine * (1.0f - MESH_LOD_HYSTERESIS);
+        float between = (refine + coarsen) * 0.5f;
+        std::cout << "select  Sphere-Mesh LOD 0/1 at " << coarsen << " px coarser, " << refine << " px finer, "
+            << between << " px keeps " << sphere.SelectLOD(between, 0) << " and " << sphere.SelectLOD(between, 1) << std::endl;
+        Check(sphere.SelectLOD(between, 0) == 0 && sphere.SelectLOD(between, 1) >= 1, "sizes inside the hysteresis band must keep the last level");
+        Check(sphere.SelectLOD(refine * 1.01f, 1) == 0, "sizes past the refine limit must go back to LOD 0");
+    }
+
+    void Dolly() {
+        Scene scene;
+        AddSphere(scene, LA::vec3(0.0f));
+        std::vector<float> distances;
+        for (float z = 4.0f; z <= 120.0f; z += 0.25f)
+            distances.push_back(z);
+        std::vector<uint8_t> out, back;
+        for (float z : distances)
+            out.push_back(LODAt(scene, z));
+        for (auto it = distances.rbegin(); it != distances.rend(); ++it)
+            back.push_back(LODAt(scene, *it));
+
+        // first distance each level is reached walking away, and last distance it is kept walking back
+        uint8_t coarsest = out.back();
+        Check(coarsest > 0, "a distant sphere should not draw LOD 0");
+        for (uint8_t lod = 1; lod <= coarsest; lod++) {
+            float away = 0.0f, towards = 0.0f;
+            for (size_t i = 0; i < out.size() && away == 0.0f; i++)
+                away = out[i] >= lod ? distances[i] : 0.0f;
+            for (size_t i = 0; i < back.size(); i++)
+                towards = back[i] >= lod ? distances[distances.size() - 1 - i] : towards;
+            std::cout << "dolly   LOD " << (int)lod << " from " << away << " walking away, kept to " << towards << " walking back" << std::endl;
+            Check(towards < away, "walking back should keep LOD " + std::to_string(lod) + " closer than it was picked");
+        }
+
+        // a camera shaking around the first switch distance
+        float away = 0.0f;
+        for (size_t i = 0; i < out.size() && away == 0.0f; i++)
+            away = out[i] >= 1 ? distances[i] : 0.0f;
+        uint32_t switches = 0;
+        uint8_t last = LODAt(scene, away);
+        for (int i = 0; i < 100; i++) {
+            uint8_t lod = LODAt(scene, away + (i % 2 ? 0.1f : -0.1f));
+            switches += lod != last;
+            last = lod;
+        }
+        std::cout << "dolly   " << switches << " switches over 100 frames shaking around " << away << std::endl;
+        Check(switches <= 1, "shaking around a switch distance flickers between levels");
+    }
+
+    void Frame() {
+        Scene scene;
+        for (uint32_t row = 0; row < BENCH_ROWS; row++) {
+            for (uint32_t column = 0; column < BENCH_COLUMNS; column++)
+                AddSphere(scene, LA::vec3({((float)column - (float)(BENCH_COLUMNS - 1) * 0.5f) * 3.0f, 0.0f, -(float)row * 8.0f}));
+        }
+        SceneView view = BenchView(10.0f);
+
+        uint32_t triangles[2] = {0, 0};
+        uint32_t visible = 0;
+        for (bool meshLOD : {false, true}) {
+            _renderer.SetMeshLOD(meshLOD);
+            Render(scene, view);
+            Render(scene, view);
+            triangles[meshLOD] = _renderer.GetStats().triangles;
+            visible = _renderer.GetStats().visible;
+            uint32_t levels[MESH_LOD_MAX + 1] = {};
+            for (const RenderCommand& command : _renderer.GetLastFrame().commands) {
+                if (command.type == RenderCommandType::DRAW || command.type == RenderCommandType::DRAW_INSTANCED)
+                    levels[command.lod] += command.count;
+            }
+            std::cout << "frame   LOD " << (meshLOD ? "on:  " : "off: ") << triangles[meshLOD] << " triangles, "
+                << _renderer.GetStats().draws << " draws, spheres per level";
+            for (uint32_t lod = 0; lod <= MESH_LOD_MAX; lod++)
+                std::cout << " " << levels[lod];
+            std::cout << std::endl;
+        }
+        _renderer.SetMeshLOD(true);
+        Check(triangles[1] * 4 < triangles[0] * 3, "LOD should save at least a quarter of the sphere field's triangles");
+        Check(triangles[0] == visible * FindRenderAsset<Mesh>("Sphere-Mesh")->GetTriangleCount(),
+            "LOD off must draw every visible sphere whole");
+    }
+
+private:
+    HeadlessRenderer& _renderer = HeadlessRenderer::Instance();
+
+    void AddSphere(Scene& scene, const LA::vec3& position) {
+        Entity sphere = scene.CreateEntity("Sphere");
+        sphere.GetComponent<TransformComponent>().position = position;
+        MeshRendererComponent& mrc = sphere.AddComponent<MeshRendererComponent>();
+        mrc.mesh = FindRenderAsset<Mesh>("Sphere-Mesh");
+        mrc.material = FindRenderAsset<Material>("default-material");
+    }
+
+    void Render(Scene& scene, const SceneView& view) {
+        _renderer.Clear();
+        SceneRenderer(scene).Render(view, ShadingMode::SHADED);
+        _renderer.EndFrame();
+    }
+
+    // level the single sphere in scene is drawn at with the camera at z
+    uint8_t LODAt(Scene& scene, float z) {
+        Render(scene, BenchView(z));
+        for (const RenderCommand& command : _renderer.GetLastFrame().commands) {
+            if (command.type == RenderCommandType::DRAW)
+                return command.lod;
+        }
+        return 0;
+    }
+
+    void Check(bool condition, const std::string& message) {
+        if (condition)
+            return;
+        std::cout << "ERROR (lod_bench): " << message << "." << std::endl;
+        passed = false;
+    }
+};
+
+// the sphere field through the software rasteriser, frame time with LOD off and on
+void SoftwareFrames() {
+    Scene scene;
+    std::shared_ptr<Mesh> sphere = FindRenderAsset<Mesh>("Sphere-Mesh");
+    for (uint32_t row = 0; row < BENCH_ROWS; row++) {
+        for (uint32_t column = 0; column < BENCH_COLUMNS; column++) {
+            Entity entity = scene.CreateEntity("Sphere");
+            entity.GetComponent<TransformComponent>().position = LA::vec3({((float)column - (float)(BENCH_COLUMNS - 1) * 0.5f) * 3.0f, 0.0f, -(float)row * 8.0f});
+            MeshRendererComponent& mrc = entity.AddComponent<MeshRendererComponent>();
+            mrc.mesh = sphere;
+            mrc.material = FindRenderAsset<Material>("default-material");
+        }
+    }
+
+    RendererAPI::SetAPI(RendererAPI::API::SOFTWARE);
+    SoftwareRenderer& renderer = SoftwareRenderer::Instance();
+    renderer.Boot();
+    renderer.SetFrameBuffer(FrameBuffer::Create("lod-bench", BENCH_WIDTH, BENCH_HEIGHT));
+    for (bool meshLOD : {false, true}) {
+        renderer.SetMeshLOD(meshLOD);
+        uint64_t triangles = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < BENCH_FRAMES; i++) {
+            renderer.Clear();
+            SceneRenderer(scene).Render(BenchView(10.0f), ShadingMode::SHADED);
+            renderer.EndFrame();
+            triangles += renderer.GetStats().triangles;
+        }
+        std::cout << "software LOD " << (meshLOD ? "on:  " : "off: ") << Millis(start) / BENCH_FRAMES << " ms/frame, "
+            << triangles / BENCH_FRAMES << " triangles" << std::endl;
+    }
+    renderer.Shutdown();
+}
+
+int main(int argc, char** argv) {
+    RendererAPI::SetAPI(RendererAPI::API::NONE);
+    HeadlessRenderer& renderer = HeadlessRenderer::Instance();
+    renderer.Boot();
+
+    bool loaded = LoadPresets({
+        "marathon/assets/shaders/base.vert",
+        "marathon/assets/shaders/base.frag"
+    });
+    if (!loaded) {
+        std::cout << "ERROR (lod_bench): Failed to load the presets, run from the repository root." << std::endl;
+        return 1;
+    }
+
+    std::shared_ptr<Shader> base = CreateRenderAsset<Shader>("base",
+        FindRenderAsset<ShaderSource>("base_vert"), FindRenderAsset<ShaderSource>("base_frag"));
+    std::shared_ptr<Material> material = CreateRenderAsset<Material>("default-material");
+    material->SetProperty("colour", LA::vec4(1.0f));
+    material->shader = base;
+
+    LODBench bench;
+    bench.Import();
+    bench.Select();
+    bench.Dolly();
+    bench.Frame();
+    bool passed = bench.passed;
+    renderer.Shutdown();
+    SoftwareFrames();
+    return passed ? 0 : 1;
+}
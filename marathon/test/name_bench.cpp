@@ -0,0 +1,80 @@
+// std libs
+#include <iostream>
+#include <string>
+#include <random>
+#include <chrono>
+
+// internal libs
+#include "la_extended.h"
+#include "ecs/ngine.hpp"
+#include "renderer/components.hpp"
+#include "serializer/scene_serializer.hpp"
+
+// Deserialises a json scene whose mesh renderers all resolve assets by name,
+// then looks entities up by name. Both lean on the name indices.
+
+#define BENCH_ASSETS 1000
+#define BENCH_ENTITIES 50000
+#define BENCH_LOOKUPS 10000
+#define BENCH_PATH "name_bench.json"
+
+double Millis(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    AssetManager& assetManager = AssetManager::Instance();
+    // half meshes, half materials
+    std::vector<std::shared_ptr<Mesh>> meshes;
+    std::vector<std::shared_ptr<Material>> materials;
+    for (int i = 0; i < BENCH_ASSETS / 2; i++) {
+        meshes.push_back(assetManager.CreateAsset<OpenGLMesh>("bench-mesh-" + std::to_string(i)));
+        materials.push_back(assetManager.CreateAsset<OpenGLMaterial>("bench-material-" + std::to_string(i)));
+    }
+
+    std::mt19937 rng(1234);
+    {
+        Scene scene;
+        for (int i = 0; i < BENCH_ENTITIES; i++) {
+            Entity e = scene.CreateEntity("entity-" + std::to_string(i));
+            MeshRendererComponent& mrc = e.AddComponent<MeshRendererComponent>();
+            mrc.mesh = meshes[rng() % meshes.size()];
+            mrc.material = materials[rng() % materials.size()];
+        }
+        SceneSerializer(scene).Serialize(BENCH_PATH);
+    }
+
+    Scene scene;
+    auto start = std::chrono::steady_clock::now();
+    SceneSerializer(scene).Deserialize(BENCH_PATH);
+    double loadMs = Millis(start);
+
+    std::vector<std::string> names(BENCH_LOOKUPS);
+    for (std::string& name : names)
+        name = "entity-" + std::to_string(rng() % BENCH_ENTITIES);
+    size_t found = 0;
+    start = std::chrono::steady_clock::now();
+    for (const std::string& name : names)
+        found += (bool)scene.FindEntityByName(name);
+    double findMs = Millis(start);
+
+    // same lookups the serializer does, without the json parsing around them
+    std::vector<std::string> assetNames(BENCH_ENTITIES);
+    for (std::string& name : assetNames)
+        name = "bench-mesh-" + std::to_string(rng() % meshes.size());
+    start = std::chrono::steady_clock::now();
+    for (const std::string& name : assetNames)
+        found += assetManager.FindAsset<OpenGLMesh>(name) != nullptr;
+    double assetMs = Millis(start);
+
+    if (found != BENCH_LOOKUPS + BENCH_ENTITIES || scene.GetEntitiesWith<MeshRendererComponent>().size() != BENCH_ENTITIES) {
+        std::cout << "ERROR (name_bench): Scene did not load fully." << std::endl;
+        return 1;
+    }
+
+    std::cout << BENCH_ASSETS << " assets, " << BENCH_ENTITIES << " entities" << std::endl;
+    std::cout << "deserialise:      " << loadMs << " ms" << std::endl;
+    std::cout << "FindAsset:        " << assetMs * 1000000.0 / BENCH_ENTITIES << " ns/lookup" << std::endl;
+    std::cout << "FindEntityByName: " << findMs * 1000000.0 / BENCH_LOOKUPS << " ns/lookup" << std::endl;
+    return 0;
+}
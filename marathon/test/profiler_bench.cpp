@@ -0,0 +1,93 @@
+// std libs
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <future>
+
+// internal libs
+#include "core/profiler.hpp"
+#include "core/thread_pool.hpp"
+
+// Cost of a profile zone: a frame of nested zones on the main thread, then the same with every
+// pool worker recording at once, and the cost of draining the rings at the frame boundary.
+// The recorded frames are written as a Chrome trace.
+// Usage: profiler_bench [zones per frame] [trace path]
+
+#define BENCH_ZONES 2000
+#define BENCH_FRAMES 60
+#define BENCH_TRACE "profiler_bench.json"
+
+double Millis(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// keeps the loop from being optimised away when zones are compiled out
+volatile uint32_t sink = 0;
+
+void Work(int zones) {
+    PROFILE_SCOPE("Work");
+    for (int i = 0; i < zones; i++) {
+        PROFILE_SCOPE("Zone");
+        sink = sink + i;
+    }
+}
+
+int main(int argc, char** argv) {
+    int zones = argc > 1 ? std::atoi(argv[1]) : BENCH_ZONES;
+    std::string trace = argc > 2 ? argv[2] : BENCH_TRACE;
+    Profiler& profiler = Profiler::Instance();
+    profiler.SetThreadName("Main");
+
+    // baseline without recording, zones still check the flag
+    profiler.SetRecording(false);
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < BENCH_FRAMES; frame++)
+        Work(zones);
+    double offMs = Millis(start);
+    profiler.SetRecording(true);
+
+    double drainMs = 0.0;
+    start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+        Work(zones);
+        auto drain = std::chrono::steady_clock::now();
+        profiler.BeginFrame();
+        drainMs += Millis(drain);
+    }
+    double onMs = Millis(start) - drainMs;
+
+    ThreadPool pool;
+    uint32_t workers = pool.GetWorkerCount();
+    double threadedDrainMs = 0.0;
+    start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+        std::vector<std::future<void>> jobs;
+        for (uint32_t i = 0; i < workers; i++)
+            jobs.push_back(pool.Submit([zones]() { Work(zones); }));
+        Work(zones);
+        for (std::future<void>& job : jobs)
+            job.wait();
+        auto drain = std::chrono::steady_clock::now();
+        profiler.BeginFrame();
+        threadedDrainMs += Millis(drain);
+    }
+    double threadedMs = Millis(start) - threadedDrainMs;
+
+    double recorded = (double)BENCH_FRAMES * (zones + 1);
+    std::cout << zones << " zones per frame, " << BENCH_FRAMES << " frames, " << workers << " workers" << std::endl;
+    std::cout << "not recording:  " << offMs * 1e6 / recorded << " ns/zone" << std::endl;
+    std::cout << "main thread:    " << onMs * 1e6 / recorded << " ns/zone, drain "
+        << drainMs * 1e3 / BENCH_FRAMES << " us/frame" << std::endl;
+    std::cout << "all threads:    " << threadedMs * 1e6 / (recorded * (workers + 1)) << " ns/zone/thread, drain "
+        << threadedDrainMs * 1e3 / BENCH_FRAMES << " us/frame" << std::endl;
+    std::cout << "dropped:        " << profiler.GetDroppedCount() << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    if (!profiler.WriteChromeTrace(trace))
+        return 1;
+    std::cout << "trace:          " << trace << " (" << profiler.GetFrameCount() << " frames, " << Millis(start) << " ms)" << std::endl;
+    return 0;
+}
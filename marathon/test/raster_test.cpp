@@ -0,0 +1,203 @@
+// std libs
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <filesystem>
+
+// internal libs
+#include "la_extended.h"
+#include "ecs/asset.hpp"
+#include "renderer/model_loader.hpp"
+#include "renderer/shader_loader.hpp"
+#include "renderer/render_assets.hpp"
+#include "renderer/scene_renderer.hpp"
+#include "serializer/scene_converter.hpp"
+#include "platform/software/software_renderer.hpp"
+#include "bench_common.hpp"
+
+// Renders Preset.json with the software rasteriser from a fixed camera and compares it to a golden PNG.
+// On a mismatch the render and a diff (mismatched pixels in red) are written next to the binary's cwd.
+// With --bench the same frame is timed at a larger size for 1, 2, 4... threads up to the hardware count.
+// Run from the repository root. Usage: raster_test [--update] [--bench]
+//      --update    writes the golden instead of comparing, look at it before committing
+
+#define RASTER_TEST_WIDTH 320
+#define RASTER_TEST_HEIGHT 240
+#define RASTER_TEST_GOLDEN "marathon/test/golden/preset.png"
+#define RASTER_TEST_OUTPUT "raster_test_out.png"
+#define RASTER_TEST_DIFF "raster_test_diff.png"
+// per channel difference still counted as a match, and the share of pixels allowed beyond it
+#define RASTER_TEST_TOLERANCE 8
+#define RASTER_TEST_MAX_MISMATCH 0.002
+#define RASTER_BENCH_WIDTH 1280
+#define RASTER_BENCH_HEIGHT 720
+#define RASTER_BENCH_FRAMES 20
+
+SceneView PresetView(uint32_t width, uint32_t height) {
+    return MakeView(LA::vec3({0.0f, 12.0f, 32.0f}), LA::vec3({0.0f, 1.0f, 0.0f}), width, height);
+}
+
+void RenderFrame(Scene& scene, const SceneView& view) {
+    Renderer::Instance().Clear();
+    SceneRenderer(scene).Render(view, ShadingMode::SHADED);
+}
+
+bool WritePNG(const std::string& path, int width, int height, const std::vector<uint8_t>& pixels) {
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty())
+        std::filesystem::create_directories(parent);
+    return stbi_write_png(path.c_str(), width, height, 4, pixels.data(), width * 4) != 0;
+}
+
+// counts pixels with any channel beyond the tolerance, the diff marks them red over a dimmed render
+uint32_t Compare(const std::vector<uint8_t>& image, const uint8_t* golden, uint32_t pixels, std::vector<uint8_t>& diff) {
+    diff.resize(image.size());
+    uint32_t mismatched = 0;
+    for (uint32_t i = 0; i < pixels; i++) {
+        int worst = 0;
+        for (int c = 0; c < 3; c++)
+            worst = std::max(worst, std::abs((int)image[i * 4 + c] - (int)golden[i * 4 + c]));
+        bool mismatch = worst > RASTER_TEST_TOLERANCE;
+        mismatched += mismatch;
+        for (int c = 0; c < 3; c++)
+            diff[i * 4 + c] = mismatch ? (c == 0 ? 255 : 0) : image[i * 4 + c] / 3;
+        diff[i * 4 + 3] = 255;
+    }
+    return mismatched;
+}
+
+bool GoldenTest(Scene& scene, std::shared_ptr<SoftwareFrameBuffer> target, bool update) {
+    RenderFrame(scene, PresetView(RASTER_TEST_WIDTH, RASTER_TEST_HEIGHT));
+    std::vector<uint8_t> image;
+    target->ReadPixels(image);
+    const RasterStats& stats = SoftwareRenderer::Instance().GetRasterStats();
+    std::cout << "preset:   " << stats.triangles << " triangles, " << stats.clipped << " clipped, " << stats.culled
+        << " culled, " << stats.pixelsShaded << " pixels shaded" << std::endl;
+
+    if (update) {
+        bool written = WritePNG(RASTER_TEST_GOLDEN, RASTER_TEST_WIDTH, RASTER_TEST_HEIGHT, image);
+        std::cout << (written ? "Updated " : "ERROR (raster_test): Failed to write ") << RASTER_TEST_GOLDEN << std::endl;
+        return written;
+    }
+
+    int width = 0, height = 0, channels = 0;
+    uint8_t* golden = stbi_load(RASTER_TEST_GOLDEN, &width, &height, &channels, 4);
+    if (!golden || channels != 4 || width != RASTER_TEST_WIDTH || height != RASTER_TEST_HEIGHT) {
+        std::cout << "ERROR (raster_test): No usable golden at " << RASTER_TEST_GOLDEN
+            << ", check " << RASTER_TEST_OUTPUT << " and run with --update." << std::endl;
+        WritePNG(RASTER_TEST_OUTPUT, RASTER_TEST_WIDTH, RASTER_TEST_HEIGHT, image);
+        if (golden)
+            stbi_image_free(golden);
+        return false;
+    }
+
+    uint32_t pixels = RASTER_TEST_WIDTH * RASTER_TEST_HEIGHT;
+    std::vector<uint8_t> diff;
+    uint32_t mismatched = Compare(image, golden, pixels, diff);
+    stbi_image_free(golden);
+    double share = (double)mismatched / pixels;
+    bool passed = share <= RASTER_TEST_MAX_MISMATCH;
+    std::cout << "golden:   " << mismatched << " of " << pixels << " pixels differ (" << share * 100.0 << "%), "
+        << (passed ? "passed" : "FAILED") << std::endl;
+    if (!passed) {
+        WritePNG(RASTER_TEST_OUTPUT, RASTER_TEST_WIDTH, RASTER_TEST_HEIGHT, image);
+        WritePNG(RASTER_TEST_DIFF, RASTER_TEST_WIDTH, RASTER_TEST_HEIGHT, diff);
+        std::cout << "Wrote " << RASTER_TEST_OUTPUT << " and " << RASTER_TEST_DIFF << std::endl;
+    }
+    return passed;
+}
+
+void Bench(Scene& scene, std::shared_ptr<SoftwareFrameBuffer> target) {
+    SoftwareRenderer& renderer = SoftwareRenderer::Instance();
+    target->Resize(RASTER_BENCH_WIDTH, RASTER_BENCH_HEIGHT);
+    SceneView view = PresetView(RASTER_BENCH_WIDTH, RASTER_BENCH_HEIGHT);
+
+    uint32_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<uint32_t> counts;
+    for (uint32_t threads = 1; threads < hardware; threads *= 2)
+        counts.push_back(threads);
+    counts.push_back(hardware);
+
+    std::cout << RASTER_BENCH_WIDTH << "x" << RASTER_BENCH_HEIGHT << ", " << RASTER_BENCH_FRAMES << " frames per thread count" << std::endl;
+    double singleMs = 0.0;
+    for (uint32_t threads : counts) {
+        renderer.SetThreadCount(threads);
+        // first frame spins up the workers and sizes the bins
+        RenderFrame(scene, view);
+        double vertexMs = 0.0, setupMs = 0.0, rasterMs = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < RASTER_BENCH_FRAMES; i++) {
+            RenderFrame(scene, view);
+            const RasterStats& stats = renderer.GetRasterStats();
+            vertexMs += stats.vertexMs;
+            setupMs += stats.setupMs;
+            rasterMs += stats.rasterMs;
+        }
+        double frameMs = Millis(start) / RASTER_BENCH_FRAMES;
+        const RasterStats& stats = renderer.GetRasterStats();
+        double drawMs = (vertexMs + setupMs + rasterMs) / RASTER_BENCH_FRAMES;
+        if (threads == 1)
+            singleMs = drawMs;
+        std::cout << threads << " threads: " << frameMs << " ms/frame, raster " << drawMs << " ms (vertex "
+            << vertexMs / RASTER_BENCH_FRAMES << ", setup " << setupMs / RASTER_BENCH_FRAMES << ", tiles "
+            << rasterMs / RASTER_BENCH_FRAMES << "), " << stats.triangles / drawMs / 1000.0 << " Mtri/s, "
+            << stats.pixelsShaded / drawMs / 1000.0 << " Mpix/s, x" << singleMs / drawMs << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    bool update = false, bench = false;
+    for (int i = 1; i < argc; i++) {
+        update |= std::strcmp(argv[i], "--update") == 0;
+        bench |= std::strcmp(argv[i], "--bench") == 0;
+    }
+
+    RendererAPI::SetAPI(RendererAPI::API::SOFTWARE);
+    SoftwareRenderer& renderer = SoftwareRenderer::Instance();
+    renderer.Boot();
+
+    // parse every run, the image must not depend on what a previous run cached
+    DerivedDataCache::Instance().SetEnabled(false);
+    bool loaded = LoadPresets({
+        "marathon/assets/shaders/base.vert",
+        "marathon/assets/shaders/base.frag",
+        "marathon/assets/shaders/lighting.vert",
+        "marathon/assets/shaders/lighting.frag"
+    });
+    if (!loaded) {
+        std::cout << "ERROR (raster_test): Failed to load the presets, run from the repository root." << std::endl;
+        return 1;
+    }
+
+    std::shared_ptr<Shader> base = CreateRenderAsset<Shader>("base",
+        FindRenderAsset<ShaderSource>("base_vert"), FindRenderAsset<ShaderSource>("base_frag"));
+    std::shared_ptr<Shader> lighting = CreateRenderAsset<Shader>("lighting",
+        FindRenderAsset<ShaderSource>("lighting_vert"), FindRenderAsset<ShaderSource>("lighting_frag"));
+    std::shared_ptr<Material> material = CreateRenderAsset<Material>("default-material");
+    material->SetProperty("colour", LA::vec4(1.0f));
+    material->shader = lighting;
+    std::shared_ptr<Material> wireframe = CreateRenderAsset<Material>(WIREFRAME_MATERIAL_NAME);
+    wireframe->shader = base;
+
+    Scene scene;
+    if (!LoadSceneFile(scene, "marathon/assets/scenes/Preset.json")) {
+        std::cout << "ERROR (raster_test): Failed to load Preset.json." << std::endl;
+        return 1;
+    }
+
+    std::shared_ptr<SoftwareFrameBuffer> target = std::static_pointer_cast<SoftwareFrameBuffer>(
+        FrameBuffer::Create("raster-test", RASTER_TEST_WIDTH, RASTER_TEST_HEIGHT));
+    renderer.SetFrameBuffer(target);
+
+    bool passed = GoldenTest(scene, target, update);
+    if (bench)
+        Bench(scene, target);
+
+    renderer.Shutdown();
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,163 @@
+// std libs
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+
+// internal libs
+#include "la_extended.h"
+#include "ecs/ngine.hpp"
+#include "runtime/application.hpp"
+#include "renderer/components.hpp"
+#include "renderer/scene_renderer.hpp"
+#include "platform/headless/headless_renderer.hpp"
+
+// Runs a headless application over a field of cubes, moving a tenth of them every frame.
+// Times scene update, culling and the render queue with no window or GPU, then checks the
+// recorded command list: every visible entity drawn exactly once, batches sharing binds.
+// Usage: render_bench [entities] [frames]
+
+#define BENCH_ENTITIES 20000
+#define BENCH_FRAMES 300
+#define BENCH_MESHES 16
+#define BENCH_MATERIALS 4
+
+// instanced shader, the headless backend only reads the declarations
+const char* BENCH_VERT = R"(
+#ifndef INSTANCED
+uniform mat4 uModel;
+#endif
+uniform float uTime;
+)";
+const char* BENCH_FRAG = R"(
+uniform vec4 uColour;
+)";
+
+std::shared_ptr<Mesh> MakeCube(const std::string& name) {
+    std::shared_ptr<Mesh> mesh = Mesh::Create(name);
+    for (int i = 0; i < 8; i++)
+        mesh->vertices.push_back(LA::vec3({i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f}));
+    const uint32_t faces[6][4] = {{0, 1, 3, 2}, {4, 6, 7, 5}, {0, 4, 5, 1}, {2, 3, 7, 6}, {0, 2, 6, 4}, {1, 5, 7, 3}};
+    for (const auto& face : faces) {
+        mesh->indices.insert(mesh->indices.end(), {face[0], face[1], face[2], face[0], face[2], face[3]});
+    }
+    mesh->CalculateBounds();
+    return mesh;
+}
+
+class RenderBench : public Interactive {
+public:
+    RenderBench(int entities)
+        : _entities(entities) {}
+
+    bool passed = true;
+
+    void Start() override {
+        std::shared_ptr<Shader> shader = Shader::Create("bench-shader",
+            ShaderSource::Create("bench_vert", BENCH_VERT, ShaderStage::VERTEX),
+            ShaderSource::Create("bench_frag", BENCH_FRAG, ShaderStage::FRAGMENT));
+        for (int i = 0; i < BENCH_MESHES; i++)
+            _meshes.push_back(MakeCube("bench-mesh-" + std::to_string(i)));
+        for (int i = 0; i < BENCH_MATERIALS; i++) {
+            std::shared_ptr<Material> material = Material::Create("bench-material-" + std::to_string(i));
+            material->shader = shader;
+            material->SetProperty("uColour", LA::vec4(1.0f));
+            _materials.push_back(material);
+        }
+
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> spread(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> depth(-200.0f, 0.0f);
+        for (int i = 0; i < _entities; i++) {
+            Entity e = _scene.CreateEntity("entity-" + std::to_string(i));
+            e.GetComponent<TransformComponent>().position = LA::vec3({spread(rng), spread(rng), depth(rng)});
+            MeshRendererComponent& mrc = e.AddComponent<MeshRendererComponent>();
+            mrc.mesh = _meshes[rng() % BENCH_MESHES];
+            mrc.material = _materials[rng() % BENCH_MATERIALS];
+            _moving.push_back(e);
+        }
+        _moving.resize(_entities / 10);
+
+        // identity view, camera at the origin looking down -z
+        _view.projection = LA::Perspective(45.0f, 16.0f / 9.0f, 0.1f, 150.0f);
+    }
+
+    void Update(double dt) override {
+        _time += dt;
+        for (Entity& e : _moving)
+            e.GetComponent<TransformComponent>().rotation = LA::vec3({0.0f, (float)_time * 90.0f, 0.0f});
+
+        auto start = std::chrono::steady_clock::now();
+        _sceneRenderer.Render(_view, ShadingMode::SHADED);
+        _renderMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        _frames++;
+        Check();
+    }
+
+    void End() override {
+        const RenderStats& stats = _renderer.GetStats();
+        std::cout << _entities << " entities, " << _frames << " frames, " << stats.visible << " visible, "
+            << stats.culled << " culled" << std::endl;
+        std::cout << "render:   " << _renderMs / std::max(1, _frames) << " ms/frame (update, cull, queue, flush)" << std::endl;
+        std::cout << "draws:    " << stats.draws << " (" << stats.instances << " instances), "
+            << stats.programBinds << " program binds, " << stats.vaoBinds << " vao binds, "
+            << stats.uniformUploads << " uniform uploads" << std::endl;
+        std::cout << "commands: " << _commands << " per frame" << std::endl;
+    }
+
+private:
+    int _entities = 0;
+    int _frames = 0;
+    double _time = 0.0;
+    double _renderMs = 0.0;
+    size_t _commands = 0;
+
+    Scene _scene;
+    SceneRenderer _sceneRenderer = SceneRenderer(_scene);
+    SceneView _view;
+    HeadlessRenderer& _renderer = HeadlessRenderer::Instance();
+    std::vector<std::shared_ptr<Mesh>> _meshes;
+    std::vector<std::shared_ptr<Material>> _materials;
+    std::vector<Entity> _moving;
+
+    // this frame's commands must draw every visible entity once and bind each mesh at most once
+    void Check() {
+        const RenderCommandList& list = _renderer.GetCommands();
+        const RenderStats& stats = _renderer.GetStats();
+        uint32_t drawn = 0;
+        for (const RenderCommand& command : list.commands) {
+            if (command.type == RenderCommandType::DRAW || command.type == RenderCommandType::DRAW_INSTANCED)
+                drawn += command.count;
+        }
+        uint32_t meshBinds = list.CountOf(RenderCommandType::BIND_MESH);
+        if (drawn != stats.visible || list.transforms.size() != drawn
+            || meshBinds > BENCH_MESHES * BENCH_MATERIALS || list.CountOf(RenderCommandType::BIND_SHADER) > 2) {
+            std::cout << "ERROR (render_bench): Frame " << _frames << " drew " << drawn << " of " << stats.visible
+                << " visible with " << meshBinds << " mesh binds." << std::endl;
+            passed = false;
+            Application::Instance().Stop();
+        }
+        _commands = list.commands.size();
+    }
+};
+
+int main(int argc, char** argv) {
+    int entities = argc > 1 ? std::atoi(argv[1]) : BENCH_ENTITIES;
+    ApplicationConfig cfg;
+    cfg.name = "render_bench";
+    cfg.headless = true;
+    cfg.loopConfig.maxFrames = argc > 2 ? std::atoi(argv[2]) : BENCH_FRAMES;
+
+    Application* app = Application::Create(cfg);
+    RenderBench* bench = new RenderBench(entities);
+    app->SetInteractive(bench);
+    app->Run();
+    const LoopStats& loop = app->GetLoopStats();
+    std::cout << "frame:    p50 " << loop.frameTimes.p50 << " ms, p99 " << loop.frameTimes.p99 << " ms" << std::endl;
+    bool passed = bench->passed;
+    // deletes the bench after End
+    delete app;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+// std libs
+#include <iostream>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <sys/resource.h>
+
+// internal libs
+#include "la_extended.h"
+#include "ecs/ngine.hpp"
+#include "renderer/components.hpp"
+#include "serializer/scene_converter.hpp"
+
+// Generates a large scene, saves it as json and binary, then loads each in a fresh process.
+// Each load runs as a child so peak RSS belongs to that format alone.
+// Usage: scene_bench [entities], child mode: scene_bench --load <file>
+
+#define BENCH_ENTITIES 100000
+#define BENCH_MESHES 32
+#define BENCH_MATERIALS 8
+#define BENCH_JSON_PATH "scene_bench.json"
+#define BENCH_BINARY_PATH "scene_bench" SCENE_BINARY_EXT
+
+// peak resident set in KB, linux reports ru_maxrss in KB
+long PeakRSS() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+void CreateAssets() {
+    AssetManager& assetManager = AssetManager::Instance();
+    for (int i = 0; i < BENCH_MESHES; i++)
+        assetManager.CreateAsset<OpenGLMesh>("bench-mesh-" + std::to_string(i));
+    for (int i = 0; i < BENCH_MATERIALS; i++)
+        assetManager.CreateAsset<OpenGLMaterial>("bench-material-" + std::to_string(i));
+}
+
+void GenerateScene(Scene& scene, int count) {
+    AssetManager& assetManager = AssetManager::Instance();
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+    std::uniform_int_distribution<int> pick(0, 99);
+
+    std::vector<Entity> entities;
+    entities.reserve(count);
+    for (int i = 0; i < count; i++) {
+        Entity e = scene.CreateEntity("entity-" + std::to_string(i));
+        TransformComponent& tc = e.GetComponent<TransformComponent>();
+        tc.position = LA::vec3({position(rng), position(rng), position(rng)});
+        tc.rotation = LA::vec3({0.0f, angle(rng), 0.0f});
+
+        int roll = pick(rng);
+        if (roll < 80) {
+            MeshRendererComponent& mrc = e.AddComponent<MeshRendererComponent>();
+            mrc.mesh = assetManager.FindAsset<OpenGLMesh>("bench-mesh-" + std::to_string(i % BENCH_MESHES));
+            mrc.material = assetManager.FindAsset<OpenGLMaterial>("bench-material-" + std::to_string(i % BENCH_MATERIALS));
+        } else if (roll < 85) {
+            e.AddComponent<PointLightComponent>();
+        } else if (roll < 86) {
+            e.AddComponent<SpotLightComponent>();
+        }
+        // roughly one in ten hangs off an earlier entity
+        if (i > 0 && pick(rng) < 10)
+            e.SetParent(entities[rng() % entities.size()]);
+        entities.push_back(e);
+    }
+}
+
+// child process, load one file and report
+int LoadAndReport(const std::string& filepath) {
+    CreateAssets();
+    long baseRSS = PeakRSS();
+    Scene scene;
+    auto start = std::chrono::steady_clock::now();
+    bool loaded = LoadSceneFile(scene, filepath);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (!loaded) {
+        std::cout << "ERROR (scene_bench): Failed to load " << filepath << std::endl;
+        return 1;
+    }
+    std::cout << filepath << ": " << scene.GetEntityCount() << " entities, "
+        << ms << " ms, peak RSS " << PeakRSS() / 1024 << " MB (+"
+        << (PeakRSS() - baseRSS) / 1024 << " MB over startup)" << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 3 && std::strcmp(argv[1], "--load") == 0)
+        return LoadAndReport(argv[2]);
+
+    int count = argc > 1 ? std::atoi(argv[1]) : BENCH_ENTITIES;
+    CreateAssets();
+    {
+        Scene scene;
+        GenerateScene(scene, count);
+        SaveSceneFile(scene, BENCH_JSON_PATH);
+    }
+    // binary is produced through the converter so it gets exercised too
+    if (!ConvertScene(BENCH_JSON_PATH, BENCH_BINARY_PATH)) {
+        std::cout << "ERROR (scene_bench): Failed to convert scene." << std::endl;
+        return 1;
+    }
+
+    std::string self = argv[0];
+    int result = std::system((self + " --load " BENCH_JSON_PATH).c_str());
+    result |= std::system((self + " --load " BENCH_BINARY_PATH).c_str());
+    return result == 0 ? 0 : 1;
+}
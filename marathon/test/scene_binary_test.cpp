@@ -0,0 +1,123 @@
+// std libs
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+// internal libs
+#include "la_extended.h"
+#include "ecs/ngine.hpp"
+#include "renderer/components.hpp"
+#include "serializer/scene_binary.hpp"
+
+// Corrupt copies of a small binary scene must fail to load and leave the loaded scene untouched:
+//      missing     no file at the path
+//      truncated   file cut in half
+//      section     section offset near the top of uint64_t, so offset + size wraps
+//      strings     string offsets out of order
+//      cycle       two entities parented to each other
+// Usage: scene_binary_test
+
+#define TEST_PATH "scene_binary_test" SCENE_BINARY_EXT
+#define TEST_CORRUPT_PATH "scene_binary_test_corrupt" SCENE_BINARY_EXT
+#define TEST_ENTITIES 4
+
+bool passed = true;
+
+void Check(bool condition, const std::string& message) {
+    if (condition)
+        return;
+    std::cout << "ERROR (scene_binary_test): " << message << "." << std::endl;
+    passed = false;
+}
+
+std::vector<uint8_t> ReadBytes(const std::string& filepath) {
+    std::ifstream file(filepath, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+void WriteBytes(const std::string& filepath, const std::vector<uint8_t>& bytes) {
+    std::ofstream file(filepath, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+SceneBinaryHeader Header(const std::vector<uint8_t>& bytes) {
+    SceneBinaryHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(SceneBinaryHeader));
+    return header;
+}
+
+SceneBinarySection* Sections(std::vector<uint8_t>& bytes) {
+    return reinterpret_cast<SceneBinarySection*>(bytes.data() + sizeof(SceneBinaryHeader));
+}
+
+// loads a corrupt copy into a scene that already holds the original, which must survive
+void ExpectRejected(const std::vector<uint8_t>& bytes, const std::string& name) {
+    Scene scene;
+    SceneBinarySerializer serializer(scene);
+    Check(serializer.Deserialize(TEST_PATH), name + ": original failed to load");
+    WriteBytes(TEST_CORRUPT_PATH, bytes);
+    Check(!serializer.Deserialize(TEST_CORRUPT_PATH), name + ": corrupt file loaded");
+    Check(scene.GetEntityCount() == TEST_ENTITIES, name + ": scene was replaced by a failed load");
+}
+
+int main() {
+    {
+        Scene scene;
+        std::vector<Entity> entities;
+        for (int i = 0; i < TEST_ENTITIES; i++)
+            entities.push_back(scene.CreateEntity("entity-" + std::to_string(i)));
+        entities[1].SetParent(entities[0]);
+        entities[2].SetParent(entities[1]);
+        entities[3].AddComponent<PointLightComponent>();
+        SceneBinarySerializer serializer(scene);
+        if (!serializer.Serialize(TEST_PATH)) {
+            std::cout << "ERROR (scene_binary_test): Failed to write " TEST_PATH "." << std::endl;
+            return 1;
+        }
+    }
+    const std::vector<uint8_t> original = ReadBytes(TEST_PATH);
+    SceneBinaryHeader header = Header(original);
+
+    {
+        Scene scene;
+        SceneBinarySerializer serializer(scene);
+        Check(serializer.Deserialize(TEST_PATH), "valid file failed to load");
+        Check(scene.GetEntityCount() == TEST_ENTITIES, "valid file loaded wrong entity count");
+        std::remove(TEST_CORRUPT_PATH);
+        Check(!serializer.Deserialize(TEST_CORRUPT_PATH), "missing: file loaded");
+        Check(scene.GetEntityCount() == TEST_ENTITIES, "missing: scene was replaced by a failed load");
+    }
+
+    std::vector<uint8_t> truncated(original.begin(), original.begin() + original.size() / 2);
+    ExpectRejected(truncated, "truncated");
+
+    std::vector<uint8_t> section = original;
+    Sections(section)[0].offset = UINT64_MAX - 7;
+    ExpectRejected(section, "section");
+
+    std::vector<uint8_t> strings = original;
+    uint32_t* offsets = reinterpret_cast<uint32_t*>(strings.data() + header.stringTableOffset);
+    offsets[0] = offsets[1] + 1;
+    ExpectRejected(strings, "strings");
+
+    // core section arrays: uuids, names, parents, active, each 8 byte aligned
+    std::vector<uint8_t> cycle = original;
+    for (uint32_t i = 0; i < header.sectionCount; i++) {
+        const SceneBinarySection& core = Sections(cycle)[i];
+        if (core.type != SceneSection::CORE)
+            continue;
+        size_t parentsOffset = core.offset + ((TEST_ENTITIES * 8 + 7) & ~7) + ((TEST_ENTITIES * 4 + 7) & ~7);
+        uint32_t* parents = reinterpret_cast<uint32_t*>(cycle.data() + parentsOffset);
+        parents[0] = 1;
+        parents[1] = 0;
+    }
+    ExpectRejected(cycle, "cycle");
+
+    std::remove(TEST_PATH);
+    std::remove(TEST_CORRUPT_PATH);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,215 @@
+// std libs
+#include <iostream>
+#include <vector>
+#include <string>
+#include <set>
+#include <cmath>
+#include <chrono>
+
+// internal libs
+#include "la_extended.h"
+#include "ecs/asset.hpp"
+#include "renderer/model_loader.hpp"
+#include "renderer/shader_loader.hpp"
+#include "renderer/render_assets.hpp"
+#include "renderer/scene_renderer.hpp"
+#include "serializer/scene_converter.hpp"
+#include "platform/headless/headless_renderer.hpp"
+#include "bench_common.hpp"
+
+// Shadow map caching on Preset.json with the headless renderer, plus a shadowed spot light:
+//      first       every planned map is drawn
+//      static      a second frame of the same scene keeps every map and issues no shadow draws
+//      camera      moving the camera by less than a snap step keeps every map
+//      caster      moving one caster redraws exactly the maps it was or now is inside of
+//      light       moving the spot light redraws only its own map
+//      bench       frame time and shadow draws with a static scene against a caster moving every frame
+// Run from the repository root. Usage: shadow_bench
+
+#define BENCH_WIDTH 1280
+#define BENCH_HEIGHT 720
+#define BENCH_FRAMES 200
+#define BENCH_CAMERA_NUDGE 0.01f
+
+// camera at (0, 12, 32) looking down at the scene, slid by offset
+SceneView BenchView(const LA::vec3& offset=LA::vec3(0.0f)) {
+    return MakeView(LA::vec3({0.0f, 12.0f, 32.0f}) + offset, LA::vec3({0.0f, 1.0f, 0.0f}) + offset, BENCH_WIDTH, BENCH_HEIGHT);
+}
+
+class ShadowBench {
+public:
+    bool passed = true;
+
+    ShadowBench(Scene& scene)
+        : _scene(scene), _view(BenchView()) {}
+
+    void Run() {
+        Frame();
+        uint32_t views = (uint32_t)_renderer.GetShadowMaps().GetViews().size();
+        const RenderStats& first = _renderer.GetStats();
+        std::cout << "first:    " << views << " maps, " << first.shadowViews << " drawn, " << first.shadowDraws
+            << " draws (" << first.shadowCasters << " casters)" << std::endl;
+        Check(views == SHADOW_CASCADES + 1, "expected the cascades and one spot map");
+        Check(first.shadowViews == views && first.shadowCacheHits == 0, "first frame must draw every map");
+        Check(first.shadowDraws > 0, "first frame drew no casters");
+        Check(_renderer.GetLastFrame().CountOf(RenderCommandType::SHADOW_VIEW) == views, "SHADOW_VIEW commands don't match the maps drawn");
+
+        Frame();
+        const RenderStats& still = _renderer.GetStats();
+        std::cout << "static:   " << still.shadowCacheHits << " cached, " << still.shadowViews << " drawn, "
+            << still.shadowDraws << " draws" << std::endl;
+        Check(still.shadowCacheHits == views && still.shadowViews == 0 && still.shadowDraws == 0, "static frame redrew shadow maps");
+        Check(_renderer.GetLastFrame().CountOf(RenderCommandType::SHADOW_VIEW) == 0, "static frame recorded SHADOW_VIEW commands");
+
+        MoveCamera();
+        MoveCaster();
+        MoveLight();
+        Bench();
+    }
+
+private:
+    Scene& _scene;
+    SceneView _view;
+    HeadlessRenderer& _renderer = HeadlessRenderer::Instance();
+
+    void Frame() {
+        _renderer.Clear();
+        SceneRenderer(_scene).Render(_view, ShadingMode::SHADED);
+        _renderer.EndFrame();
+    }
+
+    void Check(bool condition, const std::string& message) {
+        if (condition)
+            return;
+        std::cout << "ERROR (shadow_bench): " << message << "." << std::endl;
+        passed = false;
+    }
+
+    // slots holding caster i in the last Update
+    std::set<uint32_t> SlotsWith(uint32_t caster) {
+        std::set<uint32_t> slots;
+        for (const ShadowView& view : _renderer.GetShadowMaps().GetViews()) {
+            for (uint32_t index : view.casters) {
+                if (index == caster)
+                    slots.insert(view.slot);
+            }
+        }
+        return slots;
+    }
+
+    std::set<uint32_t> DrawnSlots() {
+        std::set<uint32_t> slots;
+        for (const RenderCommand& command : _renderer.GetLastFrame().commands) {
+            if (command.type == RenderCommandType::SHADOW_VIEW)
+                slots.insert(command.first);
+        }
+        return slots;
+    }
+
+    void MoveCamera() {
+        // far less than a snap step of even the nearest cascade, whose boxes must stay put to the bit
+        _view = BenchView(LA::vec3({BENCH_CAMERA_NUDGE, BENCH_CAMERA_NUDGE, -BENCH_CAMERA_NUDGE}));
+        Frame();
+        const RenderStats& stats = _renderer.GetStats();
+        std::cout << "camera:   " << stats.shadowViews << " drawn, " << stats.shadowCacheHits << " cached" << std::endl;
+        Check(stats.shadowViews == 0, "moving the camera within a snap step redrew shadow maps");
+    }
+
+    void MoveCaster() {
+        // every Preset renderable casts, so casters follow the renderable order
+        std::vector<Entity> renderables = _scene.GetEntitiesWith<MeshRendererComponent>();
+        uint32_t caster = 0;
+        std::set<uint32_t> expected = SlotsWith(caster);
+        renderables[caster].GetComponent<TransformComponent>().position.y += 0.5f;
+        Frame();
+        std::set<uint32_t> after = SlotsWith(caster);
+        expected.insert(after.begin(), after.end());
+        std::set<uint32_t> drawn = DrawnSlots();
+        const RenderStats& stats = _renderer.GetStats();
+        std::cout << "caster:   " << drawn.size() << " drawn, " << stats.shadowCacheHits << " cached, "
+            << stats.shadowDraws << " draws" << std::endl;
+        Check(!expected.empty(), "moved caster is in no shadow map");
+        Check(drawn == expected, "moving a caster must redraw exactly the maps it touches");
+    }
+
+    void MoveLight() {
+        std::vector<Entity> spots = _scene.GetEntitiesWith<SpotLightComponent>();
+        spots[0].GetComponent<TransformComponent>().position.x += 1.0f;
+        Frame();
+        std::set<uint32_t> drawn = DrawnSlots();
+        std::cout << "light:    " << drawn.size() << " drawn, " << _renderer.GetStats().shadowCacheHits << " cached" << std::endl;
+        Check(drawn == std::set<uint32_t>({SHADOW_CASCADES}), "moving the spot light must redraw only its map");
+    }
+
+    void Bench() {
+        std::vector<Entity> renderables = _scene.GetEntitiesWith<MeshRendererComponent>();
+        TransformComponent& moving = renderables[0].GetComponent<TransformComponent>();
+        for (bool dynamic : {false, true}) {
+            Frame();
+            uint64_t draws = 0, drawn = 0, cached = 0;
+            double shadowMs = 0.0;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < BENCH_FRAMES; i++) {
+                if (dynamic)
+                    moving.position.x += (i % 2 == 0) ? 0.01f : -0.01f;
+                Frame();
+                const RenderStats& stats = _renderer.GetStats();
+                draws += stats.shadowDraws;
+                drawn += stats.shadowViews;
+                cached += stats.shadowCacheHits;
+                shadowMs += _renderer.GetShadowMaps().GetStats().updateMs;
+            }
+            std::cout << (dynamic ? "bench moving: " : "bench static: ") << Millis(start) / BENCH_FRAMES << " ms/frame, plan "
+                << shadowMs / BENCH_FRAMES << " ms, " << (double)drawn / BENCH_FRAMES << " maps drawn, "
+                << (double)cached / BENCH_FRAMES << " cached, " << (double)draws / BENCH_FRAMES << " shadow draws per frame" << std::endl;
+        }
+    }
+};
+
+int main(int argc, char** argv) {
+    RendererAPI::SetAPI(RendererAPI::API::NONE);
+    HeadlessRenderer& renderer = HeadlessRenderer::Instance();
+    renderer.Boot();
+
+    bool loaded = LoadPresets({
+        "marathon/assets/shaders/base.vert",
+        "marathon/assets/shaders/base.frag",
+        "marathon/assets/shaders/lighting.vert",
+        "marathon/assets/shaders/lighting.frag",
+        "marathon/assets/shaders/shadow.vert",
+        "marathon/assets/shaders/shadow.frag"
+    });
+    if (!loaded) {
+        std::cout << "ERROR (shadow_bench): Failed to load the presets, run from the repository root." << std::endl;
+        return 1;
+    }
+
+    std::shared_ptr<Shader> lighting = CreateRenderAsset<Shader>("lighting",
+        FindRenderAsset<ShaderSource>("lighting_vert"), FindRenderAsset<ShaderSource>("lighting_frag"));
+    CreateRenderAsset<Shader>(SHADOW_SHADER_NAME,
+        FindRenderAsset<ShaderSource>("shadow_vert"), FindRenderAsset<ShaderSource>("shadow_frag"));
+    std::shared_ptr<Material> material = CreateRenderAsset<Material>("default-material");
+    material->SetProperty("colour", LA::vec4(1.0f));
+    material->shader = lighting;
+
+    Scene scene;
+    if (!LoadSceneFile(scene, "marathon/assets/scenes/Preset.json")) {
+        std::cout << "ERROR (shadow_bench): Failed to load Preset.json." << std::endl;
+        return 1;
+    }
+    // a shadowed spot light above the scene looking straight down
+    Entity spot = scene.CreateEntity("Shadow Spot");
+    TransformComponent& tc = spot.GetComponent<TransformComponent>();
+    tc.position = LA::vec3({0.0f, 15.0f, 0.0f});
+    tc.rotation = LA::vec3({90.0f, 0.0f, 0.0f});
+    SpotLightComponent& slc = spot.AddComponent<SpotLightComponent>();
+    slc.outerCutOff = 40.0f;
+    slc.range = 30.0f;
+    slc.castShadows = true;
+
+    ShadowBench bench(scene);
+    bench.Run();
+    bool passed = bench.passed;
+    renderer.Shutdown();
+    return passed ? 0 : 1;
+}
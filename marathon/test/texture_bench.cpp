@@ -0,0 +1,108 @@
+// std libs
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <filesystem>
+
+// internal libs
+#include "ecs/asset.hpp"
+#include "core/filepath.hpp"
+// brings in the stb_image implementation along with tinygltf
+#include "renderer/model_loader.hpp"
+#include "renderer/texture_loader.hpp"
+
+// Decodes every supported texture under marathon/assets/textures serially, then through LoadAsync.
+// Includes building the mip chains, nothing is uploaded to GL.
+// Then imports with block compression twice through a fresh cache, cold (encode) and warm (cache hits).
+// Run from the repository root. Usage: texture_bench [folder]
+
+#define BENCH_FOLDER "marathon/assets/textures"
+#define BENCH_CACHE "texture_bench_cache"
+
+double Millis(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// CPU bytes of the mip chains of the most recently loaded count textures
+size_t TextureBytes(size_t count) {
+    auto textures = AssetManager::Instance().GetAssets<OpenGLTexture>();
+    size_t bytes = 0;
+    for (size_t i = textures.size() - count; i < textures.size(); i++) {
+        for (const std::vector<uint8_t>& mip : static_cast<Texture*>(textures[i].get())->mips)
+            bytes += mip.size();
+    }
+    return bytes;
+}
+
+double Import(AssetLoaderManager& loaderManager, const std::vector<std::string>& paths, bool& ok) {
+    auto start = std::chrono::steady_clock::now();
+    ok &= loaderManager.Wait(loaderManager.LoadAsync(paths));
+    return Millis(start);
+}
+
+int main(int argc, char** argv) {
+    std::string folder = argc > 1 ? argv[1] : BENCH_FOLDER;
+    AssetLoaderManager& loaderManager = AssetLoaderManager::Instance();
+    std::shared_ptr<TextureLoader> textureLoader = std::make_shared<TextureLoader>();
+    textureLoader->compress = false;
+    loaderManager.AddLoader(textureLoader);
+    DerivedDataCache& cache = DerivedDataCache::Instance();
+    cache.SetRoot(BENCH_CACHE);
+    std::filesystem::remove_all(BENCH_CACHE);
+
+    std::vector<std::string> paths;
+    for (const std::string& path : ListFilesRecursive(folder)) {
+        if (textureLoader->CanLoad(path))
+            paths.push_back(path);
+    }
+    if (paths.empty()) {
+        std::cout << "ERROR (texture_bench): No textures found, run from the repository root." << std::endl;
+        return 1;
+    }
+
+    // decode rows measure decoding, not cache hits
+    cache.SetEnabled(false);
+    bool serialOk = true;
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string& path : paths)
+        serialOk &= loaderManager.Load(path);
+    double serialMs = Millis(start);
+
+    // first call spins up the pool, keep that out of the timing
+    loaderManager.Wait(loaderManager.LoadAsync({}));
+    start = std::chrono::steady_clock::now();
+    std::vector<AssetLoadHandle> handles = loaderManager.LoadAsync(paths);
+    bool asyncOk = loaderManager.Wait(handles);
+    double asyncMs = Millis(start);
+
+    size_t rawBytes = TextureBytes(paths.size());
+
+    cache.SetEnabled(true);
+    textureLoader->compress = true;
+    bool importOk = true;
+    double coldMs = Import(loaderManager, paths, importOk);
+    DerivedDataStats cold = cache.GetStats();
+    cache.ResetStats();
+    double warmMs = Import(loaderManager, paths, importOk);
+    DerivedDataStats warm = cache.GetStats();
+    size_t compressedBytes = TextureBytes(paths.size());
+    std::filesystem::remove_all(BENCH_CACHE);
+
+    if (!serialOk || !asyncOk || !importOk) {
+        std::cout << "ERROR (texture_bench): Some textures failed to decode." << std::endl;
+        return 1;
+    }
+
+    std::cout << paths.size() << " textures, " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+    std::cout << "decode serial: " << serialMs << " ms" << std::endl;
+    std::cout << "decode async:  " << asyncMs << " ms (" << serialMs / asyncMs << "x)" << std::endl;
+    std::cout << "import cold:   " << coldMs << " ms, hit rate " << cold.GetHitRate() * 100.0f << "%, "
+        << cold.bytesWritten / 1024 << " KB cached" << std::endl;
+    std::cout << "import warm:   " << warmMs << " ms, hit rate " << warm.GetHitRate() * 100.0f << "%" << std::endl;
+    std::cout << "memory:        " << rawBytes / 1024 << " KB -> " << compressedBytes / 1024 << " KB ("
+        << 100.0 - 100.0 * compressedBytes / rawBytes << "% saved)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,322 @@
+// std libs
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+
+// internal libs
+#include "ecs/ngine.hpp"
+#include "window/window.hpp"
+#include "renderer/renderer.hpp"
+#include "renderer/shader_loader.hpp"
+#include "renderer/model_loader.hpp"
+#include "serializer/scene_serializer.hpp"
+
+// Counts the uniform driver calls a Runtime frame makes on the Preset scene.
+// "before" replays the old path: glGetUniformLocation + glUniform per set.
+// "after" resolves UniformHandles once and only issues glUniform per set.
+// "blocks" fills the std140 camera/light blocks and uploads them once per frame.
+// Run from the repository root so the asset paths resolve.
+
+#define BENCH_FRAMES 1000
+
+struct DriverCalls {
+    uint64_t locationQueries = 0;
+    uint64_t uniformUploads = 0;
+    uint64_t bufferUploads = 0;
+};
+
+struct LightCounts {
+    size_t directional = 0;
+    size_t point = 0;
+    size_t spot = 0;
+    size_t renderables = 0;
+};
+
+// old path, query location by name on every set
+void SetByName(DriverCalls& calls, const std::string& name, const LA::vec3& v) {
+    GLint program = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    GLint loc = glGetUniformLocation(program, name.c_str());
+    glUniform3f(loc, v.x, v.y, v.z);
+    calls.locationQueries++;
+    calls.uniformUploads++;
+}
+
+void SetByName(DriverCalls& calls, const std::string& name, float f) {
+    GLint program = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    GLint loc = glGetUniformLocation(program, name.c_str());
+    glUniform1f(loc, f);
+    calls.locationQueries++;
+    calls.uniformUploads++;
+}
+
+void SetByName(DriverCalls& calls, const std::string& name, int i) {
+    GLint program = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    GLint loc = glGetUniformLocation(program, name.c_str());
+    glUniform1i(loc, i);
+    calls.locationQueries++;
+    calls.uniformUploads++;
+}
+
+void SetByName(DriverCalls& calls, const std::string& name, const LA::mat4& m) {
+    GLint program = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    GLint loc = glGetUniformLocation(program, name.c_str());
+    glUniformMatrix4fv(loc, 1, GL_FALSE, &(m)[0][0]);
+    calls.locationQueries++;
+    calls.uniformUploads++;
+}
+
+void FrameBefore(DriverCalls& calls, std::vector<std::shared_ptr<Shader>>& shaders, const LightCounts& lc) {
+    LA::vec3 v = LA::vec3(1.0f);
+    LA::mat4 m = LA::mat4();
+    for (auto& shader : shaders) {
+        shader->Bind();
+        SetByName(calls, "uResolution", v);
+        SetByName(calls, "uCameraPosition", v);
+        for (int i = 0; i < DIRECTIONAL_LIGHT_MAX; i++) {
+            std::string index = "[" + std::to_string(i) + "]";
+            if (i < lc.directional) {
+                SetByName(calls, "uDirectionalLights" + index + ".colour", v);
+                SetByName(calls, "uDirectionalLights" + index + ".intensity", 1.0f);
+                SetByName(calls, "uDirectionalLights" + index + ".direction", v);
+            }
+            SetByName(calls, "uDirectionalLights" + index + ".enabled", (int)(i < lc.directional));
+        }
+        for (int i = 0; i < POINT_LIGHT_MAX; i++) {
+            std::string index = "[" + std::to_string(i) + "]";
+            if (i < lc.point) {
+                SetByName(calls, "uPointLights" + index + ".colour", v);
+                SetByName(calls, "uPointLights" + index + ".intensity", 1.0f);
+                SetByName(calls, "uPointLights" + index + ".position", v);
+            }
+            SetByName(calls, "uPointLights" + index + ".range", i < lc.point ? 10.0f : 0.0f);
+        }
+        for (int i = 0; i < SPOT_LIGHT_MAX; i++) {
+            std::string index = "[" + std::to_string(i) + "]";
+            if (i < lc.spot) {
+                SetByName(calls, "uSpotLights" + index + ".colour", v);
+                SetByName(calls, "uSpotLights" + index + ".intensity", 1.0f);
+                SetByName(calls, "uSpotLights" + index + ".position", v);
+                SetByName(calls, "uSpotLights" + index + ".range", 10.0f);
+                SetByName(calls, "uSpotLights" + index + ".direction", v);
+                SetByName(calls, "uSpotLights" + index + ".cutOff", 1.0f);
+                SetByName(calls, "uSpotLights" + index + ".outerCutOff", 1.0f);
+            }
+            SetByName(calls, "uSpotLights" + index + ".enabled", (int)(i < lc.spot));
+        }
+    }
+    // per entity transform uniforms
+    for (size_t i = 0; i < lc.renderables; i++) {
+        shaders.back()->Bind();
+        SetByName(calls, "uView", m);
+        SetByName(calls, "uProjection", m);
+        SetByName(calls, "uModel", m);
+    }
+}
+
+// resolved once per shader, reused every frame
+struct ShaderHandles {
+    std::shared_ptr<Shader> shader;
+    UniformHandle resolution, cameraPosition, view, projection, model;
+    std::vector<UniformHandle> directional, point, spot;
+
+    ShaderHandles(std::shared_ptr<Shader> s)
+        : shader(s) {
+        resolution = s->Locate("uResolution");
+        cameraPosition = s->Locate("uCameraPosition");
+        view = s->Locate("uView");
+        projection = s->Locate("uProjection");
+        model = s->Locate("uModel");
+        for (int i = 0; i < DIRECTIONAL_LIGHT_MAX; i++) {
+            std::string index = "uDirectionalLights[" + std::to_string(i) + "]";
+            for (auto field : {".colour", ".intensity", ".direction", ".enabled"})
+                directional.push_back(s->Locate(index + field));
+        }
+        for (int i = 0; i < POINT_LIGHT_MAX; i++) {
+            std::string index = "uPointLights[" + std::to_string(i) + "]";
+            for (auto field : {".colour", ".intensity", ".position", ".range"})
+                point.push_back(s->Locate(index + field));
+        }
+        for (int i = 0; i < SPOT_LIGHT_MAX; i++) {
+            std::string index = "uSpotLights[" + std::to_string(i) + "]";
+            for (auto field : {".colour", ".intensity", ".position", ".range", ".direction", ".cutOff", ".outerCutOff", ".enabled"})
+                spot.push_back(s->Locate(index + field));
+        }
+    }
+};
+
+// only count uploads the shader would actually issue
+void Upload(DriverCalls& calls, UniformHandle h) {
+    if (h.IsValid())
+        calls.uniformUploads++;
+}
+
+void FrameAfter(DriverCalls& calls, std::vector<ShaderHandles>& handles, const LightCounts& lc) {
+    LA::vec3 v = LA::vec3(1.0f);
+    LA::mat4 m = LA::mat4();
+    for (auto& h : handles) {
+        h.shader->Bind();
+        h.shader->SetVec3(h.resolution, v); Upload(calls, h.resolution);
+        h.shader->SetVec3(h.cameraPosition, v); Upload(calls, h.cameraPosition);
+        for (int i = 0; i < DIRECTIONAL_LIGHT_MAX; i++) {
+            UniformHandle* f = &h.directional[i * 4];
+            if (i < lc.directional) {
+                h.shader->SetVec3(f[0], v); Upload(calls, f[0]);
+                h.shader->SetFloat(f[1], 1.0f); Upload(calls, f[1]);
+                h.shader->SetVec3(f[2], v); Upload(calls, f[2]);
+            }
+            h.shader->SetInt(f[3], (int)(i < lc.directional)); Upload(calls, f[3]);
+        }
+        for (int i = 0; i < POINT_LIGHT_MAX; i++) {
+            UniformHandle* f = &h.point[i * 4];
+            if (i < lc.point) {
+                h.shader->SetVec3(f[0], v); Upload(calls, f[0]);
+                h.shader->SetFloat(f[1], 1.0f); Upload(calls, f[1]);
+                h.shader->SetVec3(f[2], v); Upload(calls, f[2]);
+            }
+            h.shader->SetFloat(f[3], i < lc.point ? 10.0f : 0.0f); Upload(calls, f[3]);
+        }
+        for (int i = 0; i < SPOT_LIGHT_MAX; i++) {
+            UniformHandle* f = &h.spot[i * 8];
+            if (i < lc.spot) {
+                for (int j = 0; j < 7; j++) {
+                    if (j == 1 || j == 3 || j == 5 || j == 6)
+                        h.shader->SetFloat(f[j], 1.0f);
+                    else
+                        h.shader->SetVec3(f[j], v);
+                    Upload(calls, f[j]);
+                }
+            }
+            h.shader->SetInt(f[7], (int)(i < lc.spot)); Upload(calls, f[7]);
+        }
+    }
+    // per entity transform uniforms
+    ShaderHandles& last = handles.back();
+    for (size_t i = 0; i < lc.renderables; i++) {
+        last.shader->Bind();
+        last.shader->SetMat4(last.view, m); Upload(calls, last.view);
+        last.shader->SetMat4(last.projection, m); Upload(calls, last.projection);
+        last.shader->SetMat4(last.model, m); Upload(calls, last.model);
+    }
+}
+
+void FrameBlocks(DriverCalls& calls, uint32_t ubo, std::vector<ShaderHandles>& handles, const LightCounts& lc) {
+    CameraBlock camera;
+    LightBlock lights;
+    for (size_t i = 0; i < DIRECTIONAL_LIGHT_MAX; i++)
+        lights.directional[i].enabled = (int32_t)(i < lc.directional);
+    for (size_t i = 0; i < POINT_LIGHT_MAX; i++)
+        lights.point[i].range = i < lc.point ? 10.0f : 0.0f;
+    for (size_t i = 0; i < SPOT_LIGHT_MAX; i++) {
+        lights.spot[i].enabled = (int32_t)(i < lc.spot);
+        lights.spot[i].range = 10.0f;
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &camera);
+    glBufferSubData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), sizeof(LightBlock), &lights);
+    calls.bufferUploads += 2;
+    // only the model matrix is left per entity
+    LA::mat4 m = LA::mat4();
+    ShaderHandles& last = handles.back();
+    for (size_t i = 0; i < lc.renderables; i++) {
+        last.shader->Bind();
+        last.shader->SetMat4(last.model, m); Upload(calls, last.model);
+    }
+}
+
+void PrintResult(const std::string& label, const DriverCalls& calls, double ms) {
+    std::cout << label << ": "
+        << calls.locationQueries / BENCH_FRAMES << " location queries/frame, "
+        << calls.uniformUploads / BENCH_FRAMES << " uniform uploads/frame, "
+        << calls.bufferUploads / BENCH_FRAMES << " buffer uploads/frame, "
+        << ms / BENCH_FRAMES << " ms/frame" << std::endl;
+}
+
+int main() {
+    Window& window = Window::Instance();
+    window.Boot();
+    Renderer& renderer = Renderer::Instance();
+    renderer.Boot();
+
+    AssetManager& assetManager = AssetManager::Instance();
+    AssetLoaderManager& loaderManager = AssetLoaderManager::Instance();
+    loaderManager.AddLoader(std::make_shared<ModelLoader>());
+    loaderManager.AddLoader(std::make_shared<ShaderLoader>());
+    for (auto model : {"cone", "cube", "cylinder", "dome", "ico_sphere", "plane", "prism", "sphere"}) {
+        loaderManager.Load(std::string("marathon/assets/models/presets/") + model + ".gltf");
+    }
+    loaderManager.Load("marathon/assets/shaders/base.vert");
+    loaderManager.Load("marathon/assets/shaders/base.frag");
+    loaderManager.Load("marathon/assets/shaders/lighting.vert");
+    loaderManager.Load("marathon/assets/shaders/lighting.frag");
+
+    std::vector<std::shared_ptr<Shader>> shaders = {
+        assetManager.CreateAsset<OpenGLShader>(
+            "base",
+            assetManager.FindAsset<OpenGLShaderSource>("base_vert"),
+            assetManager.FindAsset<OpenGLShaderSource>("base_frag")),
+        assetManager.CreateAsset<OpenGLShader>(
+            "lighting",
+            assetManager.FindAsset<OpenGLShaderSource>("lighting_vert"),
+            assetManager.FindAsset<OpenGLShaderSource>("lighting_frag"))
+    };
+
+    Scene scene = Scene();
+    SceneSerializer ss = SceneSerializer(scene);
+    ss.Deserialize("marathon/assets/scenes/Preset.json");
+    LightCounts lc;
+    lc.directional = scene.GetEntitiesWith<DirectionalLightComponent>().size();
+    lc.point = scene.GetEntitiesWith<PointLightComponent>().size();
+    lc.spot = scene.GetEntitiesWith<SpotLightComponent>().size();
+    lc.renderables = scene.GetEntitiesWith<MeshRendererComponent>().size();
+    std::cout << "Preset scene: " << lc.renderables << " renderables, "
+        << lc.directional << " directional, " << lc.point << " point, " << lc.spot << " spot lights" << std::endl;
+
+    // before
+    DriverCalls before;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        FrameBefore(before, shaders, lc);
+    }
+    glFinish();
+    double beforeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // after
+    std::vector<ShaderHandles> handles;
+    for (auto& shader : shaders) {
+        handles.emplace_back(shader);
+    }
+    DriverCalls after;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        FrameAfter(after, handles, lc);
+    }
+    glFinish();
+    double afterMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // blocks
+    uint32_t ubo = 0;
+    glGenBuffers(1, &ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock) + sizeof(LightBlock), nullptr, GL_DYNAMIC_DRAW);
+    DriverCalls blocks;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        FrameBlocks(blocks, ubo, handles, lc);
+    }
+    glFinish();
+    double blocksMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    glDeleteBuffers(1, &ubo);
+
+    PrintResult("before (glGetUniformLocation per set)", before, beforeMs);
+    PrintResult("after (cached UniformHandle)", after, afterMs);
+    PrintResult("blocks (std140 uniform buffers)", blocks, blocksMs);
+
+    renderer.Shutdown();
+    window.Shutdown();
+    return 0;
+}
@@ -0,0 +1,163 @@
+// std libs
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+// internal libs
+#include "la_extended.h"
+#include "renderer/vertex_layout.hpp"
+#include "platform/headless/headless_mesh.hpp"
+
+// Round trips of the quantised vertex formats and the index size picked at the 0xFFFF boundary:
+//      half        FloatToHalf decoded back stays within half precision, with exact zeros, subnormals,
+//                  infinities and nans
+//      snorm       PackSnorm2101010 decoded back is within half a step, w keeps its sign, values clamp
+//      vertices    a quantised mesh packed by PackVertices decodes to its own normals and uvs
+//      indices     16 bit indices up to 0xFFFE vertices, quantised or not, 32 bit from 0xFFFF
+// Usage: vertex_test
+
+bool passed = true;
+
+void Check(bool condition, const std::string& message) {
+    if (condition)
+        return;
+    std::cout << "ERROR (vertex_test): " << message << "." << std::endl;
+    passed = false;
+}
+
+float HalfToFloat(uint16_t half) {
+    uint32_t sign = (half & 0x8000u) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+    if (exponent == 0)
+        return (sign ? -1.0f : 1.0f) * std::ldexp((float)mantissa, -24);
+    uint32_t bits = exponent == 0x1F ? sign | 0x7F800000u | (mantissa << 13)
+        : sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    float value = 0.0f;
+    std::memcpy(&value, &bits, sizeof(float));
+    return value;
+}
+
+// sign extended 10 or 2 bit field of a packed 2_10_10_10
+float UnpackSnorm(uint32_t packed, uint32_t shift, uint32_t bits, float scale) {
+    int32_t value = (int32_t)(packed << (32 - shift - bits)) >> (32 - bits);
+    return std::max((float)value / scale, -1.0f);
+}
+
+void TestHalf() {
+    for (float value : {0.0f, 1.0f, -2.0f, 0.5f, 0.25f, 1024.0f, 65504.0f, -65504.0f})
+        Check(HalfToFloat(FloatToHalf(value)) == value, "half of " + std::to_string(value) + " is not exact");
+    Check(FloatToHalf(-0.0f) == 0x8000, "negative zero lost its sign");
+    // the smallest half subnormal survives, a quarter of it rounds to zero
+    Check(HalfToFloat(FloatToHalf(std::ldexp(1.0f, -24))) == std::ldexp(1.0f, -24), "smallest subnormal is not exact");
+    Check(FloatToHalf(std::ldexp(1.0f, -26)) == 0, "values far below the subnormals must flush to zero");
+    Check(FloatToHalf(1e6f) == 0x7C00 && FloatToHalf(-1e6f) == 0xFC00, "overflow must clamp to infinity");
+    Check(FloatToHalf(INFINITY) == 0x7C00, "infinity must stay infinity");
+    Check(std::isnan(HalfToFloat(FloatToHalf(NAN))), "nan must stay nan");
+
+    // normal range keeps 11 bits, subnormals a fixed step of 2^-24
+    float worst = 0.0f;
+    for (float value = -70000.0f; value <= 70000.0f; value += 1.37f) {
+        float magnitude = std::fabs(value);
+        if (magnitude > 65504.0f)
+            continue;
+        float error = std::fabs(HalfToFloat(FloatToHalf(value)) - value);
+        worst = std::max(worst, magnitude > 0.0f ? error / magnitude : error);
+    }
+    for (float value = 1e-7f; value < 1e-4f; value *= 1.1f) {
+        float decoded = HalfToFloat(FloatToHalf(value));
+        Check(std::fabs(decoded - value) <= std::max(std::ldexp(1.0f, -25), value * std::ldexp(1.0f, -11)),
+            "small half of " + std::to_string(value) + " is off by more than half a step");
+    }
+    std::cout << "half:     worst relative error " << worst << std::endl;
+    Check(worst <= std::ldexp(1.0f, -11), "half round trip lost more than half a unit in the last place");
+}
+
+void TestSnorm() {
+    float worst = 0.0f;
+    for (float x = -1.0f; x <= 1.0f; x += 0.013f) {
+        float y = -x * 0.5f, z = std::sin(x * 3.0f);
+        uint32_t packed = PackSnorm2101010(x, y, z, x < 0.0f ? -1.0f : 1.0f);
+        float decoded[3] = {UnpackSnorm(packed, 0, 10, 511.0f), UnpackSnorm(packed, 10, 10, 511.0f), UnpackSnorm(packed, 20, 10, 511.0f)};
+        float source[3] = {x, y, z};
+        for (int i = 0; i < 3; i++)
+            worst = std::max(worst, std::fabs(decoded[i] - source[i]));
+        Check(UnpackSnorm(packed, 30, 2, 1.0f) == (x < 0.0f ? -1.0f : 1.0f), "w lost its sign");
+    }
+    std::cout << "snorm:    worst error " << worst << std::endl;
+    Check(worst <= 0.5f / 511.0f + 1e-6f, "snorm round trip is off by more than half a step");
+
+    uint32_t clamped = PackSnorm2101010(2.0f, -2.0f, 1.0f, -1.0f);
+    Check(UnpackSnorm(clamped, 0, 10, 511.0f) == 1.0f && UnpackSnorm(clamped, 10, 10, 511.0f) == -1.0f
+        && UnpackSnorm(clamped, 20, 10, 511.0f) == 1.0f, "out of range values must clamp to [-1, 1]");
+}
+
+void TestVertices() {
+    HeadlessMesh mesh("vertex-test");
+    mesh.vertices = {LA::vec3({0.0f, 0.0f, 0.0f}), LA::vec3({1.0f, 0.0f, 0.0f}), LA::vec3({0.0f, 1.0f, 0.0f})};
+    mesh.normals = {LA::vec3({0.0f, 0.0f, 1.0f}), LA::vec3({0.6f, 0.0f, 0.8f}), LA::vec3({0.0f, -0.8f, 0.6f})};
+    mesh.uv0 = {LA::vec2({0.0f, 0.0f}), LA::vec2({0.3f, 0.7f}), LA::vec2({1.0f, 1.0f})};
+    VertexLayout layout = VertexLayout::Build(mesh, true);
+    std::vector<uint8_t> packed;
+    PackVertices(mesh, layout, packed);
+    Check(packed.size() == mesh.vertices.size() * layout.stride, "packed buffer is not one stride per vertex");
+
+    for (const VertexElement& element : layout.elements) {
+        for (size_t i = 0; i < mesh.vertices.size(); i++) {
+            const uint8_t* src = packed.data() + i * layout.stride + element.offset;
+            if (element.slot == VertexSlot::POSITION) {
+                float position[3];
+                std::memcpy(position, src, sizeof(position));
+                Check(position[0] == mesh.vertices[i].x && position[1] == mesh.vertices[i].y && position[2] == mesh.vertices[i].z,
+                    "positions must stay full floats");
+            } else if (element.slot == VertexSlot::NORMAL) {
+                Check(element.format == VertexFormat::SNORM_2_10_10_10, "quantised normals must be 2_10_10_10");
+                uint32_t normal = 0;
+                std::memcpy(&normal, src, sizeof(uint32_t));
+                Check(std::fabs(UnpackSnorm(normal, 0, 10, 511.0f) - mesh.normals[i].x) <= 1.0f / 511.0f
+                    && std::fabs(UnpackSnorm(normal, 10, 10, 511.0f) - mesh.normals[i].y) <= 1.0f / 511.0f
+                    && std::fabs(UnpackSnorm(normal, 20, 10, 511.0f) - mesh.normals[i].z) <= 1.0f / 511.0f,
+                    "packed normal doesn't decode to the mesh's");
+            } else if (element.slot == VertexSlot::UV0) {
+                Check(element.format == VertexFormat::HALF2, "quantised uvs must be half floats");
+                uint16_t uv[2];
+                std::memcpy(uv, src, sizeof(uv));
+                Check(std::fabs(HalfToFloat(uv[0]) - mesh.uv0[i].x) <= 1e-3f && std::fabs(HalfToFloat(uv[1]) - mesh.uv0[i].y) <= 1e-3f,
+                    "packed uv doesn't decode to the mesh's");
+            }
+        }
+    }
+}
+
+// index bytes a mesh of vertexCount vertices and 3 indices reports once uploaded
+size_t IndexBytes(size_t vertexCount, bool quantise) {
+    HeadlessMesh mesh("index-test");
+    mesh.vertices.resize(vertexCount, LA::vec3(0.0f));
+    mesh.indices = {0, (uint32_t)vertexCount / 2, (uint32_t)vertexCount - 1};
+    mesh.quantise = quantise;
+    mesh.RequestUpload();
+    return mesh.GetMemoryUsage().indexBytes;
+}
+
+void TestIndices() {
+    Check(UseShortIndices(0xFFFE), "0xFFFE vertices fit 16 bit indices");
+    Check(!UseShortIndices(0xFFFF), "0xFFFF vertices would use the primitive restart index");
+    Check(!UseShortIndices(0x10000), "0x10000 vertices don't fit 16 bit indices");
+
+    size_t below = IndexBytes(0xFFFE, true), at = IndexBytes(0xFFFF, true), plain = IndexBytes(0xFFFE, false);
+    std::cout << "indices:  " << below << " bytes at 0xFFFE vertices, " << at << " at 0xFFFF, " << plain << " unquantised" << std::endl;
+    Check(below == 3 * sizeof(uint16_t), "meshes below 0xFFFF vertices must upload 16 bit indices");
+    Check(at == 3 * sizeof(uint32_t), "meshes of 0xFFFF vertices must upload 32 bit indices");
+    Check(plain == 3 * sizeof(uint16_t), "unquantised meshes below 0xFFFF vertices must upload 16 bit indices too");
+}
+
+int main(int argc, char** argv) {
+    TestHalf();
+    TestSnorm();
+    TestVertices();
+    TestIndices();
+    return passed ? 0 : 1;
+}
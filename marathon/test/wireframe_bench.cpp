@@ -0,0 +1,219 @@
+// std libs
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <chrono>
+
+// internal libs
+#include "la_extended.h"
+#include "ecs/asset.hpp"
+#include "renderer/model_loader.hpp"
+#include "renderer/shader_loader.hpp"
+#include "renderer/render_assets.hpp"
+#include "renderer/scene_renderer.hpp"
+#include "serializer/scene_converter.hpp"
+#include "platform/headless/headless_renderer.hpp"
+#include "platform/software/software_renderer.hpp"
+#include "bench_common.hpp"
+
+// Shaded wireframe on Preset.json, as the editor and runtime draw by default:
+//      headless    with single pass wireframe off every mesh is drawn shaded and again as lines, on it is
+//                  drawn once with the lighting shader's WIREFRAME variant and the draw mode never changes
+//      fallback    the deferred path and shaders without a geometry source still draw the overlay as lines
+//      software    the overlay only darkens pixels along triangle edges of the shaded image
+//      bench       frame time, draws and draw mode changes per frame with single pass off and on
+// Run from the repository root. Usage: wireframe_bench
+
+#define BENCH_WIDTH 320
+#define BENCH_HEIGHT 240
+#define BENCH_FRAMES 200
+
+// camera at (0, 12, 32) looking down at the scene
+SceneView BenchView() {
+    return MakeView(LA::vec3({0.0f, 12.0f, 32.0f}), LA::vec3({0.0f, 1.0f, 0.0f}), BENCH_WIDTH, BENCH_HEIGHT);
+}
+
+class WireframeBench {
+public:
+    bool passed = true;
+
+    WireframeBench(Scene& scene, const std::shared_ptr<Material>& material)
+        : _scene(scene), _material(material), _view(BenchView()) {}
+
+    void Run() {
+        RenderStats twoPass = Frame(false);
+        uint32_t lineDraws = DrawsIn(RenderPass::WIREFRAME);
+        std::cout << "two pass:    " << twoPass.draws << " draws, " << lineDraws << " as lines, "
+            << twoPass.drawModeChanges << " draw mode changes, " << twoPass.programBinds << " program binds" << std::endl;
+        Check(lineDraws > 0, "two pass frame drew no lines");
+
+        // the first single pass frame still switches back from the lines the last one ended on
+        Frame(true);
+        RenderStats onePass = Frame(true);
+        std::cout << "single pass: " << onePass.draws << " draws, " << DrawsIn(RenderPass::WIREFRAME) << " as lines, "
+            << onePass.drawModeChanges << " draw mode changes, " << onePass.programBinds << " program binds" << std::endl;
+        Check(DrawsIn(RenderPass::WIREFRAME) == 0, "single pass frame still drew lines");
+        Check(onePass.drawModeChanges == 0 && _renderer.GetLastFrame().CountOf(RenderCommandType::SET_DRAW_MODE) == 0,
+            "single pass frame changed the draw mode");
+        Check(onePass.draws * 2 == twoPass.draws, "single pass must halve the draws");
+        for (const RenderCommand& command : _renderer.GetLastFrame().commands) {
+            bool draw = command.type == RenderCommandType::DRAW || command.type == RenderCommandType::DRAW_INSTANCED;
+            if (draw && !((uint8_t)command.variant & (uint8_t)ShaderVariant::WIREFRAME)) {
+                Check(false, "single pass draw without the WIREFRAME variant");
+                break;
+            }
+        }
+
+        Fallbacks(lineDraws);
+        Bench();
+    }
+
+private:
+    Scene& _scene;
+    std::shared_ptr<Material> _material;
+    SceneView _view;
+    HeadlessRenderer& _renderer = HeadlessRenderer::Instance();
+
+    RenderStats Frame(bool singlePass) {
+        _renderer.SetSinglePassWireframe(singlePass);
+        _renderer.Clear();
+        SceneRenderer(_scene).Render(_view, ShadingMode::SHADED_WIREFRAME);
+        _renderer.EndFrame();
+        return _renderer.GetStats();
+    }
+
+    uint32_t DrawsIn(RenderPass pass) {
+        uint32_t draws = 0;
+        for (const RenderCommand& command : _renderer.GetLastFrame().commands) {
+            bool draw = command.type == RenderCommandType::DRAW || command.type == RenderCommandType::DRAW_INSTANCED;
+            draws += draw && command.pass == pass;
+        }
+        return draws;
+    }
+
+    void Check(bool condition, const std::string& message) {
+        if (condition)
+            return;
+        std::cout << "ERROR (wireframe_bench): " << message << "." << std::endl;
+        passed = false;
+    }
+
+    void Fallbacks(uint32_t lineDraws) {
+        // the G-buffer keeps no edges
+        _renderer.SetRenderPath(RenderPath::DEFERRED);
+        Frame(true);
+        _renderer.SetRenderPath(RenderPath::FORWARD);
+        std::cout << "deferred:    " << DrawsIn(RenderPass::WIREFRAME) << " as lines" << std::endl;
+        Check(DrawsIn(RenderPass::SHADED_WIREFRAME) == 0 && DrawsIn(RenderPass::WIREFRAME) == lineDraws,
+            "deferred path must draw the overlay as lines");
+
+        // no geometry source, no WIREFRAME variant
+        std::shared_ptr<Shader> lighting = _material->shader;
+        _material->shader = CreateRenderAsset<Shader>("lighting-without-geometry",
+            FindRenderAsset<ShaderSource>("lighting_vert"), FindRenderAsset<ShaderSource>("lighting_frag"));
+        Frame(true);
+        _material->shader = lighting;
+        std::cout << "no geometry: " << DrawsIn(RenderPass::WIREFRAME) << " as lines" << std::endl;
+        Check(DrawsIn(RenderPass::SHADED_WIREFRAME) == 0 && DrawsIn(RenderPass::WIREFRAME) == lineDraws,
+            "shaders without a WIREFRAME variant must draw the overlay as lines");
+    }
+
+    void Bench() {
+        for (bool singlePass : {false, true}) {
+            Frame(singlePass);
+            uint64_t draws = 0, modes = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < BENCH_FRAMES; i++) {
+                RenderStats stats = Frame(singlePass);
+                draws += stats.draws;
+                modes += stats.drawModeChanges;
+            }
+            std::cout << (singlePass ? "bench single pass: " : "bench two pass:    ") << Millis(start) / BENCH_FRAMES << " ms/frame, "
+                << (double)draws / BENCH_FRAMES << " draws, " << (double)modes / BENCH_FRAMES << " draw mode changes per frame" << std::endl;
+        }
+        _renderer.SetSinglePassWireframe(true);
+    }
+};
+
+// shaded and shaded wireframe through the software rasteriser, edges may only darken the shaded image
+bool SoftwareEdges(Scene& scene) {
+    RendererAPI::SetAPI(RendererAPI::API::SOFTWARE);
+    SoftwareRenderer& renderer = SoftwareRenderer::Instance();
+    renderer.Boot();
+    std::shared_ptr<SoftwareFrameBuffer> target = std::static_pointer_cast<SoftwareFrameBuffer>(
+        FrameBuffer::Create("wireframe-bench", BENCH_WIDTH, BENCH_HEIGHT));
+    renderer.SetFrameBuffer(target);
+
+    std::vector<uint32_t> images[2];
+    for (int i = 0; i < 2; i++) {
+        renderer.Clear();
+        SceneRenderer(scene).Render(BenchView(), i == 0 ? ShadingMode::SHADED : ShadingMode::SHADED_WIREFRAME);
+        renderer.EndFrame();
+        for (int y = 0; y < BENCH_HEIGHT; y++) {
+            const uint32_t* row = target->GetColour() + (size_t)y * target->GetStride();
+            images[i].insert(images[i].end(), row, row + BENCH_WIDTH);
+        }
+    }
+    renderer.Shutdown();
+
+    uint32_t edges = 0, brighter = 0;
+    for (size_t p = 0; p < images[0].size(); p++) {
+        if (images[0][p] == images[1][p])
+            continue;
+        edges++;
+        for (int c = 0; c < 3; c++) {
+            if (((images[1][p] >> (c * 8)) & 0xFF) > ((images[0][p] >> (c * 8)) & 0xFF)) {
+                brighter++;
+                break;
+            }
+        }
+    }
+    std::cout << "software:    " << edges << " of " << images[0].size() << " pixels on edges, " << brighter << " brighter" << std::endl;
+    bool passed = edges > 0 && edges < images[0].size() / 2 && brighter == 0;
+    if (!passed)
+        std::cout << "ERROR (wireframe_bench): software overlay must darken some, but not most, pixels." << std::endl;
+    return passed;
+}
+
+int main(int argc, char** argv) {
+    RendererAPI::SetAPI(RendererAPI::API::NONE);
+    HeadlessRenderer& renderer = HeadlessRenderer::Instance();
+    renderer.Boot();
+
+    bool loaded = LoadPresets({
+        "marathon/assets/shaders/base.vert",
+        "marathon/assets/shaders/base.frag",
+        "marathon/assets/shaders/lighting.vert",
+        "marathon/assets/shaders/lighting.frag",
+        "marathon/assets/shaders/lighting.geom"
+    });
+    if (!loaded) {
+        std::cout << "ERROR (wireframe_bench): Failed to load the presets, run from the repository root." << std::endl;
+        return 1;
+    }
+
+    std::shared_ptr<Shader> base = CreateRenderAsset<Shader>("base",
+        FindRenderAsset<ShaderSource>("base_vert"), FindRenderAsset<ShaderSource>("base_frag"));
+    std::shared_ptr<Shader> lighting = CreateRenderAsset<Shader>("lighting",
+        FindRenderAsset<ShaderSource>("lighting_vert"), FindRenderAsset<ShaderSource>("lighting_frag"),
+        FindRenderAsset<ShaderSource>("lighting_geom"));
+    std::shared_ptr<Material> material = CreateRenderAsset<Material>("default-material");
+    material->SetProperty("colour", LA::vec4(1.0f));
+    material->shader = lighting;
+    std::shared_ptr<Material> wireframe = CreateRenderAsset<Material>(WIREFRAME_MATERIAL_NAME);
+    wireframe->shader = base;
+
+    Scene scene;
+    if (!LoadSceneFile(scene, "marathon/assets/scenes/Preset.json")) {
+        std::cout << "ERROR (wireframe_bench): Failed to load Preset.json." << std::endl;
+        return 1;
+    }
+
+    WireframeBench bench(scene, material);
+    bench.Run();
+    bool passed = bench.passed;
+    renderer.Shutdown();
+    passed &= SoftwareEdges(scene);
+    return passed ? 0 : 1;
+}
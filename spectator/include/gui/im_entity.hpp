@@ -9,6 +9,8 @@
 #include "renderer/components.hpp"
 #include "renderer/material.hpp"
 #include "renderer/mesh.hpp"
+#include "platform/opengl/opengl_mesh.hpp"
+#include "platform/opengl/opengl_material.hpp"
 
 //// TODO:
 // Implement type LUT to automatically try every panel
@@ -84,7 +86,7 @@ public:
         std::strncpy(buffer, cc.name.c_str(), sizeof(buffer));
         buffer[sizeof(buffer) - 1] = 0; // Ensure null termination
         if (ImGui::InputText("##NameEntity", buffer, sizeof(buffer))) {
-            cc.name = std::string(buffer);
+            e.SetName(std::string(buffer));
         }
         ImGui::Checkbox("Active", &cc.active);
         ComponentPanelEnd();
@@ -125,8 +127,7 @@ public:
             if (ImGui::Selectable("None")) {
                 mrc.mesh = nullptr;
             }
-            for (auto it = assetManager.begin<Mesh>(); it != assetManager.end<Mesh>(); ++it) {
-                std::shared_ptr<Mesh> mesh = std::dynamic_pointer_cast<Mesh>(*it);
+            for (const std::shared_ptr<OpenGLMesh>& mesh : assetManager.GetAssets<OpenGLMesh>()) {
                 if (ImGui::Selectable(mesh->name.c_str())) {
                     mrc.mesh = mesh;
                 }
@@ -134,18 +135,28 @@ public:
             ImGui::EndCombo();
         }
 
+        if (mrc.mesh != nullptr && mrc.mesh->IsUsable()) {
+            MeshMemoryUsage memory = mrc.mesh->GetMemoryUsage();
+            size_t packed = memory.vertexBytes + memory.indexBytes;
+            ImGui::Text(("Vertex Bytes: " + std::to_string(memory.vertexBytes)).c_str());
+            ImGui::Text(("Index Bytes: " + std::to_string(memory.indexBytes)).c_str());
+            ImGui::Text(("Unpacked Bytes: " + std::to_string(memory.unpackedBytes)).c_str());
+            if (memory.unpackedBytes > 0)
+                ImGui::Text("Packed Ratio: %.2f", (float)packed / (float)memory.unpackedBytes);
+        }
+
         if (ImGui::BeginCombo("Select Material", ((mrc.material == nullptr) ? "None": mrc.material->name.c_str()))) {
             if (ImGui::Selectable("None")) {
                 mrc.material = nullptr;
             } 
-            for (auto it = assetManager.begin<Mesh>(); it != assetManager.end<Mesh>(); ++it) {
-                std::shared_ptr<Material> material = std::dynamic_pointer_cast<Material>(*it);
+            for (const std::shared_ptr<OpenGLMaterial>& material : assetManager.GetAssets<OpenGLMaterial>()) {
                 if (ImGui::Selectable(material->name.c_str())) {
                     mrc.material = material;
                 }
             }
             ImGui::EndCombo();
         }
+        ImGui::Checkbox("Cast Shadows", &mrc.castShadows);
 
         ComponentPanelEnd();
     }
@@ -164,6 +175,7 @@ public:
         DirectionalLightComponent& dlc = e.GetComponent<DirectionalLightComponent>();
         ImGui::InputFloat3("Colour", dlc.colour.m);
         ImGui::SliderFloat("Intensity", &dlc.intensity, 0.0f, 5.0f, "%.2f", ImGuiSliderFlags_NoRoundToFormat);
+        ImGui::Checkbox("Cast Shadows", &dlc.castShadows);
         ComponentPanelEnd();
     }
 
@@ -186,6 +198,8 @@ public:
         ImGui::SliderFloat("Intensity", &slc.intensity, 0.0f, 5.0f, "%.2f", ImGuiSliderFlags_NoRoundToFormat);
         ImGui::SliderFloat("Cut Off", &slc.cutOff, 5.0f, 15.0f, "%.2f", ImGuiSliderFlags_NoRoundToFormat);
         ImGui::SliderFloat("Outer Cut Off", &slc.outerCutOff, 5.0f, 90.0f, "%.2f", ImGuiSliderFlags_NoRoundToFormat);
+        ImGui::SliderFloat("Range", &slc.range, 0.01f, 20.0f, "%.2f", ImGuiSliderFlags_NoRoundToFormat);
+        ImGui::Checkbox("Cast Shadows", &slc.castShadows);
         ComponentPanelEnd();
     }
 
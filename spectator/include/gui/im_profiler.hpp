@@ -0,0 +1,210 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <tinyfiledialogs.h>
+
+#include "gui/im_window.hpp"
+#include "core/profiler.hpp"
+
+//// TODO:
+// compare two selected frames
+// search/highlight zones by name
+
+//// NOTES:
+// Frame time graph over the profiler history, clicking a bar pauses and inspects that frame.
+// The selected frame is drawn as a timeline, one row per thread plus the GPU, nested zones stack downwards.
+// Below it zones are totalled by name for the frame, slowest first.
+
+#define IM_PROFILER_BAR_HEIGHT 18.0f
+#define IM_PROFILER_GRAPH_HEIGHT 60.0f
+
+class ImProfiler : public IImWindow {
+public:
+    ImProfiler() {
+        isOpen = false;
+    }
+
+    void ProfilerWindow() {
+        if (!isOpen)
+            return;
+        Profiler& profiler = Profiler::Instance();
+        ImGui::Begin("Profiler", &isOpen, _windowFlags);
+
+        bool recording = profiler.IsRecording();
+        if (ImGui::Checkbox("Record", &recording))
+            profiler.SetRecording(recording);
+        ImGui::SameLine();
+        bool paused = profiler.IsPaused();
+        if (ImGui::Checkbox("Pause", &paused)) {
+            profiler.SetPaused(paused);
+            _selected = -1;
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Save Trace")) {
+            const char* filepath = tinyfd_saveFileDialog("Save Chrome Trace", "profile.json", 0, NULL, NULL);
+            if (filepath != NULL)
+                profiler.WriteChromeTrace(filepath);
+        }
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(120.0f);
+        ImGui::SliderFloat("Zoom", &_zoom, 1.0f, 50.0f, "%.1fx", ImGuiSliderFlags_Logarithmic);
+
+        uint32_t frameCount = profiler.GetFrameCount();
+        if (frameCount == 0) {
+            ImGui::Text("No frames recorded yet.");
+            ImGui::End();
+            return;
+        }
+        if (_selected >= (int)frameCount)
+            _selected = -1;
+
+        FrameGraph(profiler, frameCount);
+        const ProfileFrame& frame = profiler.GetFrame(_selected < 0 ? frameCount - 1 : _selected);
+        ImGui::Text("Frame %llu: %.3f ms, %zu zones, %llu dropped", (unsigned long long)frame.index, frame.GetMillis(),
+            frame.events.size(), (unsigned long long)profiler.GetDroppedCount());
+
+        Timeline(profiler, frame);
+        Summary(frame);
+        ImGui::End();
+    }
+
+private:
+    // history index of the inspected frame, -1 follows the latest
+    int _selected = -1;
+    float _zoom = 1.0f;
+    std::vector<float> _frameTimes;
+
+    struct ZoneTotal {
+        const char* name = nullptr;
+        bool gpu = false;
+        uint32_t calls = 0;
+        double total = 0.0;
+        double max = 0.0;
+    };
+    std::vector<ZoneTotal> _totals;
+
+    void FrameGraph(Profiler& profiler, uint32_t frameCount) {
+        _frameTimes.resize(frameCount);
+        float maxMs = 0.0f;
+        for (uint32_t i = 0; i < frameCount; i++) {
+            _frameTimes[i] = profiler.GetFrame(i).GetMillis();
+            maxMs = std::max(maxMs, _frameTimes[i]);
+        }
+        ImVec2 size(ImGui::GetContentRegionAvail().x, IM_PROFILER_GRAPH_HEIGHT);
+        ImGui::PlotHistogram("##frames", _frameTimes.data(), frameCount, 0, NULL, 0.0f, maxMs * 1.1f, size);
+        if (ImGui::IsItemClicked()) {
+            float t = (ImGui::GetIO().MousePos.x - ImGui::GetItemRectMin().x) / ImGui::GetItemRectSize().x;
+            _selected = std::clamp((int)(t * frameCount), 0, (int)frameCount - 1);
+            // freeze the history so the selection keeps pointing at the same frame
+            profiler.SetPaused(true);
+        }
+    }
+
+    static ImU32 ZoneColour(const char* name) {
+        // stable per zone name
+        size_t hash = std::hash<std::string_view>{}(name);
+        float hue = (hash % 360) / 360.0f;
+        float r, g, b;
+        ImGui::ColorConvertHSVtoRGB(hue, 0.5f, 0.8f, r, g, b);
+        return ImGui::GetColorU32(ImVec4(r, g, b, 1.0f));
+    }
+
+    void Timeline(Profiler& profiler, const ProfileFrame& frame) {
+        // rows per track, deepest zone decides the height
+        std::vector<uint32_t> tracks;
+        std::unordered_map<uint32_t, uint32_t> depths;
+        for (const ProfileEvent& event : frame.events) {
+            auto it = depths.find(event.track);
+            if (it == depths.end()) {
+                depths[event.track] = event.depth;
+                tracks.push_back(event.track);
+            } else {
+                it->second = std::max(it->second, event.depth);
+            }
+        }
+        std::sort(tracks.begin(), tracks.end());
+
+        float height = 0.0f;
+        for (uint32_t track : tracks)
+            height += (depths[track] + 2) * IM_PROFILER_BAR_HEIGHT;
+        height = std::min(height + ImGui::GetStyle().ScrollbarSize, ImGui::GetContentRegionAvail().y * 0.6f);
+        ImGui::BeginChild("##timeline", ImVec2(0.0f, height), true, ImGuiWindowFlags_HorizontalScrollbar);
+
+        float width = ImGui::GetContentRegionAvail().x * _zoom;
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        double scale = width / std::max<double>(1.0, frame.end - frame.start);
+        ImVec2 mouse = ImGui::GetIO().MousePos;
+        float y = origin.y;
+        for (uint32_t track : tracks) {
+            drawList->AddText(ImVec2(origin.x + ImGui::GetScrollX(), y), ImGui::GetColorU32(ImGuiCol_Text),
+                profiler.GetTrackName(track).c_str());
+            y += IM_PROFILER_BAR_HEIGHT;
+            for (const ProfileEvent& event : frame.events) {
+                if (event.track != track)
+                    continue;
+                // zones can start before the frame on workers, clamp them to its range
+                double start = event.start > frame.start ? event.start - frame.start : 0.0;
+                double end = event.end > frame.start ? event.end - frame.start : 0.0;
+                ImVec2 min(origin.x + start * scale, y + event.depth * IM_PROFILER_BAR_HEIGHT);
+                ImVec2 max(origin.x + std::max(end * scale, start * scale + 1.0), min.y + IM_PROFILER_BAR_HEIGHT - 1.0f);
+                drawList->AddRectFilled(min, max, ZoneColour(event.name));
+                // label only when it fits
+                ImVec2 textSize = ImGui::CalcTextSize(event.name);
+                if (textSize.x + 4.0f < max.x - min.x)
+                    drawList->AddText(ImVec2(min.x + 2.0f, min.y + 1.0f), IM_COL32(0, 0, 0, 255), event.name);
+                if (ImGui::IsWindowHovered() && mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y)
+                    ImGui::SetTooltip("%s\n%.3f ms", event.name, (event.end - event.start) / 1e6);
+            }
+            y += (depths[track] + 1) * IM_PROFILER_BAR_HEIGHT;
+        }
+        ImGui::Dummy(ImVec2(width, y - origin.y));
+        ImGui::EndChild();
+    }
+
+    void Summary(const ProfileFrame& frame) {
+        // names are literals, so the pointer identifies the zone, GPU zones share names with their CPU side
+        _totals.clear();
+        std::unordered_map<const char*, size_t> index[2];
+        for (const ProfileEvent& event : frame.events) {
+            bool gpu = event.track == PROFILER_GPU_TRACK;
+            auto [it, inserted] = index[gpu].try_emplace(event.name, _totals.size());
+            if (inserted) {
+                _totals.emplace_back();
+                _totals.back().name = event.name;
+                _totals.back().gpu = gpu;
+            }
+            ZoneTotal& total = _totals[it->second];
+            double ms = (event.end - event.start) / 1e6;
+            total.calls++;
+            total.total += ms;
+            total.max = std::max(total.max, ms);
+        }
+        std::sort(_totals.begin(), _totals.end(), [](const ZoneTotal& a, const ZoneTotal& b) { return a.total > b.total; });
+
+        if (ImGui::BeginTable("##zones", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY)) {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("Zone");
+            ImGui::TableSetupColumn("Calls");
+            ImGui::TableSetupColumn("Total (ms)");
+            ImGui::TableSetupColumn("Max (ms)");
+            ImGui::TableHeadersRow();
+            for (const ZoneTotal& total : _totals) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text(total.gpu ? "%s (GPU)" : "%s", total.name);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", total.calls);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", total.total);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", total.max);
+            }
+            ImGui::EndTable();
+        }
+    }
+};
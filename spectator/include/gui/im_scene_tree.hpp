@@ -4,8 +4,12 @@
 #include "ecs/ngine.hpp"
 
 //// TODO:
-// Implement as tree
-// Allow for drag and dropping of nodes to rebind tree structure
+// Reorder siblings by drag and drop
+
+//// NOTES:
+// Drag a node onto another to parent it, drop onto the window background to make it a root.
+
+#define SCENE_TREE_PAYLOAD "SCENE_TREE_ENTITY"
 
 class ImSceneTree : public IImWindow {
 public:
@@ -15,18 +19,41 @@ public:
         return (bool)entitySelected;
     }
 
-    // flattened until scene tree implemented
-    void SceneNode(Entity e) {
+    void SceneNode(std::shared_ptr<Scene> scene, Entity e) {
         ImGuiTreeNodeFlags node_flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick | ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_DefaultOpen;
         if (entitySelected == e)
             node_flags |= ImGuiTreeNodeFlags_Selected;
-        node_flags |= ImGuiTreeNodeFlags_Leaf;
+        std::vector<Entity> children = e.GetChildren();
+        if (children.empty())
+            node_flags |= ImGuiTreeNodeFlags_Leaf;
+        ImGui::PushID((int)(uint32_t)e);
         bool node_open = ImGui::TreeNodeEx(e.GetComponent<CoreComponent>().name.c_str(), node_flags);
         if (ImGui::IsItemClicked() && !ImGui::IsItemToggledOpen())
             entitySelected = e;
+
+        // drag this node
+        if (ImGui::BeginDragDropSource()) {
+            uint32_t handle = (uint32_t)e;
+            ImGui::SetDragDropPayload(SCENE_TREE_PAYLOAD, &handle, sizeof(uint32_t));
+            ImGui::Text(e.GetComponent<CoreComponent>().name.c_str());
+            ImGui::EndDragDropSource();
+        }
+        // drop onto this node to parent
+        if (ImGui::BeginDragDropTarget()) {
+            if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload(SCENE_TREE_PAYLOAD)) {
+                Entity dragged = Entity{(entt::entity)*(const uint32_t*)payload->Data, scene.get()};
+                dragged.SetParent(e);
+            }
+            ImGui::EndDragDropTarget();
+        }
+
         if (node_open) {
+            for (auto child : children) {
+                SceneNode(scene, child);
+            }
             ImGui::TreePop();
-        }   
+        }
+        ImGui::PopID();
     }
     
     void SceneTreeWindow(std::shared_ptr<Scene> scene) {
@@ -34,7 +61,20 @@ public:
         if (scene != nullptr) {
             std::vector<Entity> entities = scene->GetEntities();
             for (auto e : entities) {
-                SceneNode(e);
+                if (!e.GetParent())
+                    SceneNode(scene, e);
+            }
+
+            // drop onto empty space to unparent
+            ImVec2 space = ImGui::GetContentRegionAvail();
+            space.y = std::max(space.y, ImGui::GetFrameHeight());
+            ImGui::Dummy(space);
+            if (ImGui::BeginDragDropTarget()) {
+                if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload(SCENE_TREE_PAYLOAD)) {
+                    Entity dragged = Entity{(entt::entity)*(const uint32_t*)payload->Data, scene.get()};
+                    dragged.SetParent(Entity());
+                }
+                ImGui::EndDragDropTarget();
             }
         }
         ImGui::End();
@@ -2,9 +2,16 @@
 
 #include "gui/im_window.hpp"
 #include "core/tick_timer.hpp"
+#include "core/frame_histogram.hpp"
+#include "runtime/application.hpp"
+#include "renderer/renderer.hpp"
+#include "renderer/texture.hpp"
+#include "core/derived_data_cache.hpp"
+#include "ecs/asset.hpp"
+#include "platform/opengl/opengl_texture.hpp"
 
 //// TODO:
-// add more stats, draw calls?
+// add more stats
 
 class ImStatistics : public IImWindow {
 public:
@@ -22,6 +29,60 @@ public:
         ImGui::Text(("Time Elapsed: " + std::to_string(timeElapsed)).c_str());
         ImGui::Text(("Time Delta: " + std::to_string(timeDelta)).c_str());
         ImGui::Text(("Frame Count: " + std::to_string(frameCount)).c_str());
+
+        // frame time distribution over the histogram window, plotted up to the slowest frame
+        Application& app = Application::Instance();
+        const LoopStats& loop = app.GetLoopStats();
+        ImGui::Text("Frame Time: p50 %.2f ms, p99 %.2f ms, max %.2f ms", loop.frameTimes.p50, loop.frameTimes.p99, loop.frameTimes.max);
+        ImGui::Text("Fixed Steps: %u, alpha %.2f, paced %.2f ms", loop.fixedSteps, loop.alpha, loop.sleptMs);
+        const auto& bins = app.GetFrameTimes().GetBins();
+        int lastBin = 0;
+        for (int i = 0; i < FRAME_HISTOGRAM_BINS; i++) {
+            if (bins[i] > 0)
+                lastBin = i;
+        }
+        ImGui::PlotHistogram("##frame_times", [](void* data, int i) { return (float)static_cast<const uint32_t*>(data)[i]; },
+            (void*)bins.data(), lastBin + 1, 0, "frames per 0.25 ms", 0.0f, FLT_MAX, ImVec2(0.0f, 50.0f));
+
+        const RenderStats& stats = Renderer::Instance().GetStats();
+        ImGui::Separator();
+        ImGui::Text(("Draws: " + std::to_string(stats.draws)).c_str());
+        ImGui::Text(("Instances: " + std::to_string(stats.instances)).c_str());
+        ImGui::Text(("Program Binds: " + std::to_string(stats.programBinds)).c_str());
+        ImGui::Text(("VAO Binds: " + std::to_string(stats.vaoBinds)).c_str());
+        ImGui::Text(("Uniform Uploads: " + std::to_string(stats.uniformUploads)).c_str());
+        ImGui::Text(("Draw Mode Changes: " + std::to_string(stats.drawModeChanges)).c_str());
+        ImGui::Text(("Triangles: " + std::to_string(stats.triangles)).c_str());
+        ImGui::Text(("Visible: " + std::to_string(stats.visible)).c_str());
+        ImGui::Text(("Culled: " + std::to_string(stats.culled)).c_str());
+        ImGui::Text(("Upload Bytes: " + std::to_string(stats.uploadBytes)).c_str());
+        ImGui::Text(("Uploads Pending: " + std::to_string(stats.uploadsPending)).c_str());
+        ImGui::Text("Shadow Maps: %u drawn, %u cached", stats.shadowViews, stats.shadowCacheHits);
+        ImGui::Text("Shadow Draws: %u (%u casters)", stats.shadowDraws, stats.shadowCasters);
+        ImGui::Text("G-Buffer Draws: %u, %u lighting passes", stats.gBufferDraws, stats.lightingPasses);
+        // switch paths to compare their frame times on the same scene
+        bool deferred = Renderer::Instance().GetRenderPath() == RenderPath::DEFERRED;
+        if (ImGui::Checkbox("Deferred Shading", &deferred))
+            Renderer::Instance().SetRenderPath(deferred ? RenderPath::DEFERRED : RenderPath::FORWARD);
+        bool singlePass = Renderer::Instance().IsSinglePassWireframe();
+        if (ImGui::Checkbox("Single Pass Wireframe", &singlePass))
+            Renderer::Instance().SetSinglePassWireframe(singlePass);
+        bool meshLOD = Renderer::Instance().IsMeshLOD();
+        if (ImGui::Checkbox("Mesh LOD", &meshLOD))
+            Renderer::Instance().SetMeshLOD(meshLOD);
+
+        // textures report their memory once resident
+        size_t textureBytes = 0;
+        size_t uncompressedBytes = 0;
+        for (const auto& texture : AssetManager::Instance().GetAssets<OpenGLTexture>()) {
+            TextureMemoryUsage usage = static_cast<Texture*>(texture.get())->GetMemoryUsage();
+            textureBytes += usage.bytes;
+            uncompressedBytes += usage.uncompressedBytes;
+        }
+        DerivedDataStats cache = DerivedDataCache::Instance().GetStats();
+        ImGui::Separator();
+        ImGui::Text("Texture Memory: %.1f MB (%.1f MB saved)", textureBytes / 1048576.0, (uncompressedBytes - textureBytes) / 1048576.0);
+        ImGui::Text("Derived Data Cache: %u hits, %u misses (%.0f%%)", cache.hits, cache.misses, cache.GetHitRate() * 100.0f);
         ImGui::End();
     }
 
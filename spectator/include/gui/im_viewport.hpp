@@ -108,8 +108,11 @@ public:
             LA::mat4 view = LA::inverse(ec->transform.GetTransform());
             LA::mat4 proj = ec->GetProjection();
             
+            // gizmo works in world space, children are converted back into parent space
             TransformComponent& tc = entitySelected.GetComponent<TransformComponent>();
-            LA::mat4 selectedTrans = tc.GetTransform();
+            Entity parent = entitySelected.GetParent();
+            LA::mat4 parentTrans = parent ? parent.GetComponent<TransformComponent>().GetWorldTransform() : LA::mat4();
+            LA::mat4 selectedTrans = parentTrans * tc.GetTransform();
 
             float distance = 8.f;
             ImGuizmo::ViewManipulate((float*)&view, distance, ImVec2(viewManipulateRight - 128, viewManipulateTop), ImVec2(128, 128), 0x10101010);
@@ -119,6 +122,9 @@ public:
                 std::cout << "manipulate" << std::endl;
             }
             
+            if (parent)
+                selectedTrans = LA::inverse(parentTrans) * selectedTrans;
+
             // Note: decompose converts to quartenions and breaks current LA implementation of rotations
             LA::vec3 pos, rot, scl;
             ImGuizmo::DecomposeMatrixToComponents((float*)&selectedTrans, (float*)&pos, (float*)&rot, (float*)&scl);
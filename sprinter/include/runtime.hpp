@@ -2,14 +2,17 @@
 
 #include "ecs/ngine.hpp"
 #include "runtime/interactive.hpp"
+#include "runtime/application.hpp"
 #include "renderer/renderer.hpp"
+#include "renderer/scene_renderer.hpp"
 #include "core/tick_timer.hpp"
-#include "serializer/scene_serializer.hpp"
+#include "serializer/scene_converter.hpp"
 #include "input/input.hpp"
 #include "platform/opengl/opengl_material.hpp"
 #include "platform/opengl/opengl_renderer.hpp"
 #include "renderer/shader_loader.hpp"
 #include "renderer/model_loader.hpp"
+#include "renderer/texture_loader.hpp"
 
 
 #include "first_person_camera.hpp"
@@ -17,12 +20,6 @@
 //// TODO:
 // consolidate naming such that Tick is every frame/on timer
 
-enum class ShadingMode {
-    SHADED,
-    WIREFRAME,
-    SHADED_WIREFRAME
-};
-
 class Runtime : public Interactive {
 private:
     // global modules
@@ -30,21 +27,20 @@ private:
     AssetLoaderManager& loaderManager = AssetLoaderManager::Instance();
     Renderer& renderer = OpenGLRenderer::Instance();
     std::shared_ptr<Scene> scene = std::make_shared<Scene>();
+    std::shared_ptr<TextureLoader> textureLoader = std::make_shared<TextureLoader>();
 
     // local stuff
     FirstPersonCamera firstPersonCamera = FirstPersonCamera();
     ShadingMode shadingMode = ShadingMode::SHADED_WIREFRAME;
 
-    // Load Scene from JSON
+    // Load Scene from JSON or binary, by extension
     void LoadScene(const std::string& filepath) {
-        SceneSerializer js = SceneSerializer(*scene);
-        js.Deserialize(filepath);
+        LoadSceneFile(*scene, filepath);
     }
 
-    // Save scene to JSON
+    // Save scene to JSON or binary, by extension
     void SaveScene(const std::string& filepath) {
-        SceneSerializer js = SceneSerializer(*scene);
-        js.Serialize(filepath);
+        SaveSceneFile(*scene, filepath);
     }
     
 
@@ -53,25 +49,34 @@ public:
     ~Runtime() {}
 
     void Start() override {
+        auto startTime = std::chrono::steady_clock::now();
         // add loaders to asset libary
         loaderManager.AddLoader(std::make_shared<ModelLoader>());
         loaderManager.AddLoader(std::make_shared<ShaderLoader>());
-
-        // load default model(s)
-        loaderManager.Load("marathon/assets/models/presets/cone.gltf");
-        loaderManager.Load("marathon/assets/models/presets/cube.gltf");
-        loaderManager.Load("marathon/assets/models/presets/cylinder.gltf");
-        loaderManager.Load("marathon/assets/models/presets/dome.gltf");
-        loaderManager.Load("marathon/assets/models/presets/ico_sphere.gltf");
-        loaderManager.Load("marathon/assets/models/presets/plane.gltf");
-        loaderManager.Load("marathon/assets/models/presets/prism.gltf");
-        loaderManager.Load("marathon/assets/models/presets/sphere.gltf");
-
-        // load default shader source(s)
-        loaderManager.Load("marathon/assets/shaders/base.vert");
-        loaderManager.Load("marathon/assets/shaders/base.frag");
-        loaderManager.Load("marathon/assets/shaders/lighting.vert");
-        loaderManager.Load("marathon/assets/shaders/lighting.frag");
+        loaderManager.AddLoader(textureLoader);
+
+        // load default model(s) and shader source(s), parsed in parallel
+        std::vector<AssetLoadHandle> loads = loaderManager.LoadAsync({
+            "marathon/assets/models/presets/cone.gltf",
+            "marathon/assets/models/presets/cube.gltf",
+            "marathon/assets/models/presets/cylinder.gltf",
+            "marathon/assets/models/presets/dome.gltf",
+            "marathon/assets/models/presets/ico_sphere.gltf",
+            "marathon/assets/models/presets/plane.gltf",
+            "marathon/assets/models/presets/prism.gltf",
+            "marathon/assets/models/presets/sphere.gltf",
+            "marathon/assets/shaders/base.vert",
+            "marathon/assets/shaders/base.frag",
+            "marathon/assets/shaders/lighting.vert",
+            "marathon/assets/shaders/lighting.frag",
+            "marathon/assets/shaders/lighting.geom",
+            "marathon/assets/shaders/shadow.vert",
+            "marathon/assets/shaders/shadow.frag",
+            "marathon/assets/shaders/deferred.vert",
+            "marathon/assets/shaders/deferred.frag"
+        });
+        // shaders below need the sources, so block here
+        loaderManager.Wait(loads);
 
         // load default shader(s)
         std::shared_ptr<Shader> base = assetManager.CreateAsset<OpenGLShader>(
@@ -82,7 +87,21 @@ public:
         std::shared_ptr<Shader> lighting = assetManager.CreateAsset<OpenGLShader>(
             "lighting",
             assetManager.FindAsset<OpenGLShaderSource>("lighting_vert"),
-            assetManager.FindAsset<OpenGLShaderSource>("lighting_frag")
+            assetManager.FindAsset<OpenGLShaderSource>("lighting_frag"),
+            // draws the wireframe overlay in the same pass
+            assetManager.FindAsset<OpenGLShaderSource>("lighting_geom")
+        );
+        // depth only, SceneRenderer draws shadow maps with it
+        assetManager.CreateAsset<OpenGLShader>(
+            SHADOW_SHADER_NAME,
+            assetManager.FindAsset<OpenGLShaderSource>("shadow_vert"),
+            assetManager.FindAsset<OpenGLShaderSource>("shadow_frag")
+        );
+        // full screen G-buffer lighting for the deferred path
+        assetManager.CreateAsset<OpenGLShader>(
+            DEFERRED_SHADER_NAME,
+            assetManager.FindAsset<OpenGLShaderSource>("deferred_vert"),
+            assetManager.FindAsset<OpenGLShaderSource>("deferred_frag")
         );
 
         // load material(s)
@@ -91,9 +110,22 @@ public:
         );
         material->SetProperty("colour", vec4(1.0f));
         material->shader = lighting;
+        std::shared_ptr<Material> wireframe = assetManager.CreateAsset<OpenGLMaterial>(
+            WIREFRAME_MATERIAL_NAME
+        );
+        wireframe->shader = base;
 
         // load scene
         LoadScene("marathon/assets/scenes/Preset.json");
+
+        // compare cold and warm starts, a warm start should be all hits
+        double startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        DerivedDataStats stats = DerivedDataCache::Instance().GetStats();
+        TextureImportStats textures = textureLoader->GetStats();
+        std::cout << "DEBUG (Runtime): Startup took " << startupMs << " ms, derived data cache "
+                  << stats.hits << " hits / " << stats.misses << " misses (" << stats.GetHitRate() * 100.0f << "% hit rate), "
+                  << textures.textures << " textures " << textures.memory.bytes / 1024 << " KB ("
+                  << (textures.memory.uncompressedBytes - textures.memory.bytes) / 1024 << " KB saved)" << std::endl;
     }
 
     void Update(double dt) override {
@@ -105,128 +137,19 @@ public:
 
     void End() override {
         // clean up resources if necessary
+        FrameStats frames = Application::Instance().GetLoopStats().frameTimes;
+        std::cout << "DEBUG (Runtime): Frame time p50 " << frames.p50 << " ms, p99 " << frames.p99
+                  << " ms over the last " << frames.frames << " frames" << std::endl;
     }
 
     void RenderScene(std::shared_ptr<Scene> scene, FirstPersonCamera& camera) {
-        std::vector<std::shared_ptr<Asset>> shaders = assetManager.GetAssets<OpenGLShader>();
-        for (auto asset : shaders) {
-            // set editor camera uniforms
-            std::shared_ptr<Shader> shader = std::dynamic_pointer_cast<Shader>(asset);
-            renderer.SetProjection(camera.GetProjection());
-            renderer.SetView(LA::inverse(camera.transform.GetTransform()));
-            shader->Bind();
-            shader->SetVec3("uResolution", camera.width, camera.height, 1.0f);
-            shader->SetVec3("uCameraPosition", camera.transform.position);
-
-            // set lighting objects
-            ShaderDirectionalLights(shader);
-            ShaderPointLights(shader);
-            ShaderSpotLights(shader);
-        }
-        // render entities
-        std::vector<Entity> renderables = scene->GetEntitiesWith<MeshRendererComponent>();
-        for (auto& ent : renderables) {
-            RenderObject(ent);
-        }
-    }
-
-    void RenderObject(Entity entity) {
-        TransformComponent& tc = entity.GetComponent<TransformComponent>();
-        mat4 model = tc.GetTransform();
-
-        // check meshrenderer mesh is not none
-        MeshRendererComponent& mrc = entity.GetComponent<MeshRendererComponent>();
-        std::shared_ptr<Mesh> mesh = mrc.mesh;
-        std::shared_ptr<Material> material = mrc.material;
-        if (mesh == nullptr || material == nullptr) {
-            std::cout << "WARNING (GraphicsEngine): Trying to render null mesh/material." << std::endl;
-            return;
-        }
-
-        renderer.context->SetDrawMode(DrawMode::FILL);
-        // render shaded
-        if (shadingMode == ShadingMode::SHADED || shadingMode == ShadingMode::SHADED_WIREFRAME) {
-            if (material->IsUsable()) {
-                material->Bind();
-                renderer.RenderMesh(material->shader, mrc.mesh, model);
-            }
-        } 
-        
-        renderer.context->SetDrawMode(DrawMode::LINES);
-        // render wireframe
-        if (shadingMode == ShadingMode::WIREFRAME || shadingMode == ShadingMode::SHADED_WIREFRAME) {
-            std::shared_ptr<Shader> shader = assetManager.FindAsset<OpenGLShader>("base");
-            renderer.RenderMesh(shader, mrc.mesh, model);
-        }
-    }
-
-
-    void ShaderDirectionalLights(std::shared_ptr<Shader> shader) {
-        std::vector<Entity> entities = scene->GetEntitiesWith<DirectionalLightComponent>();
-        
-        // directional lights
-        if (entities.size() >= DIRECTIONAL_LIGHT_MAX) {
-            std::cout << "WARNING (Renderer): Too many directional lights, only first 4 will be used" << std::endl;
-        }
-        for (int i = 0; i < DIRECTIONAL_LIGHT_MAX; i++) {
-            std::string index = "[" + std::to_string(i) + "]";
-            if (i < entities.size()) {
-                TransformComponent& tc = entities[i].GetComponent<TransformComponent>();
-                DirectionalLightComponent& dlc = entities[i].GetComponent<DirectionalLightComponent>();
-                shader->SetVec3("uDirectionalLights" + index + ".colour", dlc.colour);
-                shader->SetFloat("uDirectionalLights" + index + ".intensity", dlc.intensity);
-                shader->SetVec3("uDirectionalLights" + index + ".direction", tc.GetForward());
-                shader->SetInt("uDirectionalLights" + index + ".enabled", 1);
-            } else {
-                shader->SetInt("uDirectionalLights" + index + ".enabled", 0);
-            }
-        }
-    }
-
-    void ShaderPointLights(std::shared_ptr<Shader> shader) {
-        std::vector<Entity> entities = scene->GetEntitiesWith<PointLightComponent>();
-
-        // point lights
-        if (entities.size() >= POINT_LIGHT_MAX) {
-            std::cout << "WARNING (Renderer): Too many point lights, only first 16 will be used" << std::endl;
-        }
-        for (int i = 0; i < POINT_LIGHT_MAX; i++) {
-            std::string index = "[" + std::to_string(i) + "]";
-            if (i < entities.size()) {
-                TransformComponent& tc = entities[i].GetComponent<TransformComponent>();
-                PointLightComponent& plc = entities[i].GetComponent<PointLightComponent>();
-                shader->SetVec3("uPointLights" + index + ".colour", plc.colour);
-                shader->SetFloat("uPointLights" + index + ".intensity", plc.intensity);
-                shader->SetVec3("uPointLights" + index + ".position", tc.position);
-                shader->SetInt("uPointLights" + index + ".enabled", 1);
-            } else {
-                shader->SetInt("uPointLights" + index + ".enabled", 0);
-            }
-        }
-    }
-
-    void ShaderSpotLights(std::shared_ptr<Shader> shader) {
-        std::vector<Entity> entities = scene->GetEntitiesWith<SpotLightComponent>();
-
-        // point lights
-        if (entities.size() >= POINT_LIGHT_MAX) {
-            std::cout << "WARNING (Renderer): Too many spot lights, only first 4 will be used" << std::endl;
-        }
-        for (int i = 0; i < POINT_LIGHT_MAX; i++) {
-            std::string index = "[" + std::to_string(i) + "]";
-            if (i < entities.size()) {
-                TransformComponent& tc = entities[i].GetComponent<TransformComponent>();
-                SpotLightComponent& slc = entities[i].GetComponent<SpotLightComponent>();
-                shader->SetVec3("uSpotLights" + index + ".colour", slc.colour);
-                shader->SetFloat("uSpotLights" + index + ".intensity", slc.intensity);
-                shader->SetVec3("uSpotLights" + index + ".position", tc.position);
-                shader->SetVec3("uSpotLights" + index + ".direction", tc.GetForward());
-                shader->SetFloat("uSpotLights" + index + ".cutOff", LA::Radians(slc.cutOff));
-                shader->SetFloat("uSpotLights" + index + ".outerCutOff", LA::Radians(slc.outerCutOff));
-                shader->SetInt("uSpotLights" + index + ".enabled", 1);
-            } else {
-                shader->SetInt("uSpotLights" + index + ".enabled", 0);
-            }
-        }
+        SceneView view;
+        view.projection = camera.GetProjection();
+        view.view = LA::inverse(camera.transform.GetTransform());
+        view.position = camera.transform.position;
+        view.width = camera.width;
+        view.height = camera.height;
+        SceneRenderer sr = SceneRenderer(*scene);
+        sr.Render(view, shadingMode);
     }
-};
+};
\ No newline at end of file